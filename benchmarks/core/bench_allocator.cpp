@@ -0,0 +1,108 @@
+#include "velm/core/allocator.h"
+#include "velm/core/ndarray.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#    include <sys/resource.h>
+#endif
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+
+using velm_DR::ndarray;
+
+/*
+ * Construction cost of a cubic float grid of edge state.range(0) for each storage policy, compared with the
+ * original `new T[n]{}` path. Each policy is measured twice: construction alone, and construction followed by a
+ * full overwrite (what an I/O read does), which is the fair comparison for uninitialised construction since its
+ * page faults are only deferred to the first write.
+ */
+
+namespace {
+
+long minor_page_faults() {
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_minflt;
+#else
+    return 0;
+#endif
+}
+
+void report(benchmark::State & state, long faults_before) {
+    std::size_t edge  = static_cast<std::size_t>(state.range(0));
+    std::size_t bytes = edge * edge * edge * sizeof(float);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+    double faults = static_cast<double>(minor_page_faults() - faults_before);
+    state.counters["page_faults"] = benchmark::Counter(faults, benchmark::Counter::kAvgIterations);
+}
+
+template <bool Overwrite> void BM_new_array(benchmark::State & state) {
+    std::size_t edge   = static_cast<std::size_t>(state.range(0));
+    std::size_t count  = edge * edge * edge;
+    long        faults = minor_page_faults();
+    for (auto _ : state) {
+        float * data = new float[count]{};
+        if constexpr (Overwrite) {
+            for (std::size_t i = 0; i < count; ++i) {
+                data[i] = 1.0f;
+            }
+        }
+        benchmark::DoNotOptimize(data);
+        delete[] data;
+    }
+    report(state, faults);
+}
+
+template <typename Alloc, bool Uninitialized, bool Overwrite> void BM_ndarray(benchmark::State & state) {
+    std::size_t edge   = static_cast<std::size_t>(state.range(0));
+    long        faults = minor_page_faults();
+    for (auto _ : state) {
+        if constexpr (Uninitialized) {
+            ndarray<float, 3, Alloc> grid(velm_DR::uninitialized, edge, edge, edge);
+            if constexpr (Overwrite) {
+                grid.fill(1.0f);
+            }
+            benchmark::DoNotOptimize(grid.data);
+        } else {
+            ndarray<float, 3, Alloc> grid(edge, edge, edge);
+            if constexpr (Overwrite) {
+                grid.fill(1.0f);
+            }
+            benchmark::DoNotOptimize(grid.data);
+        }
+    }
+    report(state, faults);
+}
+
+template <bool Overwrite> void BM_ndarray_pooled(benchmark::State & state) {
+    std::size_t                    edge = static_cast<std::size_t>(state.range(0));
+    velm_DR::block_pool            pool;
+    velm_DR::pool_allocator<float> alloc(pool);
+    long                           faults = minor_page_faults();
+    for (auto _ : state) {
+        ndarray<float, 3, velm_DR::pool_allocator<float>> grid(velm_DR::uninitialized, alloc, edge, edge, edge);
+        if constexpr (Overwrite) {
+            grid.fill(1.0f);
+        }
+        benchmark::DoNotOptimize(grid.data);
+    }
+    report(state, faults);
+}
+
+using aligned   = velm_DR::aligned_allocator<float>;
+using huge_page = velm_DR::huge_page_allocator<float>;
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_new_array, false)->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_ndarray, aligned, false, false)->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_ndarray, aligned, true, false)->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_ndarray, huge_page, false, false)->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_ndarray_pooled, false)->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_TEMPLATE(BM_new_array, true)->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_ndarray, aligned, false, true)->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_ndarray, aligned, true, true)->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_ndarray, huge_page, false, true)->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_ndarray_pooled, true)->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,140 @@
+#include "velm/core/bricked_array.h"
+#include "velm/core/ndarray.h"
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+using velm_DR::brick_order;
+using velm_DR::bricked_array;
+using velm_DR::ndarray;
+
+/*
+ * Row-major ndarray against bricked storage on a 256^3 float grid.
+ *
+ * BM_slice copies the middle plane normal to axis state.range(0) through operator(), as a slicing viewer would;
+ * for the row-major layout axis 0 is one contiguous block and axis 2 a gather with a stride of a whole row.
+ * BM_laplacian is a 7-point stencil over the interior; the bricked version walks one brick at a time and only goes
+ * through the brick table for neighbours in an adjacent brick.
+ */
+
+namespace {
+
+constexpr std::size_t edge = 256;
+
+using linear_grid  = ndarray<float, 3>;
+using brick8_grid  = bricked_array<float, 8>;
+using brick16_grid = bricked_array<float, 16>;
+
+float sample(std::size_t i, std::size_t j, std::size_t k) {
+    return static_cast<float>((i * 7 + j * 13 + k * 29) % 1021) * 0.01f;
+}
+
+template <typename Grid> Grid make_grid(brick_order order) {
+    Grid grid = [&] {
+        if constexpr (std::is_same_v<Grid, linear_grid>) {
+            (void)order;
+            return Grid(velm_DR::uninitialized, edge, edge, edge);
+        } else {
+            return Grid(velm_DR::uninitialized, edge, edge, edge, order);
+        }
+    }();
+    for (std::size_t i = 0; i < edge; ++i) {
+        for (std::size_t j = 0; j < edge; ++j) {
+            for (std::size_t k = 0; k < edge; ++k) {
+                grid(i, j, k) = sample(i, j, k);
+            }
+        }
+    }
+    return grid;
+}
+
+template <typename Grid, brick_order Order> void BM_slice(benchmark::State & state) {
+    const std::size_t  axis = static_cast<std::size_t>(state.range(0));
+    const std::size_t  mid  = edge / 2;
+    Grid               grid = make_grid<Grid>(Order);
+    std::vector<float> plane(edge * edge);
+    for (auto _ : state) {
+        float * out = plane.data();
+        for (std::size_t u = 0; u < edge; ++u) {
+            for (std::size_t v = 0; v < edge; ++v) {
+                *out++ = axis == 0 ? grid(mid, u, v) : axis == 1 ? grid(u, mid, v) : grid(u, v, mid);
+            }
+        }
+        benchmark::DoNotOptimize(plane.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * edge * edge * sizeof(float)));
+}
+
+void BM_laplacian_linear(benchmark::State & state) {
+    linear_grid in  = make_grid<linear_grid>(brick_order::linear);
+    linear_grid out = make_grid<linear_grid>(brick_order::linear);
+    for (auto _ : state) {
+        for (std::size_t i = 1; i + 1 < edge; ++i) {
+            for (std::size_t j = 1; j + 1 < edge; ++j) {
+                const float * c = &in(i, j, 0);
+                float *       o = &out(i, j, 0);
+                for (std::size_t k = 1; k + 1 < edge; ++k) {
+                    o[k] = c[k - edge * edge] + c[k + edge * edge] + c[k - edge] + c[k + edge] + c[k - 1] + c[k + 1] -
+                           6.0f * c[k];
+                }
+            }
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * 2 * edge * edge * edge * sizeof(float)));
+}
+
+template <typename Grid, brick_order Order> void BM_laplacian_bricked(benchmark::State & state) {
+    constexpr std::size_t B   = Grid::brick_edge;
+    Grid                  in  = make_grid<Grid>(Order);
+    Grid                  out = make_grid<Grid>(Order);
+    for (auto _ : state) {
+        for (std::size_t b = 0; b < in.brick_count(); ++b) {
+            auto src = in.brick(b);
+            auto dst = out.brick(b);
+            for (std::size_t i = 0; i < B; ++i) {
+                std::size_t gi = src.origin[0] + i;
+                if (gi == 0 || gi + 1 == edge) {
+                    continue;
+                }
+                for (std::size_t j = 0; j < B; ++j) {
+                    std::size_t gj = src.origin[1] + j;
+                    if (gj == 0 || gj + 1 == edge) {
+                        continue;
+                    }
+                    const float * c = &src.view(i, j, 0);
+                    float *       o = &dst.view(i, j, 0);
+                    // neighbours across the brick faces along x and y are fetched per row, the rest stay in the brick
+                    const float * xm = i > 0 ? c - B * B : &in(gi - 1, gj, src.origin[2]);
+                    const float * xp = i + 1 < B ? c + B * B : &in(gi + 1, gj, src.origin[2]);
+                    const float * ym = j > 0 ? c - B : &in(gi, gj - 1, src.origin[2]);
+                    const float * yp = j + 1 < B ? c + B : &in(gi, gj + 1, src.origin[2]);
+                    float         zm = src.origin[2] > 0 ? in(gi, gj, src.origin[2] - 1) : 0.0f;
+                    float         zp = src.origin[2] + B < edge ? in(gi, gj, src.origin[2] + B) : 0.0f;
+                    o[0] = xm[0] + xp[0] + ym[0] + yp[0] + zm + c[1] - 6.0f * c[0];
+                    for (std::size_t k = 1; k + 1 < B; ++k) {
+                        o[k] = xm[k] + xp[k] + ym[k] + yp[k] + c[k - 1] + c[k + 1] - 6.0f * c[k];
+                    }
+                    o[B - 1] = xm[B - 1] + xp[B - 1] + ym[B - 1] + yp[B - 1] + c[B - 2] + zp - 6.0f * c[B - 1];
+                }
+            }
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * 2 * edge * edge * edge * sizeof(float)));
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_slice, linear_grid, brick_order::linear)->DenseRange(0, 2)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_slice, brick8_grid, brick_order::linear)->DenseRange(0, 2)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_slice, brick8_grid, brick_order::morton)->DenseRange(0, 2)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_slice, brick16_grid, brick_order::morton)->DenseRange(0, 2)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(BM_laplacian_linear)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_laplacian_bricked, brick8_grid, brick_order::linear)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_laplacian_bricked, brick8_grid, brick_order::morton)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_laplacian_bricked, brick16_grid, brick_order::morton)->Unit(benchmark::kMillisecond);
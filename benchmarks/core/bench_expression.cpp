@@ -0,0 +1,72 @@
+#include "velm/core/ndarray.h"
+
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstddef>
+
+using velm_DR::ndarray;
+
+/*
+ * |E| = sqrt(ex² + ey² + ez²) on a 192^3 float grid, three ways: the lazy expression, a hand-written loop (the
+ * lower bound), and eager evaluation through full-size temporaries, which is what overloaded operators returning
+ * ndarray would cost.
+ */
+
+namespace {
+
+constexpr std::size_t edge = 192;
+
+ndarray<float, 3> make_component(float scale) {
+    ndarray<float, 3> field(velm_DR::uninitialized, edge, edge, edge);
+    for (std::size_t n = 0; n < field.total_elements(); ++n) {
+        field.data[n] = static_cast<float>(n % 977) * scale;
+    }
+    return field;
+}
+
+void report(benchmark::State & state) {
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * 4 * edge * edge * edge * sizeof(float)));
+}
+
+void BM_magnitude_expression(benchmark::State & state) {
+    ndarray<float, 3> ex = make_component(0.1f), ey = make_component(0.2f), ez = make_component(0.3f);
+    ndarray<float, 3> mag(velm_DR::uninitialized, edge, edge, edge);
+    for (auto _ : state) {
+        mag = sqrt(ex * ex + ey * ey + ez * ez);
+        benchmark::DoNotOptimize(mag.data);
+    }
+    report(state);
+}
+
+void BM_magnitude_loop(benchmark::State & state) {
+    ndarray<float, 3> ex = make_component(0.1f), ey = make_component(0.2f), ez = make_component(0.3f);
+    ndarray<float, 3> mag(velm_DR::uninitialized, edge, edge, edge);
+    for (auto _ : state) {
+        for (std::size_t n = 0; n < mag.total_elements(); ++n) {
+            mag.data[n] = std::sqrt(ex.data[n] * ex.data[n] + ey.data[n] * ey.data[n] + ez.data[n] * ez.data[n]);
+        }
+        benchmark::DoNotOptimize(mag.data);
+    }
+    report(state);
+}
+
+void BM_magnitude_temporaries(benchmark::State & state) {
+    ndarray<float, 3> ex = make_component(0.1f), ey = make_component(0.2f), ez = make_component(0.3f);
+    for (auto _ : state) {
+        // one materialised array per operator, as eager operators would produce
+        ndarray<float, 3> xx = ex * ex;
+        ndarray<float, 3> yy = ey * ey;
+        ndarray<float, 3> zz = ez * ez;
+        ndarray<float, 3> s1 = xx + yy;
+        ndarray<float, 3> s2 = s1 + zz;
+        ndarray<float, 3> mag = sqrt(s2);
+        benchmark::DoNotOptimize(mag.data);
+    }
+    report(state);
+}
+
+}  // namespace
+
+BENCHMARK(BM_magnitude_expression)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_magnitude_loop)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_magnitude_temporaries)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,175 @@
+#include "velm/core/fixed_ndarray.h"
+#include "velm/core/ndarray.h"
+#include "velm/core/tensor_array.h"
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+
+using velm_DR::mat3;
+using velm_DR::ndarray;
+using velm_DR::tensor_array;
+using velm_DR::tensor_layout;
+using velm_DR::vec3;
+
+/*
+ * Per-voxel 3x3 tensors on a 96^3 grid, stored as trailing runtime dimensions of an ndarray (the current path)
+ * against a tensor_array of mat3 in either layout.
+ *
+ * BM_trace reads the diagonal of every tensor through operator(), which measures indexing alone. BM_mat_vec is
+ * D = eps E at every voxel, the constitutive step of a field solver; the SoA variant through the proxy still goes
+ * voxel by voxel, while BM_mat_vec_planes works on the nine component planes directly, which is the access pattern
+ * SoA exists for and the one the compiler can vectorise.
+ */
+
+namespace {
+
+constexpr std::size_t edge   = 96;
+constexpr std::size_t voxels = edge * edge * edge;
+
+float sample(std::size_t v, std::size_t c) {
+    return static_cast<float>((v * 7 + c * 13) % 101) * 0.01f;
+}
+
+template <tensor_layout Layout> using tensor_field = tensor_array<mat3<float>, 3, Layout>;
+template <tensor_layout Layout> using vector_field = tensor_array<vec3<float>, 3, Layout>;
+
+ndarray<float, 5> make_runtime_tensors() {
+    ndarray<float, 5> eps(velm_DR::uninitialized, edge, edge, edge, 3, 3);
+    for (std::size_t v = 0; v < voxels; ++v) {
+        for (std::size_t c = 0; c < 9; ++c) {
+            eps.data[v * 9 + c] = sample(v, c);
+        }
+    }
+    return eps;
+}
+
+template <tensor_layout Layout> tensor_field<Layout> make_tensors() {
+    tensor_field<Layout> eps(velm_DR::uninitialized, edge, edge, edge);
+    for (std::size_t v = 0; v < voxels; ++v) {
+        mat3<float> m;
+        for (std::size_t c = 0; c < 9; ++c) {
+            m.data[c] = sample(v, c);
+        }
+        eps.voxel(v) = m;
+    }
+    return eps;
+}
+
+template <tensor_layout Layout> vector_field<Layout> make_vectors() {
+    vector_field<Layout> e(velm_DR::uninitialized, edge, edge, edge);
+    for (std::size_t v = 0; v < voxels; ++v) {
+        e.voxel(v) = vec3<float>{ sample(v, 0), sample(v, 1), sample(v, 2) };
+    }
+    return e;
+}
+
+void BM_trace_runtime(benchmark::State & state) {
+    ndarray<float, 5> eps = make_runtime_tensors();
+    for (auto _ : state) {
+        float sum = 0.0f;
+        for (std::size_t i = 0; i < edge; ++i) {
+            for (std::size_t j = 0; j < edge; ++j) {
+                for (std::size_t k = 0; k < edge; ++k) {
+                    sum += eps(i, j, k, 0, 0) + eps(i, j, k, 1, 1) + eps(i, j, k, 2, 2);
+                }
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * voxels));
+}
+
+template <tensor_layout Layout> void BM_trace(benchmark::State & state) {
+    const tensor_field<Layout> eps = make_tensors<Layout>();
+    for (auto _ : state) {
+        float sum = 0.0f;
+        for (std::size_t i = 0; i < edge; ++i) {
+            for (std::size_t j = 0; j < edge; ++j) {
+                for (std::size_t k = 0; k < edge; ++k) {
+                    auto m = eps(i, j, k);
+                    sum += m(0, 0) + m(1, 1) + m(2, 2);
+                }
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * voxels));
+}
+
+void BM_mat_vec_runtime(benchmark::State & state) {
+    ndarray<float, 5> eps = make_runtime_tensors();
+    ndarray<float, 4> e(velm_DR::uninitialized, edge, edge, edge, 3);
+    ndarray<float, 4> d(velm_DR::uninitialized, edge, edge, edge, 3);
+    for (std::size_t v = 0; v < voxels; ++v) {
+        for (std::size_t c = 0; c < 3; ++c) {
+            e.data[v * 3 + c] = sample(v, c);
+        }
+    }
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < edge; ++i) {
+            for (std::size_t j = 0; j < edge; ++j) {
+                for (std::size_t k = 0; k < edge; ++k) {
+                    for (std::size_t r = 0; r < 3; ++r) {
+                        float y = 0.0f;
+                        for (std::size_t c = 0; c < 3; ++c) {
+                            y += eps(i, j, k, r, c) * e(i, j, k, c);
+                        }
+                        d(i, j, k, r) = y;
+                    }
+                }
+            }
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * voxels));
+}
+
+template <tensor_layout Layout> void BM_mat_vec(benchmark::State & state) {
+    const tensor_field<Layout> eps = make_tensors<Layout>();
+    const vector_field<Layout> e   = make_vectors<Layout>();
+    vector_field<Layout>       d(velm_DR::uninitialized, edge, edge, edge);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < edge; ++i) {
+            for (std::size_t j = 0; j < edge; ++j) {
+                for (std::size_t k = 0; k < edge; ++k) {
+                    d(i, j, k) = velm_DR::mat_vec<float, 3, 3>(eps(i, j, k), e(i, j, k));
+                }
+            }
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * voxels));
+}
+
+void BM_mat_vec_planes(benchmark::State & state) {
+    const tensor_field<tensor_layout::soa> eps = make_tensors<tensor_layout::soa>();
+    const vector_field<tensor_layout::soa> e   = make_vectors<tensor_layout::soa>();
+    vector_field<tensor_layout::soa>       d(velm_DR::uninitialized, edge, edge, edge);
+    for (auto _ : state) {
+        for (std::size_t r = 0; r < 3; ++r) {
+            float *       out = d.scalars.data + r * voxels;
+            const float * m0  = eps.scalars.data + (r * 3 + 0) * voxels;
+            const float * m1  = eps.scalars.data + (r * 3 + 1) * voxels;
+            const float * m2  = eps.scalars.data + (r * 3 + 2) * voxels;
+            const float * e0  = e.scalars.data;
+            const float * e1  = e.scalars.data + voxels;
+            const float * e2  = e.scalars.data + 2 * voxels;
+            for (std::size_t v = 0; v < voxels; ++v) {
+                out[v] = m0[v] * e0[v] + m1[v] * e1[v] + m2[v] * e2[v];
+            }
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * voxels));
+}
+
+}  // namespace
+
+BENCHMARK(BM_trace_runtime)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_trace, tensor_layout::aos)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_trace, tensor_layout::soa)->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_mat_vec_runtime)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_mat_vec, tensor_layout::aos)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_mat_vec, tensor_layout::soa)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_mat_vec_planes)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,159 @@
+#include "velm/core/ndarray.h"
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+using velm_DR::ndarray;
+
+/*
+ * Basic ndarray operations on cubic float grids of edge state.range(0): construction with and without value
+ * initialisation, fill, copy and move, and element access through offset_of_index, operator() (unchecked) and at()
+ * (bounds-checked). Traversals walk the whole grid with the given axis innermost; axis 2 is the contiguous one, so
+ * axis 0 shows the cost of striding a whole plane per step. Bytes and items count the elements touched.
+ */
+
+namespace {
+
+std::size_t edge_of(const benchmark::State & state) {
+    return static_cast<std::size_t>(state.range(0));
+}
+
+void report(benchmark::State & state, std::size_t elements) {
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * elements));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * elements * sizeof(float)));
+}
+
+ndarray<float, 3> make_grid(std::size_t edge) {
+    ndarray<float, 3> grid(velm_DR::uninitialized, edge, edge, edge);
+    for (std::size_t n = 0; n < grid.total_elements(); ++n) {
+        grid.data[n] = static_cast<float>(n % 1024);
+    }
+    return grid;
+}
+
+template <bool Initialise> void BM_construct(benchmark::State & state) {
+    std::size_t edge = edge_of(state);
+    for (auto _ : state) {
+        if constexpr (Initialise) {
+            ndarray<float, 3> grid(edge, edge, edge);
+            benchmark::DoNotOptimize(grid.data);
+        } else {
+            ndarray<float, 3> grid(velm_DR::uninitialized, edge, edge, edge);
+            benchmark::DoNotOptimize(grid.data);
+        }
+    }
+    report(state, edge * edge * edge);
+}
+
+void BM_fill(benchmark::State & state) {
+    std::size_t       edge = edge_of(state);
+    ndarray<float, 3> grid(edge, edge, edge);
+    float             value = 0.0f;
+    for (auto _ : state) {
+        grid.fill(value);
+        value += 1.0f;
+        benchmark::ClobberMemory();
+    }
+    report(state, grid.total_elements());
+}
+
+// into an array of the same shape, which reuses its storage
+void BM_copy_assign(benchmark::State & state) {
+    std::size_t       edge   = edge_of(state);
+    ndarray<float, 3> source = make_grid(edge);
+    ndarray<float, 3> target(edge, edge, edge);
+    for (auto _ : state) {
+        ndarray<float, 3> & assigned = (target = source);
+        benchmark::DoNotOptimize(assigned.data);
+        benchmark::ClobberMemory();
+    }
+    report(state, source.total_elements());
+}
+
+void BM_copy_construct(benchmark::State & state) {
+    std::size_t       edge   = edge_of(state);
+    ndarray<float, 3> source = make_grid(edge);
+    for (auto _ : state) {
+        ndarray<float, 3> copy(source);
+        benchmark::DoNotOptimize(copy.data);
+    }
+    report(state, source.total_elements());
+}
+
+// two move assignments per iteration, handing the storage back and forth; independent of the size
+void BM_move_assign(benchmark::State & state) {
+    std::size_t       edge = edge_of(state);
+    ndarray<float, 3> a    = make_grid(edge);
+    ndarray<float, 3> b(1, 1, 1);
+    for (auto _ : state) {
+        ndarray<float, 3> & to_b = (b = std::move(a));
+        ndarray<float, 3> & to_a = (a = std::move(to_b));
+        benchmark::DoNotOptimize(to_a.data);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * 2));
+}
+
+void BM_offset_of_index(benchmark::State & state) {
+    std::size_t       edge = edge_of(state);
+    ndarray<float, 3> grid(velm_DR::uninitialized, edge, edge, edge);
+    for (auto _ : state) {
+        std::size_t checksum = 0;
+        for (std::size_t i = 0; i < edge; ++i) {
+            for (std::size_t j = 0; j < edge; ++j) {
+                for (std::size_t k = 0; k < edge; ++k) {
+                    checksum += grid.offset_of_index(i, j, k);
+                }
+            }
+            benchmark::DoNotOptimize(checksum);
+        }
+        benchmark::DoNotOptimize(checksum);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * grid.total_elements()));
+}
+
+// sums the grid with `Axis` innermost, through operator() or, with Checked, at()
+template <std::size_t Axis, bool Checked> void BM_traverse(benchmark::State & state) {
+    std::size_t             edge = edge_of(state);
+    const ndarray<float, 3> grid = make_grid(edge);
+    // the loop nest runs (outer, middle, Axis)
+    constexpr std::size_t outer  = Axis == 0 ? 1 : 0;
+    constexpr std::size_t middle = Axis == 2 ? 1 : 2;
+    for (auto _ : state) {
+        float sum = 0.0f;
+        for (std::size_t a = 0; a < edge; ++a) {
+            for (std::size_t b = 0; b < edge; ++b) {
+                for (std::size_t c = 0; c < edge; ++c) {
+                    std::size_t index[3];
+                    index[outer]  = a;
+                    index[middle] = b;
+                    index[Axis]   = c;
+                    if constexpr (Checked) {
+                        sum += grid.at(index[0], index[1], index[2]);
+                    } else {
+                        sum += grid(index[0], index[1], index[2]);
+                    }
+                }
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    report(state, grid.total_elements());
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_construct, true)->ArgName("edge")->Arg(8)->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_construct, false)->ArgName("edge")->Arg(8)->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_fill)->ArgName("edge")->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_copy_assign)->ArgName("edge")->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_copy_construct)->ArgName("edge")->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_move_assign)->ArgName("edge")->Arg(256);
+BENCHMARK(BM_offset_of_index)->ArgName("edge")->Arg(128)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_traverse, 2, false)->ArgName("edge")->Arg(128)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_traverse, 1, false)->ArgName("edge")->Arg(128)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_traverse, 0, false)->ArgName("edge")->Arg(128)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_traverse, 2, true)->ArgName("edge")->Arg(128)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_traverse, 1, true)->ArgName("edge")->Arg(128)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_traverse, 0, true)->ArgName("edge")->Arg(128)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,57 @@
+#include "velm/core/profiler.h"
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+
+using velm_DR::profiler;
+
+/*
+ * Cost of one VELM_PROFILE_ZONE around an empty scope: with recording off (the production default), with it on,
+ * and the bare loop for reference. The recording run collects between batches, as a frame loop would, so the ring
+ * never fills and every zone is kept.
+ */
+
+namespace {
+
+void BM_empty_scope(benchmark::State & state) {
+    std::size_t n = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(++n);
+    }
+}
+
+void BM_zone_disabled(benchmark::State & state) {
+    profiler::global().enable(false);
+    std::size_t n = 0;
+    for (auto _ : state) {
+        VELM_PROFILE_ZONE("bench.zone", "bench");
+        benchmark::DoNotOptimize(++n);
+    }
+}
+
+void BM_zone_enabled(benchmark::State & state) {
+    profiler & p = profiler::global();
+    p.clear();
+    p.enable(true);
+    std::size_t n = 0;
+    for (auto _ : state) {
+        {
+            VELM_PROFILE_ZONE("bench.zone", "bench");
+            benchmark::DoNotOptimize(++n);
+        }
+        if (n % (profiler::ring_capacity / 2) == 0) {
+            state.PauseTiming();
+            p.clear();
+            state.ResumeTiming();
+        }
+    }
+    p.enable(false);
+    state.counters["dropped"] = static_cast<double>(p.dropped());
+    p.clear();
+}
+
+}  // namespace
+
+BENCHMARK(BM_empty_scope);
+BENCHMARK(BM_zone_disabled);
+BENCHMARK(BM_zone_enabled);
@@ -0,0 +1,90 @@
+#include "velm/core/ndarray.h"
+#include "velm/core/thread_pool.h"
+#include "velm/io/field_codec.h"
+
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+using velm_DR::ndarray;
+using vlem::compressed_field;
+using vlem::field_codec;
+
+/*
+ * Encode and decode throughput of compressed_field on a smooth 192^3 float field (a few interfering waves in
+ * [-1, 1], with noise at the 1e-4 level as in simulation output), counted in raw bytes. The first argument is the
+ * total number of threads, the calling thread included; bound_e is the negated exponent of the error bound, 0 for
+ * the lossless codec. The ratio counter is raw over compressed size.
+ */
+
+namespace {
+
+constexpr std::size_t edge = 192;
+
+const ndarray<float, 3> & smooth_field() {
+    static const ndarray<float, 3> field = [] {
+        ndarray<float, 3> out(velm_DR::uninitialized, edge, edge, edge);
+        std::uint32_t     state = 1;
+        for (std::size_t i = 0; i < edge; ++i) {
+            for (std::size_t j = 0; j < edge; ++j) {
+                for (std::size_t k = 0; k < edge; ++k) {
+                    state        = state * 1664525u + 1013904223u;
+                    float noise  = static_cast<float>(state >> 8) / static_cast<float>(1 << 24) - 0.5f;
+                    float x      = 0.05f * static_cast<float>(i);
+                    float y      = 0.04f * static_cast<float>(j);
+                    float z      = 0.03f * static_cast<float>(k);
+                    out(i, j, k) = 0.5f * std::sin(x + y) * std::cos(z) + 0.5f * std::sin(x - 2.0f * z) +
+                                   2e-4f * noise;
+                }
+            }
+        }
+        return out;
+    }();
+    return field;
+}
+
+compressed_field compress(const ndarray<float, 3> & field, int64_t bound_exponent, velm_DR::thread_pool * pool) {
+    return bound_exponent == 0 ? compressed_field(field.view(), field_codec::lossless, 0.0, pool)
+                               : compressed_field(field.view(), field_codec::bounded,
+                                                  std::pow(10.0, -static_cast<double>(bound_exponent)), pool);
+}
+
+void BM_encode(benchmark::State & state) {
+    velm_DR::thread_pool      pool(static_cast<std::size_t>(state.range(0)) - 1);
+    const ndarray<float, 3> & field = smooth_field();
+    compressed_field          packed;
+    for (auto _ : state) {
+        packed = compress(field, state.range(1), &pool);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * packed.raw_bytes()));
+    state.counters["ratio"] = static_cast<double>(packed.raw_bytes()) / static_cast<double>(packed.compressed_bytes());
+}
+
+void BM_decode(benchmark::State & state) {
+    velm_DR::thread_pool      pool(static_cast<std::size_t>(state.range(0)) - 1);
+    const ndarray<float, 3> & field  = smooth_field();
+    compressed_field          packed = compress(field, state.range(1), &pool);
+    ndarray<float, 3>         out(velm_DR::uninitialized, edge, edge, edge);
+    for (auto _ : state) {
+        packed.decode(out.view(), &pool);
+        benchmark::DoNotOptimize(out.data);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * packed.raw_bytes()));
+    state.counters["ratio"] = static_cast<double>(packed.raw_bytes()) / static_cast<double>(packed.compressed_bytes());
+}
+
+}  // namespace
+
+BENCHMARK(BM_encode)
+    ->ArgNames({ "threads", "bound_e" })
+    ->ArgsProduct({ { 1, 4 }, { 0, 3, 5 } })
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_decode)
+    ->ArgNames({ "threads", "bound_e" })
+    ->ArgsProduct({ { 1, 4 }, { 0, 3, 5 } })
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
@@ -0,0 +1,128 @@
+#include "velm/core/ndarray.h"
+#include "velm/io/hd5.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#    include <sys/resource.h>
+#endif
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+using velm_DR::ndarray;
+using velm_DR::ndarray_view;
+using vlem::hdf5_file;
+
+/*
+ * Read throughput of the HDF5 paths on a locally generated 256^3 float file holding the same field as a
+ * contiguous dataset, a 64^3-chunked dataset and a gzip-compressed chunked dataset. After the first iteration the
+ * file sits in the page cache, so the numbers measure the read pipeline rather than the disk.
+ */
+
+namespace {
+
+constexpr std::size_t edge        = 256;
+constexpr std::size_t field_bytes = edge * edge * edge * sizeof(float);
+
+// written on first use and removed when the benchmark binary exits
+struct synthetic {
+    synthetic() : path((std::filesystem::temp_directory_path() / "velm_bench_hd5.h5").string()) {
+        try {
+            write();
+        } catch (...) {
+            std::error_code ignored;
+            std::filesystem::remove(path, ignored);
+            throw;
+        }
+    }
+
+    ~synthetic() {
+        std::error_code ignored;
+        std::filesystem::remove(path, ignored);
+    }
+
+    synthetic(const synthetic &)             = delete;
+    synthetic & operator=(const synthetic &) = delete;
+
+    std::string path;
+
+  private:
+    void write() const {
+        hdf5_file         file(path, hdf5_file::access::truncate);
+        ndarray<float, 3> field(velm_DR::uninitialized, edge, edge, edge);
+        for (std::size_t n = 0; n < field.total_elements(); ++n) {
+            field.data[n] = static_cast<float>(n % 1021) * 0.25f;
+        }
+        std::size_t chunk[3] = { 64, 64, 64 };
+        file.write_field("/contiguous", field);
+        file.write_field("/chunked", field, chunk);
+        file.write_field("/gzip", field, chunk, 1);
+    }
+};
+
+const std::string & synthetic_file() {
+    static const synthetic file;
+    return file.path;
+}
+
+void report(benchmark::State & state, std::size_t bytes_per_iteration) {
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes_per_iteration));
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#    if defined(__APPLE__)
+    double peak_mib = static_cast<double>(usage.ru_maxrss) / (1024.0 * 1024.0);
+#    else
+    double peak_mib = static_cast<double>(usage.ru_maxrss) / 1024.0;
+#    endif
+    state.counters["peak_rss_MiB"] = peak_mib;
+#endif
+}
+
+void BM_extract_field(benchmark::State & state, const char * dataset) {
+    hdf5_file file(synthetic_file());
+    for (auto _ : state) {
+        ndarray<float, 3> field = file.extract_field<float, 3>(dataset);
+        benchmark::DoNotOptimize(field.data);
+    }
+    report(state, field_bytes);
+}
+
+void BM_chunk_stream(benchmark::State & state, const char * dataset) {
+    hdf5_file file(synthetic_file());
+    for (auto _ : state) {
+        vlem::chunk_stream<float, 3> stream(file, dataset);
+        ndarray<float, 3>            buffer(velm_DR::uninitialized, stream.chunk_shape());
+        std::size_t                  origin[3];
+        ndarray_view<float, 3>       chunk;
+        while (stream.next(buffer, origin, chunk)) {
+            benchmark::DoNotOptimize(chunk.data);
+        }
+    }
+    report(state, field_bytes);
+}
+
+void BM_map_field_sum(benchmark::State & state) {
+    hdf5_file file(synthetic_file());
+    for (auto _ : state) {
+        ndarray_view<const float, 3> field = file.map_field<float, 3>("/contiguous");
+        float                        sum   = 0.0f;
+        for (std::size_t n = 0; n < field.total_elements(); ++n) {
+            sum += field.data[n];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    report(state, field_bytes);
+}
+
+}  // namespace
+
+BENCHMARK_CAPTURE(BM_extract_field, contiguous_direct, "/contiguous")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_extract_field, chunked, "/chunked")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_extract_field, gzip, "/gzip")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_chunk_stream, contiguous_direct, "/contiguous")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_chunk_stream, chunked, "/chunked")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_chunk_stream, gzip, "/gzip")->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_map_field_sum)->Unit(benchmark::kMillisecond);
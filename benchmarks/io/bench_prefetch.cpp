@@ -0,0 +1,125 @@
+#include "velm/core/ndarray.h"
+#include "velm/io/hd5.h"
+#include "velm/io/prefetch.h"
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <vector>
+
+using velm_DR::ndarray;
+using vlem::field_prefetcher;
+using vlem::hdf5_file;
+
+/*
+ * Timestep playback of three 128^3 float fields over 8 steps, gzip-compressed in 32^3 chunks. The baseline reads
+ * every field with extract_field on the consuming thread; the prefetched runs overlap reads and decompression with
+ * consumption, which is simulated by summing every field of a frame.
+ */
+
+namespace {
+
+constexpr std::size_t edge        = 128;
+constexpr std::size_t steps       = 8;
+constexpr std::size_t field_count = 3;
+constexpr std::size_t frame_bytes = field_count * edge * edge * edge * sizeof(float);
+
+const char * const field_names[field_count] = { "Ex", "Ey", "Ez" };
+
+std::string dataset_path(std::size_t step, const std::string & field) {
+    return "/step_" + std::to_string(step) + "/" + field;
+}
+
+// written on first use and removed when the benchmark binary exits
+struct synthetic {
+    synthetic() : path((std::filesystem::temp_directory_path() / "velm_bench_prefetch.h5").string()) {
+        try {
+            write();
+        } catch (...) {
+            std::error_code ignored;
+            std::filesystem::remove(path, ignored);
+            throw;
+        }
+    }
+
+    ~synthetic() {
+        std::error_code ignored;
+        std::filesystem::remove(path, ignored);
+    }
+
+    synthetic(const synthetic &)             = delete;
+    synthetic & operator=(const synthetic &) = delete;
+
+    std::string path;
+
+  private:
+    void write() const {
+        hdf5_file         file(path, hdf5_file::access::truncate);
+        ndarray<float, 3> field(velm_DR::uninitialized, edge, edge, edge);
+        std::size_t       chunk[3] = { 32, 32, 32 };
+        for (std::size_t step = 0; step < steps; ++step) {
+            for (std::size_t f = 0; f < field_count; ++f) {
+                for (std::size_t n = 0; n < field.total_elements(); ++n) {
+                    field.data[n] = static_cast<float>((n + step * 7 + f * 13) % 1021) * 0.25f;
+                }
+                file.write_field(dataset_path(step, field_names[f]).c_str(), field, chunk, 1);
+            }
+        }
+    }
+};
+
+const std::string & synthetic_file() {
+    static const synthetic file;
+    return file.path;
+}
+
+float consume(const ndarray<float, 3> & field) {
+    float sum = 0.0f;
+    for (std::size_t n = 0; n < field.total_elements(); ++n) {
+        sum += field.data[n];
+    }
+    return sum;
+}
+
+void report(benchmark::State & state) {
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * steps * frame_bytes));
+    state.counters["frames_per_s"] =
+        benchmark::Counter(static_cast<double>(state.iterations() * steps), benchmark::Counter::kIsRate);
+}
+
+void BM_sequential_playback(benchmark::State & state) {
+    hdf5_file file(synthetic_file());
+    for (auto _ : state) {
+        for (std::size_t step = 0; step < steps; ++step) {
+            for (const char * name : field_names) {
+                ndarray<float, 3> field = file.extract_field<float, 3>(dataset_path(step, name).c_str());
+                benchmark::DoNotOptimize(consume(field));
+            }
+        }
+    }
+    report(state);
+}
+
+void BM_prefetched_playback(benchmark::State & state) {
+    hdf5_file                 file(synthetic_file());
+    field_prefetcher::options opts;
+    opts.depth          = 3;
+    opts.decode_threads = static_cast<std::size_t>(state.range(0));
+    for (auto _ : state) {
+        field_prefetcher prefetcher(file, { "Ex", "Ey", "Ez" }, 0, steps, dataset_path, opts);
+        while (std::optional<vlem::timestep_frame> frame = prefetcher.next()) {
+            for (const ndarray<float, 3> & field : frame->fields) {
+                benchmark::DoNotOptimize(consume(field));
+            }
+        }
+    }
+    report(state);
+}
+
+}  // namespace
+
+BENCHMARK(BM_sequential_playback)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_prefetched_playback)->Arg(1)->Arg(2)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
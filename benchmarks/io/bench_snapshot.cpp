@@ -0,0 +1,168 @@
+#include "velm/core/ndarray.h"
+#include "velm/io/hd5.h"
+#include "velm/io/snapshot.h"
+
+#if defined(__unix__)
+#    include <fcntl.h>
+#    include <unistd.h>
+#endif
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <vector>
+
+using velm_DR::ndarray;
+using velm_DR::ndarray_view;
+using vlem::hdf5_file;
+using vlem::snapshot_file;
+
+/*
+ * Time to first frame: opening a 2.25 GiB file of 12 timesteps (Ex, Ey, Ez as 256^3 floats, stored in 64^3 chunks
+ * in HDF5) and summing the three fields of the first timestep. The HDF5 path reads them into ndarrays, the
+ * snapshot path sums straight out of the mapping. The files are generated on first use and removed when the
+ * binary exits. With cold:1 the file is dropped from the page cache before every iteration (posix_fadvise, Linux
+ * only), so the disk is part of the measurement; with cold:0 everything is served from the page cache.
+ */
+
+namespace {
+
+constexpr std::size_t edge       = 256;
+constexpr std::size_t steps      = 12;
+constexpr std::size_t frame_size = 3 * edge * edge * edge * sizeof(float);
+
+const char * const components[3] = { "Ex", "Ey", "Ez" };
+
+std::string dataset_path(std::size_t step, const char * component) {
+    return "/step_" + std::to_string(step) + "/" + component;
+}
+
+// generated on first use and removed when the benchmark binary exits, so runs leave nothing in the temp directory
+struct bench_files {
+    bench_files() {
+        std::filesystem::path dir = std::filesystem::temp_directory_path();
+        hdf5     = (dir / "velm_bench_snapshot.h5").string();
+        snapshot = (dir / "velm_bench_snapshot.vsnap").string();
+        try {
+            write();
+        } catch (...) {
+            remove();
+            throw;
+        }
+    }
+
+    ~bench_files() { remove(); }
+
+    bench_files(const bench_files &)             = delete;
+    bench_files & operator=(const bench_files &) = delete;
+
+    std::string hdf5;
+    std::string snapshot;
+
+  private:
+    void write() const {
+        hdf5_file                file(hdf5, hdf5_file::access::truncate);
+        ndarray<float, 3>        field(velm_DR::uninitialized, edge, edge, edge);
+        std::size_t              chunk[3] = { 64, 64, 64 };
+        std::vector<std::string> datasets;
+        for (std::size_t step = 0; step < steps; ++step) {
+            for (std::size_t c = 0; c < 3; ++c) {
+                for (std::size_t n = 0; n < field.total_elements(); ++n) {
+                    field.data[n] = static_cast<float>((n + step * 7 + c) % 1021) * 0.25f;
+                }
+                datasets.push_back(dataset_path(step, components[c]));
+                file.write_field(datasets.back().c_str(), field, chunk);
+            }
+        }
+        vlem::convert_to_snapshot(file, datasets, snapshot);
+    }
+
+    void remove() const {
+        std::error_code ignored;
+        std::filesystem::remove(hdf5, ignored);
+        std::filesystem::remove(snapshot, ignored);
+    }
+};
+
+const bench_files & synthetic_files() {
+    static const bench_files files;
+    return files;
+}
+
+void drop_from_page_cache(const std::string & path) {
+#if defined(__unix__)
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+#else
+    (void) path;
+#endif
+}
+
+float sum(ndarray_view<const float, 3> field) {
+    float total = 0.0f;
+    for (std::size_t n = 0; n < field.total_elements(); ++n) {
+        total += field.data[n];
+    }
+    return total;
+}
+
+void BM_first_frame_hdf5(benchmark::State & state) {
+    const std::string & path = synthetic_files().hdf5;
+    for (auto _ : state) {
+        if (state.range(0) != 0) {
+            state.PauseTiming();
+            drop_from_page_cache(path);
+            state.ResumeTiming();
+        }
+        hdf5_file file(path);
+        float     total = 0.0f;
+        for (const char * component : components) {
+            ndarray<float, 3> field = file.extract_field<float, 3>(dataset_path(0, component).c_str());
+            total += sum(field.view());
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * frame_size));
+}
+
+void BM_first_frame_snapshot(benchmark::State & state) {
+    const std::string & path = synthetic_files().snapshot;
+    for (auto _ : state) {
+        if (state.range(0) != 0) {
+            state.PauseTiming();
+            drop_from_page_cache(path);
+            state.ResumeTiming();
+        }
+        snapshot_file file(path);
+        float         total = 0.0f;
+        for (const char * component : components) {
+            file.prefetch(dataset_path(0, component));
+        }
+        for (const char * component : components) {
+            total += sum(file.view<float, 3>(dataset_path(0, component)));
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * frame_size));
+}
+
+// opening alone: what it costs before the first field can be handed out
+void BM_open_snapshot(benchmark::State & state) {
+    const std::string & path = synthetic_files().snapshot;
+    for (auto _ : state) {
+        snapshot_file                file(path);
+        ndarray_view<const float, 3> field = file.view<float, 3>(dataset_path(0, "Ex"));
+        benchmark::DoNotOptimize(field.data);
+    }
+}
+
+}  // namespace
+
+BENCHMARK(BM_first_frame_hdf5)->ArgName("cold")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_first_frame_snapshot)->ArgName("cold")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_open_snapshot)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,99 @@
+#include "velm/core/ndarray.h"
+#include "velm/core/thread_pool.h"
+#include "velm/processing/isosurface.h"
+
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstddef>
+
+using velm_DR::ndarray;
+
+/*
+ * Isosurfaces of |E| around two point charges on a 256^3 float grid. The first argument is the total number of
+ * threads, the calling thread included; the second is the isovalue in thousandths. Low isovalues give large
+ * surfaces spread over most blocks, high ones small shells around the charges, where the block summary lets nearly
+ * the whole grid be skipped.
+ *
+ * BM_isosurface includes building the block summary, BM_isosurface_cached reuses one as a sweep over isovalues
+ * would. Counters report the mesh size and the fraction of blocks visited.
+ */
+
+namespace {
+
+constexpr std::size_t edge = 256;
+
+const ndarray<float, 3> & dipole_magnitude() {
+    static const ndarray<float, 3> field = [] {
+        ndarray<float, 3> out(velm_DR::uninitialized, edge, edge, edge);
+        const float       charges[2][4] = { { 96.0f, 128.0f, 128.0f, 1.0f }, { 160.0f, 128.0f, 128.0f, -1.0f } };
+        for (std::size_t i = 0; i < edge; ++i) {
+            for (std::size_t j = 0; j < edge; ++j) {
+                for (std::size_t k = 0; k < edge; ++k) {
+                    float e[3] = {};
+                    for (const float * q : charges) {
+                        float d[3] = { i - q[0], j - q[1], k - q[2] };
+                        float r2   = d[0] * d[0] + d[1] * d[1] + d[2] * d[2] + 1.0f;
+                        float s    = q[3] * 1000.0f / (r2 * std::sqrt(r2));
+                        for (std::size_t a = 0; a < 3; ++a) {
+                            e[a] += s * d[a];
+                        }
+                    }
+                    out(i, j, k) = std::sqrt(e[0] * e[0] + e[1] * e[1] + e[2] * e[2]);
+                }
+            }
+        }
+        return out;
+    }();
+    return field;
+}
+
+void report(benchmark::State & state, const velm_DP::iso_mesh & mesh, const velm_DP::block_bounds & bounds, float iso) {
+    const std::size_t * blocks = bounds.counts();
+    state.counters["triangles"] = static_cast<double>(mesh.triangle_count());
+    state.counters["vertices"]  = static_cast<double>(mesh.vertices.size());
+    state.counters["active"]    = static_cast<double>(bounds.active_blocks(iso)) / (blocks[0] * blocks[1] * blocks[2]);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * edge * edge * edge));
+}
+
+void BM_isosurface(benchmark::State & state) {
+    velm_DR::thread_pool     pool(static_cast<std::size_t>(state.range(0)) - 1);
+    const float              iso   = static_cast<float>(state.range(1)) * 0.001f;
+    const ndarray<float, 3> & field = dipole_magnitude();
+
+    velm_DP::iso_options options;
+    options.pool = &pool;
+    velm_DP::iso_mesh mesh;
+    for (auto _ : state) {
+        mesh = velm_DP::extract_isosurface(field.view(), iso, options);
+        benchmark::DoNotOptimize(mesh.indices.data());
+    }
+    report(state, mesh, velm_DP::block_bounds(field.view(), &pool), iso);
+}
+
+void BM_isosurface_cached(benchmark::State & state) {
+    velm_DR::thread_pool      pool(static_cast<std::size_t>(state.range(0)) - 1);
+    const float               iso   = static_cast<float>(state.range(1)) * 0.001f;
+    const ndarray<float, 3> & field = dipole_magnitude();
+    velm_DP::block_bounds     bounds(field.view(), &pool);
+
+    velm_DP::iso_options options;
+    options.pool   = &pool;
+    options.bounds = &bounds;
+    velm_DP::iso_mesh mesh;
+    for (auto _ : state) {
+        mesh = velm_DP::extract_isosurface(field.view(), iso, options);
+        benchmark::DoNotOptimize(mesh.indices.data());
+    }
+    report(state, mesh, bounds, iso);
+}
+
+}  // namespace
+
+BENCHMARK(BM_isosurface)
+    ->ArgsProduct({ benchmark::CreateRange(1, 16, 2), { 50, 500, 5000 } })
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_isosurface_cached)
+    ->ArgsProduct({ { 1, 4 }, { 50, 500, 5000 } })
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
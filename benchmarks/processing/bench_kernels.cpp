@@ -0,0 +1,122 @@
+#include "velm/core/ndarray.h"
+#include "velm/processing/kernels.h"
+
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstddef>
+
+using velm_DP::simd_level;
+using velm_DR::ndarray;
+
+/*
+ * Throughput of the field kernels on 192^3 grids, per instruction set (argument 0: scalar, 1: AVX2, 2: AVX-512).
+ * bytes_per_second counts every byte read and written, so it compares directly with memory bandwidth. The
+ * three-pass baseline computes |E| and then scans it twice for min and max, as a plain loop would.
+ */
+
+namespace {
+
+constexpr std::size_t edge = 192;
+
+template <typename T> ndarray<T, 3> make_component(unsigned seed) {
+    ndarray<T, 3> field(velm_DR::uninitialized, edge, edge, edge);
+    for (std::size_t n = 0; n < field.total_elements(); ++n) {
+        field.data[n] = static_cast<T>((n * 2654435761u + seed) % 4093) * T(0.001) - T(2);
+    }
+    return field;
+}
+
+bool select_level(benchmark::State & state) {
+    simd_level level = static_cast<simd_level>(state.range(0));
+    if (level > velm_DP::detected_simd_level()) {
+        state.SkipWithError("instruction set not supported by this CPU or build");
+        return false;
+    }
+    velm_DP::set_simd_level(level);
+    return true;
+}
+
+template <typename T> void report(benchmark::State & state, std::size_t arrays) {
+    std::size_t bytes = arrays * edge * edge * edge * sizeof(T);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+    velm_DP::set_simd_level(simd_level::avx512);
+}
+
+template <typename T> void BM_reduce_stats(benchmark::State & state) {
+    if (!select_level(state)) {
+        return;
+    }
+    ndarray<T, 3> field = make_component<T>(1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(velm_DP::reduce_stats(field));
+    }
+    report<T>(state, 1);
+}
+
+template <typename T> void BM_magnitude_fused(benchmark::State & state) {
+    if (!select_level(state)) {
+        return;
+    }
+    ndarray<T, 3> x = make_component<T>(1), y = make_component<T>(2), z = make_component<T>(3);
+    ndarray<T, 3> out(velm_DR::uninitialized, edge, edge, edge);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(velm_DP::magnitude<T, 3>(x.view(), y.view(), z.view(), out.view()));
+    }
+    report<T>(state, 4);
+}
+
+template <typename T> void BM_magnitude_three_pass(benchmark::State & state) {
+    ndarray<T, 3>     x = make_component<T>(1), y = make_component<T>(2), z = make_component<T>(3);
+    ndarray<T, 3>     out(velm_DR::uninitialized, edge, edge, edge);
+    const std::size_t n = out.total_elements();
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < n; ++i) {
+            out.data[i] = std::sqrt(x.data[i] * x.data[i] + y.data[i] * y.data[i] + z.data[i] * z.data[i]);
+        }
+        benchmark::DoNotOptimize(*std::min_element(out.data, out.data + n));
+        benchmark::DoNotOptimize(*std::max_element(out.data, out.data + n));
+    }
+    report<T>(state, 4);
+}
+
+template <typename T> void BM_poynting(benchmark::State & state) {
+    if (!select_level(state)) {
+        return;
+    }
+    ndarray<T, 3> ex = make_component<T>(1), ey = make_component<T>(2), ez = make_component<T>(3);
+    ndarray<T, 3> hx = make_component<T>(4), hy = make_component<T>(5), hz = make_component<T>(6);
+    ndarray<T, 3> sx(velm_DR::uninitialized, edge, edge, edge);
+    ndarray<T, 3> sy(velm_DR::uninitialized, edge, edge, edge);
+    ndarray<T, 3> sz(velm_DR::uninitialized, edge, edge, edge);
+    for (auto _ : state) {
+        velm_DP::poynting<T, 3>(ex.view(), ey.view(), ez.view(), hx.view(), hy.view(), hz.view(), sx.view(),
+                                sy.view(), sz.view());
+        benchmark::ClobberMemory();
+    }
+    report<T>(state, 9);
+}
+
+template <typename T> void BM_energy_density(benchmark::State & state) {
+    if (!select_level(state)) {
+        return;
+    }
+    ndarray<T, 3> ex = make_component<T>(1), ey = make_component<T>(2), ez = make_component<T>(3);
+    ndarray<T, 3> hx = make_component<T>(4), hy = make_component<T>(5), hz = make_component<T>(6);
+    ndarray<T, 3> out(velm_DR::uninitialized, edge, edge, edge);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(velm_DP::energy_density<T, 3>(ex.view(), ey.view(), ez.view(), hx.view(),
+                                                               hy.view(), hz.view(), out.view()));
+    }
+    report<T>(state, 7);
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_reduce_stats, float)->DenseRange(0, 2)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_reduce_stats, double)->DenseRange(0, 2)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_magnitude_three_pass, float)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_magnitude_fused, float)->DenseRange(0, 2)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_magnitude_fused, double)->DenseRange(0, 2)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_poynting, float)->DenseRange(0, 2)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_energy_density, float)->DenseRange(0, 2)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,154 @@
+#include "velm/core/ndarray.h"
+#include "velm/core/thread_pool.h"
+#include "velm/io/tiled_field.h"
+#include "velm/processing/out_of_core.h"
+
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+using velm_DR::ndarray;
+using vlem::tiled_field;
+using vlem::tiled_options;
+
+/*
+ * Tiled kernels on a 192^3 float grid kept in raw scratch files, against the in-core gradient on the same data.
+ * The first argument is the tile edge, the second the resident budget of each field in MiB, so small budgets show
+ * the cost of paging every tile (and its halo) in and the results out again. Scratch files live in the temporary
+ * directory, so their pages are usually still cached and the numbers reflect the engine rather than the disk.
+ */
+
+namespace {
+
+constexpr std::size_t edge = 192;
+
+const std::filesystem::path temp_dir = std::filesystem::temp_directory_path();
+
+struct scratch {
+    scratch(const std::string & name, const tiled_options & options) :
+        path((temp_dir / ("velm_bench_out_of_core_" + name + ".raw")).string()),
+        field(std::make_shared<vlem::raw_tile_store<float>>(path, dims), options) {}
+
+    ~scratch() {
+        field.release_all();
+        std::filesystem::remove(path);
+    }
+
+    static constexpr std::size_t dims[3] = { edge, edge, edge };
+    std::string                  path;
+    tiled_field<float>           field;
+};
+
+void fill(tiled_field<float> & field) {
+    velm_DP::for_each_tile(field, vlem::tile_access::overwrite, [](const std::size_t (&origin)[3], auto tile) {
+        for (std::size_t i = 0; i < tile.dims[0]; ++i) {
+            for (std::size_t j = 0; j < tile.dims[1]; ++j) {
+                for (std::size_t k = 0; k < tile.dims[2]; ++k) {
+                    float x       = static_cast<float>(origin[0] + i);
+                    float y       = static_cast<float>(origin[1] + j + origin[2] + k);
+                    tile(i, j, k) = std::sin(0.05f * x) * std::cos(0.07f * y);
+                }
+            }
+        }
+    });
+    field.flush();
+}
+
+tiled_options settings(const benchmark::State & state, velm_DR::thread_pool & pool) {
+    tiled_options options;
+    options.tile[0]        = static_cast<std::size_t>(state.range(0));
+    options.tile[1]        = static_cast<std::size_t>(state.range(0));
+    options.tile[2]        = static_cast<std::size_t>(state.range(0));
+    options.resident_bytes = static_cast<std::size_t>(state.range(1)) << 20;
+    options.pool           = &pool;
+    return options;
+}
+
+// tile loads of `field` per iteration, after the `before` of filling it
+void report(benchmark::State & state, std::size_t fields, const tiled_field<float> & field, std::size_t before) {
+    std::size_t loads       = field.counters().loads - before;
+    state.counters["loads"] = static_cast<double>(loads) / static_cast<double>(state.iterations());
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * fields * edge * edge * edge * sizeof(float)));
+}
+
+void BM_tiled_gradient(benchmark::State & state) {
+    velm_DR::thread_pool pool;
+    tiled_options        options = settings(state, pool);
+    scratch              phi("phi", options), gx("gx", options), gy("gy", options), gz("gz", options);
+    fill(phi.field);
+    const std::size_t before = phi.field.counters().loads;
+
+    for (auto _ : state) {
+        velm_DP::gradient(phi.field, gx.field, gy.field, gz.field);
+        gx.field.flush();
+        gy.field.flush();
+        gz.field.flush();
+    }
+    report(state, 4, phi.field, before);
+}
+
+void BM_tiled_reduce(benchmark::State & state) {
+    velm_DR::thread_pool pool;
+    tiled_options        options = settings(state, pool);
+    scratch              phi("phi", options);
+    fill(phi.field);
+    const std::size_t before = phi.field.counters().loads;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(velm_DP::reduce_stats(phi.field));
+    }
+    report(state, 1, phi.field, before);
+}
+
+void BM_tiled_downsample(benchmark::State & state) {
+    velm_DR::thread_pool pool;
+    tiled_options        options = settings(state, pool);
+    scratch              phi("phi", options);
+    const std::size_t    half[3] = { edge / 2, edge / 2, edge / 2 };
+    tiled_field<float>   coarse(std::make_shared<vlem::raw_tile_store<float>>(
+                                  (temp_dir / "velm_bench_out_of_core_coarse.raw").string(), half),
+                              options);
+    fill(phi.field);
+    const std::size_t before = phi.field.counters().loads;
+
+    for (auto _ : state) {
+        velm_DP::downsample(phi.field, velm_DP::lod_filter::mean, coarse);
+        coarse.flush();
+    }
+    report(state, 1, phi.field, before);
+    coarse.release_all();
+    std::filesystem::remove(temp_dir / "velm_bench_out_of_core_coarse.raw");
+}
+
+void BM_in_core_gradient(benchmark::State & state) {
+    velm_DR::thread_pool pool;
+    ndarray<float, 3>    phi(velm_DR::uninitialized, edge, edge, edge);
+    ndarray<float, 3>    gx(velm_DR::uninitialized, edge, edge, edge);
+    ndarray<float, 3>    gy(velm_DR::uninitialized, edge, edge, edge);
+    ndarray<float, 3>    gz(velm_DR::uninitialized, edge, edge, edge);
+    for (std::size_t i = 0; i < edge; ++i) {
+        for (std::size_t j = 0; j < edge; ++j) {
+            for (std::size_t k = 0; k < edge; ++k) {
+                phi(i, j, k) = std::sin(0.05f * i) * std::cos(0.07f * (j + k));
+            }
+        }
+    }
+
+    velm_DP::stencil_options<float> options;
+    options.pool = &pool;
+    for (auto _ : state) {
+        velm_DP::gradient<float>(phi.view(), gx.view(), gy.view(), gz.view(), options);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * 4 * edge * edge * edge * sizeof(float)));
+}
+
+}  // namespace
+
+BENCHMARK(BM_tiled_gradient)->ArgsProduct({ { 32, 64 }, { 4, 64 } })->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_tiled_reduce)->ArgsProduct({ { 32, 64 }, { 4, 64 } })->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_tiled_downsample)->ArgsProduct({ { 32, 64 }, { 4, 64 } })->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_in_core_gradient)->UseRealTime()->Unit(benchmark::kMillisecond);
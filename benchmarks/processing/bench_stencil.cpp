@@ -0,0 +1,85 @@
+#include "velm/core/ndarray.h"
+#include "velm/core/thread_pool.h"
+#include "velm/processing/stencil.h"
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+
+using velm_DR::ndarray;
+
+/*
+ * Thread scaling of the finite-difference operators on 256^3 float grids. The argument is the total number of
+ * threads, the calling thread included; counts beyond the hardware threads show oversubscription rather than
+ * speedup. bytes_per_second counts one read of every input and one write of every output.
+ */
+
+namespace {
+
+constexpr std::size_t edge = 256;
+
+ndarray<float, 3> make_component(unsigned seed) {
+    ndarray<float, 3> field(velm_DR::uninitialized, edge, edge, edge);
+    for (std::size_t n = 0; n < field.total_elements(); ++n) {
+        field.data[n] = static_cast<float>((n * 2654435761u + seed) % 4093) * 0.001f - 2.0f;
+    }
+    return field;
+}
+
+void report(benchmark::State & state, std::size_t arrays) {
+    std::size_t bytes = arrays * edge * edge * edge * sizeof(float);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+}
+
+void BM_curl(benchmark::State & state) {
+    velm_DR::thread_pool pool(static_cast<std::size_t>(state.range(0)) - 1);
+    ndarray<float, 3>    ex = make_component(1), ey = make_component(2), ez = make_component(3);
+    ndarray<float, 3>    hx(velm_DR::uninitialized, edge, edge, edge);
+    ndarray<float, 3>    hy(velm_DR::uninitialized, edge, edge, edge);
+    ndarray<float, 3>    hz(velm_DR::uninitialized, edge, edge, edge);
+
+    velm_DP::stencil_options<float> options;
+    options.scheme = velm_DP::difference::forward;
+    options.pool   = &pool;
+    for (auto _ : state) {
+        velm_DP::curl<float>(ex.view(), ey.view(), ez.view(), hx.view(), hy.view(), hz.view(), options);
+        benchmark::ClobberMemory();
+    }
+    report(state, 6);
+}
+
+void BM_divergence(benchmark::State & state) {
+    velm_DR::thread_pool pool(static_cast<std::size_t>(state.range(0)) - 1);
+    ndarray<float, 3>    bx = make_component(1), by = make_component(2), bz = make_component(3);
+    ndarray<float, 3>    out(velm_DR::uninitialized, edge, edge, edge);
+
+    velm_DP::stencil_options<float> options;
+    options.scheme = velm_DP::difference::forward;
+    options.pool   = &pool;
+    for (auto _ : state) {
+        velm_DP::divergence<float>(bx.view(), by.view(), bz.view(), out.view(), options);
+        benchmark::ClobberMemory();
+    }
+    report(state, 4);
+}
+
+void BM_gradient(benchmark::State & state) {
+    velm_DR::thread_pool pool(static_cast<std::size_t>(state.range(0)) - 1);
+    ndarray<float, 3>    phi = make_component(1);
+    ndarray<float, 3>    gx(velm_DR::uninitialized, edge, edge, edge);
+    ndarray<float, 3>    gy(velm_DR::uninitialized, edge, edge, edge);
+    ndarray<float, 3>    gz(velm_DR::uninitialized, edge, edge, edge);
+
+    velm_DP::stencil_options<float> options;
+    options.pool = &pool;
+    for (auto _ : state) {
+        velm_DP::gradient<float>(phi.view(), gx.view(), gy.view(), gz.view(), options);
+        benchmark::ClobberMemory();
+    }
+    report(state, 4);
+}
+
+}  // namespace
+
+BENCHMARK(BM_curl)->RangeMultiplier(2)->Range(1, 32)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_divergence)->RangeMultiplier(2)->Range(1, 32)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_gradient)->RangeMultiplier(2)->Range(1, 32)->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,93 @@
+#include "velm/core/ndarray.h"
+#include "velm/core/thread_pool.h"
+#include "velm/processing/streamlines.h"
+
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+
+using velm_DR::ndarray;
+
+/*
+ * Field lines of two opposite point charges on a 128^3 grid, seeded on a small sphere around the positive one.
+ * Lines leaving towards the negative charge are short arcs, those leaving away from it run out to the faces of the
+ * grid, so line lengths differ by an order of magnitude. The first argument is the total number of threads, the
+ * calling thread included, the second the number of seeds; items_per_second counts lines.
+ */
+
+namespace {
+
+constexpr std::size_t edge = 128;
+
+struct dipole {
+    ndarray<float, 3> x{ velm_DR::uninitialized, edge, edge, edge };
+    ndarray<float, 3> y{ velm_DR::uninitialized, edge, edge, edge };
+    ndarray<float, 3> z{ velm_DR::uninitialized, edge, edge, edge };
+};
+
+const dipole & dipole_field() {
+    static const dipole field = [] {
+        dipole      out;
+        const float charges[2][4] = { { 48.0f, 64.0f, 64.0f, 1.0f }, { 80.0f, 64.0f, 64.0f, -1.0f } };
+        for (std::size_t i = 0; i < edge; ++i) {
+            for (std::size_t j = 0; j < edge; ++j) {
+                for (std::size_t k = 0; k < edge; ++k) {
+                    float e[3] = {};
+                    for (const float * q : charges) {
+                        float d[3] = { i - q[0], j - q[1], k - q[2] };
+                        float r2   = d[0] * d[0] + d[1] * d[1] + d[2] * d[2] + 0.25f;
+                        float s    = q[3] / (r2 * std::sqrt(r2));
+                        for (std::size_t a = 0; a < 3; ++a) {
+                            e[a] += s * d[a];
+                        }
+                    }
+                    out.x(i, j, k) = e[0];
+                    out.y(i, j, k) = e[1];
+                    out.z(i, j, k) = e[2];
+                }
+            }
+        }
+        return out;
+    }();
+    return field;
+}
+
+// Fibonacci sphere of radius 3 around the positive charge
+ndarray<float, 2> make_seeds(std::size_t count) {
+    ndarray<float, 2> seeds(count, 3);
+    const float       golden = std::numbers::pi_v<float> * (3.0f - std::sqrt(5.0f));
+    for (std::size_t s = 0; s < count; ++s) {
+        float z     = 1.0f - 2.0f * (static_cast<float>(s) + 0.5f) / static_cast<float>(count);
+        float r     = std::sqrt(1.0f - z * z);
+        seeds(s, 0) = 48.0f + 3.0f * r * std::cos(golden * s);
+        seeds(s, 1) = 64.0f + 3.0f * r * std::sin(golden * s);
+        seeds(s, 2) = 64.0f + 3.0f * z;
+    }
+    return seeds;
+}
+
+void BM_streamlines(benchmark::State & state) {
+    velm_DR::thread_pool pool(static_cast<std::size_t>(state.range(0)) - 1);
+    const dipole &       field = dipole_field();
+    ndarray<float, 2>    seeds = make_seeds(static_cast<std::size_t>(state.range(1)));
+
+    velm_DP::streamline_options options;
+    options.direction = velm_DP::trace_direction::forward;
+    options.pool      = &pool;
+    velm_DP::streamline_set lines;
+    for (auto _ : state) {
+        lines = velm_DP::trace_streamlines(field.x.view(), field.y.view(), field.z.view(), seeds.view(), options);
+        benchmark::DoNotOptimize(lines.vertices.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * seeds.dims[0]));
+    state.counters["vertices"] = static_cast<double>(lines.vertices.size());
+    state.counters["rejected"] = static_cast<double>(lines.rejected_steps);
+}
+
+}  // namespace
+
+BENCHMARK(BM_streamlines)
+    ->ArgsProduct({ benchmark::CreateRange(1, 16, 2), { 1024, 4096 } })
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
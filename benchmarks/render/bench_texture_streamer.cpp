@@ -0,0 +1,82 @@
+#include "velm/core/ndarray.h"
+#include "velm/render/texture_streamer.h"
+
+#ifdef VELM_HAVE_EGL
+#include "velm/render/headless_context.h"
+#endif
+
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstddef>
+#include <exception>
+#include <memory>
+
+using velm_DR::ndarray;
+using velm_GL::streamer_options;
+using velm_GL::texel_format;
+using velm_GL::texture_streamer;
+
+/*
+ * Timestep uploads of a 128^3 float field into a 3D texture, on whatever context EGL provides (llvmpipe on machines
+ * without a GPU, where the "GPU" copy competes with the conversion for the same cores).
+ *
+ * BM_upload streams one step per iteration in each texel format, staged through 8 MiB slots: the 16-bit formats
+ * convert on the CPU but move half the bytes. The second argument is the number of staging slots; with one slot
+ * every slab waits for the copy of the one before, which shows up as stall time.
+ */
+
+namespace {
+
+constexpr std::size_t edge = 128;
+
+bool have_context() {
+#ifdef VELM_HAVE_EGL
+    static std::unique_ptr<velm_GL::headless_context> context = []() -> std::unique_ptr<velm_GL::headless_context> {
+        try {
+            return std::make_unique<velm_GL::headless_context>();
+        } catch (const std::exception &) {
+            return nullptr;
+        }
+    }();
+    return context != nullptr;
+#else
+    return false;
+#endif
+}
+
+void BM_upload(benchmark::State & state) {
+    if (!have_context()) {
+        state.SkipWithError("no OpenGL context");
+        return;
+    }
+    ndarray<float, 3> field(velm_DR::uninitialized, edge, edge, edge);
+    std::size_t       n = 0;
+    for (float & value : field) {
+        value = std::sin(0.001f * static_cast<float>(n++));
+    }
+    streamer_options options;
+    options.format        = static_cast<texel_format>(state.range(0));
+    options.staging_slots = static_cast<std::size_t>(state.range(1));
+    options.staging_bytes = std::size_t(8) << 20;
+    options.range_min     = -1.0f;
+    texture_streamer streamer(edge, edge, edge, options);
+
+    for (auto _ : state) {
+        streamer.upload<float>(field.view());
+    }
+    streamer.finish();
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * field.total_elements() * sizeof(float)));
+    state.counters["stalls"]     = static_cast<double>(streamer.stats().stalls);
+    state.counters["stall_ms"]   = streamer.stats().stall_seconds * 1e3;
+    state.counters["convert_ms"] = streamer.stats().convert_seconds * 1e3;
+}
+
+}  // namespace
+
+BENCHMARK(BM_upload)
+    ->ArgsProduct({ { static_cast<int>(texel_format::float32),
+                      static_cast<int>(texel_format::float16),
+                      static_cast<int>(texel_format::unorm16) },
+                    { 1, 3 } })
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+namespace velm_DR {
+
+/*
+ * Storage policies for ndarray.
+ *
+ * A policy provides allocate(n)/deallocate(p, n) for raw, unconstructed storage of n elements and declares
+ * `zeroed`, which is true when fresh storage is guaranteed to read as all-zero bytes (so value-initialising
+ * trivial element types can be skipped).
+ */
+
+// tag selecting construction without value-initialisation, for arrays that are about to be overwritten
+struct uninitialized_t {
+    explicit uninitialized_t() = default;
+};
+
+inline constexpr uninitialized_t uninitialized{};
+
+inline constexpr std::size_t default_alignment = 64;  // one cache line, enough for AVX-512 loads
+
+template <typename T, std::size_t Alignment = default_alignment> struct aligned_allocator {
+    static_assert(Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0, "Invalid alignment");
+
+    static constexpr bool zeroed = false;
+
+    [[nodiscard]] T * allocate(std::size_t n) {
+        return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T * p, std::size_t) noexcept { ::operator delete(p, std::align_val_t(Alignment)); }
+
+    bool operator==(const aligned_allocator &) const = default;
+};
+
+// anonymous mappings rounded up to whole huge pages, with transparent huge pages requested where supported; zero
+// bytes map nothing and return a non-null pointer that must not be dereferenced
+[[nodiscard]] void * huge_page_allocate(std::size_t bytes);
+void                 huge_page_deallocate(void * p, std::size_t bytes) noexcept;
+
+template <typename T> struct huge_page_allocator {
+    // fresh anonymous mappings are zero-filled by the kernel on first touch
+    static constexpr bool zeroed = true;
+
+    [[nodiscard]] T * allocate(std::size_t n) { return static_cast<T *>(huge_page_allocate(n * sizeof(T))); }
+
+    void deallocate(T * p, std::size_t n) noexcept { huge_page_deallocate(p, n * sizeof(T)); }
+
+    bool operator==(const huge_page_allocator &) const = default;
+};
+
+/*
+ * Thread-safe cache of released blocks, keyed by exact byte size.
+ *
+ * Per-timestep temporaries have the same shape every frame, so after the first frame every acquire is served
+ * from the cache instead of the system allocator. Blocks beyond `max_cached_bytes` are returned to the system.
+ * The global() pool caches at most default_global_cache_bytes, so one large frame does not pin its peak for the
+ * rest of the process; raise it with set_max_cached_bytes() when the working set is known to be larger.
+ */
+class block_pool {
+  public:
+    static constexpr std::size_t default_global_cache_bytes = std::size_t(256) << 20;
+
+    explicit block_pool(std::size_t max_cached_bytes = static_cast<std::size_t>(-1));
+    ~block_pool();
+
+    block_pool(const block_pool &)             = delete;
+    block_pool & operator=(const block_pool &) = delete;
+
+    [[nodiscard]] void * acquire(std::size_t bytes);
+    void                 release(void * p, std::size_t bytes) noexcept;
+    void                 trim() noexcept;
+    // blocks cached beyond the new limit are returned to the system right away
+    void                 set_max_cached_bytes(std::size_t bytes) noexcept;
+
+    [[nodiscard]] std::size_t max_cached_bytes() const;
+    [[nodiscard]] std::size_t cached_bytes() const;
+    [[nodiscard]] std::size_t hits() const;
+    [[nodiscard]] std::size_t misses() const;
+
+    // process-wide pool used by default-constructed pool_allocators
+    [[nodiscard]] static block_pool & global();
+
+  private:
+    mutable std::mutex                                   mutex;
+    std::unordered_map<std::size_t, std::vector<void *>> free_blocks;
+    std::size_t                                          max_cached;
+    std::size_t                                          cached     = 0;
+    std::size_t                                          hit_count  = 0;
+    std::size_t                                          miss_count = 0;
+};
+
+template <typename T> struct pool_allocator {
+    static constexpr bool zeroed = false;
+
+    block_pool * pool = &block_pool::global();
+
+    pool_allocator() = default;
+
+    explicit pool_allocator(block_pool & pool) : pool(&pool) {}
+
+    [[nodiscard]] T * allocate(std::size_t n) { return static_cast<T *>(pool->acquire(n * sizeof(T))); }
+
+    void deallocate(T * p, std::size_t n) noexcept { pool->release(p, n * sizeof(T)); }
+
+    bool operator==(const pool_allocator &) const = default;
+};
+
+};  // namespace velm_DR
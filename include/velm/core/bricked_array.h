@@ -0,0 +1,394 @@
+#pragma once
+
+#include "velm/core/allocator.h"
+#include "velm/core/ndarray.h"
+#include "velm/core/ndarray_view.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace velm_DR {
+
+/*
+ * 3D array stored as cubic bricks of Brick³ elements instead of one row-major block.
+ *
+ * In ndarray, neighbours along the first axis are a whole plane apart, so stencils and slices across the slow axis
+ * touch a new cache line (and often a new page) per element. Here each brick is a dense row-major block of its own,
+ * so all six neighbours of most elements share a brick of 2 KiB (8³ floats) or 16 KiB (16³ floats).
+ *
+ * Bricks are laid out one after another, either in row-major order over the grid of bricks or along a Morton
+ * (Z-order) curve, which also keeps neighbouring bricks close. Edge bricks are padded to the full Brick³, and the
+ * padding stays value-initialised. Indexing goes through a small brick table, one entry per brick.
+ *
+ * Kernels that can work one brick at a time should iterate with brick(b) / for_each_brick(): the brick's view
+ * covers only elements inside the grid and has unit stride along the last axis.
+ */
+
+enum class brick_order { linear, morton };
+
+// a brick as seen by kernels: where it starts in the grid and a view of its elements inside the grid
+template <typename T> struct brick_ref {
+    std::size_t        origin[3];
+    ndarray_view<T, 3> view;
+};
+
+template <typename T, std::size_t Brick = 8, typename Alloc = aligned_allocator<T>> class bricked_array {
+    static_assert(Brick > 1 && (Brick & (Brick - 1)) == 0, "Brick edge must be a power of two");
+
+  public:
+    static constexpr std::size_t brick_edge     = Brick;
+    static constexpr std::size_t brick_elements = Brick * Brick * Brick;
+
+    T * data = nullptr;
+
+    std::size_t dims[3];
+    std::size_t bricks[3];  // bricks along each axis, dims rounded up to whole bricks
+    brick_order order;
+
+    [[no_unique_address]] Alloc alloc;
+
+    bricked_array(std::size_t nx, std::size_t ny, std::size_t nz, brick_order order = brick_order::linear,
+                  const Alloc & alloc = Alloc());
+    bricked_array(uninitialized_t, std::size_t nx, std::size_t ny, std::size_t nz,
+                  brick_order order = brick_order::linear, const Alloc & alloc = Alloc());
+    // converts from the linear layout
+    explicit bricked_array(ndarray_view<const T, 3> linear, brick_order order = brick_order::linear,
+                           const Alloc & alloc = Alloc());
+    ~bricked_array();
+
+    bricked_array(const bricked_array & other);
+    bricked_array(bricked_array && other) noexcept;
+    bricked_array & operator=(const bricked_array & other);
+    bricked_array & operator=(bricked_array && other) noexcept;
+
+    [[nodiscard]] T &       at(std::size_t i, std::size_t j, std::size_t k);
+    [[nodiscard]] const T & at(std::size_t i, std::size_t j, std::size_t k) const;
+    [[nodiscard]] T &       operator()(std::size_t i, std::size_t j, std::size_t k);
+    [[nodiscard]] const T & operator()(std::size_t i, std::size_t j, std::size_t k) const;
+
+    [[nodiscard]] std::size_t offset_of_index(std::size_t i, std::size_t j, std::size_t k) const;
+    [[nodiscard]] std::size_t total_elements() const;
+    // elements allocated, including the padding of edge bricks
+    [[nodiscard]] std::size_t storage_elements() const;
+
+    void fill(T value);
+
+    // converts back to the linear layout; `out` may be any view of matching shape
+    void                        to_linear(ndarray_view<T, 3> out) const;
+    [[nodiscard]] ndarray<T, 3> to_ndarray() const;
+
+    // bricks in storage order, b < brick_count()
+    [[nodiscard]] std::size_t        brick_count() const;
+    [[nodiscard]] brick_ref<T>       brick(std::size_t b);
+    [[nodiscard]] brick_ref<const T> brick(std::size_t b) const;
+    template <typename F> void       for_each_brick(F && f);
+    template <typename F> void       for_each_brick(F && f) const;
+
+  private:
+    static constexpr std::size_t shift = std::countr_zero(Brick);
+    static constexpr std::size_t mask  = Brick - 1;
+
+    void init_shape(std::size_t nx, std::size_t ny, std::size_t nz);
+    void allocate_storage(bool value_initialize);
+    void release_storage() noexcept;
+
+    // storage slot of each brick, indexed row-major over the grid of bricks, and the inverse
+    std::vector<std::size_t> slot_of_brick;
+    std::vector<std::size_t> brick_of_slot;
+};
+
+namespace detail {
+
+// spreads the low 21 bits of v so that two zero bits follow each of them
+constexpr std::uint64_t spread_bits_3d(std::uint64_t v) {
+    v &= 0x1fffff;
+    v = (v | v << 32) & 0x1f00000000ffff;
+    v = (v | v << 16) & 0x1f0000ff0000ff;
+    v = (v | v << 8) & 0x100f00f00f00f00f;
+    v = (v | v << 4) & 0x10c30c30c30c30c3;
+    v = (v | v << 2) & 0x1249249249249249;
+    return v;
+}
+
+constexpr std::uint64_t morton_code(std::uint64_t i, std::uint64_t j, std::uint64_t k) {
+    return spread_bits_3d(i) << 2 | spread_bits_3d(j) << 1 | spread_bits_3d(k);
+}
+
+};  // namespace detail
+
+template <typename T, std::size_t Brick, typename Alloc>
+bricked_array<T, Brick, Alloc>::bricked_array(std::size_t nx, std::size_t ny, std::size_t nz, brick_order order,
+                                              const Alloc & alloc) :
+    order(order),
+    alloc(alloc) {
+    init_shape(nx, ny, nz);
+    allocate_storage(true);
+}
+
+template <typename T, std::size_t Brick, typename Alloc>
+bricked_array<T, Brick, Alloc>::bricked_array(uninitialized_t, std::size_t nx, std::size_t ny, std::size_t nz,
+                                              brick_order order, const Alloc & alloc) :
+    order(order),
+    alloc(alloc) {
+    init_shape(nx, ny, nz);
+    allocate_storage(false);
+}
+
+template <typename T, std::size_t Brick, typename Alloc>
+bricked_array<T, Brick, Alloc>::bricked_array(ndarray_view<const T, 3> linear, brick_order order, const Alloc & alloc) :
+    order(order),
+    alloc(alloc) {
+    init_shape(linear.dims[0], linear.dims[1], linear.dims[2]);
+    // padding must still be initialised, so value-initialise and copy over the interior
+    allocate_storage(true);
+    for (std::size_t b = 0; b < brick_count(); ++b) {
+        brick_ref<T> dst = brick(b);
+        for (std::size_t i = 0; i < dst.view.dims[0]; ++i) {
+            for (std::size_t j = 0; j < dst.view.dims[1]; ++j) {
+                T *       out = &dst.view(i, j, 0);
+                const T * in  = &linear(dst.origin[0] + i, dst.origin[1] + j, dst.origin[2]);
+                for (std::size_t k = 0; k < dst.view.dims[2]; ++k) {
+                    out[k] = in[k * linear.strides[2]];
+                }
+            }
+        }
+    }
+}
+
+template <typename T, std::size_t Brick, typename Alloc> bricked_array<T, Brick, Alloc>::~bricked_array() {
+    release_storage();
+}
+
+template <typename T, std::size_t Brick, typename Alloc>
+bricked_array<T, Brick, Alloc>::bricked_array(const bricked_array & other) :
+    order(other.order),
+    alloc(other.alloc),
+    slot_of_brick(other.slot_of_brick),
+    brick_of_slot(other.brick_of_slot) {
+    for (std::size_t a = 0; a < 3; ++a) {
+        dims[a]   = other.dims[a];
+        bricks[a] = other.bricks[a];
+    }
+    data = alloc.allocate(storage_elements());
+    std::uninitialized_copy_n(other.data, storage_elements(), data);
+}
+
+template <typename T, std::size_t Brick, typename Alloc>
+bricked_array<T, Brick, Alloc>::bricked_array(bricked_array && other) noexcept :
+    data(other.data),
+    order(other.order),
+    alloc(other.alloc),
+    slot_of_brick(std::move(other.slot_of_brick)),
+    brick_of_slot(std::move(other.brick_of_slot)) {
+    for (std::size_t a = 0; a < 3; ++a) {
+        dims[a]   = other.dims[a];
+        bricks[a] = other.bricks[a];
+    }
+    other.data = nullptr;
+}
+
+template <typename T, std::size_t Brick, typename Alloc>
+bricked_array<T, Brick, Alloc> & bricked_array<T, Brick, Alloc>::operator=(const bricked_array & other) {
+    if (this != &other) {
+        *this = bricked_array(other);
+    }
+    return *this;
+}
+
+template <typename T, std::size_t Brick, typename Alloc>
+bricked_array<T, Brick, Alloc> & bricked_array<T, Brick, Alloc>::operator=(bricked_array && other) noexcept {
+    if (this != &other) {
+        release_storage();
+        for (std::size_t a = 0; a < 3; ++a) {
+            dims[a]   = other.dims[a];
+            bricks[a] = other.bricks[a];
+        }
+        order         = other.order;
+        alloc         = other.alloc;
+        slot_of_brick = std::move(other.slot_of_brick);
+        brick_of_slot = std::move(other.brick_of_slot);
+        data          = other.data;
+        other.data    = nullptr;
+    }
+    return *this;
+}
+
+template <typename T, std::size_t Brick, typename Alloc>
+void bricked_array<T, Brick, Alloc>::init_shape(std::size_t nx, std::size_t ny, std::size_t nz) {
+    const std::size_t shape[3] = { nx, ny, nz };
+    for (std::size_t a = 0; a < 3; ++a) {
+        dims[a]   = shape[a];
+        bricks[a] = (shape[a] + Brick - 1) >> shift;
+    }
+
+    const std::size_t count = bricks[0] * bricks[1] * bricks[2];
+    brick_of_slot.resize(count);
+    for (std::size_t b = 0; b < count; ++b) {
+        brick_of_slot[b] = b;
+    }
+    if (order == brick_order::morton) {
+        // sorting by Morton code keeps the curve's order while skipping codes outside non-cubic grids
+        std::vector<std::uint64_t> codes(count);
+        for (std::size_t bi = 0, b = 0; bi < bricks[0]; ++bi) {
+            for (std::size_t bj = 0; bj < bricks[1]; ++bj) {
+                for (std::size_t bk = 0; bk < bricks[2]; ++bk, ++b) {
+                    codes[b] = detail::morton_code(bi, bj, bk);
+                }
+            }
+        }
+        std::sort(brick_of_slot.begin(), brick_of_slot.end(),
+                  [&](std::size_t a, std::size_t b) { return codes[a] < codes[b]; });
+    }
+    slot_of_brick.resize(count);
+    for (std::size_t slot = 0; slot < count; ++slot) {
+        slot_of_brick[brick_of_slot[slot]] = slot;
+    }
+}
+
+template <typename T, std::size_t Brick, typename Alloc>
+void bricked_array<T, Brick, Alloc>::allocate_storage(bool value_initialize) {
+    data = alloc.allocate(storage_elements());
+    if (value_initialize && !(Alloc::zeroed && std::is_trivial_v<T>)) {
+        std::uninitialized_value_construct_n(data, storage_elements());
+    } else {
+        std::uninitialized_default_construct_n(data, storage_elements());
+    }
+}
+
+template <typename T, std::size_t Brick, typename Alloc>
+void bricked_array<T, Brick, Alloc>::release_storage() noexcept {
+    if (data != nullptr) {
+        std::destroy_n(data, storage_elements());
+        alloc.deallocate(data, storage_elements());
+        data = nullptr;
+    }
+}
+
+template <typename T, std::size_t Brick, typename Alloc>
+std::size_t bricked_array<T, Brick, Alloc>::offset_of_index(std::size_t i, std::size_t j, std::size_t k) const {
+    std::size_t brick_index = ((i >> shift) * bricks[1] + (j >> shift)) * bricks[2] + (k >> shift);
+    std::size_t local       = (((i & mask) << shift | (j & mask)) << shift) | (k & mask);
+    return slot_of_brick[brick_index] * brick_elements + local;
+}
+
+template <typename T, std::size_t Brick, typename Alloc>
+T & bricked_array<T, Brick, Alloc>::at(std::size_t i, std::size_t j, std::size_t k) {
+    if (i >= dims[0] || j >= dims[1] || k >= dims[2]) {
+        abort();
+    }
+    return data[offset_of_index(i, j, k)];
+}
+
+template <typename T, std::size_t Brick, typename Alloc>
+const T & bricked_array<T, Brick, Alloc>::at(std::size_t i, std::size_t j, std::size_t k) const {
+    if (i >= dims[0] || j >= dims[1] || k >= dims[2]) {
+        abort();
+    }
+    return data[offset_of_index(i, j, k)];
+}
+
+template <typename T, std::size_t Brick, typename Alloc>
+T & bricked_array<T, Brick, Alloc>::operator()(std::size_t i, std::size_t j, std::size_t k) {
+    return data[offset_of_index(i, j, k)];
+}
+
+template <typename T, std::size_t Brick, typename Alloc>
+const T & bricked_array<T, Brick, Alloc>::operator()(std::size_t i, std::size_t j, std::size_t k) const {
+    return data[offset_of_index(i, j, k)];
+}
+
+template <typename T, std::size_t Brick, typename Alloc>
+std::size_t bricked_array<T, Brick, Alloc>::total_elements() const {
+    return dims[0] * dims[1] * dims[2];
+}
+
+template <typename T, std::size_t Brick, typename Alloc>
+std::size_t bricked_array<T, Brick, Alloc>::storage_elements() const {
+    return brick_count() * brick_elements;
+}
+
+template <typename T, std::size_t Brick, typename Alloc> void bricked_array<T, Brick, Alloc>::fill(T value) {
+    // padding is filled too, which keeps the loop a single flat run
+    for (std::size_t n = 0; n < storage_elements(); ++n) {
+        data[n] = value;
+    }
+}
+
+template <typename T, std::size_t Brick, typename Alloc>
+void bricked_array<T, Brick, Alloc>::to_linear(ndarray_view<T, 3> out) const {
+    for (std::size_t a = 0; a < 3; ++a) {
+        if (out.dims[a] != dims[a]) {
+            abort();
+        }
+    }
+    for_each_brick([&](const brick_ref<const T> & src) {
+        for (std::size_t i = 0; i < src.view.dims[0]; ++i) {
+            for (std::size_t j = 0; j < src.view.dims[1]; ++j) {
+                const T * in = &src.view(i, j, 0);
+                T *       to = &out(src.origin[0] + i, src.origin[1] + j, src.origin[2]);
+                for (std::size_t k = 0; k < src.view.dims[2]; ++k) {
+                    to[k * out.strides[2]] = in[k];
+                }
+            }
+        }
+    });
+}
+
+template <typename T, std::size_t Brick, typename Alloc>
+ndarray<T, 3> bricked_array<T, Brick, Alloc>::to_ndarray() const {
+    ndarray<T, 3> result(uninitialized, dims[0], dims[1], dims[2]);
+    to_linear(result.view());
+    return result;
+}
+
+template <typename T, std::size_t Brick, typename Alloc>
+std::size_t bricked_array<T, Brick, Alloc>::brick_count() const {
+    return brick_of_slot.size();
+}
+
+template <typename T, std::size_t Brick, typename Alloc>
+brick_ref<T> bricked_array<T, Brick, Alloc>::brick(std::size_t b) {
+    std::size_t index = brick_of_slot[b];
+    std::size_t bk    = index % bricks[2];
+    std::size_t bj    = (index / bricks[2]) % bricks[1];
+    std::size_t bi    = index / (bricks[2] * bricks[1]);
+
+    brick_ref<T> result;
+    std::size_t  extent[3];
+    std::size_t  position[3] = { bi, bj, bk };
+    for (std::size_t a = 0; a < 3; ++a) {
+        result.origin[a] = position[a] << shift;
+        extent[a]        = std::min(Brick, dims[a] - result.origin[a]);
+    }
+    result.view = ndarray_view<T, 3>(data + b * brick_elements, extent, { Brick * Brick, Brick, 1 });
+    return result;
+}
+
+template <typename T, std::size_t Brick, typename Alloc>
+brick_ref<const T> bricked_array<T, Brick, Alloc>::brick(std::size_t b) const {
+    brick_ref<T> result = const_cast<bricked_array *>(this)->brick(b);
+    return brick_ref<const T>{ { result.origin[0], result.origin[1], result.origin[2] }, result.view };
+}
+
+template <typename T, std::size_t Brick, typename Alloc> template <typename F>
+void bricked_array<T, Brick, Alloc>::for_each_brick(F && f) {
+    for (std::size_t b = 0; b < brick_count(); ++b) {
+        f(brick(b));
+    }
+}
+
+template <typename T, std::size_t Brick, typename Alloc> template <typename F>
+void bricked_array<T, Brick, Alloc>::for_each_brick(F && f) const {
+    for (std::size_t b = 0; b < brick_count(); ++b) {
+        f(brick(b));
+    }
+}
+
+};  // namespace velm_DR
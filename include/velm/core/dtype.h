@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace velm_DR {
+
+// runtime tag for the element types ndarray is stored with on disk
+enum class dtype : std::uint8_t {
+    int8,
+    uint8,
+    int16,
+    uint16,
+    int32,
+    uint32,
+    int64,
+    uint64,
+    float32,
+    float64,
+};
+
+template <typename T> [[nodiscard]] constexpr dtype dtype_of() {
+    using U = std::remove_cv_t<T>;
+    static_assert(std::is_arithmetic_v<U> && !std::is_same_v<U, bool>, "Unsupported element type");
+    if constexpr (std::is_floating_point_v<U>) {
+        static_assert(sizeof(U) == 4 || sizeof(U) == 8, "Unsupported floating point width");
+        return sizeof(U) == 4 ? dtype::float32 : dtype::float64;
+    } else if constexpr (sizeof(U) == 1) {
+        return std::is_signed_v<U> ? dtype::int8 : dtype::uint8;
+    } else if constexpr (sizeof(U) == 2) {
+        return std::is_signed_v<U> ? dtype::int16 : dtype::uint16;
+    } else if constexpr (sizeof(U) == 4) {
+        return std::is_signed_v<U> ? dtype::int32 : dtype::uint32;
+    } else {
+        return std::is_signed_v<U> ? dtype::int64 : dtype::uint64;
+    }
+}
+
+[[nodiscard]] constexpr std::size_t dtype_size(dtype type) {
+    switch (type) {
+        case dtype::int8:
+        case dtype::uint8:
+            return 1;
+        case dtype::int16:
+        case dtype::uint16:
+            return 2;
+        case dtype::int32:
+        case dtype::uint32:
+        case dtype::float32:
+            return 4;
+        case dtype::int64:
+        case dtype::uint64:
+        case dtype::float64:
+            return 8;
+    }
+    return 0;
+}
+
+};  // namespace velm_DR
@@ -0,0 +1,372 @@
+#pragma once
+
+#include "velm/core/ndarray_view.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <type_traits>
+#include <utility>
+
+namespace velm_DR {
+
+/*
+ * Lazy elementwise arithmetic on ndarray and ndarray_view.
+ *
+ * Operators and the math functions below do not compute anything; they build a tree of small expression nodes
+ * that is evaluated element by element when it is assigned to an ndarray (or written into a view with assign()).
+ * `ndarray<float, 3> mag = sqrt(ex * ex + ey * ey + ez * ez)` is therefore one loop over the grid with no
+ * temporaries. When every operand and the destination are contiguous the loop runs over flat indices, which the
+ * compiler can vectorise; otherwise it walks the logical index space.
+ *
+ * Operand shapes are checked when a node is built and again on assignment; a mismatch aborts. Scalars broadcast
+ * and take the element type of the array side. Nodes hold views, not copies: an expression must not outlive the
+ * arrays it refers to, and the destination may only alias an operand element for element (a = a * 2 is fine,
+ * a = a.transpose() is not).
+ */
+
+template <typename T, std::size_t N, typename Alloc> class ndarray;
+
+template <typename E> struct is_expression : std::false_type {};
+// true for expression nodes, which only come into existence through the operators below
+template <typename E> inline constexpr bool is_expression_v = is_expression<std::remove_cvref_t<E>>::value;
+
+// leaf referring to array elements
+template <typename T, std::size_t N> class terminal_expr {
+  public:
+    using value_type                  = T;
+    static constexpr std::size_t rank = N;
+
+    explicit terminal_expr(ndarray_view<const T, N> view) : view(view) {}
+
+    [[nodiscard]] const std::size_t * shape() const { return view.dims; }
+    [[nodiscard]] bool                contiguous() const { return view.is_contiguous(); }
+    [[nodiscard]] T                   flat(std::size_t i) const { return view.data[i]; }
+    [[nodiscard]] T                   at(const std::size_t (&index)[N]) const {
+        std::size_t offset = 0;
+        for (std::size_t a = 0; a < N; ++a) {
+            offset += index[a] * view.strides[a];
+        }
+        return view.data[offset];
+    }
+
+  private:
+    ndarray_view<const T, N> view;
+};
+
+// leaf broadcasting one value over any shape
+template <typename T, std::size_t N> class scalar_expr {
+  public:
+    using value_type                  = T;
+    static constexpr std::size_t rank = N;
+
+    explicit scalar_expr(T value) : value(value) {}
+
+    // no shape of its own, it adopts the shape of the other operand
+    [[nodiscard]] const std::size_t * shape() const { return nullptr; }
+    [[nodiscard]] bool                contiguous() const { return true; }
+    [[nodiscard]] T                   flat(std::size_t) const { return value; }
+    [[nodiscard]] T                   at(const std::size_t (&)[N]) const { return value; }
+
+  private:
+    T value;
+};
+
+template <typename Op, typename E> class unary_expr {
+  public:
+    using value_type                  = decltype(Op{}(std::declval<typename E::value_type>()));
+    static constexpr std::size_t rank = E::rank;
+
+    explicit unary_expr(E operand) : operand(std::move(operand)) {}
+
+    [[nodiscard]] const std::size_t * shape() const { return operand.shape(); }
+    [[nodiscard]] bool                contiguous() const { return operand.contiguous(); }
+    [[nodiscard]] value_type          flat(std::size_t i) const { return Op{}(operand.flat(i)); }
+    [[nodiscard]] value_type          at(const std::size_t (&index)[rank]) const { return Op{}(operand.at(index)); }
+
+  private:
+    E operand;
+};
+
+template <typename Op, typename L, typename R> class binary_expr {
+    static_assert(L::rank == R::rank, "Operands of an array expression must have the same rank");
+
+  public:
+    using value_type = decltype(Op{}(std::declval<typename L::value_type>(), std::declval<typename R::value_type>()));
+    static constexpr std::size_t rank = L::rank;
+
+    binary_expr(L left, R right) : left(std::move(left)), right(std::move(right)) {
+        const std::size_t * a = this->left.shape();
+        const std::size_t * b = this->right.shape();
+        if (a != nullptr && b != nullptr) {
+            for (std::size_t i = 0; i < rank; ++i) {
+                if (a[i] != b[i]) {
+                    abort();
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] const std::size_t * shape() const {
+        return left.shape() != nullptr ? left.shape() : right.shape();
+    }
+    [[nodiscard]] bool       contiguous() const { return left.contiguous() && right.contiguous(); }
+    [[nodiscard]] value_type flat(std::size_t i) const { return Op{}(left.flat(i), right.flat(i)); }
+    [[nodiscard]] value_type at(const std::size_t (&index)[rank]) const {
+        return Op{}(left.at(index), right.at(index));
+    }
+
+  private:
+    L left;
+    R right;
+};
+
+template <typename T, std::size_t N> struct is_expression<terminal_expr<T, N>> : std::true_type {};
+template <typename T, std::size_t N> struct is_expression<scalar_expr<T, N>> : std::true_type {};
+template <typename Op, typename E> struct is_expression<unary_expr<Op, E>> : std::true_type {};
+template <typename Op, typename L, typename R> struct is_expression<binary_expr<Op, L, R>> : std::true_type {};
+
+namespace expr_detail {
+
+template <typename T> struct operand_traits {
+    static constexpr bool is_array = is_expression_v<T>;
+};
+template <typename T, std::size_t N, typename Alloc> struct operand_traits<ndarray<T, N, Alloc>> {
+    static constexpr bool is_array = true;
+};
+template <typename T, std::size_t N> struct operand_traits<ndarray_view<T, N>> {
+    static constexpr bool is_array = true;
+};
+
+template <typename T>
+concept array_operand = operand_traits<std::remove_cvref_t<T>>::is_array;
+
+template <typename T>
+concept scalar_operand = std::is_arithmetic_v<std::remove_cvref_t<T>>;
+
+template <typename T, std::size_t N, typename Alloc>
+terminal_expr<T, N> as_expression(const ndarray<T, N, Alloc> & array) {
+    return terminal_expr<T, N>(array.view());
+}
+
+template <typename T, std::size_t N>
+terminal_expr<std::remove_const_t<T>, N> as_expression(const ndarray_view<T, N> & view) {
+    return terminal_expr<std::remove_const_t<T>, N>(view);
+}
+
+template <typename E>
+    requires is_expression_v<E>
+const E & as_expression(const E & expr) {
+    return expr;
+}
+
+template <typename E> using expression_t = std::remove_cvref_t<decltype(as_expression(std::declval<const E &>()))>;
+
+template <typename Op, typename L, typename R> auto combine(const L & left, const R & right) {
+    if constexpr (scalar_operand<L>) {
+        using E = expression_t<R>;
+        return binary_expr<Op, scalar_expr<typename E::value_type, E::rank>, E>(
+            scalar_expr<typename E::value_type, E::rank>(static_cast<typename E::value_type>(left)),
+            as_expression(right));
+    } else if constexpr (scalar_operand<R>) {
+        using E = expression_t<L>;
+        return binary_expr<Op, E, scalar_expr<typename E::value_type, E::rank>>(
+            as_expression(left),
+            scalar_expr<typename E::value_type, E::rank>(static_cast<typename E::value_type>(right)));
+    } else {
+        return binary_expr<Op, expression_t<L>, expression_t<R>>(as_expression(left), as_expression(right));
+    }
+}
+
+template <typename Op, typename E> auto apply(const E & operand) {
+    return unary_expr<Op, expression_t<E>>(as_expression(operand));
+}
+
+// a binary operator applies when one side is an array and the other an array or a scalar
+template <typename L, typename R>
+concept binary_operands = (array_operand<L> && (array_operand<R> || scalar_operand<R>)) ||
+                          (scalar_operand<L> && array_operand<R>);
+
+struct plus_op {
+    template <typename A, typename B> auto operator()(A a, B b) const { return a + b; }
+};
+struct minus_op {
+    template <typename A, typename B> auto operator()(A a, B b) const { return a - b; }
+};
+struct multiplies_op {
+    template <typename A, typename B> auto operator()(A a, B b) const { return a * b; }
+};
+struct divides_op {
+    template <typename A, typename B> auto operator()(A a, B b) const { return a / b; }
+};
+struct min_op {
+    template <typename A, typename B> auto operator()(A a, B b) const {
+        using C = std::common_type_t<A, B>;
+        return C(b) < C(a) ? C(b) : C(a);
+    }
+};
+struct max_op {
+    template <typename A, typename B> auto operator()(A a, B b) const {
+        using C = std::common_type_t<A, B>;
+        return C(b) > C(a) ? C(b) : C(a);
+    }
+};
+struct pow_op {
+    template <typename A, typename B> auto operator()(A a, B b) const { return std::pow(a, b); }
+};
+struct negate_op {
+    template <typename A> A operator()(A a) const { return -a; }
+};
+struct sqrt_op {
+    template <typename A> auto operator()(A a) const { return std::sqrt(a); }
+};
+struct abs_op {
+    template <typename A> auto operator()(A a) const { return std::abs(a); }
+};
+struct exp_op {
+    template <typename A> auto operator()(A a) const { return std::exp(a); }
+};
+struct log_op {
+    template <typename A> auto operator()(A a) const { return std::log(a); }
+};
+struct sin_op {
+    template <typename A> auto operator()(A a) const { return std::sin(a); }
+};
+struct cos_op {
+    template <typename A> auto operator()(A a) const { return std::cos(a); }
+};
+
+};  // namespace expr_detail
+
+template <typename L, typename R>
+    requires expr_detail::binary_operands<L, R>
+auto operator+(const L & left, const R & right) {
+    return expr_detail::combine<expr_detail::plus_op>(left, right);
+}
+
+template <typename L, typename R>
+    requires expr_detail::binary_operands<L, R>
+auto operator-(const L & left, const R & right) {
+    return expr_detail::combine<expr_detail::minus_op>(left, right);
+}
+
+template <typename L, typename R>
+    requires expr_detail::binary_operands<L, R>
+auto operator*(const L & left, const R & right) {
+    return expr_detail::combine<expr_detail::multiplies_op>(left, right);
+}
+
+template <typename L, typename R>
+    requires expr_detail::binary_operands<L, R>
+auto operator/(const L & left, const R & right) {
+    return expr_detail::combine<expr_detail::divides_op>(left, right);
+}
+
+template <typename E>
+    requires expr_detail::array_operand<E>
+auto operator-(const E & operand) {
+    return expr_detail::apply<expr_detail::negate_op>(operand);
+}
+
+// elementwise minimum / maximum, e.g. for clamping
+template <typename L, typename R>
+    requires expr_detail::binary_operands<L, R>
+auto min(const L & left, const R & right) {
+    return expr_detail::combine<expr_detail::min_op>(left, right);
+}
+
+template <typename L, typename R>
+    requires expr_detail::binary_operands<L, R>
+auto max(const L & left, const R & right) {
+    return expr_detail::combine<expr_detail::max_op>(left, right);
+}
+
+template <typename L, typename R>
+    requires expr_detail::binary_operands<L, R>
+auto pow(const L & left, const R & right) {
+    return expr_detail::combine<expr_detail::pow_op>(left, right);
+}
+
+template <typename E>
+    requires expr_detail::array_operand<E>
+auto sqrt(const E & operand) {
+    return expr_detail::apply<expr_detail::sqrt_op>(operand);
+}
+
+template <typename E>
+    requires expr_detail::array_operand<E>
+auto abs(const E & operand) {
+    return expr_detail::apply<expr_detail::abs_op>(operand);
+}
+
+template <typename E>
+    requires expr_detail::array_operand<E>
+auto exp(const E & operand) {
+    return expr_detail::apply<expr_detail::exp_op>(operand);
+}
+
+template <typename E>
+    requires expr_detail::array_operand<E>
+auto log(const E & operand) {
+    return expr_detail::apply<expr_detail::log_op>(operand);
+}
+
+template <typename E>
+    requires expr_detail::array_operand<E>
+auto sin(const E & operand) {
+    return expr_detail::apply<expr_detail::sin_op>(operand);
+}
+
+template <typename E>
+    requires expr_detail::array_operand<E>
+auto cos(const E & operand) {
+    return expr_detail::apply<expr_detail::cos_op>(operand);
+}
+
+// evaluates `expr` into `out` in a single pass; shapes must match
+template <typename T, std::size_t N, typename E>
+    requires is_expression_v<E>
+void assign(ndarray_view<T, N> out, const E & expr) {
+    static_assert(E::rank == N, "Expression rank does not match the destination");
+    const std::size_t * shape = expr.shape();
+    for (std::size_t i = 0; i < N; ++i) {
+        if (shape != nullptr && shape[i] != out.dims[i]) {
+            abort();
+        }
+    }
+
+    std::size_t total = out.total_elements();
+    if (total == 0) {
+        return;
+    }
+    if (out.is_contiguous() && expr.contiguous()) {
+        T * dst = out.data;
+        for (std::size_t i = 0; i < total; ++i) {
+            dst[i] = static_cast<T>(expr.flat(i));
+        }
+        return;
+    }
+
+    // walk the logical index space, innermost axis in the inner loop
+    const std::size_t length     = out.dims[N - 1];
+    const std::size_t dst_stride = out.strides[N - 1];
+    std::size_t       index[N]   = {};
+    for (std::size_t row = 0; row < total / length; ++row) {
+        T * dst = out.data;
+        for (std::size_t a = 0; a + 1 < N; ++a) {
+            dst += index[a] * out.strides[a];
+        }
+        for (index[N - 1] = 0; index[N - 1] < length; ++index[N - 1]) {
+            dst[index[N - 1] * dst_stride] = static_cast<T>(expr.at(index));
+        }
+        index[N - 1] = 0;
+        for (std::size_t a = N - 1; a > 0; --a) {
+            if (++index[a - 1] < out.dims[a - 1]) {
+                break;
+            }
+            index[a - 1] = 0;
+        }
+    }
+}
+
+};  // namespace velm_DR
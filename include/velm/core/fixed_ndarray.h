@@ -0,0 +1,217 @@
+#pragma once
+
+#include "velm/core/ndarray_view.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <type_traits>
+#include <utility>
+
+namespace velm_DR {
+
+/*
+ * Array with its shape fixed at compile time, for the small tensors that live at every voxel: vectors, 3×3
+ * permittivity tensors, 2×2 Jones matrices.
+ *
+ * Elements are stored inline, row-major, so a fixed_ndarray is a trivially copyable aggregate of exactly
+ * size * sizeof(T) bytes: it can be the element type of an ndarray or a tensor_array (see tensor_array.h), lives on
+ * the stack and is usable in constant expressions. dims and strides are static constants, and offset_of_index folds
+ * the indices against them without a loop, so after inlining an access costs what a hand-written offset would.
+ *
+ * Brace initialisation lists the elements in row-major order: mat3<float> m{ 1, 0, 0, 0, 1, 0, 0, 0, 1 }.
+ */
+
+namespace detail {
+
+template <std::size_t... Extents> constexpr auto fixed_strides() {
+    constexpr std::size_t rank          = sizeof...(Extents);
+    constexpr std::size_t extents[rank] = { Extents... };
+    struct strides_t {
+        std::size_t values[rank];
+    } strides{};
+    std::size_t stride = 1;
+    for (std::size_t i = rank; i > 0; --i) {
+        strides.values[i - 1] = stride;
+        stride *= extents[i - 1];
+    }
+    return strides;
+}
+
+};  // namespace detail
+
+template <typename T, std::size_t... Extents> struct fixed_ndarray {
+    static_assert(sizeof...(Extents) > 0, "fixed_ndarray requires at least one dimension");
+    static_assert(((Extents > 0) && ...), "fixed_ndarray extents must be positive");
+
+    using value_type = T;
+
+  private:
+    static constexpr auto stride_table = detail::fixed_strides<Extents...>();
+
+  public:
+    static constexpr std::size_t rank       = sizeof...(Extents);
+    static constexpr std::size_t size       = (Extents * ...);
+    static constexpr std::size_t dims[rank] = { Extents... };
+    static constexpr const std::size_t (&strides)[rank] = stride_table.values;
+
+    T data[size];
+
+    template <typename... Idx>
+        requires(sizeof...(Idx) == rank && (std::is_integral_v<Idx> && ...))
+    [[nodiscard]] static constexpr std::size_t offset_of_index(Idx... idx) {
+        const std::size_t indices[rank] = { static_cast<std::size_t>(idx)... };
+        return [&]<std::size_t... Axis>(std::index_sequence<Axis...>) {
+            return ((indices[Axis] * strides[Axis]) + ...);
+        }(std::make_index_sequence<rank>());
+    }
+
+    template <typename... Idx>
+        requires(sizeof...(Idx) == rank && (std::is_integral_v<Idx> && ...))
+    [[nodiscard]] constexpr T & operator()(Idx... idx) {
+        return data[offset_of_index(idx...)];
+    }
+
+    template <typename... Idx>
+        requires(sizeof...(Idx) == rank && (std::is_integral_v<Idx> && ...))
+    [[nodiscard]] constexpr const T & operator()(Idx... idx) const {
+        return data[offset_of_index(idx...)];
+    }
+
+    template <typename... Idx>
+        requires(sizeof...(Idx) == rank && (std::is_integral_v<Idx> && ...))
+    [[nodiscard]] constexpr T & at(Idx... idx) {
+        check_bounds(idx...);
+        return data[offset_of_index(idx...)];
+    }
+
+    template <typename... Idx>
+        requires(sizeof...(Idx) == rank && (std::is_integral_v<Idx> && ...))
+    [[nodiscard]] constexpr const T & at(Idx... idx) const {
+        check_bounds(idx...);
+        return data[offset_of_index(idx...)];
+    }
+
+    [[nodiscard]] static constexpr std::size_t total_elements() { return size; }
+
+    constexpr void fill(const T & value) {
+        for (T & element : data) {
+            element = value;
+        }
+    }
+
+    [[nodiscard]] constexpr T *       begin() { return data; }
+    [[nodiscard]] constexpr const T * begin() const { return data; }
+    [[nodiscard]] constexpr T *       end() { return data + size; }
+    [[nodiscard]] constexpr const T * end() const { return data + size; }
+
+    // for code written against runtime shapes
+    [[nodiscard]] ndarray_view<T, rank>       view() { return ndarray_view<T, rank>(data, dims, strides); }
+    [[nodiscard]] ndarray_view<const T, rank> view() const {
+        return ndarray_view<const T, rank>(data, dims, strides);
+    }
+
+    [[nodiscard]] constexpr bool operator==(const fixed_ndarray &) const = default;
+
+    constexpr fixed_ndarray & operator+=(const fixed_ndarray & other) {
+        for (std::size_t i = 0; i < size; ++i) {
+            data[i] += other.data[i];
+        }
+        return *this;
+    }
+
+    constexpr fixed_ndarray & operator-=(const fixed_ndarray & other) {
+        for (std::size_t i = 0; i < size; ++i) {
+            data[i] -= other.data[i];
+        }
+        return *this;
+    }
+
+    constexpr fixed_ndarray & operator*=(const T & scale) {
+        for (T & element : data) {
+            element *= scale;
+        }
+        return *this;
+    }
+
+  private:
+    template <typename... Idx> static constexpr void check_bounds(Idx... idx) {
+        const std::size_t indices[rank] = { static_cast<std::size_t>(idx)... };
+        for (std::size_t i = 0; i < rank; ++i) {
+            if (indices[i] >= dims[i]) {
+                abort();
+            }
+        }
+    }
+};
+
+template <typename T> using vec2 = fixed_ndarray<T, 2>;
+template <typename T> using vec3 = fixed_ndarray<T, 3>;
+template <typename T> using mat2 = fixed_ndarray<T, 2, 2>;
+template <typename T> using mat3 = fixed_ndarray<T, 3, 3>;
+
+template <typename T> struct is_fixed_ndarray : std::false_type {};
+template <typename T, std::size_t... Extents>
+struct is_fixed_ndarray<fixed_ndarray<T, Extents...>> : std::true_type {};
+template <typename T> inline constexpr bool is_fixed_ndarray_v = is_fixed_ndarray<std::remove_cvref_t<T>>::value;
+
+template <typename T, std::size_t... Extents>
+[[nodiscard]] constexpr fixed_ndarray<T, Extents...> operator+(fixed_ndarray<T, Extents...> left,
+                                                               const fixed_ndarray<T, Extents...> & right) {
+    return left += right;
+}
+
+template <typename T, std::size_t... Extents>
+[[nodiscard]] constexpr fixed_ndarray<T, Extents...> operator-(fixed_ndarray<T, Extents...> left,
+                                                               const fixed_ndarray<T, Extents...> & right) {
+    return left -= right;
+}
+
+template <typename T, std::size_t... Extents>
+[[nodiscard]] constexpr fixed_ndarray<T, Extents...> operator*(fixed_ndarray<T, Extents...> left,
+                                                               const std::type_identity_t<T> & scale) {
+    return left *= scale;
+}
+
+template <typename T, std::size_t... Extents>
+[[nodiscard]] constexpr fixed_ndarray<T, Extents...> operator*(const std::type_identity_t<T> & scale,
+                                                               fixed_ndarray<T, Extents...> right) {
+    return right *= scale;
+}
+
+// y = m x
+template <typename T, std::size_t Rows, std::size_t Cols>
+[[nodiscard]] constexpr fixed_ndarray<T, Rows> mat_vec(const fixed_ndarray<T, Rows, Cols> & m,
+                                                       const fixed_ndarray<T, Cols> &       x) {
+    fixed_ndarray<T, Rows> y{};
+    for (std::size_t r = 0; r < Rows; ++r) {
+        for (std::size_t c = 0; c < Cols; ++c) {
+            y.data[r] += m.data[r * Cols + c] * x.data[c];
+        }
+    }
+    return y;
+}
+
+template <typename T, std::size_t Rows, std::size_t Inner, std::size_t Cols>
+[[nodiscard]] constexpr fixed_ndarray<T, Rows, Cols> mat_mul(const fixed_ndarray<T, Rows, Inner> & a,
+                                                             const fixed_ndarray<T, Inner, Cols> & b) {
+    fixed_ndarray<T, Rows, Cols> c{};
+    for (std::size_t r = 0; r < Rows; ++r) {
+        for (std::size_t k = 0; k < Inner; ++k) {
+            for (std::size_t j = 0; j < Cols; ++j) {
+                c.data[r * Cols + j] += a.data[r * Inner + k] * b.data[k * Cols + j];
+            }
+        }
+    }
+    return c;
+}
+
+template <typename T, std::size_t N>
+[[nodiscard]] constexpr T dot(const fixed_ndarray<T, N> & a, const fixed_ndarray<T, N> & b) {
+    T sum{};
+    for (std::size_t i = 0; i < N; ++i) {
+        sum += a.data[i] * b.data[i];
+    }
+    return sum;
+}
+
+};  // namespace velm_DR
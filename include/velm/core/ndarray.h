@@ -1,23 +1,53 @@
+#pragma once
+
+#include "velm/core/allocator.h"
+#include "velm/core/expression.h"
+#include "velm/core/ndarray_view.h"
+
 #include <cstddef>
 #include <cstdlib>
+#include <memory>
+#include <type_traits>
 
 namespace velm_DR {
 
 /*
  * vulnerabilities:
  *  1. Abort is the only error handling in place currently
- *  2. If new[] fails in assignment operators, momory could be leaked
+ *  2. If allocation fails in assignment operators, the target is left without storage
  *
+ * Storage comes from the Alloc policy (see allocator.h); the default gives 64-byte aligned buffers.
  */
 
-template <typename T, std::size_t N> class ndarray {
+template <typename T, std::size_t N, typename Alloc = aligned_allocator<T>> class ndarray {
   public:
     T * data = nullptr;
 
     std::size_t dims[N];
     std::size_t strides[N];
 
-    template <typename... Idx> ndarray(Idx... idx);
+    [[no_unique_address]] Alloc alloc;
+
+    template <typename... Idx>
+        requires(std::is_integral_v<Idx> && ...)
+    ndarray(Idx... idx);
+    // leaves trivial element types uninitialised, for arrays that are about to be overwritten
+    template <typename... Idx>
+        requires(std::is_integral_v<Idx> && ...)
+    ndarray(uninitialized_t, Idx... idx);
+    template <typename... Idx>
+        requires(std::is_integral_v<Idx> && ...)
+    ndarray(const Alloc & alloc, Idx... idx);
+    template <typename... Idx>
+        requires(std::is_integral_v<Idx> && ...)
+    ndarray(uninitialized_t, const Alloc & alloc, Idx... idx);
+    // shape given as an array, for dims only known at runtime
+    explicit ndarray(const std::size_t (&shape)[N], const Alloc & alloc = Alloc());
+    ndarray(uninitialized_t, const std::size_t (&shape)[N], const Alloc & alloc = Alloc());
+    // materialises a lazy expression in a single pass, see expression.h
+    template <typename E>
+        requires is_expression_v<E>
+    ndarray(const E & expr, const Alloc & alloc = Alloc());
     ~ndarray();
 
     template <typename... Idx> [[nodiscard]] T &       at(Idx... idx);
@@ -34,33 +64,143 @@ template <typename T, std::size_t N> class ndarray {
 
     template <typename... Idx> [[nodiscard]] T &       operator()(Idx... idx);
     template <typename... Idx> [[nodiscard]] const T & operator()(Idx... idx) const;
+
+    // zero-copy views, see ndarray_view.h
+    [[nodiscard]] ndarray_view<T, N>           view();
+    [[nodiscard]] ndarray_view<const T, N>     view() const;
+    [[nodiscard]] ndarray_view<T, N>           slice(std::size_t axis,
+                                                     std::size_t begin,
+                                                     std::size_t end,
+                                                     std::size_t step = 1);
+    [[nodiscard]] ndarray_view<const T, N>     slice(std::size_t axis,
+                                                     std::size_t begin,
+                                                     std::size_t end,
+                                                     std::size_t step = 1) const;
+    [[nodiscard]] ndarray_view<T, N>           subarray(const std::size_t (&begin)[N], const std::size_t (&extent)[N]);
+    [[nodiscard]] ndarray_view<const T, N>     subarray(const std::size_t (&begin)[N],
+                                                        const std::size_t (&extent)[N]) const;
+    [[nodiscard]] ndarray_view<T, N - 1>       index(std::size_t axis, std::size_t i);
+    [[nodiscard]] ndarray_view<const T, N - 1> index(std::size_t axis, std::size_t i) const;
+    [[nodiscard]] ndarray_view<T, N>           permute(const std::size_t (&axes)[N]);
+    [[nodiscard]] ndarray_view<const T, N>     permute(const std::size_t (&axes)[N]) const;
+    [[nodiscard]] ndarray_view<T, N>           transpose();
+    [[nodiscard]] ndarray_view<const T, N>     transpose() const;
+
     [[nodiscard]] ndarray &                            operator=(const ndarray & B);
     [[nodiscard]] ndarray &                            operator=(ndarray && B) noexcept;
     ndarray(const ndarray & B);
     ndarray(ndarray && B) noexcept;
+
+    // takes the shape of the expression, reallocating if it differs
+    template <typename E>
+        requires is_expression_v<E>
+    ndarray & operator=(const E & expr);
+    // elementwise in place with an array, view, expression or scalar of matching shape
+    template <typename E> ndarray & operator+=(const E & operand);
+    template <typename E> ndarray & operator-=(const E & operand);
+    template <typename E> ndarray & operator*=(const E & operand);
+    template <typename E> ndarray & operator/=(const E & operand);
+
+  private:
+    void init_shape(const std::size_t (&shape)[N]);
+    void allocate_storage(bool value_initialize);
+    void release_storage() noexcept;
 };
 
-template <typename T, std::size_t N> template <typename... Idx> ndarray<T, N>::ndarray(Idx... idx) {
+template <typename T, std::size_t N, typename Alloc> template <typename... Idx>
+    requires(std::is_integral_v<Idx> && ...)
+ndarray<T, N, Alloc>::ndarray(Idx... idx) {
     static_assert(sizeof...(Idx) == N, "Number of indices must match grid dimension");
-    std::size_t indices[N] = { static_cast<std::size_t>(idx)... };
+    init_shape({ static_cast<std::size_t>(idx)... });
+    allocate_storage(true);
+}
+
+template <typename T, std::size_t N, typename Alloc> template <typename... Idx>
+    requires(std::is_integral_v<Idx> && ...)
+ndarray<T, N, Alloc>::ndarray(uninitialized_t, Idx... idx) {
+    static_assert(sizeof...(Idx) == N, "Number of indices must match grid dimension");
+    init_shape({ static_cast<std::size_t>(idx)... });
+    allocate_storage(false);
+}
+
+template <typename T, std::size_t N, typename Alloc> template <typename... Idx>
+    requires(std::is_integral_v<Idx> && ...)
+ndarray<T, N, Alloc>::ndarray(const Alloc & alloc, Idx... idx) : alloc(alloc) {
+    static_assert(sizeof...(Idx) == N, "Number of indices must match grid dimension");
+    init_shape({ static_cast<std::size_t>(idx)... });
+    allocate_storage(true);
+}
+
+template <typename T, std::size_t N, typename Alloc> template <typename... Idx>
+    requires(std::is_integral_v<Idx> && ...)
+ndarray<T, N, Alloc>::ndarray(uninitialized_t, const Alloc & alloc, Idx... idx) : alloc(alloc) {
+    static_assert(sizeof...(Idx) == N, "Number of indices must match grid dimension");
+    init_shape({ static_cast<std::size_t>(idx)... });
+    allocate_storage(false);
+}
+
+template <typename T, std::size_t N, typename Alloc>
+ndarray<T, N, Alloc>::ndarray(const std::size_t (&shape)[N], const Alloc & alloc) : alloc(alloc) {
+    init_shape(shape);
+    allocate_storage(true);
+}
+
+template <typename T, std::size_t N, typename Alloc>
+ndarray<T, N, Alloc>::ndarray(uninitialized_t, const std::size_t (&shape)[N], const Alloc & alloc) : alloc(alloc) {
+    init_shape(shape);
+    allocate_storage(false);
+}
+
+template <typename T, std::size_t N, typename Alloc> template <typename E>
+    requires is_expression_v<E>
+ndarray<T, N, Alloc>::ndarray(const E & expr, const Alloc & alloc) : alloc(alloc) {
+    static_assert(E::rank == N, "Expression rank does not match the array");
+    std::size_t shape[N];
     for (std::size_t i = 0; i < N; ++i) {
-        dims[i] = indices[i];
+        shape[i] = expr.shape()[i];
+    }
+    init_shape(shape);
+    allocate_storage(false);
+    assign(view(), expr);
+}
+
+template <typename T, std::size_t N, typename Alloc> ndarray<T, N, Alloc>::~ndarray() {
+    release_storage();
+}
+
+template <typename T, std::size_t N, typename Alloc>
+void ndarray<T, N, Alloc>::init_shape(const std::size_t (&shape)[N]) {
+    for (std::size_t i = 0; i < N; ++i) {
+        dims[i] = shape[i];
     }
 
     strides[N - 1] = 1;
     for (std::size_t i = N - 1; i > 0; --i) {
         strides[i - 1] = strides[i] * dims[i];
     }
+}
 
-    // allocate memory
-    data = new T[total_elements()]{};
+template <typename T, std::size_t N, typename Alloc>
+void ndarray<T, N, Alloc>::allocate_storage(bool value_initialize) {
+    data = alloc.allocate(total_elements());
+    // storage the policy already zeroed doubles as value-initialised trivial elements, skip the extra pass
+    if (value_initialize && !(Alloc::zeroed && std::is_trivial_v<T>)) {
+        std::uninitialized_value_construct_n(data, total_elements());
+    } else {
+        std::uninitialized_default_construct_n(data, total_elements());
+    }
 }
 
-template <typename T, std::size_t N> ndarray<T, N>::~ndarray() {
-    delete[] data;
+template <typename T, std::size_t N, typename Alloc> void ndarray<T, N, Alloc>::release_storage() noexcept {
+    if (data != nullptr) {
+        std::destroy_n(data, total_elements());
+        alloc.deallocate(data, total_elements());
+        data = nullptr;
+    }
 }
 
-template <typename T, std::size_t N> template <typename... Idx> [[nodiscard]] T & ndarray<T, N>::at(Idx... idx) {
+template <typename T, std::size_t N, typename Alloc> template <typename... Idx>
+T & ndarray<T, N, Alloc>::at(Idx... idx) {
     std::size_t indices[N] = { static_cast<std::size_t>(idx)... };
     for (std::size_t i = 0; i < N; ++i) {
         if (indices[i] >= dims[i]) {
@@ -70,7 +210,8 @@ template <typename T, std::size_t N> template <typename... Idx> [[nodiscard]] T
     return data[offset_of_index(idx...)];
 }
 
-template <typename T, std::size_t N> template <typename... Idx> const T & ndarray<T, N>::at(Idx... idx) const {
+template <typename T, std::size_t N, typename Alloc> template <typename... Idx>
+const T & ndarray<T, N, Alloc>::at(Idx... idx) const {
     std::size_t indices[N] = { static_cast<std::size_t>(idx)... };
     for (std::size_t i = 0; i < N; ++i) {
         if (indices[i] >= dims[i]) {
@@ -80,8 +221,8 @@ template <typename T, std::size_t N> template <typename... Idx> const T & ndarra
     return data[offset_of_index(idx...)];
 }
 
-template <typename T, std::size_t N> template <typename... Idx>
-std::size_t ndarray<T, N>::offset_of_index(const Idx &... idx) const {
+template <typename T, std::size_t N, typename Alloc> template <typename... Idx>
+std::size_t ndarray<T, N, Alloc>::offset_of_index(const Idx &... idx) const {
     static_assert(sizeof...(Idx) == N, "Number of indices must match grid dimension");
     std::size_t indices[N] = { static_cast<std::size_t>(idx)... };
     std::size_t offset     = 0;
@@ -91,7 +232,7 @@ std::size_t ndarray<T, N>::offset_of_index(const Idx &... idx) const {
     return offset;
 }
 
-template <typename T, std::size_t N> std::size_t ndarray<T, N>::total_elements() const {
+template <typename T, std::size_t N, typename Alloc> std::size_t ndarray<T, N, Alloc>::total_elements() const {
     std::size_t element_count = 1;
     for (std::size_t i = 0; i < N; ++i) {
         element_count *= dims[i];
@@ -99,38 +240,101 @@ template <typename T, std::size_t N> std::size_t ndarray<T, N>::total_elements()
     return element_count;
 }
 
-template <typename T, std::size_t N> T * ndarray<T, N>::begin() {
+template <typename T, std::size_t N, typename Alloc> T * ndarray<T, N, Alloc>::begin() {
     return data;
 }
 
-template <typename T, std::size_t N> const T * ndarray<T, N>::begin() const {
+template <typename T, std::size_t N, typename Alloc> const T * ndarray<T, N, Alloc>::begin() const {
     return data;
 }
 
-template <typename T, std::size_t N> T * ndarray<T, N>::end() {
+template <typename T, std::size_t N, typename Alloc> T * ndarray<T, N, Alloc>::end() {
     return data + total_elements();
 }
 
-template <typename T, std::size_t N> const T * ndarray<T, N>::end() const {
+template <typename T, std::size_t N, typename Alloc> const T * ndarray<T, N, Alloc>::end() const {
     return data + total_elements();
 }
 
-template <typename T, std::size_t N> void ndarray<T, N>::fill(T value) {
+template <typename T, std::size_t N, typename Alloc> void ndarray<T, N, Alloc>::fill(T value) {
     T * p = begin();
     for (std::size_t i = 0; i < total_elements(); ++i) {
         *(p++) = value;
     }
 }
 
-template <typename T, std::size_t N> template <typename... Idx> T & ndarray<T, N>::operator()(Idx... idx) {
+template <typename T, std::size_t N, typename Alloc> template <typename... Idx>
+T & ndarray<T, N, Alloc>::operator()(Idx... idx) {
     return data[offset_of_index(idx...)];
 }
 
-template <typename T, std::size_t N> template <typename... Idx> const T & ndarray<T, N>::operator()(Idx... idx) const {
+template <typename T, std::size_t N, typename Alloc> template <typename... Idx>
+const T & ndarray<T, N, Alloc>::operator()(Idx... idx) const {
     return data[offset_of_index(idx...)];
 }
 
-template <typename T, std::size_t N> ndarray<T, N> & ndarray<T, N>::operator=(const ndarray & B) {
+template <typename T, std::size_t N, typename Alloc> ndarray_view<T, N> ndarray<T, N, Alloc>::view() {
+    return ndarray_view<T, N>(data, dims, strides);
+}
+
+template <typename T, std::size_t N, typename Alloc> ndarray_view<const T, N> ndarray<T, N, Alloc>::view() const {
+    return ndarray_view<const T, N>(data, dims, strides);
+}
+
+template <typename T, std::size_t N, typename Alloc>
+ndarray_view<T, N> ndarray<T, N, Alloc>::slice(std::size_t axis, std::size_t begin, std::size_t end, std::size_t step) {
+    return view().slice(axis, begin, end, step);
+}
+
+template <typename T, std::size_t N, typename Alloc>
+ndarray_view<const T, N> ndarray<T, N, Alloc>::slice(std::size_t axis,
+                                                     std::size_t begin,
+                                                     std::size_t end,
+                                                     std::size_t step) const {
+    return view().slice(axis, begin, end, step);
+}
+
+template <typename T, std::size_t N, typename Alloc>
+ndarray_view<T, N> ndarray<T, N, Alloc>::subarray(const std::size_t (&begin)[N], const std::size_t (&extent)[N]) {
+    return view().subarray(begin, extent);
+}
+
+template <typename T, std::size_t N, typename Alloc>
+ndarray_view<const T, N> ndarray<T, N, Alloc>::subarray(const std::size_t (&begin)[N],
+                                                         const std::size_t (&extent)[N]) const {
+    return view().subarray(begin, extent);
+}
+
+template <typename T, std::size_t N, typename Alloc>
+ndarray_view<T, N - 1> ndarray<T, N, Alloc>::index(std::size_t axis, std::size_t i) {
+    return view().index(axis, i);
+}
+
+template <typename T, std::size_t N, typename Alloc>
+ndarray_view<const T, N - 1> ndarray<T, N, Alloc>::index(std::size_t axis, std::size_t i) const {
+    return view().index(axis, i);
+}
+
+template <typename T, std::size_t N, typename Alloc>
+ndarray_view<T, N> ndarray<T, N, Alloc>::permute(const std::size_t (&axes)[N]) {
+    return view().permute(axes);
+}
+
+template <typename T, std::size_t N, typename Alloc>
+ndarray_view<const T, N> ndarray<T, N, Alloc>::permute(const std::size_t (&axes)[N]) const {
+    return view().permute(axes);
+}
+
+template <typename T, std::size_t N, typename Alloc> ndarray_view<T, N> ndarray<T, N, Alloc>::transpose() {
+    return view().transpose();
+}
+
+template <typename T, std::size_t N, typename Alloc> ndarray_view<const T, N> ndarray<T, N, Alloc>::transpose() const {
+    return view().transpose();
+}
+
+template <typename T, std::size_t N, typename Alloc>
+ndarray<T, N, Alloc> & ndarray<T, N, Alloc>::operator=(const ndarray & B) {
     // self-assignment check
     if (this != &B) {
         bool same_dims = true;
@@ -142,12 +346,14 @@ template <typename T, std::size_t N> ndarray<T, N> & ndarray<T, N>::operator=(co
 
         // if dimensions are different, deallocate and reallocate
         if (!same_dims) {
-            delete[] data;
+            release_storage();
             for (std::size_t i = 0; i < N; ++i) {
                 dims[i]    = B.dims[i];
                 strides[i] = B.strides[i];
             }
-            data = new T[total_elements()];
+            data = alloc.allocate(total_elements());
+            std::uninitialized_copy_n(B.data, total_elements(), data);
+            return *this;
         }
 
         // copy the data
@@ -158,34 +364,36 @@ template <typename T, std::size_t N> ndarray<T, N> & ndarray<T, N>::operator=(co
     return *this;
 }
 
-template <typename T, std::size_t N> ndarray<T, N> & ndarray<T, N>::operator=(ndarray && B) noexcept {
+template <typename T, std::size_t N, typename Alloc>
+ndarray<T, N, Alloc> & ndarray<T, N, Alloc>::operator=(ndarray && B) noexcept {
     if (this != &B) {
-        delete[] data;
+        release_storage();
 
         for (std::size_t i = 0; i < N; ++i) {
             dims[i]    = B.dims[i];
             strides[i] = B.strides[i];
         }
 
-        // transfer ownership of data
+        // transfer ownership of data, together with the allocator that has to release it
+        alloc  = B.alloc;
         data   = B.data;
         B.data = nullptr;
     }
     return *this;
 }
 
-template <typename T, std::size_t N> ndarray<T, N>::ndarray(const ndarray & grid_b) {
+template <typename T, std::size_t N, typename Alloc>
+ndarray<T, N, Alloc>::ndarray(const ndarray & grid_b) : alloc(grid_b.alloc) {
     for (std::size_t i = 0; i < N; ++i) {
         dims[i]    = grid_b.dims[i];
         strides[i] = grid_b.strides[i];
     }
-    data = new T[total_elements()];
-    for (std::size_t i = 0; i < total_elements(); ++i) {
-        data[i] = grid_b.data[i];
-    }
+    data = alloc.allocate(total_elements());
+    std::uninitialized_copy_n(grid_b.data, total_elements(), data);
 }
 
-template <typename T, std::size_t N> ndarray<T, N>::ndarray(ndarray && grid_b) noexcept {
+template <typename T, std::size_t N, typename Alloc>
+ndarray<T, N, Alloc>::ndarray(ndarray && grid_b) noexcept : alloc(grid_b.alloc) {
     for (std::size_t i = 0; i < N; ++i) {
         dims[i]    = grid_b.dims[i];
         strides[i] = grid_b.strides[i];
@@ -194,4 +402,41 @@ template <typename T, std::size_t N> ndarray<T, N>::ndarray(ndarray && grid_b) n
     grid_b.data = nullptr;
 }
 
+template <typename T, std::size_t N, typename Alloc> template <typename E>
+    requires is_expression_v<E>
+ndarray<T, N, Alloc> & ndarray<T, N, Alloc>::operator=(const E & expr) {
+    for (std::size_t i = 0; i < N; ++i) {
+        if (dims[i] != expr.shape()[i]) {
+            // evaluate before releasing, the expression may still read from this array
+            return *this = ndarray(expr, alloc);
+        }
+    }
+    assign(view(), expr);
+    return *this;
+}
+
+template <typename T, std::size_t N, typename Alloc> template <typename E>
+ndarray<T, N, Alloc> & ndarray<T, N, Alloc>::operator+=(const E & operand) {
+    assign(view(), *this + operand);
+    return *this;
+}
+
+template <typename T, std::size_t N, typename Alloc> template <typename E>
+ndarray<T, N, Alloc> & ndarray<T, N, Alloc>::operator-=(const E & operand) {
+    assign(view(), *this - operand);
+    return *this;
+}
+
+template <typename T, std::size_t N, typename Alloc> template <typename E>
+ndarray<T, N, Alloc> & ndarray<T, N, Alloc>::operator*=(const E & operand) {
+    assign(view(), *this * operand);
+    return *this;
+}
+
+template <typename T, std::size_t N, typename Alloc> template <typename E>
+ndarray<T, N, Alloc> & ndarray<T, N, Alloc>::operator/=(const E & operand) {
+    assign(view(), *this / operand);
+    return *this;
+}
+
 };  // namespace velm_DR
@@ -0,0 +1,274 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <iterator>
+#include <type_traits>
+
+namespace velm_DR {
+
+/*
+ * Non-owning, arbitrarily strided window into ndarray storage.
+ *
+ * A view shares the dims/strides model of ndarray, but strides are not required to describe a dense row-major
+ * layout and `data` may point anywhere inside the parent buffer. Slicing, sub-boxing and axis permutation only
+ * rewrite dims/strides/data, so extracting a plane from a large grid never touches the elements themselves.
+ *
+ * Constness is shallow (like std::span): a const view still grants write access; use ndarray_view<const T, N>
+ * for read-only access.
+ */
+
+template <typename T, std::size_t N> class ndarray_view {
+    static_assert(N > 0, "ndarray_view requires at least one dimension");
+
+  public:
+    class iterator;
+
+    T * data = nullptr;
+
+    std::size_t dims[N]    = {};
+    std::size_t strides[N] = {};
+
+    ndarray_view() = default;
+    ndarray_view(T * data, const std::size_t (&dims)[N], const std::size_t (&strides)[N]);
+
+    // implicit conversion from a mutable view to a read-only one
+    template <typename U>
+        requires std::is_same_v<const U, T>
+    ndarray_view(const ndarray_view<U, N> & other);
+
+    template <typename... Idx> [[nodiscard]] T & at(Idx... idx) const;
+    template <typename... Idx> [[nodiscard]] T & operator()(Idx... idx) const;
+
+    template <typename... Idx> [[nodiscard]] std::size_t offset_of_index(const Idx &... idx) const;
+    [[nodiscard]] std::size_t                            total_elements() const;
+    [[nodiscard]] bool                                   is_contiguous() const;
+
+    void                   fill(const T & value) const;
+    [[nodiscard]] iterator begin() const;
+    [[nodiscard]] iterator end() const;
+
+    // same-rank sub-range [begin, end) along one axis, taking every step-th element
+    [[nodiscard]] ndarray_view slice(std::size_t axis, std::size_t begin, std::size_t end, std::size_t step = 1) const;
+    // same-rank box starting at `begin` with the given extent along every axis
+    [[nodiscard]] ndarray_view subarray(const std::size_t (&begin)[N], const std::size_t (&extent)[N]) const;
+    // rank-reducing: fixes `axis` at position `i`
+    [[nodiscard]] ndarray_view<T, N - 1> index(std::size_t axis, std::size_t i) const;
+    // axis k of the result is axis `axes[k]` of this view
+    [[nodiscard]] ndarray_view permute(const std::size_t (&axes)[N]) const;
+    // reverses the axis order
+    [[nodiscard]] ndarray_view transpose() const;
+};
+
+/*
+ * Forward iterator visiting the elements of a view in logical row-major order, independent of the underlying
+ * strides. The iterator carries its own copy of the shape, so it stays valid after the view it came from is gone.
+ */
+template <typename T, std::size_t N> class ndarray_view<T, N>::iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = std::remove_cv_t<T>;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = T *;
+    using reference         = T &;
+
+    iterator() = default;
+
+    iterator(const ndarray_view & view, std::size_t position) : ptr(view.data), position(position) {
+        for (std::size_t i = 0; i < N; ++i) {
+            dims[i]    = view.dims[i];
+            strides[i] = view.strides[i];
+            index[i]   = 0;
+        }
+    }
+
+    [[nodiscard]] reference operator*() const { return *ptr; }
+
+    [[nodiscard]] pointer operator->() const { return ptr; }
+
+    iterator & operator++() {
+        ++position;
+        for (std::size_t i = N; i > 0; --i) {
+            ptr += strides[i - 1];
+            if (++index[i - 1] < dims[i - 1]) {
+                return *this;
+            }
+            // carry into the next slower axis
+            ptr -= strides[i - 1] * dims[i - 1];
+            index[i - 1] = 0;
+        }
+        return *this;
+    }
+
+    iterator operator++(int) {
+        iterator tmp = *this;
+        ++(*this);
+        return tmp;
+    }
+
+    [[nodiscard]] bool operator==(const iterator & other) const { return position == other.position; }
+
+  private:
+    T *         ptr        = nullptr;
+    std::size_t position   = 0;
+    std::size_t dims[N]    = {};
+    std::size_t strides[N] = {};
+    std::size_t index[N]   = {};
+};
+
+template <typename T, std::size_t N>
+ndarray_view<T, N>::ndarray_view(T * data, const std::size_t (&dims)[N], const std::size_t (&strides)[N]) :
+    data(data) {
+    for (std::size_t i = 0; i < N; ++i) {
+        this->dims[i]    = dims[i];
+        this->strides[i] = strides[i];
+    }
+}
+
+template <typename T, std::size_t N> template <typename U>
+    requires std::is_same_v<const U, T>
+ndarray_view<T, N>::ndarray_view(const ndarray_view<U, N> & other) : data(other.data) {
+    for (std::size_t i = 0; i < N; ++i) {
+        dims[i]    = other.dims[i];
+        strides[i] = other.strides[i];
+    }
+}
+
+template <typename T, std::size_t N> template <typename... Idx> T & ndarray_view<T, N>::at(Idx... idx) const {
+    std::size_t indices[N] = { static_cast<std::size_t>(idx)... };
+    for (std::size_t i = 0; i < N; ++i) {
+        if (indices[i] >= dims[i]) {
+            abort();
+        }
+    }
+    return data[offset_of_index(idx...)];
+}
+
+template <typename T, std::size_t N> template <typename... Idx> T & ndarray_view<T, N>::operator()(Idx... idx) const {
+    return data[offset_of_index(idx...)];
+}
+
+template <typename T, std::size_t N> template <typename... Idx>
+std::size_t ndarray_view<T, N>::offset_of_index(const Idx &... idx) const {
+    static_assert(sizeof...(Idx) == N, "Number of indices must match grid dimension");
+    std::size_t indices[N] = { static_cast<std::size_t>(idx)... };
+    std::size_t offset     = 0;
+    for (std::size_t i = 0; i < N; ++i) {
+        offset += indices[i] * strides[i];
+    }
+    return offset;
+}
+
+template <typename T, std::size_t N> std::size_t ndarray_view<T, N>::total_elements() const {
+    std::size_t element_count = 1;
+    for (std::size_t i = 0; i < N; ++i) {
+        element_count *= dims[i];
+    }
+    return element_count;
+}
+
+template <typename T, std::size_t N> bool ndarray_view<T, N>::is_contiguous() const {
+    std::size_t expected = 1;
+    for (std::size_t i = N; i > 0; --i) {
+        // a unit-length axis never moves the pointer, so its stride is irrelevant
+        if (dims[i - 1] != 1 && strides[i - 1] != expected) {
+            return false;
+        }
+        expected *= dims[i - 1];
+    }
+    return true;
+}
+
+template <typename T, std::size_t N> void ndarray_view<T, N>::fill(const T & value) const {
+    if (is_contiguous()) {
+        T * p = data;
+        for (std::size_t i = 0; i < total_elements(); ++i) {
+            *(p++) = value;
+        }
+        return;
+    }
+    for (T & element : *this) {
+        element = value;
+    }
+}
+
+template <typename T, std::size_t N> typename ndarray_view<T, N>::iterator ndarray_view<T, N>::begin() const {
+    return iterator(*this, 0);
+}
+
+template <typename T, std::size_t N> typename ndarray_view<T, N>::iterator ndarray_view<T, N>::end() const {
+    return iterator(*this, total_elements());
+}
+
+template <typename T, std::size_t N>
+ndarray_view<T, N> ndarray_view<T, N>::slice(std::size_t axis,
+                                             std::size_t begin,
+                                             std::size_t end,
+                                             std::size_t step) const {
+    if (axis >= N || begin > end || end > dims[axis] || step == 0) {
+        abort();
+    }
+    ndarray_view result = *this;
+    result.data += begin * strides[axis];
+    result.dims[axis]    = (end - begin + step - 1) / step;
+    result.strides[axis] = strides[axis] * step;
+    return result;
+}
+
+template <typename T, std::size_t N>
+ndarray_view<T, N> ndarray_view<T, N>::subarray(const std::size_t (&begin)[N], const std::size_t (&extent)[N]) const {
+    ndarray_view result = *this;
+    for (std::size_t i = 0; i < N; ++i) {
+        if (begin[i] + extent[i] > dims[i]) {
+            abort();
+        }
+        result.data += begin[i] * strides[i];
+        result.dims[i] = extent[i];
+    }
+    return result;
+}
+
+template <typename T, std::size_t N>
+ndarray_view<T, N - 1> ndarray_view<T, N>::index(std::size_t axis, std::size_t i) const {
+    static_assert(N > 1, "Cannot reduce the rank of a one-dimensional view");
+    if (axis >= N || i >= dims[axis]) {
+        abort();
+    }
+    ndarray_view<T, N - 1> result;
+    result.data = data + i * strides[axis];
+    for (std::size_t src = 0, dst = 0; src < N; ++src) {
+        if (src == axis) {
+            continue;
+        }
+        result.dims[dst]    = dims[src];
+        result.strides[dst] = strides[src];
+        ++dst;
+    }
+    return result;
+}
+
+template <typename T, std::size_t N>
+ndarray_view<T, N> ndarray_view<T, N>::permute(const std::size_t (&axes)[N]) const {
+    bool         seen[N] = {};
+    ndarray_view result  = *this;
+    for (std::size_t i = 0; i < N; ++i) {
+        if (axes[i] >= N || seen[axes[i]]) {
+            abort();
+        }
+        seen[axes[i]]     = true;
+        result.dims[i]    = dims[axes[i]];
+        result.strides[i] = strides[axes[i]];
+    }
+    return result;
+}
+
+template <typename T, std::size_t N> ndarray_view<T, N> ndarray_view<T, N>::transpose() const {
+    ndarray_view result = *this;
+    for (std::size_t i = 0; i < N; ++i) {
+        result.dims[i]    = dims[N - 1 - i];
+        result.strides[i] = strides[N - 1 - i];
+    }
+    return result;
+}
+
+};  // namespace velm_DR
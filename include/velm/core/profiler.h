@@ -0,0 +1,170 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace velm_DR {
+
+// one finished zone, timestamps in nanoseconds since the profiler was created
+struct trace_event {
+    const char *  name     = nullptr;  // string literals, never copied
+    const char *  category = nullptr;
+    std::uint64_t start    = 0;
+    std::uint64_t end      = 0;
+    std::uint32_t thread   = 0;
+};
+
+// timings of every zone sharing one name since the last clear(), in milliseconds
+struct stage_stats {
+    const char * name     = nullptr;
+    const char * category = nullptr;
+    std::size_t  calls    = 0;
+    double       total    = 0.0;
+    double       last     = 0.0;
+    double       mean     = 0.0;
+    double       max      = 0.0;
+};
+
+// resident set of the process, in bytes; zero where the platform does not report it
+struct memory_usage {
+    std::size_t resident      = 0;
+    std::size_t peak_resident = 0;
+};
+
+[[nodiscard]] memory_usage process_memory();
+
+/*
+ * Collects timing zones from every thread for the Chrome trace viewer (chrome://tracing, Perfetto) and for
+ * per-stage summaries.
+ *
+ * Each thread records into its own fixed-size ring, written only by that thread and drained by collect(), so
+ * recording takes no lock and never allocates after the thread's first zone. Rings are created by the first zone a
+ * thread records, not by name_thread(), and the first collect() after the thread exits drains and frees its ring,
+ * so short-lived threads cost nothing once they are gone. Zones that find their ring full are dropped and counted
+ * rather than blocking the hot path. Recording is off until enable(true); a disabled zone
+ * costs one relaxed atomic load. Building with VELM_ENABLE_PROFILING off removes the VELM_PROFILE_ZONE macros
+ * entirely.
+ */
+class profiler {
+  public:
+    static constexpr std::size_t ring_capacity    = 1 << 14;  // zones per thread between two collect() calls
+    static constexpr std::size_t history_capacity = 1 << 20;  // collected zones kept for export, oldest go first
+
+    profiler();
+    ~profiler();
+
+    profiler(const profiler &)             = delete;
+    profiler & operator=(const profiler &) = delete;
+
+    void               enable(bool on) { active.store(on, std::memory_order_relaxed); }
+    [[nodiscard]] bool enabled() const { return active.load(std::memory_order_relaxed); }
+
+    // nanoseconds since this profiler was created
+    [[nodiscard]] std::uint64_t now() const;
+
+    // appends a finished zone to the calling thread's ring; name and category must outlive the profiler
+    void record(const char * name, const char * category, std::uint64_t start, std::uint64_t end);
+    // label for the calling thread in exported traces; kept per thread and attached to its ring once it records
+    void name_thread(const std::string & name);
+
+    // moves the zones of every ring into the history and the stage statistics
+    void collect();
+    // drops the history, the statistics and the dropped count
+    void clear();
+
+    // collects first; ordered by name
+    [[nodiscard]] std::vector<stage_stats> stages();
+    [[nodiscard]] std::vector<trace_event> events();
+    [[nodiscard]] std::size_t              dropped() const;
+    // rings currently held, one per thread that recorded and has not exited or not been collected since
+    [[nodiscard]] std::size_t live_rings() const;
+
+    // collects first, then writes the history as Chrome trace-event JSON; throws std::runtime_error on I/O errors
+    void write_chrome_trace(const std::string & path);
+    // collects first, then logs one line per stage
+    void log_summary();
+
+    // process-wide profiler the zone macros record into
+    [[nodiscard]] static profiler & global();
+
+  private:
+    struct thread_ring {
+        std::array<trace_event, ring_capacity> events;
+        std::atomic<std::size_t>               head{ 0 };  // written by the owning thread only
+        std::atomic<std::size_t>               tail{ 0 };  // written by collect() only
+        std::atomic<std::size_t>               dropped{ 0 };
+        std::atomic<bool>                      retired{ false };  // set when the owning thread exits
+        std::uint32_t                          thread = 0;
+        std::string                            name;  // guarded by rings_mutex
+    };
+
+    thread_ring * find_ring_of_this_thread() const;
+    thread_ring & ring_of_this_thread();
+
+    std::atomic<bool> active{ false };
+    std::uint64_t     id;
+    std::int64_t      epoch;
+
+    mutable std::mutex                        rings_mutex;
+    std::vector<std::shared_ptr<thread_ring>> rings;
+    std::uint32_t                             next_thread = 1;
+    // what is left of freed rings: names for the zones still in the history, and their dropped counts
+    std::map<std::uint32_t, std::string> retired_names;
+    std::size_t                          retired_dropped = 0;
+
+    // zones named by equal literals from different translation units may not share an address, so stages are
+    // keyed by the text
+    std::mutex                              collect_mutex;
+    std::deque<trace_event>                 history;
+    std::map<std::string_view, stage_stats> totals;
+};
+
+// records the enclosing scope as one zone of profiler::global(), if it is enabled when the scope is entered
+class profile_zone {
+  public:
+    profile_zone(const char * name, const char * category) : name(name), category(category) {
+        profiler & p = profiler::global();
+        if (p.enabled()) {
+            start = p.now();
+            armed = true;
+        }
+    }
+
+    ~profile_zone() {
+        if (armed) {
+            profiler & p = profiler::global();
+            p.record(name, category, start, p.now());
+        }
+    }
+
+    profile_zone(const profile_zone &)             = delete;
+    profile_zone & operator=(const profile_zone &) = delete;
+
+  private:
+    const char *  name;
+    const char *  category;
+    std::uint64_t start = 0;
+    bool          armed = false;
+};
+
+};  // namespace velm_DR
+
+#define VELM_PROFILE_CONCAT_INNER(a, b) a##b
+#define VELM_PROFILE_CONCAT(a, b)       VELM_PROFILE_CONCAT_INNER(a, b)
+
+// VELM_PROFILE_ZONE("hdf5.read", "io") times the rest of the enclosing scope
+#ifdef VELM_ENABLE_PROFILING
+#    define VELM_PROFILE_ZONE(name, category) \
+        ::velm_DR::profile_zone VELM_PROFILE_CONCAT(velm_profile_zone_, __LINE__)(name, category)
+#else
+#    define VELM_PROFILE_ZONE(name, category) static_cast<void>(0)
+#endif
@@ -0,0 +1,312 @@
+#pragma once
+
+#include "velm/core/allocator.h"
+#include "velm/core/fixed_ndarray.h"
+#include "velm/core/ndarray.h"
+#include "velm/core/ndarray_view.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+
+namespace velm_DR {
+
+/*
+ * N-dimensional grid with a small fixed-shape tensor E (a fixed_ndarray) at every voxel, stored either as an array
+ * of structures or as a structure of arrays.
+ *
+ * With tensor_layout::aos the tensors lie one after another, so a voxel's components share a cache line; this suits
+ * kernels that read whole tensors at scattered voxels. With tensor_layout::soa every component has a plane of its
+ * own, so one component over consecutive voxels is contiguous and loops over component planes vectorise.
+ *
+ * Both layouts are addressed the same way: field(i, j, k) is the tensor at a voxel, field(i, j, k)(a, b) one of its
+ * components, and a tensor can be read from or assigned to it as a whole. For aos it is a plain E &; for soa it is
+ * an soa_ref, which gathers and scatters the components across the planes. component(a, b) views one component over
+ * the whole grid, contiguous for soa and strided by E::size for aos. The converting constructor switches layouts.
+ *
+ * The scalars are an ndarray with the components flattened into one extra axis, last for aos and first for soa, so
+ * storage, copies and moves are the ndarray's; at() aborts on indices outside the grid.
+ */
+
+enum class tensor_layout {
+    aos,  // component c of voxel v at v * E::size + c
+    soa,  // component c of voxel v at c * voxels + v
+};
+
+/*
+ * A voxel of an soa tensor_array. Assignment writes through to the array, also from another soa_ref, so it copies
+ * values like a reference would rather than rebinding. T is const for read-only access.
+ */
+template <typename E, typename T> class soa_ref {
+  public:
+    soa_ref(T * first, std::size_t plane) : first(first), plane(plane) {}
+    soa_ref(const soa_ref &) = default;
+
+    template <typename... Idx> [[nodiscard]] T & operator()(Idx... idx) const {
+        return first[E::offset_of_index(idx...) * plane];
+    }
+
+    [[nodiscard]] E load() const {
+        E value;
+        for (std::size_t c = 0; c < E::size; ++c) {
+            value.data[c] = first[c * plane];
+        }
+        return value;
+    }
+
+    operator E() const { return load(); }
+
+    const soa_ref & operator=(const E & value) const
+        requires(!std::is_const_v<T>)
+    {
+        for (std::size_t c = 0; c < E::size; ++c) {
+            first[c * plane] = value.data[c];
+        }
+        return *this;
+    }
+
+    const soa_ref & operator=(const soa_ref & other) const
+        requires(!std::is_const_v<T>)
+    {
+        return *this = other.load();
+    }
+
+  private:
+    T *         first;
+    std::size_t plane;
+};
+
+template <typename E, std::size_t N, tensor_layout Layout = tensor_layout::aos,
+          typename Alloc = aligned_allocator<typename E::value_type>>
+class tensor_array {
+    static_assert(is_fixed_ndarray_v<E>, "tensor_array elements must be fixed_ndarrays");
+    static_assert(std::is_trivially_copyable_v<E> && sizeof(E) == E::size * sizeof(typename E::value_type),
+                  "tensor_array elements must be dense and trivially copyable");
+
+  public:
+    using value_type   = E;
+    using scalar_type  = typename E::value_type;
+    using storage_type = ndarray<scalar_type, N + 1, Alloc>;
+    using reference    = std::conditional_t<Layout == tensor_layout::aos, E &, soa_ref<E, scalar_type>>;
+    using const_reference =
+        std::conditional_t<Layout == tensor_layout::aos, const E &, soa_ref<E, const scalar_type>>;
+
+    static constexpr tensor_layout layout     = Layout;
+    static constexpr std::size_t   components = E::size;
+
+    // dims..., components for aos; components, dims... for soa
+    storage_type scalars;
+
+    std::size_t dims[N];
+    std::size_t strides[N];  // in voxels
+
+    template <typename... Idx>
+        requires(sizeof...(Idx) == N && (std::is_integral_v<Idx> && ...))
+    tensor_array(Idx... idx);
+    // leaves the components uninitialised, for arrays that are about to be overwritten
+    template <typename... Idx>
+        requires(sizeof...(Idx) == N && (std::is_integral_v<Idx> && ...))
+    tensor_array(uninitialized_t, Idx... idx);
+    explicit tensor_array(const std::size_t (&shape)[N], const Alloc & alloc = Alloc());
+    tensor_array(uninitialized_t, const std::size_t (&shape)[N], const Alloc & alloc = Alloc());
+    // copies `other` into this layout
+    template <tensor_layout Other, typename OtherAlloc>
+    explicit tensor_array(const tensor_array<E, N, Other, OtherAlloc> & other, const Alloc & alloc = Alloc());
+
+    template <typename... Idx> [[nodiscard]] reference       operator()(Idx... idx);
+    template <typename... Idx> [[nodiscard]] const_reference operator()(Idx... idx) const;
+    template <typename... Idx> [[nodiscard]] reference       at(Idx... idx);
+    template <typename... Idx> [[nodiscard]] const_reference at(Idx... idx) const;
+
+    // tensor at the voxel with row-major number v
+    [[nodiscard]] reference       voxel(std::size_t v);
+    [[nodiscard]] const_reference voxel(std::size_t v) const;
+
+    template <typename... Idx> [[nodiscard]] std::size_t offset_of_index(const Idx &... idx) const;
+    [[nodiscard]] std::size_t                            voxel_count() const;
+    // scalars in storage, voxel_count() * components
+    [[nodiscard]] std::size_t total_elements() const;
+
+    void fill(const E & value);
+
+    // one component over the grid, e.g. component(0, 1) for the xy entries of a mat3 field
+    template <typename... Idx> [[nodiscard]] ndarray_view<scalar_type, N>       component(Idx... idx);
+    template <typename... Idx> [[nodiscard]] ndarray_view<const scalar_type, N> component(Idx... idx) const;
+
+  private:
+    struct storage_shape_t {
+        std::size_t values[N + 1];
+    };
+
+    static constexpr std::size_t component_axis = Layout == tensor_layout::aos ? N : 0;
+
+    [[nodiscard]] static storage_shape_t storage_shape(const std::size_t (&shape)[N]);
+    void                                 init_shape(const std::size_t (&shape)[N]);
+    template <typename... Idx> void      check_bounds(const Idx &... idx) const;
+};
+
+template <typename E, std::size_t N, tensor_layout Layout, typename Alloc> template <typename... Idx>
+    requires(sizeof...(Idx) == N && (std::is_integral_v<Idx> && ...))
+tensor_array<E, N, Layout, Alloc>::tensor_array(Idx... idx) : tensor_array({ static_cast<std::size_t>(idx)... }) {}
+
+template <typename E, std::size_t N, tensor_layout Layout, typename Alloc> template <typename... Idx>
+    requires(sizeof...(Idx) == N && (std::is_integral_v<Idx> && ...))
+tensor_array<E, N, Layout, Alloc>::tensor_array(uninitialized_t, Idx... idx) :
+    tensor_array(uninitialized, { static_cast<std::size_t>(idx)... }) {}
+
+template <typename E, std::size_t N, tensor_layout Layout, typename Alloc>
+tensor_array<E, N, Layout, Alloc>::tensor_array(const std::size_t (&shape)[N], const Alloc & alloc) :
+    scalars(storage_shape(shape).values, alloc) {
+    init_shape(shape);
+}
+
+template <typename E, std::size_t N, tensor_layout Layout, typename Alloc>
+tensor_array<E, N, Layout, Alloc>::tensor_array(uninitialized_t, const std::size_t (&shape)[N], const Alloc & alloc) :
+    scalars(uninitialized, storage_shape(shape).values, alloc) {
+    init_shape(shape);
+}
+
+template <typename E, std::size_t N, tensor_layout Layout, typename Alloc>
+template <tensor_layout Other, typename OtherAlloc>
+tensor_array<E, N, Layout, Alloc>::tensor_array(const tensor_array<E, N, Other, OtherAlloc> & other,
+                                                const Alloc &                                 alloc) :
+    tensor_array(uninitialized, other.dims, alloc) {
+    const std::size_t   voxels = voxel_count();
+    const scalar_type * source = other.scalars.data;
+    scalar_type *       target = scalars.data;
+    if constexpr (Layout == Other) {
+        std::copy_n(source, total_elements(), target);
+    } else if constexpr (Layout == tensor_layout::soa) {
+        // component-major writes, so each plane is filled front to back
+        for (std::size_t c = 0; c < components; ++c) {
+            scalar_type * plane = target + c * voxels;
+            for (std::size_t v = 0; v < voxels; ++v) {
+                plane[v] = source[v * components + c];
+            }
+        }
+    } else {
+        for (std::size_t c = 0; c < components; ++c) {
+            const scalar_type * plane = source + c * voxels;
+            for (std::size_t v = 0; v < voxels; ++v) {
+                target[v * components + c] = plane[v];
+            }
+        }
+    }
+}
+
+template <typename E, std::size_t N, tensor_layout Layout, typename Alloc> template <typename... Idx>
+typename tensor_array<E, N, Layout, Alloc>::reference tensor_array<E, N, Layout, Alloc>::operator()(Idx... idx) {
+    return voxel(offset_of_index(idx...));
+}
+
+template <typename E, std::size_t N, tensor_layout Layout, typename Alloc> template <typename... Idx>
+typename tensor_array<E, N, Layout, Alloc>::const_reference
+tensor_array<E, N, Layout, Alloc>::operator()(Idx... idx) const {
+    return voxel(offset_of_index(idx...));
+}
+
+template <typename E, std::size_t N, tensor_layout Layout, typename Alloc> template <typename... Idx>
+typename tensor_array<E, N, Layout, Alloc>::reference tensor_array<E, N, Layout, Alloc>::at(Idx... idx) {
+    check_bounds(idx...);
+    return voxel(offset_of_index(idx...));
+}
+
+template <typename E, std::size_t N, tensor_layout Layout, typename Alloc> template <typename... Idx>
+typename tensor_array<E, N, Layout, Alloc>::const_reference tensor_array<E, N, Layout, Alloc>::at(Idx... idx) const {
+    check_bounds(idx...);
+    return voxel(offset_of_index(idx...));
+}
+
+template <typename E, std::size_t N, tensor_layout Layout, typename Alloc>
+typename tensor_array<E, N, Layout, Alloc>::reference tensor_array<E, N, Layout, Alloc>::voxel(std::size_t v) {
+    if constexpr (Layout == tensor_layout::aos) {
+        // the scalar buffer implicitly holds the E objects, E being an implicit-lifetime aggregate of scalars
+        return *std::launder(reinterpret_cast<E *>(scalars.data + v * components));
+    } else {
+        return reference(scalars.data + v, voxel_count());
+    }
+}
+
+template <typename E, std::size_t N, tensor_layout Layout, typename Alloc>
+typename tensor_array<E, N, Layout, Alloc>::const_reference
+tensor_array<E, N, Layout, Alloc>::voxel(std::size_t v) const {
+    if constexpr (Layout == tensor_layout::aos) {
+        return *std::launder(reinterpret_cast<const E *>(scalars.data + v * components));
+    } else {
+        return const_reference(scalars.data + v, voxel_count());
+    }
+}
+
+template <typename E, std::size_t N, tensor_layout Layout, typename Alloc> template <typename... Idx>
+std::size_t tensor_array<E, N, Layout, Alloc>::offset_of_index(const Idx &... idx) const {
+    static_assert(sizeof...(Idx) == N, "Number of indices must match grid dimension");
+    const std::size_t indices[N] = { static_cast<std::size_t>(idx)... };
+    std::size_t       offset     = 0;
+    for (std::size_t i = 0; i < N; ++i) {
+        offset += indices[i] * strides[i];
+    }
+    return offset;
+}
+
+template <typename E, std::size_t N, tensor_layout Layout, typename Alloc>
+std::size_t tensor_array<E, N, Layout, Alloc>::voxel_count() const {
+    return total_elements() / components;
+}
+
+template <typename E, std::size_t N, tensor_layout Layout, typename Alloc>
+std::size_t tensor_array<E, N, Layout, Alloc>::total_elements() const {
+    return scalars.total_elements();
+}
+
+template <typename E, std::size_t N, tensor_layout Layout, typename Alloc>
+void tensor_array<E, N, Layout, Alloc>::fill(const E & value) {
+    for (std::size_t c = 0; c < components; ++c) {
+        scalars.index(component_axis, c).fill(value.data[c]);
+    }
+}
+
+template <typename E, std::size_t N, tensor_layout Layout, typename Alloc> template <typename... Idx>
+ndarray_view<typename E::value_type, N> tensor_array<E, N, Layout, Alloc>::component(Idx... idx) {
+    return scalars.index(component_axis, E::offset_of_index(idx...));
+}
+
+template <typename E, std::size_t N, tensor_layout Layout, typename Alloc> template <typename... Idx>
+ndarray_view<const typename E::value_type, N> tensor_array<E, N, Layout, Alloc>::component(Idx... idx) const {
+    return scalars.index(component_axis, E::offset_of_index(idx...));
+}
+
+template <typename E, std::size_t N, tensor_layout Layout, typename Alloc>
+typename tensor_array<E, N, Layout, Alloc>::storage_shape_t
+tensor_array<E, N, Layout, Alloc>::storage_shape(const std::size_t (&shape)[N]) {
+    storage_shape_t storage;
+    storage.values[component_axis] = components;
+    for (std::size_t i = 0; i < N; ++i) {
+        storage.values[Layout == tensor_layout::aos ? i : i + 1] = shape[i];
+    }
+    return storage;
+}
+
+template <typename E, std::size_t N, tensor_layout Layout, typename Alloc>
+void tensor_array<E, N, Layout, Alloc>::init_shape(const std::size_t (&shape)[N]) {
+    for (std::size_t i = 0; i < N; ++i) {
+        dims[i] = shape[i];
+    }
+    strides[N - 1] = 1;
+    for (std::size_t i = N - 1; i > 0; --i) {
+        strides[i - 1] = strides[i] * dims[i];
+    }
+}
+
+template <typename E, std::size_t N, tensor_layout Layout, typename Alloc> template <typename... Idx>
+void tensor_array<E, N, Layout, Alloc>::check_bounds(const Idx &... idx) const {
+    const std::size_t indices[N] = { static_cast<std::size_t>(idx)... };
+    for (std::size_t i = 0; i < N; ++i) {
+        if (indices[i] >= dims[i]) {
+            abort();
+        }
+    }
+}
+
+};  // namespace velm_DR
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace velm_DR {
+
+/*
+ * Fixed-size pool of worker threads shared by the I/O pipeline and the processing kernels.
+ *
+ * parallel_for lets the calling thread take part in the work and only waits for the blocks themselves, not for
+ * helper tasks to be scheduled, so it is safe to call from inside a task running on the same pool.
+ */
+class thread_pool {
+  public:
+    explicit thread_pool(std::size_t threads = std::max(1u, std::thread::hardware_concurrency()));
+    ~thread_pool();
+
+    thread_pool(const thread_pool &)             = delete;
+    thread_pool & operator=(const thread_pool &) = delete;
+
+    [[nodiscard]] std::size_t size() const { return workers.size(); }
+
+    template <typename F> [[nodiscard]] std::future<std::invoke_result_t<F>> submit(F && task);
+
+    // calls body(begin, end) on disjoint blocks of at most `grain` indices covering [0, count)
+    template <typename F> void parallel_for(std::size_t count, std::size_t grain, F && body);
+
+    // process-wide pool sized to the machine
+    [[nodiscard]] static thread_pool & global();
+
+  private:
+    void enqueue(std::function<void()> task);
+    void worker_loop();
+
+    std::vector<std::thread>          workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex                        mutex;
+    std::condition_variable           wake;
+    bool                              stopping = false;
+};
+
+template <typename F> std::future<std::invoke_result_t<F>> thread_pool::submit(F && task) {
+    using R = std::invoke_result_t<F>;
+
+    auto           packed = std::make_shared<std::packaged_task<R()>>(std::forward<F>(task));
+    std::future<R> result = packed->get_future();
+    enqueue([packed] { (*packed)(); });
+    return result;
+}
+
+template <typename F> void thread_pool::parallel_for(std::size_t count, std::size_t grain, F && body) {
+    if (count == 0) {
+        return;
+    }
+    grain               = std::max<std::size_t>(grain, 1);
+    std::size_t blocks  = (count + grain - 1) / grain;
+    std::size_t helpers = std::min(blocks, size() + 1) - 1;
+
+    // shared with helper tasks, which may start after this call has already returned
+    struct shared_state {
+        std::atomic<std::size_t> next_block{ 0 };
+        std::atomic<std::size_t> done_blocks{ 0 };
+        std::mutex               mutex;
+        std::condition_variable  finished;
+        std::exception_ptr       error;
+    };
+
+    auto state = std::make_shared<shared_state>();
+    auto run   = [state, count, grain, blocks, &body] {
+        std::size_t block;
+        while ((block = state->next_block.fetch_add(1)) < blocks) {
+            try {
+                std::size_t begin = block * grain;
+                body(begin, std::min(begin + grain, count));
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (!state->error) {
+                    state->error = std::current_exception();
+                }
+            }
+            if (state->done_blocks.fetch_add(1) + 1 == blocks) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->finished.notify_all();
+            }
+        }
+    };
+
+    for (std::size_t i = 0; i < helpers; ++i) {
+        enqueue(run);
+    }
+    run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&] { return state->done_blocks.load() == blocks; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+};  // namespace velm_DR
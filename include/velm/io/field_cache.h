@@ -0,0 +1,87 @@
+#pragma once
+
+#include "velm/core/ndarray.h"
+#include "velm/core/ndarray_view.h"
+#include "velm/core/thread_pool.h"
+#include "velm/io/field_codec.h"
+#include "velm/io/hd5.h"
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace vlem {
+
+struct cache_options {
+    std::size_t            budget_bytes = std::size_t(1) << 30;  // compressed bytes held, brick indices included
+    field_codec            codec        = field_codec::lossless;
+    double                 error_bound  = 0.0;                    // absolute, for field_codec::bounded
+    velm_DR::thread_pool * pool         = nullptr;                // nullptr: thread_pool::global()
+};
+
+// running totals since construction, except entries and the bytes held, which describe the cache right now
+struct cache_counters {
+    std::size_t hits           = 0;
+    std::size_t misses         = 0;
+    std::size_t evictions      = 0;
+    std::size_t uncacheable    = 0;  // misses larger than the whole budget, read but not kept
+    std::size_t entries        = 0;
+    std::size_t bytes_held     = 0;
+    std::size_t raw_bytes_held = 0;  // what the entries would take decoded
+    double      read_seconds   = 0.0;
+    double      encode_seconds = 0.0;
+    double      decode_seconds = 0.0;
+};
+
+/*
+ * Cache of float 3D datasets of an hdf5_file, held compressed so that many more timesteps fit in memory than as
+ * raw arrays, and evicted least recently used first once the budget is exceeded.
+ *
+ * A hit decodes the entry in parallel on the pool; a miss reads the dataset, hands the values read to the caller
+ * and keeps a compressed copy. With field_codec::bounded a hit therefore differs from the miss before it by at most
+ * the error bound. Lookups and bookkeeping are serialized on one mutex, reading and both codec directions are not,
+ * so several threads can scrub through the same cache.
+ */
+class field_cache {
+  public:
+    explicit field_cache(hdf5_file & file, cache_options options = {});
+
+    field_cache(const field_cache &)             = delete;
+    field_cache & operator=(const field_cache &) = delete;
+
+    [[nodiscard]] velm_DR::ndarray<float, 3> get(const std::string & dataset);
+    // into `out`, which must have the dataset's shape and may be strided
+    void get(const std::string & dataset, velm_DR::ndarray_view<float, 3> out);
+
+    [[nodiscard]] bool contains(const std::string & dataset) const;
+    // evicts right away if the held bytes exceed the new budget
+    void               set_budget(std::size_t budget_bytes);
+    void               clear();
+
+    [[nodiscard]] cache_counters counters() const;
+
+  private:
+    using entry_list = std::list<std::pair<std::string, std::shared_ptr<const compressed_field>>>;
+
+    std::shared_ptr<const compressed_field> find(const std::string & dataset);
+    void                                    decode(const compressed_field & entry, velm_DR::ndarray_view<float, 3> out);
+    void                                    load(const std::string & dataset, velm_DR::ndarray_view<float, 3> out);
+    void                                    insert(const std::string &                     dataset,
+                                                   std::shared_ptr<const compressed_field> entry,
+                                                   double                                  read_seconds,
+                                                   double                                  encode_seconds);
+    void                                    evict();
+
+    hdf5_file &   file;
+    cache_options options;
+
+    mutable std::mutex                                    mutex;
+    entry_list                                            recent;  // most recently used first
+    std::unordered_map<std::string, entry_list::iterator> index;
+    cache_counters                                        totals;
+};
+
+};  // namespace vlem
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "velm/core/ndarray.h"
+#include "velm/core/ndarray_view.h"
+#include "velm/core/thread_pool.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace vlem {
+
+enum class field_codec {
+    lossless,  // bit-exact, NaNs included
+    bounded,   // every value within error_bound of the original; NaN and infinity kept exactly
+};
+
+/*
+ * A float field held compressed in memory, in independent 16³ bricks so both directions run in parallel.
+ *
+ * Bricks are predicted, byte-shuffled so the slowly varying high bytes of neighbouring values line up, and
+ * deflated. The lossless codec stores the difference of each value's bit pattern to its predecessor. The bounded
+ * codec quantises the residual of a 3D Lorenzo predictor (the corner completing the parallelepiped of the seven
+ * decoded neighbours) in steps of twice the error bound; values the step cannot reach within the bound are stored
+ * verbatim. Smooth fields typically shrink 2-3× losslessly and well beyond that with a bound of ~1e-3 of their
+ * range. Bricks that do not shrink are stored raw.
+ *
+ * Errors, e.g. a non-positive bound or a destination of the wrong shape, are reported as std::runtime_error.
+ */
+class compressed_field {
+  public:
+    static constexpr std::size_t brick_edge = 16;
+
+    compressed_field() = default;
+    compressed_field(velm_DR::ndarray_view<const float, 3> field,
+                     field_codec                           codec,
+                     double                                error_bound = 0.0,
+                     velm_DR::thread_pool *                pool        = nullptr);
+
+    // decodes into `out`, which must have the field's shape and may be strided
+    void decode(velm_DR::ndarray_view<float, 3> out, velm_DR::thread_pool * pool = nullptr) const;
+    [[nodiscard]] velm_DR::ndarray<float, 3> decode(velm_DR::thread_pool * pool = nullptr) const;
+
+    [[nodiscard]] const std::size_t * dims() const { return shape; }
+    [[nodiscard]] field_codec         codec() const { return kind; }
+    [[nodiscard]] double              error_bound() const { return bound; }
+    [[nodiscard]] std::size_t         raw_bytes() const { return shape[0] * shape[1] * shape[2] * sizeof(float); }
+    // memory held, brick index included
+    [[nodiscard]] std::size_t         compressed_bytes() const;
+
+  private:
+    std::size_t              shape[3]  = {};
+    std::size_t              bricks[3] = {};
+    field_codec              kind      = field_codec::lossless;
+    double                   bound     = 0.0;
+    std::vector<std::byte>   payload;
+    std::vector<std::size_t> offsets;  // brick b is payload[offsets[b], offsets[b + 1])
+};
+
+};  // namespace vlem
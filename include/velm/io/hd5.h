@@ -1,15 +1,281 @@
+#pragma once
+
+#include "velm/core/dtype.h"
 #include "velm/core/ndarray.h"
 
+#include <array>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace vlem {
 
+// one stage of a dataset's HDF5 filter pipeline, with the filter id and client data as stored in the file
+struct filter_info {
+    int                   id = 0;
+    std::vector<unsigned> parameters;
+};
+
+// shape and on-disk layout of a dataset, enough to plan reads without touching the data
+struct dataset_info {
+    static constexpr std::uint64_t no_offset = ~std::uint64_t(0);
+
+    velm_DR::dtype           type = velm_DR::dtype::float32;
+    std::vector<std::size_t> dims;
+    std::vector<std::size_t> chunk_dims;               // empty for contiguous datasets
+    std::vector<filter_info> filters;                  // in the order they are applied on write
+    bool                     filtered    = false;      // gzip, szip, shuffle, ...
+    bool                     native      = false;      // file type is bit-identical to the in-memory type
+    std::uint64_t            file_offset = no_offset;  // byte offset of contiguous, unfiltered, allocated data
+    std::array<std::byte, 8> fill_value  = {};         // one element of `type` as unwritten storage reads back
+
+    [[nodiscard]] bool is_chunked() const { return !chunk_dims.empty(); }
+
+    // the payload is a plain array in the file and can be served straight from a mapping
+    [[nodiscard]] bool is_direct() const { return native && !filtered && file_offset != no_offset; }
+};
+
+/*
+ * HDF5 file holding field datasets.
+ *
+ * Reads into dense destinations land directly in the caller's storage, and contiguous, uncompressed,
+ * native-typed datasets bypass the HDF5 pipeline and are copied (or, via map_field, viewed) straight from a
+ * memory mapping of the file. Errors are reported as std::runtime_error.
+ *
+ * The HDF5 library is not thread-safe by default, so every HDF5 call made through any hdf5_file is serialized on
+ * one library-wide lock. Copies out of the mapping and the caller's own decompression run outside of it.
+ */
 class hdf5_file {
-    hdf5_file();
+  public:
+    enum class access {
+        read,
+        truncate,
+    };
+
+    explicit hdf5_file(const std::string & path, access mode = access::read);
     ~hdf5_file();
 
-    template <typename T, std::size_t N, typename... Idx> velm_DR::ndarray<T, N> extract_field(const char *... fields);
-    template <typename T, std::size_t N, typename... Idx> velm_DR::ndarray<T, N> extract_field(const char *);
+    hdf5_file(const hdf5_file &)             = delete;
+    hdf5_file & operator=(const hdf5_file &) = delete;
+    hdf5_file(hdf5_file && other) noexcept;
+    hdf5_file & operator=(hdf5_file && other) noexcept;
+
+    [[nodiscard]] const std::string & path() const;
+    [[nodiscard]] bool                has_dataset(const char * field) const;
+    [[nodiscard]] dataset_info        info(const char * field) const;
+
+    // whole dataset, materialised
+    template <typename T, std::size_t N> [[nodiscard]] velm_DR::ndarray<T, N> extract_field(const char * field);
+    template <typename T, std::size_t N, typename... Fields>
+        requires(sizeof...(Fields) > 0)
+    [[nodiscard]] std::array<velm_DR::ndarray<T, N>, sizeof...(Fields) + 1> extract_field(const char * field,
+                                                                                           Fields... fields);
+
+    // box starting at `begin` with the extent of `out`; only the chunks touching the box are read
+    template <typename T, std::size_t N>
+    void read_region(const char * field, const std::size_t (&begin)[N], velm_DR::ndarray_view<T, N> out);
+
+    // zero-copy view of a dataset for which info().is_direct() holds, valid while this file is open
+    template <typename T, std::size_t N> [[nodiscard]] velm_DR::ndarray_view<const T, N> map_field(const char * field);
+
+    // raw, still-filtered bytes of the chunk starting at `chunk_origin`; bytes is left empty for chunks that were
+    // never written. Returns the chunk's filter mask: bit i set means filters[i] was skipped for this chunk.
+    std::uint32_t read_chunk(const char * field, const std::size_t * chunk_origin, std::vector<std::byte> & bytes);
+
+    // chunk_dims == nullptr writes a contiguous dataset; gzip_level > 0 requires chunking
+    template <typename T, std::size_t N>
+    void write_field(const char *                      field,
+                     velm_DR::ndarray_view<const T, N> values,
+                     const std::size_t *               chunk_dims = nullptr,
+                     int                               gzip_level = 0);
+    template <typename T, std::size_t N, typename Alloc>
+    void write_field(const char *                          field,
+                     const velm_DR::ndarray<T, N, Alloc> & values,
+                     const std::size_t *                   chunk_dims = nullptr,
+                     int                                   gzip_level = 0);
+
+  private:
+    void check_shape(const char * field, velm_DR::dtype type, std::size_t rank, std::size_t * dims) const;
+    void read_raw(const char *        field,
+                  velm_DR::dtype      type,
+                  std::size_t         rank,
+                  const std::size_t * begin,
+                  const std::size_t * count,
+                  void *              dst);
+    const void * map_raw(const char * field);
+    void         write_raw(const char *        field,
+                           velm_DR::dtype      type,
+                           std::size_t         rank,
+                           const std::size_t * dims,
+                           const std::size_t * chunk_dims,
+                           int                 gzip_level,
+                           const void *        src);
+
+    struct impl;
+    std::unique_ptr<impl> state;
 };
 
+/*
+ * Streams a dataset chunk by chunk into a caller-provided buffer.
+ *
+ * The traversal follows the dataset's HDF5 chunk layout (or slabs along the slowest axis for contiguous
+ * datasets), so every read maps onto whole chunks and the same buffer is reused for the entire dataset. Each
+ * chunk is stored densely at the start of the buffer and exposed through `chunk_view`, whose dims are the chunk's
+ * extent (smaller than chunk_shape() at the upper edges of the dataset).
+ */
+template <typename T, std::size_t N> class chunk_stream {
+  public:
+    chunk_stream(hdf5_file & file, const char * field);
+
+    // buffer shape every next() call expects
+    [[nodiscard]] const std::size_t (&chunk_shape() const)[N] { return chunk; }
+
+    [[nodiscard]] std::size_t chunk_count() const;
+
+    // reads the next chunk into `buffer`; returns false once the dataset is exhausted
+    bool next(velm_DR::ndarray<T, N> & buffer, std::size_t (&origin)[N], velm_DR::ndarray_view<T, N> & chunk_view);
+
+    void rewind() { position = 0; }
+
+  private:
+    hdf5_file * file;
+    std::string field;
+    std::size_t dims[N];
+    std::size_t chunk[N];
+    std::size_t grid[N];
+    std::size_t position = 0;
+};
+
+template <typename T, std::size_t N> velm_DR::ndarray<T, N> hdf5_file::extract_field(const char * field) {
+    std::size_t dims[N];
+    check_shape(field, velm_DR::dtype_of<T>(), N, dims);
+    std::size_t begin[N] = {};
+
+    velm_DR::ndarray<T, N> result(velm_DR::uninitialized, dims);
+    read_raw(field, velm_DR::dtype_of<T>(), N, begin, dims, result.data);
+    return result;
+}
+
+template <typename T, std::size_t N, typename... Fields>
+    requires(sizeof...(Fields) > 0)
+std::array<velm_DR::ndarray<T, N>, sizeof...(Fields) + 1> hdf5_file::extract_field(const char * field,
+                                                                                    Fields... fields) {
+    return { extract_field<T, N>(field), extract_field<T, N>(static_cast<const char *>(fields))... };
+}
+
+template <typename T, std::size_t N>
+void hdf5_file::read_region(const char * field, const std::size_t (&begin)[N], velm_DR::ndarray_view<T, N> out) {
+    if (out.is_contiguous()) {
+        read_raw(field, velm_DR::dtype_of<T>(), N, begin, out.dims, out.data);
+        return;
+    }
+    // HDF5 memory spaces cannot express permuted strides, so gather through a dense temporary
+    std::vector<T> staging(out.total_elements());
+    read_raw(field, velm_DR::dtype_of<T>(), N, begin, out.dims, staging.data());
+    std::size_t i = 0;
+    for (T & element : out) {
+        element = staging[i++];
+    }
+}
+
+template <typename T, std::size_t N> velm_DR::ndarray_view<const T, N> hdf5_file::map_field(const char * field) {
+    std::size_t dims[N];
+    check_shape(field, velm_DR::dtype_of<T>(), N, dims);
+    std::size_t strides[N];
+    strides[N - 1] = 1;
+    for (std::size_t i = N - 1; i > 0; --i) {
+        strides[i - 1] = strides[i] * dims[i];
+    }
+    return velm_DR::ndarray_view<const T, N>(static_cast<const T *>(map_raw(field)), dims, strides);
+}
+
+template <typename T, std::size_t N>
+void hdf5_file::write_field(const char *                      field,
+                            velm_DR::ndarray_view<const T, N> values,
+                            const std::size_t *               chunk_dims,
+                            int                               gzip_level) {
+    if (!values.is_contiguous()) {
+        std::vector<T> staging(values.begin(), values.end());
+        write_raw(field, velm_DR::dtype_of<T>(), N, values.dims, chunk_dims, gzip_level, staging.data());
+        return;
+    }
+    write_raw(field, velm_DR::dtype_of<T>(), N, values.dims, chunk_dims, gzip_level, values.data);
+}
+
+template <typename T, std::size_t N, typename Alloc>
+void hdf5_file::write_field(const char *                          field,
+                            const velm_DR::ndarray<T, N, Alloc> & values,
+                            const std::size_t *                   chunk_dims,
+                            int                                   gzip_level) {
+    write_field<T, N>(field, values.view(), chunk_dims, gzip_level);
+}
+
+template <typename T, std::size_t N> chunk_stream<T, N>::chunk_stream(hdf5_file & file, const char * field) :
+    file(&file),
+    field(field) {
+    dataset_info info = file.info(field);
+    if (info.dims.size() != N || info.type != velm_DR::dtype_of<T>()) {
+        throw std::runtime_error(std::string("chunk_stream: rank or type mismatch for ") + field);
+    }
+    for (std::size_t i = 0; i < N; ++i) {
+        dims[i]  = info.dims[i];
+        chunk[i] = info.is_chunked() ? info.chunk_dims[i] : dims[i];
+    }
+    if (!info.is_chunked()) {
+        // contiguous data: slabs of whole rows along the slowest axis, roughly 16 MiB each
+        constexpr std::size_t target_bytes = std::size_t(16) << 20;
+        std::size_t           slab_bytes   = sizeof(T);
+        for (std::size_t i = 1; i < N; ++i) {
+            slab_bytes *= dims[i];
+        }
+        std::size_t rows = slab_bytes == 0 ? 1 : target_bytes / slab_bytes;
+        chunk[0]         = rows == 0 ? 1 : (rows < dims[0] ? rows : dims[0]);
+    }
+    for (std::size_t i = 0; i < N; ++i) {
+        grid[i] = chunk[i] == 0 ? 0 : (dims[i] + chunk[i] - 1) / chunk[i];
+    }
+}
+
+template <typename T, std::size_t N> std::size_t chunk_stream<T, N>::chunk_count() const {
+    std::size_t count = 1;
+    for (std::size_t i = 0; i < N; ++i) {
+        count *= grid[i];
+    }
+    return count;
+}
+
+template <typename T, std::size_t N>
+bool chunk_stream<T, N>::next(velm_DR::ndarray<T, N> &      buffer,
+                              std::size_t (&origin)[N],
+                              velm_DR::ndarray_view<T, N> & chunk_view) {
+    if (position >= chunk_count()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < N; ++i) {
+        if (buffer.dims[i] != chunk[i]) {
+            throw std::runtime_error("chunk_stream: buffer does not match the chunk shape");
+        }
+    }
+    // chunk grid coordinates in row-major order, matching the order chunks are usually laid out on disk
+    std::size_t linear = position++;
+    std::size_t extent[N];
+    for (std::size_t i = N; i > 0; --i) {
+        std::size_t c = linear % grid[i - 1];
+        linear /= grid[i - 1];
+        origin[i - 1] = c * chunk[i - 1];
+        extent[i - 1] = origin[i - 1] + chunk[i - 1] <= dims[i - 1] ? chunk[i - 1] : dims[i - 1] - origin[i - 1];
+    }
+    std::size_t strides[N];
+    strides[N - 1] = 1;
+    for (std::size_t i = N - 1; i > 0; --i) {
+        strides[i - 1] = strides[i] * extent[i];
+    }
+    chunk_view = velm_DR::ndarray_view<T, N>(buffer.data, extent, strides);
+    file->read_region<T, N>(field.c_str(), origin, chunk_view);
+    return true;
+}
+
 };  // namespace vlem
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace vlem {
+
+/*
+ * Read-only memory mapping of a whole file.
+ *
+ * Pages are faulted in by the OS on first access, so wrapping a region of the mapping in an ndarray_view gives
+ * zero-copy access to on-disk payloads. Throws std::runtime_error if the file cannot be opened or mapped.
+ */
+class mapped_file {
+  public:
+    mapped_file() = default;
+    explicit mapped_file(const std::string & path);
+    ~mapped_file();
+
+    mapped_file(const mapped_file &)             = delete;
+    mapped_file & operator=(const mapped_file &) = delete;
+    mapped_file(mapped_file && other) noexcept;
+    mapped_file & operator=(mapped_file && other) noexcept;
+
+    [[nodiscard]] const std::byte * data() const { return base; }
+
+    [[nodiscard]] std::size_t size() const { return length; }
+
+    [[nodiscard]] bool is_open() const { return base != nullptr; }
+
+    // hints that [offset, offset + bytes) is about to be read sequentially
+    void prefetch(std::size_t offset, std::size_t bytes) const;
+
+  private:
+    void unmap() noexcept;
+
+    const std::byte * base   = nullptr;
+    std::size_t       length = 0;
+#if defined(_WIN32)
+    void * file_handle    = nullptr;
+    void * mapping_handle = nullptr;
+#endif
+};
+
+};  // namespace vlem
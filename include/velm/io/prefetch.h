@@ -0,0 +1,104 @@
+#pragma once
+
+#include "velm/core/ndarray.h"
+#include "velm/core/thread_pool.h"
+#include "velm/io/hd5.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vlem {
+
+// all requested fields of one timestep, in the order the prefetcher was given them
+struct timestep_frame {
+    std::size_t                             step = 0;
+    std::vector<velm_DR::ndarray<float, 3>> fields;
+};
+
+/*
+ * Background pipeline that reads the next timesteps of several fields while the current one is in use.
+ *
+ * A reader thread walks the timesteps in order and issues the HDF5 calls, which are serialized by hdf5_file. For
+ * chunked datasets it only fetches the raw chunk bytes; decompression and scattering into the frame run on a
+ * worker pool, as do copies out of the mapping for contiguous datasets. At most `depth` frames are in flight
+ * (decoding, waiting to be consumed, or dropped by seek() but still decoding), which bounds memory and gives
+ * backpressure when consumption is slower than the disk.
+ */
+class field_prefetcher {
+  public:
+    // dataset holding `field` at `step`, e.g. "/step_0042/Ex"
+    using dataset_path = std::function<std::string(std::size_t step, const std::string & field)>;
+
+    struct options {
+        std::size_t depth          = 3;
+        std::size_t decode_threads = 0;  // 0: one per hardware thread
+    };
+
+    field_prefetcher(hdf5_file &              file,
+                     std::vector<std::string> fields,
+                     std::size_t              first_step,
+                     std::size_t              end_step,
+                     dataset_path             path);
+    field_prefetcher(hdf5_file &              file,
+                     std::vector<std::string> fields,
+                     std::size_t              first_step,
+                     std::size_t              end_step,
+                     dataset_path             path,
+                     options                  opts);
+    ~field_prefetcher();
+
+    field_prefetcher(const field_prefetcher &)             = delete;
+    field_prefetcher & operator=(const field_prefetcher &) = delete;
+
+    // blocks until the next timestep is decoded; empty once end_step is reached. Rethrows read errors.
+    [[nodiscard]] std::optional<timestep_frame> next();
+
+    // drops everything in flight and continues from `step`, for scrubbing
+    void seek(std::size_t step);
+
+    // frames holding memory right now, never more than the depth
+    [[nodiscard]] std::size_t frames_in_flight() const;
+
+  private:
+    struct pending;
+
+    void reader_loop();
+    void load(const std::shared_ptr<pending> & frame);
+    void load_chunked(const std::shared_ptr<pending> & frame,
+                      const std::string &               dataset,
+                      const dataset_info &              info,
+                      velm_DR::ndarray<float, 3> &      target);
+    void dispatch(const std::shared_ptr<pending> & frame, std::function<void()> task);
+    void complete(const std::shared_ptr<pending> & frame);
+    // requires the mutex
+    [[nodiscard]] std::size_t frames_held() const;
+
+    hdf5_file &              file;
+    std::vector<std::string> fields;
+    std::size_t              end_step;
+    dataset_path             path;
+    options                  opts;
+
+    mutable std::mutex                   mutex;
+    std::condition_variable              changed;
+    std::deque<std::shared_ptr<pending>> in_flight;
+    std::size_t                          discarded_in_flight = 0;  // dropped by seek(), still decoding
+    std::size_t                          cursor;
+    std::atomic<std::size_t>             generation{ 0 };
+    bool                                 stopping = false;
+
+    std::thread reader;
+    // declared last so it is destroyed first, finishing queued tasks while the state above is still alive
+    std::unique_ptr<velm_DR::thread_pool> workers;
+};
+
+};  // namespace vlem
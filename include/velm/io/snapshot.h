@@ -0,0 +1,194 @@
+#pragma once
+
+#include "velm/core/bricked_array.h"
+#include "velm/core/dtype.h"
+#include "velm/core/ndarray.h"
+#include "velm/core/ndarray_view.h"
+#include "velm/io/hd5.h"
+#include "velm/io/mapped_file.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace vlem {
+
+/*
+ * Velm-native snapshot files: arrays stored exactly as they sit in memory, for sessions that reopen data they
+ * have already converted.
+ *
+ * A file is a 4 KiB header, the payloads, each starting on a 4 KiB boundary, and a field table at the end. The
+ * table records every field's name, dtype, dims, strides (in elements), layout and byte range. Opening maps the
+ * file and reads the table; a field is then wrapped as an ndarray_view straight over the mapping, without copying
+ * or decoding, and its pages are faulted in on first touch. Values are stored in host byte order.
+ *
+ * Bricked fields hold a bricked_array's storage verbatim, padded bricks in storage order. They can be viewed as an
+ * array of bricks (brick_view) or loaded back into a bricked_array with a single copy.
+ *
+ * Errors, e.g. a malformed file or a field requested with the wrong type, rank or layout, are reported as
+ * std::runtime_error.
+ */
+
+enum class snapshot_layout : std::uint8_t { linear, bricked };
+
+struct snapshot_field {
+    std::string              name;
+    velm_DR::dtype           type = velm_DR::dtype::float32;
+    std::vector<std::size_t> dims;
+    std::vector<std::size_t> strides;  // in elements; for bricked fields, of the (slot, i, j, k) brick array
+    snapshot_layout          layout     = snapshot_layout::linear;
+    std::size_t              brick_edge = 0;
+    velm_DR::brick_order     order      = velm_DR::brick_order::linear;
+    std::uint64_t            offset     = 0;  // byte offset in the file, a multiple of snapshot_alignment
+    std::uint64_t            bytes      = 0;
+};
+
+inline constexpr std::size_t snapshot_alignment = 4096;
+inline constexpr std::size_t snapshot_max_rank  = 8;
+
+class snapshot_writer {
+  public:
+    explicit snapshot_writer(const std::string & path);
+    // removes the file if finish() was not called, so an interrupted write never looks like a complete snapshot
+    ~snapshot_writer();
+
+    snapshot_writer(const snapshot_writer &)             = delete;
+    snapshot_writer & operator=(const snapshot_writer &) = delete;
+
+    // strided views are packed into row-major order
+    template <typename T, std::size_t N> void add(const std::string & name, velm_DR::ndarray_view<const T, N> values);
+    template <typename T, std::size_t N, typename Alloc>
+    void add(const std::string & name, const velm_DR::ndarray<T, N, Alloc> & values);
+    template <typename T, std::size_t Brick, typename Alloc>
+    void add(const std::string & name, const velm_DR::bricked_array<T, Brick, Alloc> & values);
+
+    // a linear field streamed in row-major pieces, for fields that do not fit in memory at once
+    void begin_field(const std::string & name, velm_DR::dtype type, const std::vector<std::size_t> & dims);
+    void append(const void * bytes, std::size_t size);
+    void end_field();
+
+    // writes the field table and the header; the file is complete afterwards
+    void finish();
+
+  private:
+    void open_field(snapshot_field field);
+
+    std::string                 file_path;
+    std::ofstream               out;
+    std::vector<snapshot_field> table;
+    std::uint64_t               end        = snapshot_alignment;  // bytes written so far
+    bool                        field_open = false;
+    bool                        finished   = false;
+};
+
+class snapshot_file {
+  public:
+    explicit snapshot_file(const std::string & path);
+
+    [[nodiscard]] const std::string &                 path() const { return file_path; }
+    [[nodiscard]] const std::vector<snapshot_field> & fields() const { return table; }
+    [[nodiscard]] bool                                has_field(const std::string & name) const;
+    [[nodiscard]] const snapshot_field &              field(const std::string & name) const;
+
+    // zero-copy view of a linear field, valid while this file is open
+    template <typename T, std::size_t N>
+    [[nodiscard]] velm_DR::ndarray_view<const T, N> view(const std::string & name) const;
+    // zero-copy view of a bricked field as (slot, i, j, k): dims[0] bricks of brick_edge³ in storage order
+    template <typename T> [[nodiscard]] velm_DR::ndarray_view<const T, 4> brick_view(const std::string & name) const;
+    template <typename T, std::size_t Brick>
+    [[nodiscard]] velm_DR::bricked_array<T, Brick> load_bricked(const std::string & name) const;
+
+    // hints that a field is about to be read, so its pages are read ahead
+    void prefetch(const std::string & name) const;
+
+  private:
+    const snapshot_field & checked(const std::string & name, velm_DR::dtype type, std::size_t rank,
+                                   snapshot_layout layout) const;
+
+    std::string                 file_path;
+    mapped_file                 mapping;
+    std::vector<snapshot_field> table;
+};
+
+// copies datasets of an HDF5 file into a new snapshot as linear fields of the same names, streaming them in slabs
+void convert_to_snapshot(hdf5_file & file, const std::vector<std::string> & datasets, const std::string & path);
+
+template <typename T, std::size_t N>
+void snapshot_writer::add(const std::string & name, velm_DR::ndarray_view<const T, N> values) {
+    begin_field(name, velm_DR::dtype_of<T>(), std::vector<std::size_t>(values.dims, values.dims + N));
+    if (values.is_contiguous()) {
+        append(values.data, values.total_elements() * sizeof(T));
+    } else {
+        std::vector<T> staging(values.begin(), values.end());
+        append(staging.data(), staging.size() * sizeof(T));
+    }
+    end_field();
+}
+
+template <typename T, std::size_t N, typename Alloc>
+void snapshot_writer::add(const std::string & name, const velm_DR::ndarray<T, N, Alloc> & values) {
+    add<T, N>(name, values.view());
+}
+
+template <typename T, std::size_t Brick, typename Alloc>
+void snapshot_writer::add(const std::string & name, const velm_DR::bricked_array<T, Brick, Alloc> & values) {
+    snapshot_field field;
+    field.name       = name;
+    field.type       = velm_DR::dtype_of<T>();
+    field.dims       = { values.dims[0], values.dims[1], values.dims[2] };
+    field.strides    = { Brick * Brick * Brick, Brick * Brick, Brick, 1 };
+    field.layout     = snapshot_layout::bricked;
+    field.brick_edge = Brick;
+    field.order      = values.order;
+    open_field(std::move(field));
+    append(values.data, values.storage_elements() * sizeof(T));
+    end_field();
+}
+
+template <typename T, std::size_t N>
+velm_DR::ndarray_view<const T, N> snapshot_file::view(const std::string & name) const {
+    const snapshot_field & field = checked(name, velm_DR::dtype_of<T>(), N, snapshot_layout::linear);
+    std::size_t            dims[N], strides[N];
+    for (std::size_t i = 0; i < N; ++i) {
+        dims[i]    = field.dims[i];
+        strides[i] = field.strides[i];
+    }
+    return velm_DR::ndarray_view<const T, N>(reinterpret_cast<const T *>(mapping.data() + field.offset), dims,
+                                             strides);
+}
+
+template <typename T> velm_DR::ndarray_view<const T, 4> snapshot_file::brick_view(const std::string & name) const {
+    const snapshot_field & field      = checked(name, velm_DR::dtype_of<T>(), 3, snapshot_layout::bricked);
+    std::size_t            edge       = field.brick_edge;
+    std::size_t            dims[4]    = { field.bytes / (edge * edge * edge * sizeof(T)), edge, edge, edge };
+    std::size_t            strides[4] = { edge * edge * edge, edge * edge, edge, 1 };
+    return velm_DR::ndarray_view<const T, 4>(reinterpret_cast<const T *>(mapping.data() + field.offset), dims,
+                                             strides);
+}
+
+template <typename T, std::size_t Brick>
+velm_DR::bricked_array<T, Brick> snapshot_file::load_bricked(const std::string & name) const {
+    const snapshot_field & field = checked(name, velm_DR::dtype_of<T>(), 3, snapshot_layout::bricked);
+    if (field.brick_edge != Brick) {
+        throw std::runtime_error("snapshot_file: " + name + " has bricks of edge " + std::to_string(field.brick_edge));
+    }
+    // the dims come from the file: size the storage they imply against the payload before allocating any of it
+    std::size_t storage = Brick * Brick * Brick * sizeof(T);
+    for (std::size_t a = 0; a < 3; ++a) {
+        storage *= (field.dims[a] + Brick - 1) / Brick;
+    }
+    if (storage != field.bytes) {
+        throw std::runtime_error("snapshot_file: " + name + " does not hold a whole bricked array");
+    }
+    // the same shape and order give the same storage layout, so the payload is copied as is
+    velm_DR::bricked_array<T, Brick> out(velm_DR::uninitialized, field.dims[0], field.dims[1], field.dims[2],
+                                         field.order);
+    std::memcpy(out.data, mapping.data() + field.offset, field.bytes);
+    return out;
+}
+
+};  // namespace vlem
@@ -0,0 +1,587 @@
+#pragma once
+
+#include "velm/core/ndarray.h"
+#include "velm/core/ndarray_view.h"
+#include "velm/core/thread_pool.h"
+#include "velm/io/hd5.h"
+#include "velm/io/snapshot.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstddef>
+#include <exception>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vlem {
+
+/*
+ * Out-of-core 3D fields: arrays larger than memory, kept in a backing store and paged in tile by tile.
+ *
+ * A tile_store is the backing storage, read and written one box at a time: an HDF5 dataset, a linear field of a
+ * mapped snapshot, or a raw row-major file for results. tiled_field cuts the grid into tiles and keeps the
+ * recently used ones in memory under a byte budget. A tile is used through a tile_lock, which pins it; unpinned
+ * tiles are evicted least recently used first, and modified ones are written back to the store on eviction and on
+ * flush(). Tiles are loaded on the thread that first asks for them, so tiles requested from several threads are
+ * read concurrently (HDF5 calls themselves are still serialized by hdf5_file).
+ *
+ * The budget is exceeded only while more tiles are pinned at once than it holds. Kernels over whole fields live in
+ * velm/processing/out_of_core.h. Store errors are reported as std::runtime_error.
+ *
+ * With glibc, buffers of tile size sit below the dynamic mmap threshold once a few have been freed, and the
+ * per-thread heaps they then come from are rarely given back, so the process can hold several times the budget.
+ * Setting M_MMAP_THRESHOLD (or MALLOC_MMAP_THRESHOLD_) below the tile size keeps it close to the budget.
+ */
+
+// box of elements; begin + extent must lie within the store
+template <typename T> class tile_store {
+  public:
+    explicit tile_store(const std::size_t * dims) : shape{ dims[0], dims[1], dims[2] } {}
+    virtual ~tile_store() = default;
+
+    tile_store(const tile_store &)             = delete;
+    tile_store & operator=(const tile_store &) = delete;
+
+    [[nodiscard]] const std::size_t * dims() const { return shape; }
+
+    // fills `out` with the box of its extent starting at `begin`; called from several threads at once
+    virtual void read(const std::size_t (&begin)[3], velm_DR::ndarray_view<T, 3> out) = 0;
+    // stores `values` at `begin`; boxes written concurrently never overlap
+    virtual void write(const std::size_t (&begin)[3], velm_DR::ndarray_view<const T, 3> values);
+
+    [[nodiscard]] virtual bool writable() const { return false; }
+
+  protected:
+    void check_box(const std::size_t (&begin)[3], const std::size_t * extent) const;
+
+  private:
+    std::size_t shape[3];
+};
+
+// read-only dataset of an HDF5 file; tiles matching the chunk shape read each chunk once
+template <typename T> class hdf5_tile_store final : public tile_store<T> {
+  public:
+    hdf5_tile_store(hdf5_file & file, std::string dataset);
+
+    void read(const std::size_t (&begin)[3], velm_DR::ndarray_view<T, 3> out) override;
+
+  private:
+    hdf5_file * file;
+    std::string dataset;
+};
+
+// read-only linear field of a snapshot, copied out of the mapping; the file must outlive the store
+template <typename T> class snapshot_tile_store final : public tile_store<T> {
+  public:
+    snapshot_tile_store(const snapshot_file & file, const std::string & name);
+
+    void read(const std::size_t (&begin)[3], velm_DR::ndarray_view<T, 3> out) override;
+
+  private:
+    velm_DR::ndarray_view<const T, 3> field;
+};
+
+enum class raw_open {
+    create,      // new file of the given shape, truncating an existing one; reads as zero until written
+    read,        // existing file, which must hold exactly the given shape
+    read_write,  // as read, and writable
+};
+
+// byte-level positional I/O on one file, safe to use from several threads at once
+class raw_file {
+  public:
+    raw_file(const std::string & path, raw_open mode, std::size_t bytes);
+    ~raw_file();
+
+    raw_file(const raw_file &)             = delete;
+    raw_file & operator=(const raw_file &) = delete;
+
+    void read_at(std::size_t offset, void * dst, std::size_t bytes) const;
+    void write_at(std::size_t offset, const void * src, std::size_t bytes);
+
+  private:
+    std::string path;
+#if defined(_WIN32)
+    mutable std::mutex mutex;
+    std::FILE *        file = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+// row-major array of T in host byte order without any header, e.g. scratch space for the results of kernels
+template <typename T> class raw_tile_store final : public tile_store<T> {
+  public:
+    raw_tile_store(const std::string & path, const std::size_t (&dims)[3], raw_open mode = raw_open::create);
+
+    void read(const std::size_t (&begin)[3], velm_DR::ndarray_view<T, 3> out) override;
+    void write(const std::size_t (&begin)[3], velm_DR::ndarray_view<const T, 3> values) override;
+
+    [[nodiscard]] bool writable() const override { return mode != raw_open::read; }
+
+  private:
+    raw_file file;
+    raw_open mode;
+};
+
+enum class tile_access {
+    read,
+    write,      // read, then modified in place
+    overwrite,  // every element is about to be replaced, so the store is not read
+};
+
+struct tiled_options {
+    std::size_t            tile[3]        = { 64, 64, 64 };
+    std::size_t            resident_bytes = std::size_t(256) << 20;
+    velm_DR::thread_pool * pool           = nullptr;  // runs the kernels of out_of_core.h, nullptr: global()
+};
+
+struct tile_counters {
+    std::size_t loads          = 0;  // tiles brought in, from the store or blank for overwrite
+    std::size_t evictions      = 0;
+    std::size_t writebacks     = 0;
+    std::size_t resident_bytes = 0;
+    std::size_t peak_bytes     = 0;  // most bytes resident at once
+};
+
+template <typename T> class tiled_field {
+    struct entry;
+
+  public:
+    // keeps one tile pinned in memory while alive
+    class tile_lock {
+      public:
+        tile_lock(tile_lock && other) noexcept :
+            owner(std::exchange(other.owner, nullptr)),
+            index(other.index),
+            tile(other.tile) {}
+
+        tile_lock & operator=(tile_lock && other) noexcept {
+            if (this != &other) {
+                release();
+                owner = std::exchange(other.owner, nullptr);
+                index = other.index;
+                tile  = other.tile;
+            }
+            return *this;
+        }
+
+        ~tile_lock() { release(); }
+
+        [[nodiscard]] std::size_t                 id() const { return index; }
+        [[nodiscard]] velm_DR::ndarray_view<T, 3> view() const { return tile->values->view(); }
+
+      private:
+        friend class tiled_field;
+
+        tile_lock(tiled_field * owner, std::size_t index, entry * tile) : owner(owner), index(index), tile(tile) {}
+
+        void release() noexcept {
+            if (owner != nullptr) {
+                owner->unpin(index);
+                owner = nullptr;
+            }
+        }
+
+        tiled_field * owner;
+        std::size_t   index;
+        entry *       tile;
+    };
+
+    explicit tiled_field(std::shared_ptr<tile_store<T>> store, const tiled_options & options = {});
+    // writes modified tiles back; errors are lost then, call flush() to see them
+    ~tiled_field();
+
+    tiled_field(const tiled_field &)             = delete;
+    tiled_field & operator=(const tiled_field &) = delete;
+
+    [[nodiscard]] const std::size_t *     dims() const { return backing->dims(); }
+    [[nodiscard]] const std::size_t *     tile_shape() const { return options.tile; }
+    [[nodiscard]] const std::size_t *     tile_grid() const { return grid; }
+    [[nodiscard]] std::size_t             tile_count() const { return grid[0] * grid[1] * grid[2]; }
+    [[nodiscard]] const tiled_options &   settings() const { return options; }
+    [[nodiscard]] tile_store<T> &         store() { return *backing; }
+    [[nodiscard]] velm_DR::thread_pool &  pool() const;
+
+    // first element and extent of tile t, tiles numbered row-major over the tile grid
+    void tile_box(std::size_t t, std::size_t (&origin)[3], std::size_t (&extent)[3]) const;
+
+    // pins tile t, loading it first if needed; write and overwrite mark it modified
+    [[nodiscard]] tile_lock acquire(std::size_t t, tile_access mode);
+
+    // copies an arbitrary box through the resident tiles, e.g. a tile together with its halo
+    void read_box(const std::size_t (&begin)[3], velm_DR::ndarray_view<T, 3> out);
+
+    // writes every modified tile back to the store; no tile may be pinned meanwhile
+    void flush();
+    // writes back and drops every tile
+    void release_all();
+
+    [[nodiscard]] tile_counters counters() const;
+
+  private:
+    struct entry {
+        std::optional<velm_DR::ndarray<T, 3>>  values;  // allocated once the tile is loading
+        std::size_t                            pins     = 0;
+        bool                                   ready    = false;  // loaded, values may be used
+        bool                                   dirty    = false;
+        bool                                   busy     = false;  // being written back, must not be touched
+        typename std::list<std::size_t>::iterator position;        // in `unpinned`, while pins == 0
+    };
+
+    [[nodiscard]] std::size_t tile_bytes(std::size_t t) const;
+    // evicts the least recently used unpinned tile; false if there is none. May drop the lock meanwhile. The
+    // victim's buffer is handed to `recycled` if given, so a tile loaded in its place needs no new allocation.
+    bool evict_one(std::unique_lock<std::mutex> & lock, std::optional<velm_DR::ndarray<T, 3>> * recycled = nullptr);
+    void write_back(std::unique_lock<std::mutex> & lock, std::size_t t);
+    void unpin(std::size_t t) noexcept;
+
+    std::shared_ptr<tile_store<T>> backing;
+    tiled_options                  options;
+    std::size_t                    grid[3];
+
+    mutable std::mutex                  mutex;
+    std::condition_variable             changed;
+    std::vector<std::unique_ptr<entry>> tiles;     // by tile index, null while not resident
+    std::list<std::size_t>              unpinned;  // resident tiles nobody holds, most recently used first
+    tile_counters                       totals;
+};
+
+template <typename T> void tile_store<T>::write(const std::size_t (&)[3], velm_DR::ndarray_view<const T, 3>) {
+    throw std::runtime_error("tile_store: the store is read-only");
+}
+
+template <typename T>
+void tile_store<T>::check_box(const std::size_t (&begin)[3], const std::size_t * extent) const {
+    for (std::size_t a = 0; a < 3; ++a) {
+        if (begin[a] + extent[a] > shape[a]) {
+            throw std::runtime_error("tile_store: box lies outside the field");
+        }
+    }
+}
+
+namespace detail {
+
+inline std::vector<std::size_t> dataset_dims_3d(hdf5_file & file, const std::string & dataset) {
+    dataset_info info = file.info(dataset.c_str());
+    if (info.dims.size() != 3) {
+        throw std::runtime_error("hdf5_tile_store: " + dataset + " is not a 3D dataset");
+    }
+    return info.dims;
+}
+
+// element-wise copy between boxes of the same extent, a row at a time where both have unit stride along z
+template <typename T> void copy_box(velm_DR::ndarray_view<const T, 3> src, velm_DR::ndarray_view<T, 3> dst) {
+    for (std::size_t i = 0; i < dst.dims[0]; ++i) {
+        for (std::size_t j = 0; j < dst.dims[1]; ++j) {
+            if (src.strides[2] == 1 && dst.strides[2] == 1) {
+                std::copy_n(&src(i, j, 0), dst.dims[2], &dst(i, j, 0));
+                continue;
+            }
+            for (std::size_t k = 0; k < dst.dims[2]; ++k) {
+                dst(i, j, k) = src(i, j, k);
+            }
+        }
+    }
+}
+
+};  // namespace detail
+
+template <typename T>
+hdf5_tile_store<T>::hdf5_tile_store(hdf5_file & file, std::string dataset) :
+    tile_store<T>(detail::dataset_dims_3d(file, dataset).data()),
+    file(&file),
+    dataset(std::move(dataset)) {}
+
+template <typename T> void hdf5_tile_store<T>::read(const std::size_t (&begin)[3], velm_DR::ndarray_view<T, 3> out) {
+    file->read_region<T, 3>(dataset.c_str(), begin, out);
+}
+
+template <typename T>
+snapshot_tile_store<T>::snapshot_tile_store(const snapshot_file & file, const std::string & name) :
+    tile_store<T>(file.view<T, 3>(name).dims),
+    field(file.view<T, 3>(name)) {}
+
+template <typename T>
+void snapshot_tile_store<T>::read(const std::size_t (&begin)[3], velm_DR::ndarray_view<T, 3> out) {
+    this->check_box(begin, out.dims);
+    detail::copy_box<T>(field.subarray(begin, out.dims), out);
+}
+
+template <typename T>
+raw_tile_store<T>::raw_tile_store(const std::string & path, const std::size_t (&dims)[3], raw_open mode) :
+    tile_store<T>(dims),
+    file(path, mode, dims[0] * dims[1] * dims[2] * sizeof(T)),
+    mode(mode) {}
+
+template <typename T> void raw_tile_store<T>::read(const std::size_t (&begin)[3], velm_DR::ndarray_view<T, 3> out) {
+    this->check_box(begin, out.dims);
+    const std::size_t * dims = this->dims();
+    std::vector<T>      row(out.is_contiguous() ? 0 : out.dims[2]);
+    for (std::size_t i = 0; i < out.dims[0]; ++i) {
+        for (std::size_t j = 0; j < out.dims[1]; ++j) {
+            std::size_t offset = ((begin[0] + i) * dims[1] + begin[1] + j) * dims[2] + begin[2];
+            T *         dst    = &out(i, j, 0);
+            if (out.strides[2] == 1) {
+                file.read_at(offset * sizeof(T), dst, out.dims[2] * sizeof(T));
+                continue;
+            }
+            row.resize(out.dims[2]);
+            file.read_at(offset * sizeof(T), row.data(), row.size() * sizeof(T));
+            for (std::size_t k = 0; k < out.dims[2]; ++k) {
+                out(i, j, k) = row[k];
+            }
+        }
+    }
+}
+
+template <typename T>
+void raw_tile_store<T>::write(const std::size_t (&begin)[3], velm_DR::ndarray_view<const T, 3> values) {
+    if (mode == raw_open::read) {
+        tile_store<T>::write(begin, values);
+    }
+    this->check_box(begin, values.dims);
+    const std::size_t * dims = this->dims();
+    std::vector<T>      row;
+    for (std::size_t i = 0; i < values.dims[0]; ++i) {
+        for (std::size_t j = 0; j < values.dims[1]; ++j) {
+            std::size_t offset = ((begin[0] + i) * dims[1] + begin[1] + j) * dims[2] + begin[2];
+            if (values.strides[2] == 1) {
+                file.write_at(offset * sizeof(T), &values(i, j, 0), values.dims[2] * sizeof(T));
+                continue;
+            }
+            row.resize(values.dims[2]);
+            for (std::size_t k = 0; k < values.dims[2]; ++k) {
+                row[k] = values(i, j, k);
+            }
+            file.write_at(offset * sizeof(T), row.data(), row.size() * sizeof(T));
+        }
+    }
+}
+
+template <typename T>
+tiled_field<T>::tiled_field(std::shared_ptr<tile_store<T>> store, const tiled_options & options) :
+    backing(std::move(store)),
+    options(options) {
+    for (std::size_t a = 0; a < 3; ++a) {
+        if (this->options.tile[a] == 0) {
+            throw std::runtime_error("tiled_field: tiles must not be empty");
+        }
+        grid[a] = (dims()[a] + this->options.tile[a] - 1) / this->options.tile[a];
+    }
+    tiles.resize(tile_count());
+}
+
+template <typename T> tiled_field<T>::~tiled_field() {
+    try {
+        flush();
+    } catch (...) {
+    }
+}
+
+template <typename T> velm_DR::thread_pool & tiled_field<T>::pool() const {
+    return options.pool != nullptr ? *options.pool : velm_DR::thread_pool::global();
+}
+
+template <typename T>
+void tiled_field<T>::tile_box(std::size_t t, std::size_t (&origin)[3], std::size_t (&extent)[3]) const {
+    std::size_t coordinate[3] = { t / (grid[1] * grid[2]), (t / grid[2]) % grid[1], t % grid[2] };
+    for (std::size_t a = 0; a < 3; ++a) {
+        origin[a] = coordinate[a] * options.tile[a];
+        extent[a] = std::min(options.tile[a], dims()[a] - origin[a]);
+    }
+}
+
+template <typename T> std::size_t tiled_field<T>::tile_bytes(std::size_t t) const {
+    std::size_t origin[3], extent[3];
+    tile_box(t, origin, extent);
+    return extent[0] * extent[1] * extent[2] * sizeof(T);
+}
+
+template <typename T> typename tiled_field<T>::tile_lock tiled_field<T>::acquire(std::size_t t, tile_access mode) {
+    if (mode != tile_access::read && !backing->writable()) {
+        throw std::runtime_error("tiled_field: cannot modify a field whose store is read-only");
+    }
+    const std::size_t                     bytes = tile_bytes(t);
+    std::optional<velm_DR::ndarray<T, 3>> recycled;
+    std::unique_lock<std::mutex>          lock(mutex);
+    while (true) {
+        if (entry * tile = tiles[t].get()) {
+            if (!tile->ready || tile->busy) {
+                // another thread is loading or writing it back
+                changed.wait(lock);
+                continue;
+            }
+            if (tile->pins++ == 0) {
+                unpinned.erase(tile->position);
+            }
+            tile->dirty = tile->dirty || mode != tile_access::read;
+            return tile_lock(this, t, tile);
+        }
+        if (totals.resident_bytes + bytes > options.resident_bytes && evict_one(lock, &recycled)) {
+            // the lock was possibly dropped, so another thread may have loaded the tile meanwhile
+            continue;
+        }
+        break;
+    }
+
+    tiles[t]            = std::make_unique<entry>();
+    entry * tile        = tiles[t].get();
+    tile->pins          = 1;
+    totals.resident_bytes += bytes;
+    totals.peak_bytes = std::max(totals.peak_bytes, totals.resident_bytes);
+    lock.unlock();
+
+    try {
+        std::size_t origin[3], extent[3];
+        tile_box(t, origin, extent);
+        // streaming through a field replaces tiles of one shape, so reusing the victim's buffer keeps the heap
+        // from fragmenting into far more memory than the budget
+        if (recycled && std::equal(extent, extent + 3, recycled->dims)) {
+            tile->values.emplace(std::move(*recycled));
+        } else {
+            tile->values.emplace(velm_DR::uninitialized, extent);
+        }
+        if (mode != tile_access::overwrite) {
+            backing->read(origin, tile->values->view());
+        }
+    } catch (...) {
+        lock.lock();
+        tiles[t].reset();
+        totals.resident_bytes -= bytes;
+        changed.notify_all();
+        throw;
+    }
+
+    lock.lock();
+    tile->ready = true;
+    tile->dirty = mode != tile_access::read;
+    ++totals.loads;
+    changed.notify_all();
+    return tile_lock(this, t, tile);
+}
+
+template <typename T>
+bool tiled_field<T>::evict_one(std::unique_lock<std::mutex> & lock, std::optional<velm_DR::ndarray<T, 3>> * recycled) {
+    if (unpinned.empty()) {
+        return false;
+    }
+    std::size_t victim = unpinned.back();
+    unpinned.pop_back();
+    if (tiles[victim]->dirty) {
+        write_back(lock, victim);
+    }
+    totals.resident_bytes -= tile_bytes(victim);
+    ++totals.evictions;
+    if (recycled != nullptr) {
+        recycled->emplace(std::move(*tiles[victim]->values));
+    }
+    tiles[victim].reset();
+    changed.notify_all();
+    return true;
+}
+
+// with the lock held and tile t resident, unpinned and out of `unpinned`
+template <typename T> void tiled_field<T>::write_back(std::unique_lock<std::mutex> & lock, std::size_t t) {
+    entry * tile = tiles[t].get();
+    tile->busy   = true;
+    lock.unlock();
+    std::size_t origin[3], extent[3];
+    tile_box(t, origin, extent);
+    try {
+        backing->write(origin, velm_DR::ndarray_view<const T, 3>(tile->values->view()));
+    } catch (...) {
+        lock.lock();
+        tile->busy     = false;
+        tile->position = unpinned.insert(unpinned.end(), t);
+        changed.notify_all();
+        throw;
+    }
+    lock.lock();
+    tile->busy  = false;
+    tile->dirty = false;
+    ++totals.writebacks;
+}
+
+template <typename T> void tiled_field<T>::unpin(std::size_t t) noexcept {
+    std::unique_lock<std::mutex> lock(mutex);
+    entry *                      tile = tiles[t].get();
+    if (--tile->pins == 0) {
+        tile->position = unpinned.insert(unpinned.begin(), t);
+    }
+    // tiles loaded while others were pinned may have pushed the total over budget
+    try {
+        while (totals.resident_bytes > options.resident_bytes && evict_one(lock)) {
+        }
+    } catch (...) {
+        // the tile stays resident and modified, flush() reports the error
+    }
+}
+
+template <typename T> void tiled_field<T>::read_box(const std::size_t (&begin)[3], velm_DR::ndarray_view<T, 3> out) {
+    std::size_t first[3], last[3];
+    for (std::size_t a = 0; a < 3; ++a) {
+        if (begin[a] + out.dims[a] > dims()[a]) {
+            throw std::runtime_error("tiled_field: box lies outside the field");
+        }
+        if (out.dims[a] == 0) {
+            return;
+        }
+        first[a] = begin[a] / options.tile[a];
+        last[a]  = (begin[a] + out.dims[a] - 1) / options.tile[a];
+    }
+    for (std::size_t x = first[0]; x <= last[0]; ++x) {
+        for (std::size_t y = first[1]; y <= last[1]; ++y) {
+            for (std::size_t z = first[2]; z <= last[2]; ++z) {
+                tile_lock   lock = acquire((x * grid[1] + y) * grid[2] + z, tile_access::read);
+                std::size_t origin[3], extent[3];
+                tile_box(lock.id(), origin, extent);
+                // intersection of the tile and the box, relative to each
+                std::size_t in_tile[3], in_box[3], overlap[3];
+                for (std::size_t a = 0; a < 3; ++a) {
+                    std::size_t lo = std::max(origin[a], begin[a]);
+                    std::size_t hi = std::min(origin[a] + extent[a], begin[a] + out.dims[a]);
+                    in_tile[a]     = lo - origin[a];
+                    in_box[a]      = lo - begin[a];
+                    overlap[a]     = hi - lo;
+                }
+                detail::copy_box<T>(lock.view().subarray(in_tile, overlap), out.subarray(in_box, overlap));
+            }
+        }
+    }
+}
+
+template <typename T> void tiled_field<T>::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (std::size_t t = 0; t < tiles.size(); ++t) {
+        entry * tile = tiles[t].get();
+        if (tile != nullptr && tile->ready && tile->dirty && tile->pins == 0 && !tile->busy) {
+            // keeps its place in `unpinned`, so take it out while the lock is dropped
+            unpinned.erase(tile->position);
+            write_back(lock, t);
+            tile->position = unpinned.insert(unpinned.begin(), t);
+            changed.notify_all();
+        }
+    }
+}
+
+template <typename T> void tiled_field<T>::release_all() {
+    flush();
+    std::unique_lock<std::mutex> lock(mutex);
+    while (evict_one(lock)) {
+    }
+}
+
+template <typename T> tile_counters tiled_field<T>::counters() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return totals;
+}
+
+};  // namespace vlem
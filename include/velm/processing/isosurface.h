@@ -0,0 +1,78 @@
+#pragma once
+
+#include "velm/core/ndarray_view.h"
+#include "velm/core/thread_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace velm_DP {
+
+/*
+ * Marching-cubes isosurfaces of scalar fields such as |E| and |H| (see magnitude() in kernels.h).
+ *
+ * A corner counts as inside when its value is >= the isovalue. The triangle for each of the 256 corner cases is
+ * derived from the cube faces: on a face with two diagonal inside corners the corners are kept apart, a rule that
+ * depends on the face alone, so neighbouring cells always agree and the surface has no cracks.
+ *
+ * Extraction runs in parallel and allocates each output array only once:
+ *   1. the field is summarised by min/max over blocks of 8³ cells, and blocks that cannot contain the isovalue are
+ *      skipped in every later pass;
+ *   2. vertices and triangles are counted per grid row, and prefix sums give every row its place in the output;
+ *   3. rows write their vertices, and slabs of x-planes write their triangles.
+ * Every vertex lies on a grid edge and belongs to the lower end of that edge, so cells sharing an edge share one
+ * vertex (welding) and the result is the same for any number of threads.
+ */
+
+// vertex layout for a GL array buffer: two vec3 attributes, stride 24, normal at offset 12
+struct mesh_vertex {
+    float position[3];  // component a lies along array axis a: origin[a] + index * spacing[a]
+    float normal[3];    // unit length, pointing down the gradient, i.e. out of the region >= isovalue
+};
+
+// indexed triangle list for glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0)
+struct iso_mesh {
+    std::vector<mesh_vertex>   vertices;
+    std::vector<std::uint32_t> indices;  // counter-clockwise seen from the side the normals point to
+
+    [[nodiscard]] std::size_t triangle_count() const { return indices.size() / 3; }
+};
+
+/*
+ * Value range of every block of block_cells³ cells (block_cells + 1 samples per axis, clipped at the upper edges),
+ * so one field can be swept through many isovalues without rescanning it.
+ */
+class block_bounds {
+  public:
+    static constexpr std::size_t block_cells = 8;
+
+    block_bounds() = default;
+    explicit block_bounds(velm_DR::ndarray_view<const float, 3> field, velm_DR::thread_pool * pool = nullptr);
+
+    [[nodiscard]] const std::size_t * counts() const { return blocks; }
+    // whether block (a, b, c) can hold a cell with corners on both sides of `iso`
+    [[nodiscard]] bool may_cross(std::size_t a, std::size_t b, std::size_t c, float iso) const;
+    // number of blocks that can hold such a cell
+    [[nodiscard]] std::size_t active_blocks(float iso) const;
+
+  private:
+    std::size_t        blocks[3] = {};
+    std::vector<float> lo;
+    std::vector<float> hi;
+};
+
+struct iso_options {
+    float                  spacing[3] = { 1.0f, 1.0f, 1.0f };
+    float                  origin[3]  = { 0.0f, 0.0f, 0.0f };
+    const block_bounds *   bounds     = nullptr;  // summary of this field, nullptr: built on the fly
+    velm_DR::thread_pool * pool       = nullptr;  // nullptr: thread_pool::global()
+};
+
+// triangulated surface where `field` crosses `iso`. Throws std::invalid_argument if options.bounds does not match
+// the field's shape; aborts if the mesh would not fit 32-bit indices.
+[[nodiscard]] iso_mesh extract_isosurface(velm_DR::ndarray_view<const float, 3> field,
+                                          float                                 iso,
+                                          const iso_options &                   options = {});
+
+};  // namespace velm_DP
@@ -0,0 +1,278 @@
+#pragma once
+
+#include "velm/core/ndarray.h"
+#include "velm/core/profiler.h"
+#include "velm/core/ndarray_view.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace velm_DP {
+
+/*
+ * Vectorised per-voxel kernels over float and double fields.
+ *
+ * Every kernel makes a single pass over its operands: derived fields are written and their min/max/sum gathered
+ * in the same loop, so computing |E| together with its colormap range reads each component once. The loops are
+ * compiled for AVX2 and AVX-512 next to a portable scalar version, and the widest one the CPU supports is picked
+ * at run time.
+ *
+ * Operands are views of identical shape (a mismatch aborts). Contiguous operands are processed as one flat run;
+ * otherwise the kernels walk rows along the last axis, staging rows whose last-axis stride is not 1.
+ * NaNs in the input leave min/max unspecified.
+ */
+
+enum class simd_level { scalar, avx2, avx512 };
+
+// widest instruction set that is both compiled in and supported by this CPU
+[[nodiscard]] simd_level detected_simd_level();
+// instruction set currently used by the kernels, detected_simd_level() unless restricted
+[[nodiscard]] simd_level active_simd_level();
+// restricts dispatch, e.g. to compare implementations; levels above the detected one are clamped
+void set_simd_level(simd_level level);
+
+template <typename T> struct field_stats {
+    T           min   = std::numeric_limits<T>::infinity();
+    T           max   = -std::numeric_limits<T>::infinity();
+    double      sum   = 0.0;
+    std::size_t count = 0;
+
+    [[nodiscard]] double mean() const { return count != 0 ? sum / static_cast<double>(count) : 0.0; }
+
+    void merge(const field_stats & other) {
+        min = other.min < min ? other.min : min;
+        max = other.max > max ? other.max : max;
+        sum += other.sum;
+        count += other.count;
+    }
+};
+
+// min/max/sum of a field
+template <typename T, std::size_t N> [[nodiscard]] field_stats<T> reduce_stats(velm_DR::ndarray_view<const T, N> field);
+template <typename T, std::size_t N, typename Alloc>
+[[nodiscard]] field_stats<T> reduce_stats(const velm_DR::ndarray<T, N, Alloc> & field);
+
+// out = sqrt(x² + y² + z²), returning the stats of out
+template <typename T, std::size_t N>
+field_stats<T> magnitude(std::type_identity_t<velm_DR::ndarray_view<const T, N>> x,
+                         std::type_identity_t<velm_DR::ndarray_view<const T, N>> y,
+                         std::type_identity_t<velm_DR::ndarray_view<const T, N>> z,
+                         velm_DR::ndarray_view<T, N>                             out);
+
+// S = E × H, component-wise into sx, sy, sz
+template <typename T, std::size_t N>
+void poynting(std::type_identity_t<velm_DR::ndarray_view<const T, N>> ex,
+              std::type_identity_t<velm_DR::ndarray_view<const T, N>> ey,
+              std::type_identity_t<velm_DR::ndarray_view<const T, N>> ez,
+              std::type_identity_t<velm_DR::ndarray_view<const T, N>> hx,
+              std::type_identity_t<velm_DR::ndarray_view<const T, N>> hy,
+              std::type_identity_t<velm_DR::ndarray_view<const T, N>> hz,
+              velm_DR::ndarray_view<T, N>                             sx,
+              velm_DR::ndarray_view<T, N>                             sy,
+              velm_DR::ndarray_view<T, N>                             sz);
+
+// out = (epsilon |E|² + |H|² / mu) / 2, returning the stats of out
+template <typename T, std::size_t N>
+field_stats<T> energy_density(std::type_identity_t<velm_DR::ndarray_view<const T, N>> ex,
+                              std::type_identity_t<velm_DR::ndarray_view<const T, N>> ey,
+                              std::type_identity_t<velm_DR::ndarray_view<const T, N>> ez,
+                              std::type_identity_t<velm_DR::ndarray_view<const T, N>> hx,
+                              std::type_identity_t<velm_DR::ndarray_view<const T, N>> hy,
+                              std::type_identity_t<velm_DR::ndarray_view<const T, N>> hz,
+                              velm_DR::ndarray_view<T, N>                             out,
+                              T                                                       epsilon = T(1),
+                              T                                                       mu      = T(1));
+
+namespace detail {
+
+// flat kernels over `n` unit-stride elements, one table per instruction set
+template <typename T> struct kernel_table {
+    field_stats<T> (*stats)(const T * x, std::size_t n);
+    field_stats<T> (*magnitude)(const T * const * xyz, T * out, std::size_t n);
+    void (*cross)(const T * const * a, const T * const * b, T * const * out, std::size_t n);
+    field_stats<T> (*energy_density)(const T * const * e, const T * const * h, T * out, std::size_t n, T epsilon, T mu);
+};
+
+template <typename T> [[nodiscard]] const kernel_table<T> & active_kernels();
+
+/*
+ * Calls kernel(in, out, n) over runs of unit-stride elements covering every operand in lock step. `in` and `out`
+ * hold the run starts of each operand.
+ */
+template <typename T, std::size_t N, std::size_t In, std::size_t Out, typename F>
+void for_each_run(const std::array<velm_DR::ndarray_view<const T, N>, In> & in,
+                  const std::array<velm_DR::ndarray_view<T, N>, Out> &       out,
+                  F &&                                                       kernel) {
+    static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>, "Kernels support float and double only");
+    static_assert(In > 0, "Kernels need at least one input");
+
+    const std::size_t * dims       = in[0].dims;
+    bool                contiguous = true;
+    auto                check      = [&](const auto & view) {
+        for (std::size_t i = 0; i < N; ++i) {
+            if (view.dims[i] != dims[i]) {
+                abort();
+            }
+        }
+        contiguous = contiguous && view.is_contiguous();
+    };
+    for (const auto & view : in) {
+        check(view);
+    }
+    for (const auto & view : out) {
+        check(view);
+    }
+
+    std::size_t total = in[0].total_elements();
+    if (total == 0) {
+        return;
+    }
+    std::array<const T *, In> in_ptrs;
+    std::array<T *, Out>      out_ptrs;
+    if (contiguous) {
+        for (std::size_t k = 0; k < In; ++k) {
+            in_ptrs[k] = in[k].data;
+        }
+        for (std::size_t k = 0; k < Out; ++k) {
+            out_ptrs[k] = out[k].data;
+        }
+        kernel(in_ptrs.data(), out_ptrs.data(), total);
+        return;
+    }
+
+    const std::size_t length = dims[N - 1];
+    bool              unit   = length == 1;
+    if (!unit) {
+        unit = true;
+        for (const auto & view : in) {
+            unit = unit && view.strides[N - 1] == 1;
+        }
+        for (const auto & view : out) {
+            unit = unit && view.strides[N - 1] == 1;
+        }
+    }
+    // rows with a non-unit last-axis stride are gathered into staging, run, and scattered back
+    std::vector<T> staging(unit ? 0 : (In + Out) * length);
+
+    std::size_t index[N] = {};
+    for (std::size_t row = 0; row < total / length; ++row) {
+        for (std::size_t k = 0; k < In; ++k) {
+            const T * p = in[k].data;
+            for (std::size_t a = 0; a + 1 < N; ++a) {
+                p += index[a] * in[k].strides[a];
+            }
+            if (unit) {
+                in_ptrs[k] = p;
+            } else {
+                T * stage = staging.data() + k * length;
+                for (std::size_t i = 0; i < length; ++i) {
+                    stage[i] = p[i * in[k].strides[N - 1]];
+                }
+                in_ptrs[k] = stage;
+            }
+        }
+        for (std::size_t k = 0; k < Out; ++k) {
+            T * p = out[k].data;
+            for (std::size_t a = 0; a + 1 < N; ++a) {
+                p += index[a] * out[k].strides[a];
+            }
+            out_ptrs[k] = unit ? p : staging.data() + (In + k) * length;
+        }
+
+        kernel(in_ptrs.data(), out_ptrs.data(), length);
+
+        if (!unit) {
+            for (std::size_t k = 0; k < Out; ++k) {
+                T * p = out[k].data;
+                for (std::size_t a = 0; a + 1 < N; ++a) {
+                    p += index[a] * out[k].strides[a];
+                }
+                for (std::size_t i = 0; i < length; ++i) {
+                    p[i * out[k].strides[N - 1]] = out_ptrs[k][i];
+                }
+            }
+        }
+        // advance the odometer over every axis but the last
+        for (std::size_t a = N - 1; a > 0; --a) {
+            if (++index[a - 1] < dims[a - 1]) {
+                break;
+            }
+            index[a - 1] = 0;
+        }
+    }
+}
+
+};  // namespace detail
+
+template <typename T, std::size_t N> field_stats<T> reduce_stats(velm_DR::ndarray_view<const T, N> field) {
+    VELM_PROFILE_ZONE("kernels.reduce_stats", "processing");
+    const detail::kernel_table<T> & kernels = detail::active_kernels<T>();
+    field_stats<T>                  stats;
+    detail::for_each_run<T, N, 1, 0>({ field }, {}, [&](const T * const * in, T * const *, std::size_t n) {
+        stats.merge(kernels.stats(in[0], n));
+    });
+    return stats;
+}
+
+template <typename T, std::size_t N, typename Alloc>
+field_stats<T> reduce_stats(const velm_DR::ndarray<T, N, Alloc> & field) {
+    return reduce_stats<T, N>(field.view());
+}
+
+template <typename T, std::size_t N>
+field_stats<T> magnitude(std::type_identity_t<velm_DR::ndarray_view<const T, N>> x,
+                         std::type_identity_t<velm_DR::ndarray_view<const T, N>> y,
+                         std::type_identity_t<velm_DR::ndarray_view<const T, N>> z,
+                         velm_DR::ndarray_view<T, N>                             out) {
+    VELM_PROFILE_ZONE("kernels.magnitude", "processing");
+    const detail::kernel_table<T> & kernels = detail::active_kernels<T>();
+    field_stats<T>                  stats;
+    detail::for_each_run<T, N, 3, 1>({ x, y, z }, { out }, [&](const T * const * in, T * const * dst, std::size_t n) {
+        stats.merge(kernels.magnitude(in, dst[0], n));
+    });
+    return stats;
+}
+
+template <typename T, std::size_t N>
+void poynting(std::type_identity_t<velm_DR::ndarray_view<const T, N>> ex,
+              std::type_identity_t<velm_DR::ndarray_view<const T, N>> ey,
+              std::type_identity_t<velm_DR::ndarray_view<const T, N>> ez,
+              std::type_identity_t<velm_DR::ndarray_view<const T, N>> hx,
+              std::type_identity_t<velm_DR::ndarray_view<const T, N>> hy,
+              std::type_identity_t<velm_DR::ndarray_view<const T, N>> hz,
+              velm_DR::ndarray_view<T, N>                             sx,
+              velm_DR::ndarray_view<T, N>                             sy,
+              velm_DR::ndarray_view<T, N>                             sz) {
+    VELM_PROFILE_ZONE("kernels.poynting", "processing");
+    const detail::kernel_table<T> & kernels = detail::active_kernels<T>();
+    detail::for_each_run<T, N, 6, 3>({ ex, ey, ez, hx, hy, hz }, { sx, sy, sz },
+                                     [&](const T * const * in, T * const * dst, std::size_t n) {
+                                         kernels.cross(in, in + 3, dst, n);
+                                     });
+}
+
+template <typename T, std::size_t N>
+field_stats<T> energy_density(std::type_identity_t<velm_DR::ndarray_view<const T, N>> ex,
+                              std::type_identity_t<velm_DR::ndarray_view<const T, N>> ey,
+                              std::type_identity_t<velm_DR::ndarray_view<const T, N>> ez,
+                              std::type_identity_t<velm_DR::ndarray_view<const T, N>> hx,
+                              std::type_identity_t<velm_DR::ndarray_view<const T, N>> hy,
+                              std::type_identity_t<velm_DR::ndarray_view<const T, N>> hz,
+                              velm_DR::ndarray_view<T, N>                             out,
+                              T                                                       epsilon,
+                              T                                                       mu) {
+    VELM_PROFILE_ZONE("kernels.energy_density", "processing");
+    const detail::kernel_table<T> & kernels = detail::active_kernels<T>();
+    field_stats<T>                  stats;
+    detail::for_each_run<T, N, 6, 1>({ ex, ey, ez, hx, hy, hz }, { out },
+                                     [&](const T * const * in, T * const * dst, std::size_t n) {
+                                         stats.merge(kernels.energy_density(in, in + 3, dst[0], n, epsilon, mu));
+                                     });
+    return stats;
+}
+
+};  // namespace velm_DP
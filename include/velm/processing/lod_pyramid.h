@@ -0,0 +1,89 @@
+#pragma once
+
+#include "velm/core/ndarray.h"
+#include "velm/core/ndarray_view.h"
+#include "velm/core/thread_pool.h"
+#include "velm/io/hd5.h"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace velm_DP {
+
+/*
+ * Mip-style level-of-detail pyramid over a 3D field, for showing a coarse volume at once and refining on demand.
+ *
+ * Level 0 is the source itself and is not stored; every further level halves each axis (rounding up), combining
+ * each 2×2×2 block (clipped at odd upper edges) with a min, max or mean filter. Min and max keep peaks visible at
+ * coarse levels, where a mean would smear them out.
+ *
+ * Levels can be built from an array in memory or streamed chunk by chunk from an HDF5 dataset, in which case only
+ * level 1 and coarser are ever resident (1/7 of the source in total). Either way the 2×2×2 reduction is spread over
+ * a thread pool. A built pyramid can be saved to a sidecar file next to the source, and open() picks it up again
+ * as long as it is newer than the source.
+ *
+ * Only float and double fields are supported. Reading and writing files report errors as std::runtime_error.
+ */
+
+enum class lod_filter { min, max, mean };
+
+struct lod_options {
+    std::size_t            max_levels = 0;        // levels above the source, 0: down to a single voxel
+    velm_DR::thread_pool * pool       = nullptr;  // nullptr: thread_pool::global()
+};
+
+// the level chosen for a region and the region in that level's voxels
+struct lod_selection {
+    std::size_t level = 0;
+    std::size_t begin[3];
+    std::size_t extent[3];
+};
+
+template <typename T> class lod_pyramid {
+  public:
+    lod_pyramid() = default;
+    lod_pyramid(velm_DR::ndarray_view<const T, 3> source, lod_filter filter, const lod_options & options = {});
+    // streams `field` out of `file` without loading it whole
+    lod_pyramid(vlem::hdf5_file & file, const char * field, lod_filter filter, const lod_options & options = {});
+
+    // loads the pyramid saved next to `file` unless the source is newer, otherwise builds and saves it
+    [[nodiscard]] static lod_pyramid
+    open(vlem::hdf5_file & file, const char * field, lod_filter filter, const lod_options & options = {});
+    // previously saved levels of `field`, or nothing if the file does not hold a pyramid for this source shape
+    [[nodiscard]] static std::optional<lod_pyramid>
+    load(const std::string & path, const char * field, lod_filter filter, const std::size_t (&source_dims)[3]);
+    // overwrites `path`
+    void save(const std::string & path, const char * field) const;
+
+    // file open() keeps the pyramid of one field and filter in, next to the source file
+    [[nodiscard]] static std::string
+    sidecar_path(const std::string & source_path, const char * field, lod_filter filter);
+
+    [[nodiscard]] lod_filter          filter() const { return kind; }
+    [[nodiscard]] const std::size_t * source_dims() const { return source; }
+    // number of levels including the source
+    [[nodiscard]] std::size_t         level_count() const { return levels.size() + 1; }
+    // shape of level l, for any l < level_count()
+    [[nodiscard]] const std::size_t * dims(std::size_t l) const;
+    // voxels of level l, for 1 <= l < level_count()
+    [[nodiscard]] velm_DR::ndarray_view<const T, 3> level(std::size_t l) const;
+
+    /*
+     * Coarsest level at which the box [begin, end) of source voxels stays within `max_error_pixels` on screen,
+     * when its longest axis spans `screen_pixels` pixels: a voxel of level l covers 2^l source voxels, so level l
+     * is acceptable while 2^l source voxels project to at most max_error_pixels.
+     */
+    [[nodiscard]] lod_selection select(const std::size_t (&begin)[3],
+                                       const std::size_t (&end)[3],
+                                       double             screen_pixels,
+                                       double             max_error_pixels = 1.0) const;
+
+  private:
+    lod_filter                          kind      = lod_filter::mean;
+    std::size_t                         source[3] = {};
+    std::vector<velm_DR::ndarray<T, 3>> levels;  // levels[l - 1] is level l
+};
+
+};  // namespace velm_DP
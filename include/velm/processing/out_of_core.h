@@ -0,0 +1,125 @@
+#pragma once
+
+#include "velm/core/ndarray_view.h"
+#include "velm/io/tiled_field.h"
+#include "velm/processing/kernels.h"
+#include "velm/processing/lod_pyramid.h"
+#include "velm/processing/stencil.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <tuple>
+#include <vector>
+
+namespace velm_DP {
+
+/*
+ * Whole-field kernels over vlem::tiled_field, for grids larger than memory.
+ *
+ * Every kernel visits the tiles of its output in parallel on the output's pool (tiled_options::pool) and pins only
+ * the tiles of the operands it is working on, so memory stays within the fields' budgets plus a few tiles per
+ * thread. Per-tile work reuses the in-core kernels: for_each_tile and transform_tiles hand each tile to a callable
+ * as a plain ndarray_view, reductions merge per-tile field_stats, downsample builds one lod_pyramid level per tile
+ * and the stencils run on each tile grown by a one-sample halo, gathered from the neighbouring tiles (and from the
+ * opposite side of the grid for periodic boundaries), so tile seams give exactly the in-core result.
+ *
+ * Operands of one call must share dims and tile shape (downsample: the output has the coarser shape), otherwise
+ * the call aborts like the in-core kernels do. Store errors propagate as std::runtime_error. Outputs stay resident
+ * until evicted or flushed; call flush() before reading their stores directly.
+ */
+
+// f(origin, tile) for every tile, where tile is a view of the tile's elements and origin its first element
+template <typename T, typename F> void for_each_tile(vlem::tiled_field<T> & field, vlem::tile_access mode, F && f);
+
+// f(out_tile, in_tiles...) for every tile; out is overwritten, so f must assign every element of out_tile
+template <typename T, typename F, typename... In>
+void transform_tiles(vlem::tiled_field<T> & out, F && f, vlem::tiled_field<In> &... in);
+
+// min/max/sum of the whole field
+template <typename T> [[nodiscard]] field_stats<T> reduce_stats(vlem::tiled_field<T> & field);
+
+// one lod_pyramid level: out has dims (n + 1) / 2 of `in`, each voxel combining a 2×2×2 block with `filter`
+template <typename T> void downsample(vlem::tiled_field<T> & in, lod_filter filter, vlem::tiled_field<T> & out);
+
+// as the in-core versions in stencil.h; options.pool is unused, the tiles run on the output's pool
+template <typename T>
+void curl(vlem::tiled_field<T> & fx,
+          vlem::tiled_field<T> & fy,
+          vlem::tiled_field<T> & fz,
+          vlem::tiled_field<T> & cx,
+          vlem::tiled_field<T> & cy,
+          vlem::tiled_field<T> & cz,
+          const stencil_options<T> & options = {});
+
+template <typename T>
+void divergence(vlem::tiled_field<T> &     fx,
+                vlem::tiled_field<T> &     fy,
+                vlem::tiled_field<T> &     fz,
+                vlem::tiled_field<T> &     out,
+                const stencil_options<T> & options = {});
+
+template <typename T>
+void gradient(vlem::tiled_field<T> &     phi,
+              vlem::tiled_field<T> &     gx,
+              vlem::tiled_field<T> &     gy,
+              vlem::tiled_field<T> &     gz,
+              const stencil_options<T> & options = {});
+
+namespace detail {
+
+template <typename T, typename U>
+void check_same_tiling(const vlem::tiled_field<T> & a, const vlem::tiled_field<U> & b) {
+    for (std::size_t i = 0; i < 3; ++i) {
+        if (a.dims()[i] != b.dims()[i] || a.tile_shape()[i] != b.tile_shape()[i]) {
+            abort();
+        }
+    }
+}
+
+};  // namespace detail
+
+template <typename T, typename F> void for_each_tile(vlem::tiled_field<T> & field, vlem::tile_access mode, F && f) {
+    field.pool().parallel_for(field.tile_count(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t t = begin; t < end; ++t) {
+            auto        tile = field.acquire(t, mode);
+            std::size_t origin[3], extent[3];
+            field.tile_box(t, origin, extent);
+            f(origin, tile.view());
+        }
+    });
+}
+
+template <typename T, typename F, typename... In>
+void transform_tiles(vlem::tiled_field<T> & out, F && f, vlem::tiled_field<In> &... in) {
+    (detail::check_same_tiling(out, in), ...);
+    out.pool().parallel_for(out.tile_count(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t t = begin; t < end; ++t) {
+            // inputs first: when out is also an input, the tile must be read before it is marked for overwrite
+            std::tuple inputs{ in.acquire(t, vlem::tile_access::read)... };
+            auto       result = out.acquire(t, vlem::tile_access::overwrite);
+            std::apply(
+                [&](auto &... tiles) {
+                    f(result.view(), velm_DR::ndarray_view<const In, 3>(tiles.view())...);
+                },
+                inputs);
+        }
+    });
+}
+
+template <typename T> field_stats<T> reduce_stats(vlem::tiled_field<T> & field) {
+    std::vector<field_stats<T>> partial(field.tile_count());
+    field.pool().parallel_for(field.tile_count(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t t = begin; t < end; ++t) {
+            auto tile  = field.acquire(t, vlem::tile_access::read);
+            partial[t] = reduce_stats<T, 3>(tile.view());
+        }
+    });
+    // merged in tile order, so the sum does not depend on scheduling
+    field_stats<T> stats;
+    for (const field_stats<T> & p : partial) {
+        stats.merge(p);
+    }
+    return stats;
+}
+
+};  // namespace velm_DP
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "velm/core/ndarray_view.h"
+#include "velm/core/thread_pool.h"
+
+#include <cstddef>
+#include <type_traits>
+
+namespace velm_DP {
+
+/*
+ * Finite-difference vector calculus on 3D grids, for validating simulation output.
+ *
+ * Each derivative is a two-point difference along one axis. `central` evaluates it at the sample itself, while
+ * `forward` and `backward` evaluate it half a cell after or before the sample, which is how Yee-grid quantities
+ * relate: curl E (E on edges) with `forward` lands on the faces where H lives, curl H with `backward` lands back on
+ * the edges, div B with `forward` lands on cell centres and div E / grad phi use `backward` / `forward` between
+ * nodes and edges. All arrays share the same (nx, ny, nz) shape, as the components are stored in dumps.
+ *
+ * The grid is cut into tiles of rows along z, which are spread over a thread pool; within a row the loop runs
+ * over contiguous memory so the compiler vectorises it. Views need a unit stride along the last axis (anything
+ * else aborts), outputs must not overlap inputs, and all shapes must match.
+ */
+
+enum class difference { central, forward, backward };
+
+enum class boundary {
+    one_sided,  // fall back to the nearest pair of samples inside the grid
+    periodic,   // wrap around
+    zero,       // samples outside the grid are zero, e.g. tangential E on a perfect conductor
+};
+
+template <typename T> struct stencil_options {
+    T                      spacing[3] = { T(1), T(1), T(1) };  // dx, dy, dz
+    difference             scheme     = difference::central;
+    boundary               edges      = boundary::one_sided;
+    velm_DR::thread_pool * pool       = nullptr;  // nullptr: thread_pool::global()
+};
+
+template <typename T> using field_view     = velm_DR::ndarray_view<const T, 3>;
+template <typename T> using field_out_view = velm_DR::ndarray_view<T, 3>;
+
+// (cx, cy, cz) = curl (fx, fy, fz)
+template <typename T>
+void curl(std::type_identity_t<field_view<T>> fx,
+          std::type_identity_t<field_view<T>> fy,
+          std::type_identity_t<field_view<T>> fz,
+          field_out_view<T>                   cx,
+          field_out_view<T>                   cy,
+          field_out_view<T>                   cz,
+          const stencil_options<T> &          options = {});
+
+// out = div (fx, fy, fz)
+template <typename T>
+void divergence(std::type_identity_t<field_view<T>> fx,
+                std::type_identity_t<field_view<T>> fy,
+                std::type_identity_t<field_view<T>> fz,
+                field_out_view<T>                   out,
+                const stencil_options<T> &          options = {});
+
+// (gx, gy, gz) = grad phi
+template <typename T>
+void gradient(std::type_identity_t<field_view<T>> phi,
+              field_out_view<T>                   gx,
+              field_out_view<T>                   gy,
+              field_out_view<T>                   gz,
+              const stencil_options<T> &          options = {});
+
+};  // namespace velm_DP
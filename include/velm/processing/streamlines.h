@@ -0,0 +1,71 @@
+#pragma once
+
+#include "velm/core/ndarray_view.h"
+#include "velm/core/thread_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace velm_DP {
+
+/*
+ * Streamlines (field lines) through a vector field given as three float components on a regular grid.
+ *
+ * Lines follow the direction of the field, not its magnitude: they are integrated in arc length along v / |v|, so
+ * the steps stay even where a dipole field falls off by orders of magnitude. The field is interpolated trilinearly
+ * and integrated with the adaptive Dormand-Prince 5(4) pair, whose error estimate sets each step size. A line ends
+ * where it leaves the grid, where |v| drops below min_speed, where it turns back within a step (at a sink), or at
+ * max_points / max_length.
+ *
+ * Line lengths vary wildly between seeds, so seeds are handed out to the thread pool in small blocks as threads
+ * become free, and no thread sits idle while another still holds a queue of long lines. The lines are then packed
+ * into one vertex buffer in seed order, so the result does not depend on the thread count.
+ */
+
+enum class trace_direction { forward, backward, both };
+
+struct streamline_options {
+    float                  spacing[3] = { 1.0f, 1.0f, 1.0f };
+    float                  origin[3]  = { 0.0f, 0.0f, 0.0f };
+    trace_direction        direction  = trace_direction::both;
+    // step sizes and tolerance are in units of the smallest grid spacing
+    float                  tolerance  = 1e-3f;  // position error allowed per step
+    float                  first_step = 0.25f;
+    float                  min_step   = 1e-3f;  // a line that cannot advance with this step ends
+    float                  max_step   = 2.0f;
+    std::size_t            max_points = 4096;   // per direction
+    float                  max_length = 1e30f;  // per direction, in world units
+    float                  min_speed  = 1e-12f;
+    velm_DR::thread_pool * pool       = nullptr;  // nullptr: thread_pool::global()
+};
+
+// vertex layout for a GL array buffer: a vec3 position and the field magnitude there, for colouring
+struct line_vertex {
+    float position[3];
+    float speed;
+};
+
+/*
+ * All lines in one buffer: line s, traced from seed s, is vertices[first[s], first[s] + count[s]), ready for
+ * glMultiDrawArrays(GL_LINE_STRIP, first.data(), count.data(), line_count()). With trace_direction::both a line
+ * runs backward end, seed, forward end. Seeds outside the grid or in a null field give lines of fewer than two
+ * vertices.
+ */
+struct streamline_set {
+    std::vector<line_vertex>  vertices;
+    std::vector<std::int32_t> first;
+    std::vector<std::int32_t> count;
+    std::size_t               rejected_steps = 0;  // steps retried with a smaller size, a measure of effort
+
+    [[nodiscard]] std::size_t line_count() const { return first.size(); }
+};
+
+// lines from every row (x, y, z) of `seeds`, given in world coordinates; the components must have one shape
+[[nodiscard]] streamline_set trace_streamlines(velm_DR::ndarray_view<const float, 3> fx,
+                                               velm_DR::ndarray_view<const float, 3> fy,
+                                               velm_DR::ndarray_view<const float, 3> fz,
+                                               velm_DR::ndarray_view<const float, 2> seeds,
+                                              const streamline_options &            options = {});
+
+};  // namespace velm_DP
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+namespace velm_GL {
+
+// timings over the most recent frames, in milliseconds
+struct frame_stats {
+    std::size_t frames   = 0;  // frames in the window
+    double      cpu_last = 0.0;
+    double      cpu_mean = 0.0;
+    double      cpu_max  = 0.0;
+    double      gpu_last = 0.0;  // GPU time of the newest frame whose query result has arrived
+    double      gpu_mean = 0.0;
+    double      gpu_max  = 0.0;
+};
+
+/*
+ * Frame-time instrumentation for the render loop: wall-clock time between begin_frame() and end_frame() on the
+ * CPU, and the GPU time of the commands issued in between through GL_TIME_ELAPSED queries.
+ *
+ * Query results are collected a few frames late, once the GPU has them, so measuring never stalls the pipeline;
+ * frames whose result is not back yet when their query object comes round again are left out of the GPU numbers.
+ * Needs a current context with loaded entry points (see load_gl), on the thread that renders.
+ */
+class frame_timer {
+  public:
+    static constexpr std::size_t window  = 120;  // frames the statistics cover
+    static constexpr std::size_t queries = 4;    // frames a GPU result may lag behind
+
+    frame_timer();
+    ~frame_timer();
+
+    frame_timer(const frame_timer &)             = delete;
+    frame_timer & operator=(const frame_timer &) = delete;
+
+    void begin_frame();
+    void end_frame();
+
+    [[nodiscard]] frame_stats stats() const;
+
+  private:
+    using clock = std::chrono::steady_clock;
+
+    // records the results of finished queries, never waiting for the GPU
+    void collect();
+
+    clock::time_point             frame_start;
+    std::array<unsigned, queries> query_names{};
+    std::array<bool, queries>     query_pending{};
+    std::size_t                   next_query = 0;
+    std::array<double, window>    cpu_times{};
+    std::array<double, window>    gpu_times{};
+    std::size_t                   cpu_count = 0;
+    std::size_t                   gpu_count = 0;
+};
+
+};  // namespace velm_GL
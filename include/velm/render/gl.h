@@ -0,0 +1,17 @@
+#pragma once
+
+namespace velm_GL {
+
+using gl_proc   = void (*)();
+using gl_loader = gl_proc (*)(const char * name);
+
+/*
+ * Loads the OpenGL entry points of the context current on this thread, e.g. load_gl(glfwGetProcAddress) after
+ * glfwMakeContextCurrent. Returns the context version as major * 10 + minor, or 0 if loading failed.
+ *
+ * The renderer components need OpenGL 4.4 (persistent buffer mappings) and throw std::runtime_error on older
+ * contexts. GL objects belong to the context that was current when they were created.
+ */
+int load_gl(gl_loader loader);
+
+};  // namespace velm_GL
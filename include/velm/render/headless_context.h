@@ -0,0 +1,35 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+namespace velm_GL {
+
+/*
+ * Offscreen OpenGL 4.5 core context without a window or display server, through EGL's surfaceless platform. On
+ * machines without a GPU, Mesa provides it in software (llvmpipe), so renderer components can be exercised in
+ * tests and batch jobs. Rendering goes to framebuffer objects only.
+ *
+ * The constructor makes the context current on the calling thread and loads the GL entry points (see load_gl).
+ * It throws std::runtime_error when EGL or a suitable context is not available. Only built when EGL is found, which
+ * defines VELM_HAVE_EGL.
+ */
+class headless_context {
+  public:
+    headless_context();
+    ~headless_context();
+
+    headless_context(const headless_context &)             = delete;
+    headless_context & operator=(const headless_context &) = delete;
+
+    void make_current();
+
+    // GL_RENDERER of the context, e.g. "llvmpipe (LLVM 15.0.6, 256 bits)"
+    [[nodiscard]] const std::string & renderer() const;
+
+  private:
+    struct impl;
+    std::unique_ptr<impl> state;
+};
+
+};  // namespace velm_GL
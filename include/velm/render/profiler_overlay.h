@@ -0,0 +1,18 @@
+#pragma once
+
+#include "velm/core/profiler.h"
+#include "velm/render/frame_timer.h"
+
+namespace velm_GL {
+
+/*
+ * In-app window with the per-stage timings of a profiler, the process memory and, if given, the frame times:
+ * which stage stalls during playback without leaving the application.
+ *
+ * Issues ImGui widgets only, so it must be called between ImGui::NewFrame() and ImGui::Render() on the thread that
+ * owns the ImGui context; the application sets up the context and its platform and renderer backends. Collects the
+ * profiler's rings on every call. Built when the imgui submodule is checked out (VELM_HAVE_IMGUI).
+ */
+void draw_profiler_overlay(velm_DR::profiler & profiler, const frame_stats * frame = nullptr);
+
+};  // namespace velm_GL
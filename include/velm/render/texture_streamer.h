@@ -0,0 +1,105 @@
+#pragma once
+
+#include "velm/core/ndarray_view.h"
+#include "velm/core/thread_pool.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace velm_GL {
+
+// texel format of the 3D texture; the 16-bit formats halve VRAM and upload bandwidth
+enum class texel_format {
+    float32,  // GL_R32F
+    float16,  // GL_R16F, 11-bit mantissa, overflows to infinity beyond ±65504
+    unorm16,  // GL_R16, [range_min, range_max] quantised to 65536 steps, clamped outside
+};
+
+struct streamer_options {
+    texel_format           format        = texel_format::float32;
+    std::size_t            staging_slots = 3;        // PBOs in flight, 3: triple buffering
+    std::size_t            staging_bytes = 0;        // per slot, 0: the whole volume up to 64 MiB; at least one x-plane
+    float                  range_min     = 0.0f;     // field values unorm16 maps to 0 and 1
+    float                  range_max     = 1.0f;
+    velm_DR::thread_pool * pool          = nullptr;  // converts into the staging buffers, nullptr: global()
+};
+
+struct upload_stats {
+    std::size_t uploads         = 0;  // upload calls carried out
+    std::size_t slabs           = 0;  // glTexSubImage3D calls issued
+    std::size_t bytes           = 0;  // texel bytes staged
+    std::size_t stalls          = 0;  // slabs that waited for the GPU to release their staging slot
+    std::size_t skipped         = 0;  // try_upload calls refused because a slot was busy
+    double      stall_seconds   = 0.0;
+    double      convert_seconds = 0.0;
+};
+
+/*
+ * Streams 3D fields into a GL_TEXTURE_3D through persistently mapped pixel buffer objects, so loading the next
+ * timestep overlaps with drawing the current one instead of stalling the frame.
+ *
+ * Element (i, j, k) of the field is texel (k, j, i): the contiguous axis becomes the texture width and axis 0 its
+ * depth. An upload is cut into slabs of whole x-planes that fit a staging slot; each slab is converted straight into
+ * the slot's mapping on the thread pool, handed to glTexSubImage3D from the bound unpack buffer and fenced. A slot is
+ * written again only after its fence has signalled, so the CPU never overwrites texels the GPU has yet to copy, and
+ * with three slots it can fill one while the driver drains the other two.
+ *
+ * Sub-regions are updated in place given their origin in the volume. try_upload gives up instead of waiting when
+ * the slots it needs are still busy, for render loops that would rather show the previous step another frame.
+ *
+ * Needs a current OpenGL 4.4 context with loaded entry points (see load_gl) and must be used on its thread. Throws
+ * std::runtime_error on older contexts and on regions outside the volume.
+ */
+class texture_streamer {
+  public:
+    texture_streamer(std::size_t nx, std::size_t ny, std::size_t nz, const streamer_options & options = {});
+    ~texture_streamer();
+
+    texture_streamer(const texture_streamer &)             = delete;
+    texture_streamer & operator=(const texture_streamer &) = delete;
+
+    [[nodiscard]] unsigned            texture() const { return name; }
+    [[nodiscard]] const std::size_t * dims() const { return extent; }
+    [[nodiscard]] texel_format        format() const { return options.format; }
+
+    // replaces the whole volume
+    template <typename T> void upload(velm_DR::ndarray_view<const T, 3> field);
+    // replaces the box of region.dims starting at `origin`
+    template <typename T> void upload(velm_DR::ndarray_view<const T, 3> region, const std::size_t (&origin)[3]);
+    // as upload, unless a slot its first slabs need is still in use by the GPU; then nothing happens
+    template <typename T> bool try_upload(velm_DR::ndarray_view<const T, 3> region, const std::size_t (&origin)[3]);
+
+    // whether every staging slot has been released by the GPU
+    [[nodiscard]] bool idle() const;
+    // blocks until every staged slab has reached the texture
+    void finish();
+
+    // texture contents in field units (dequantised for unorm16), for tests and screenshots; out has the volume shape
+    void read_back(velm_DR::ndarray_view<float, 3> out) const;
+
+    [[nodiscard]] const upload_stats & stats() const { return counters; }
+
+  private:
+    struct slot {
+        unsigned buffer = 0;
+        void *   mapped = nullptr;
+        void *   fence  = nullptr;  // GLsync of the last slab staged here
+    };
+
+    std::size_t texel_bytes() const;
+    std::size_t slab_planes(const std::size_t (&region)[3]) const;
+    bool        slot_busy(const slot & s) const;
+    void        wait_for(slot & s);
+    template <typename T>
+    void stage(velm_DR::ndarray_view<const T, 3> slab, void * destination, velm_DR::thread_pool & pool);
+
+    streamer_options  options;
+    std::size_t       extent[3]  = {};
+    std::size_t       slot_bytes = 0;
+    unsigned          name       = 0;
+    std::vector<slot> slots;
+    std::size_t       next_slot  = 0;
+    upload_stats      counters;
+};
+
+};  // namespace velm_GL
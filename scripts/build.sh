@@ -22,4 +22,4 @@ fi
 
 echo "Build succeeded"
 
-./bin/VelmVT_tests
+ctest --output-on-failure
@@ -0,0 +1,151 @@
+#include "velm/core/allocator.h"
+
+#if defined(__linux__)
+#    include <sys/mman.h>
+#endif
+
+#include <cstring>
+#include <iterator>
+#include <new>
+
+namespace velm_DR {
+
+namespace {
+
+constexpr std::size_t huge_page_size = std::size_t(2) << 20;
+
+std::size_t round_up(std::size_t bytes, std::size_t multiple) {
+    return (bytes + multiple - 1) / multiple * multiple;
+}
+
+}  // namespace
+
+void * huge_page_allocate(std::size_t bytes) {
+    if (bytes == 0) {
+        // mmap rejects empty mappings; empty arrays still need a non-null pointer
+        alignas(default_alignment) static char empty;
+        return &empty;
+    }
+#if defined(__linux__)
+    std::size_t length = round_up(bytes, huge_page_size);
+    void *      p      = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+#    if defined(MADV_HUGEPAGE)
+    // advisory only: without THP support the mapping simply stays on regular pages
+    madvise(p, length, MADV_HUGEPAGE);
+#    endif
+    return p;
+#else
+    // fall back to zeroed, cache-line aligned storage so the zeroed guarantee of huge_page_allocator holds
+    void * p = ::operator new(bytes, std::align_val_t(default_alignment));
+    std::memset(p, 0, bytes);
+    return p;
+#endif
+}
+
+void huge_page_deallocate(void * p, std::size_t bytes) noexcept {
+    if (p == nullptr || bytes == 0) {
+        return;
+    }
+#if defined(__linux__)
+    munmap(p, round_up(bytes, huge_page_size));
+#else
+    (void) bytes;
+    ::operator delete(p, std::align_val_t(default_alignment));
+#endif
+}
+
+block_pool::block_pool(std::size_t max_cached_bytes) : max_cached(max_cached_bytes) {}
+
+block_pool::~block_pool() {
+    trim();
+}
+
+void * block_pool::acquire(std::size_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto                        it = free_blocks.find(bytes);
+        if (it != free_blocks.end() && !it->second.empty()) {
+            void * p = it->second.back();
+            it->second.pop_back();
+            cached -= bytes;
+            ++hit_count;
+            return p;
+        }
+        ++miss_count;
+    }
+    return ::operator new(bytes, std::align_val_t(default_alignment));
+}
+
+void block_pool::release(void * p, std::size_t bytes) noexcept {
+    if (p == nullptr) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (cached + bytes <= max_cached) {
+            try {
+                free_blocks[bytes].push_back(p);
+                cached += bytes;
+                return;
+            } catch (...) {
+                // bookkeeping allocation failed, hand the block straight back instead
+            }
+        }
+    }
+    ::operator delete(p, std::align_val_t(default_alignment));
+}
+
+void block_pool::trim() noexcept {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto & [bytes, blocks] : free_blocks) {
+        for (void * p : blocks) {
+            ::operator delete(p, std::align_val_t(default_alignment));
+        }
+    }
+    free_blocks.clear();
+    cached = 0;
+}
+
+void block_pool::set_max_cached_bytes(std::size_t bytes) noexcept {
+    std::lock_guard<std::mutex> lock(mutex);
+    max_cached = bytes;
+    for (auto it = free_blocks.begin(); it != free_blocks.end() && cached > max_cached;) {
+        std::vector<void *> & blocks = it->second;
+        while (!blocks.empty() && cached > max_cached) {
+            ::operator delete(blocks.back(), std::align_val_t(default_alignment));
+            blocks.pop_back();
+            cached -= it->first;
+        }
+        it = blocks.empty() ? free_blocks.erase(it) : std::next(it);
+    }
+}
+
+std::size_t block_pool::max_cached_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return max_cached;
+}
+
+std::size_t block_pool::cached_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return cached;
+}
+
+std::size_t block_pool::hits() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hit_count;
+}
+
+std::size_t block_pool::misses() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return miss_count;
+}
+
+block_pool & block_pool::global() {
+    static block_pool pool(default_global_cache_bytes);
+    return pool;
+}
+
+};  // namespace velm_DR
@@ -0,0 +1,327 @@
+#include "velm/core/profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+#ifdef VELM_HAVE_SPDLOG
+#    include <spdlog/spdlog.h>
+#else
+#    include <iostream>
+#endif
+
+#ifdef __linux__
+#    include <unistd.h>
+#endif
+
+namespace velm_DR {
+
+namespace {
+
+std::int64_t steady_nanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+std::atomic<std::uint64_t> & next_profiler_id() {
+    static std::atomic<std::uint64_t> id{ 1 };
+    return id;
+}
+
+// ring this thread owns in one profiler; ids are never reused, so a stale entry is harmless
+struct owned_ring {
+    std::uint64_t                      profiler = 0;
+    void *                             ring     = nullptr;
+    std::shared_ptr<std::atomic<bool>> retired;  // aliases the ring, keeping it alive until the thread exits
+};
+
+// marks the thread's rings retired when it exits, so collect() can drain and free them
+struct ring_owner {
+    std::vector<owned_ring> rings;
+
+    ~ring_owner() {
+        for (const owned_ring & owned : rings) {
+            owned.retired->store(true, std::memory_order_release);
+        }
+    }
+};
+
+thread_local ring_owner  owned_rings;
+thread_local std::string thread_name;
+
+double milliseconds(std::uint64_t nanoseconds) {
+    return static_cast<double>(nanoseconds) * 1e-6;
+}
+
+void write_json_string(std::ostream & out, std::string_view text) {
+    out << '"';
+    for (char c : text) {
+        switch (c) {
+            case '"':
+                out << "\\\"";
+                break;
+            case '\\':
+                out << "\\\\";
+                break;
+            case '\n':
+                out << "\\n";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                    out << escaped;
+                } else {
+                    out << c;
+                }
+        }
+    }
+    out << '"';
+}
+
+}  // namespace
+
+memory_usage process_memory() {
+    memory_usage usage;
+#ifdef __linux__
+    // VmRSS and VmHWM are reported in kB
+    std::ifstream status("/proc/self/status");
+    std::string   line;
+    while (std::getline(status, line)) {
+        std::size_t kilobytes = 0;
+        if (std::sscanf(line.c_str(), "VmRSS: %zu kB", &kilobytes) == 1) {
+            usage.resident = kilobytes * 1024;
+        } else if (std::sscanf(line.c_str(), "VmHWM: %zu kB", &kilobytes) == 1) {
+            usage.peak_resident = kilobytes * 1024;
+        }
+    }
+#endif
+    return usage;
+}
+
+profiler::profiler() : id(next_profiler_id().fetch_add(1)), epoch(steady_nanoseconds()) {}
+
+profiler::~profiler() = default;
+
+profiler & profiler::global() {
+    static profiler instance;
+    return instance;
+}
+
+std::uint64_t profiler::now() const {
+    return static_cast<std::uint64_t>(steady_nanoseconds() - epoch);
+}
+
+profiler::thread_ring * profiler::find_ring_of_this_thread() const {
+    for (const owned_ring & owned : owned_rings.rings) {
+        if (owned.profiler == id) {
+            return static_cast<thread_ring *>(owned.ring);
+        }
+    }
+    return nullptr;
+}
+
+profiler::thread_ring & profiler::ring_of_this_thread() {
+    if (thread_ring * ring = find_ring_of_this_thread()) {
+        return *ring;
+    }
+    // first zone of this thread: the only allocation and the only lock on the recording path
+    auto ring = std::make_shared<thread_ring>();
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        ring->thread = next_thread++;
+        ring->name   = thread_name;
+        rings.push_back(ring);
+    }
+    owned_rings.rings.push_back({ id, ring.get(), std::shared_ptr<std::atomic<bool>>(ring, &ring->retired) });
+    return *ring;
+}
+
+void profiler::record(const char * name, const char * category, std::uint64_t start, std::uint64_t end) {
+    thread_ring & ring = ring_of_this_thread();
+    std::size_t   head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= ring_capacity) {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    ring.events[head % ring_capacity] = { name, category, start, end, ring.thread };
+    // publishes the event to collect()
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+void profiler::name_thread(const std::string & name) {
+    thread_name = name;
+    // a thread that has not recorded yet gets the name with its ring
+    if (thread_ring * ring = find_ring_of_this_thread()) {
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        ring->name = name;
+    }
+}
+
+void profiler::collect() {
+    std::vector<std::shared_ptr<thread_ring>> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        snapshot = rings;
+    }
+
+    std::lock_guard<std::mutex>               lock(collect_mutex);
+    std::vector<std::shared_ptr<thread_ring>> drained;
+    for (const std::shared_ptr<thread_ring> & ring : snapshot) {
+        // read before head: once retired, the owner has recorded its last zone
+        bool        retired = ring->retired.load(std::memory_order_acquire);
+        std::size_t tail    = ring->tail.load(std::memory_order_relaxed);
+        std::size_t head = ring->head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            const trace_event & event = ring->events[tail % ring_capacity];
+            stage_stats &       stage = totals[event.name];
+            double              time  = milliseconds(event.end - event.start);
+            stage.name                = event.name;
+            stage.category            = event.category;
+            stage.calls += 1;
+            stage.total += time;
+            stage.last = time;
+            stage.max  = std::max(stage.max, time);
+            stage.mean = stage.total / static_cast<double>(stage.calls);
+
+            if (history.size() == history_capacity) {
+                history.pop_front();
+            }
+            history.push_back(event);
+        }
+        // hands the slots back to the owning thread
+        ring->tail.store(head, std::memory_order_release);
+        if (retired) {
+            drained.push_back(ring);
+        }
+    }
+
+    if (drained.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> rings_lock(rings_mutex);
+    for (const std::shared_ptr<thread_ring> & ring : drained) {
+        if (!ring->name.empty() && ring->head.load(std::memory_order_relaxed) != 0) {
+            retired_names[ring->thread] = ring->name;
+        }
+        retired_dropped += ring->dropped.load(std::memory_order_relaxed);
+        rings.erase(std::find(rings.begin(), rings.end(), ring));
+    }
+}
+
+void profiler::clear() {
+    collect();
+    std::lock_guard<std::mutex> lock(collect_mutex);
+    history.clear();
+    totals.clear();
+    std::lock_guard<std::mutex> rings_lock(rings_mutex);
+    for (const std::shared_ptr<thread_ring> & ring : rings) {
+        ring->dropped.store(0, std::memory_order_relaxed);
+    }
+    retired_names.clear();
+    retired_dropped = 0;
+}
+
+std::vector<stage_stats> profiler::stages() {
+    collect();
+    std::lock_guard<std::mutex> lock(collect_mutex);
+    std::vector<stage_stats>    result;
+    result.reserve(totals.size());
+    for (const auto & [name, stage] : totals) {
+        result.push_back(stage);
+    }
+    return result;
+}
+
+std::vector<trace_event> profiler::events() {
+    collect();
+    std::lock_guard<std::mutex> lock(collect_mutex);
+    return std::vector<trace_event>(history.begin(), history.end());
+}
+
+std::size_t profiler::dropped() const {
+    std::lock_guard<std::mutex> lock(rings_mutex);
+    std::size_t                 count = retired_dropped;
+    for (const std::shared_ptr<thread_ring> & ring : rings) {
+        count += ring->dropped.load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+std::size_t profiler::live_rings() const {
+    std::lock_guard<std::mutex> lock(rings_mutex);
+    return rings.size();
+}
+
+void profiler::write_chrome_trace(const std::string & path) {
+    std::vector<trace_event> zones = events();
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("profiler: cannot open " + path);
+    }
+
+    // complete ("X") events with timestamps in microseconds, plus one metadata event per named thread
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    {
+        std::lock_guard<std::mutex>          lock(rings_mutex);
+        std::map<std::uint32_t, std::string> names = retired_names;
+        for (const std::shared_ptr<thread_ring> & ring : rings) {
+            if (!ring->name.empty()) {
+                names[ring->thread] = ring->name;
+            }
+        }
+        for (const auto & [thread, name] : names) {
+            out << (first ? "\n" : ",\n") << "{\"ph\":\"M\",\"pid\":1,\"tid\":" << thread
+                << ",\"name\":\"thread_name\",\"args\":{\"name\":";
+            write_json_string(out, name);
+            out << "}}";
+            first = false;
+        }
+    }
+    char timing[64];
+    for (const trace_event & zone : zones) {
+        out << (first ? "\n" : ",\n") << "{\"ph\":\"X\",\"pid\":1,\"tid\":" << zone.thread << ",\"name\":";
+        write_json_string(out, zone.name);
+        out << ",\"cat\":";
+        write_json_string(out, zone.category);
+        std::snprintf(timing, sizeof(timing), ",\"ts\":%.3f,\"dur\":%.3f}", static_cast<double>(zone.start) * 1e-3,
+                      static_cast<double>(zone.end - zone.start) * 1e-3);
+        out << timing;
+        first = false;
+    }
+    out << "\n]}\n";
+
+    if (!out) {
+        throw std::runtime_error("profiler: failed writing " + path);
+    }
+}
+
+void profiler::log_summary() {
+    std::vector<stage_stats> summary = stages();
+    memory_usage             memory  = process_memory();
+    std::size_t              lost    = dropped();
+#ifdef VELM_HAVE_SPDLOG
+    for (const stage_stats & stage : summary) {
+        spdlog::info("{:<28} {:>8} calls  mean {:9.3f} ms  max {:9.3f} ms  total {:10.1f} ms", stage.name,
+                     stage.calls, stage.mean, stage.max, stage.total);
+    }
+    spdlog::info("resident {} MiB, peak {} MiB, {} zones dropped", memory.resident >> 20, memory.peak_resident >> 20,
+                 lost);
+#else
+    char line[160];
+    for (const stage_stats & stage : summary) {
+        std::snprintf(line, sizeof(line), "%-28s %8zu calls  mean %9.3f ms  max %9.3f ms  total %10.1f ms",
+                      stage.name, stage.calls, stage.mean, stage.max, stage.total);
+        std::clog << line << '\n';
+    }
+    std::clog << "resident " << (memory.resident >> 20) << " MiB, peak " << (memory.peak_resident >> 20) << " MiB, "
+              << lost << " zones dropped\n";
+#endif
+}
+
+};  // namespace velm_DR
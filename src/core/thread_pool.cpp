@@ -0,0 +1,53 @@
+#include "velm/core/thread_pool.h"
+
+namespace velm_DR {
+
+thread_pool::thread_pool(std::size_t threads) {
+    workers.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+        workers.emplace_back([this] { worker_loop(); });
+    }
+}
+
+thread_pool::~thread_pool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread & worker : workers) {
+        worker.join();
+    }
+}
+
+thread_pool & thread_pool::global() {
+    static thread_pool pool;
+    return pool;
+}
+
+void thread_pool::enqueue(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    wake.notify_one();
+}
+
+void thread_pool::worker_loop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !tasks.empty(); });
+            // drain the queue before honouring a stop request, so no submitted future is left unsatisfied
+            if (tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+};  // namespace velm_DR
@@ -0,0 +1,150 @@
+#include "velm/io/field_cache.h"
+
+#include "velm/core/profiler.h"
+
+#include <chrono>
+#include <stdexcept>
+#include <utility>
+
+namespace vlem {
+
+namespace {
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+field_cache::field_cache(hdf5_file & file, cache_options options) : file(file), options(options) {
+    if (options.codec == field_codec::bounded && !(options.error_bound > 0.0)) {
+        throw std::runtime_error("field_cache: the bounded codec needs a positive error bound");
+    }
+}
+
+velm_DR::ndarray<float, 3> field_cache::get(const std::string & dataset) {
+    if (std::shared_ptr<const compressed_field> entry = find(dataset)) {
+        const std::size_t *        dims = entry->dims();
+        velm_DR::ndarray<float, 3> out(velm_DR::uninitialized, dims[0], dims[1], dims[2]);
+        decode(*entry, out.view());
+        return out;
+    }
+    dataset_info info = file.info(dataset.c_str());
+    if (info.dims.size() != 3) {
+        throw std::runtime_error("field_cache: " + dataset + " is not a 3D dataset");
+    }
+    velm_DR::ndarray<float, 3> out(velm_DR::uninitialized, info.dims[0], info.dims[1], info.dims[2]);
+    load(dataset, out.view());
+    return out;
+}
+
+void field_cache::get(const std::string & dataset, velm_DR::ndarray_view<float, 3> out) {
+    if (std::shared_ptr<const compressed_field> entry = find(dataset)) {
+        decode(*entry, out);
+    } else {
+        load(dataset, out);
+    }
+}
+
+bool field_cache::contains(const std::string & dataset) const {
+    std::lock_guard lock(mutex);
+    return index.count(dataset) != 0;
+}
+
+void field_cache::set_budget(std::size_t budget_bytes) {
+    std::lock_guard lock(mutex);
+    options.budget_bytes = budget_bytes;
+    evict();
+}
+
+void field_cache::clear() {
+    std::lock_guard lock(mutex);
+    recent.clear();
+    index.clear();
+    totals.entries        = 0;
+    totals.bytes_held     = 0;
+    totals.raw_bytes_held = 0;
+}
+
+cache_counters field_cache::counters() const {
+    std::lock_guard lock(mutex);
+    return totals;
+}
+
+std::shared_ptr<const compressed_field> field_cache::find(const std::string & dataset) {
+    std::lock_guard lock(mutex);
+    auto            found = index.find(dataset);
+    if (found == index.end()) {
+        ++totals.misses;
+        return nullptr;
+    }
+    ++totals.hits;
+    recent.splice(recent.begin(), recent, found->second);
+    return found->second->second;
+}
+
+void field_cache::decode(const compressed_field & entry, velm_DR::ndarray_view<float, 3> out) {
+    VELM_PROFILE_ZONE("cache.decode", "io");
+    auto start = std::chrono::steady_clock::now();
+    entry.decode(out, options.pool);
+    double          spent = seconds_since(start);
+    std::lock_guard lock(mutex);
+    totals.decode_seconds += spent;
+}
+
+void field_cache::load(const std::string & dataset, velm_DR::ndarray_view<float, 3> out) {
+    // read_region checks the type and that `out` lies within the dataset; the shape must match exactly
+    dataset_info info = file.info(dataset.c_str());
+    if (info.dims.size() != 3 || info.dims[0] != out.dims[0] || info.dims[1] != out.dims[1] ||
+        info.dims[2] != out.dims[2]) {
+        throw std::runtime_error("field_cache: destination does not have the shape of " + dataset);
+    }
+    auto              start     = std::chrono::steady_clock::now();
+    const std::size_t origin[3] = {};
+    file.read_region<float, 3>(dataset.c_str(), origin, out);
+    double read_seconds = seconds_since(start);
+
+    VELM_PROFILE_ZONE("cache.encode", "io");
+    start      = std::chrono::steady_clock::now();
+    auto entry = std::make_shared<const compressed_field>(velm_DR::ndarray_view<const float, 3>(out), options.codec,
+                                                          options.error_bound, options.pool);
+    insert(dataset, std::move(entry), read_seconds, seconds_since(start));
+}
+
+void field_cache::insert(const std::string &                     dataset,
+                         std::shared_ptr<const compressed_field> entry,
+                         double                                  read_seconds,
+                         double                                  encode_seconds) {
+    std::lock_guard lock(mutex);
+    totals.read_seconds += read_seconds;
+    totals.encode_seconds += encode_seconds;
+    if (entry->compressed_bytes() > options.budget_bytes) {
+        ++totals.uncacheable;
+        return;
+    }
+    // another thread may have missed on the same dataset meanwhile; its copy is as good as this one
+    if (index.count(dataset) != 0) {
+        return;
+    }
+    totals.bytes_held += entry->compressed_bytes();
+    totals.raw_bytes_held += entry->raw_bytes();
+    ++totals.entries;
+    recent.emplace_front(dataset, std::move(entry));
+    index.emplace(dataset, recent.begin());
+    evict();
+}
+
+// with the mutex held
+void field_cache::evict() {
+    while (totals.bytes_held > options.budget_bytes && !recent.empty()) {
+        const auto & [dataset, entry] = recent.back();
+        totals.bytes_held -= entry->compressed_bytes();
+        totals.raw_bytes_held -= entry->raw_bytes();
+        --totals.entries;
+        ++totals.evictions;
+        index.erase(dataset);
+        recent.pop_back();
+    }
+}
+
+};  // namespace vlem
@@ -0,0 +1,313 @@
+#include "velm/io/field_codec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <zlib.h>
+
+namespace vlem {
+
+namespace {
+
+constexpr std::size_t edge         = compressed_field::brick_edge;
+constexpr std::size_t brick_values = edge * edge * edge;
+
+// brick header: storage mode, then the length of the code stream that follows
+enum : std::uint8_t { stored_raw = 0, stored_deflated = 1 };
+constexpr std::size_t header_bytes = 1 + sizeof(std::uint32_t);
+
+// bounded codes: 0 marks a value stored verbatim after the code stream, otherwise zigzag(q) + 1
+constexpr double max_quantum = 1 << 30;
+
+struct brick_shape {
+    std::size_t origin[3];
+    std::size_t extent[3];
+
+    [[nodiscard]] std::size_t count() const { return extent[0] * extent[1] * extent[2]; }
+};
+
+brick_shape brick_at(const std::size_t (&shape)[3], const std::size_t (&bricks)[3], std::size_t b) {
+    brick_shape brick;
+    std::size_t index[3] = { b / (bricks[1] * bricks[2]), b / bricks[2] % bricks[1], b % bricks[2] };
+    for (std::size_t a = 0; a < 3; ++a) {
+        brick.origin[a] = index[a] * edge;
+        brick.extent[a] = std::min(edge, shape[a] - brick.origin[a]);
+    }
+    return brick;
+}
+
+// the brick's values, row-major within the brick
+template <typename V, typename F> void for_each_row(V view, const brick_shape & brick, F && body) {
+    for (std::size_t i = 0; i < brick.extent[0]; ++i) {
+        for (std::size_t j = 0; j < brick.extent[1]; ++j) {
+            auto * row = &view(brick.origin[0] + i, brick.origin[1] + j, brick.origin[2]);
+            body(row, (i * brick.extent[1] + j) * brick.extent[2]);
+        }
+    }
+}
+
+/*
+ * Decoded values of a brick with a zero plane before its first row, column and layer, so the Lorenzo prediction
+ * (the corner completing the parallelepiped of the seven decoded neighbours) needs no tests at the brick faces.
+ */
+class lorenzo_grid {
+  public:
+    explicit lorenzo_grid(const brick_shape & brick) :
+        sj(brick.extent[2] + 1), si((brick.extent[1] + 1) * sj) {
+        std::fill_n(values, si * (brick.extent[0] + 1), 0.0f);
+    }
+
+    [[nodiscard]] std::size_t at(std::size_t i, std::size_t j, std::size_t k) const {
+        return (i + 1) * si + (j + 1) * sj + k + 1;
+    }
+    [[nodiscard]] double predict(std::size_t n) const {
+        const float * p = values + n;
+        return static_cast<double>(p[-si]) + p[-sj] + p[-1] - p[-si - sj] - p[-si - 1] - p[-sj - 1] + p[-si - sj - 1];
+    }
+
+    float values[(edge + 1) * (edge + 1) * (edge + 1)];
+
+  private:
+    std::size_t sj, si;
+};
+
+void shuffle(const std::uint32_t * codes, std::size_t count, std::byte * out) {
+    const auto * bytes = reinterpret_cast<const std::byte *>(codes);
+    for (std::size_t b = 0; b < 4; ++b) {
+        for (std::size_t n = 0; n < count; ++n) {
+            out[b * count + n] = bytes[4 * n + b];
+        }
+    }
+}
+
+void unshuffle(const std::byte * in, std::size_t count, std::uint32_t * codes) {
+    auto * bytes = reinterpret_cast<std::byte *>(codes);
+    for (std::size_t b = 0; b < 4; ++b) {
+        for (std::size_t n = 0; n < count; ++n) {
+            bytes[4 * n + b] = in[b * count + n];
+        }
+    }
+}
+
+// quantised residuals are mostly runs of small codes, for which run-length matching alone is faster and as good
+bool deflate_planes(const std::byte * in, std::size_t size, field_codec codec, Bytef * out, uLongf & out_size) {
+    z_stream stream{};
+    int      strategy = codec == field_codec::bounded ? Z_RLE : Z_DEFAULT_STRATEGY;
+    if (deflateInit2(&stream, 1, Z_DEFLATED, 15, 8, strategy) != Z_OK) {
+        return false;
+    }
+    stream.next_in   = reinterpret_cast<Bytef *>(const_cast<std::byte *>(in));
+    stream.avail_in  = static_cast<uInt>(size);
+    stream.next_out  = out;
+    stream.avail_out = static_cast<uInt>(out_size);
+    bool done        = deflate(&stream, Z_FINISH) == Z_STREAM_END;
+    out_size         = stream.total_out;
+    deflateEnd(&stream);
+    return done;
+}
+
+void encode_brick(const float *            values,
+                  const brick_shape &      brick,
+                  field_codec              codec,
+                  double                   bound,
+                  std::vector<std::byte> & out) {
+    const std::size_t count = brick.count();
+    std::uint32_t     codes[brick_values];
+    float             verbatim[brick_values];
+    std::size_t       verbatim_count = 0;
+
+    if (codec == field_codec::lossless) {
+        std::uint32_t previous = 0;
+        for (std::size_t n = 0; n < count; ++n) {
+            std::uint32_t bits;
+            std::memcpy(&bits, values + n, sizeof(bits));
+            codes[n] = bits - previous;
+            previous = bits;
+        }
+    } else {
+        // predictions are made from decoded values, exactly as the decoder will see them
+        lorenzo_grid decoded(brick);
+        const double step = 2.0 * bound;
+        std::size_t  n    = 0;
+        for (std::size_t i = 0; i < brick.extent[0]; ++i) {
+            for (std::size_t j = 0; j < brick.extent[1]; ++j) {
+                for (std::size_t k = 0; k < brick.extent[2]; ++k, ++n) {
+                    std::size_t at         = decoded.at(i, j, k);
+                    double      prediction = decoded.predict(at);
+                    double      q          = std::nearbyint((values[n] - prediction) / step);
+                    if (std::isfinite(values[n]) && std::abs(q) < max_quantum) {
+                        auto value = static_cast<float>(std::fma(q, step, prediction));
+                        if (std::abs(static_cast<double>(value) - values[n]) <= bound) {
+                            auto signed_q = static_cast<std::int32_t>(q);
+                            auto zigzag   = (static_cast<std::uint32_t>(signed_q) << 1) ^
+                                          static_cast<std::uint32_t>(signed_q >> 31);
+                            codes[n]      = zigzag + 1;
+                            decoded.values[at] = value;
+                            continue;
+                        }
+                    }
+                    codes[n]                   = 0;
+                    decoded.values[at]         = values[n];
+                    verbatim[verbatim_count++] = values[n];
+                }
+            }
+        }
+    }
+
+    std::byte shuffled[4 * brick_values];
+    shuffle(codes, count, shuffled);
+    uLongf deflated_size = compressBound(static_cast<uLong>(4 * count));
+    out.resize(header_bytes + deflated_size + verbatim_count * sizeof(float));
+    auto * deflated = reinterpret_cast<Bytef *>(out.data() + header_bytes);
+    if (deflate_planes(shuffled, 4 * count, codec, deflated, deflated_size) &&
+        deflated_size < 4 * count) {
+        out[0] = std::byte{ stored_deflated };
+    } else {
+        out[0]        = std::byte{ stored_raw };
+        deflated_size = static_cast<uLongf>(4 * count);
+        std::memcpy(out.data() + header_bytes, shuffled, 4 * count);
+    }
+    auto length = static_cast<std::uint32_t>(deflated_size);
+    std::memcpy(out.data() + 1, &length, sizeof(length));
+    std::memcpy(out.data() + header_bytes + length, verbatim, verbatim_count * sizeof(float));
+    out.resize(header_bytes + length + verbatim_count * sizeof(float));
+}
+
+void decode_brick(const std::byte * in, std::size_t size, const brick_shape & brick, field_codec codec, double bound,
+                  float * values) {
+    const std::size_t count = brick.count();
+    std::uint32_t     length;
+    if (size < header_bytes) {
+        throw std::runtime_error("compressed_field: truncated brick");
+    }
+    std::memcpy(&length, in + 1, sizeof(length));
+    if (header_bytes + length > size) {
+        throw std::runtime_error("compressed_field: truncated brick");
+    }
+
+    std::byte shuffled[4 * brick_values];
+    if (in[0] == std::byte{ stored_deflated }) {
+        uLongf inflated = static_cast<uLongf>(4 * count);
+        if (uncompress(reinterpret_cast<Bytef *>(shuffled), &inflated,
+                       reinterpret_cast<const Bytef *>(in + header_bytes), length) != Z_OK ||
+            inflated != 4 * count) {
+            throw std::runtime_error("compressed_field: corrupt deflate stream");
+        }
+    } else if (length == 4 * count) {
+        std::memcpy(shuffled, in + header_bytes, length);
+    } else {
+        throw std::runtime_error("compressed_field: corrupt brick header");
+    }
+    std::uint32_t codes[brick_values];
+    unshuffle(shuffled, count, codes);
+
+    if (codec == field_codec::lossless) {
+        std::uint32_t bits = 0;
+        for (std::size_t n = 0; n < count; ++n) {
+            bits += codes[n];
+            std::memcpy(values + n, &bits, sizeof(bits));
+        }
+        return;
+    }
+    const std::byte * verbatim = in + header_bytes + length;
+    const std::byte * end      = in + size;
+    const double      step     = 2.0 * bound;
+    lorenzo_grid      decoded(brick);
+    std::size_t       n        = 0;
+    for (std::size_t i = 0; i < brick.extent[0]; ++i) {
+        for (std::size_t j = 0; j < brick.extent[1]; ++j) {
+            for (std::size_t k = 0; k < brick.extent[2]; ++k, ++n) {
+                std::size_t at = decoded.at(i, j, k);
+                if (codes[n] == 0) {
+                    if (verbatim + sizeof(float) > end) {
+                        throw std::runtime_error("compressed_field: truncated brick");
+                    }
+                    std::memcpy(values + n, verbatim, sizeof(float));
+                    verbatim += sizeof(float);
+                } else {
+                    std::uint32_t zigzag = codes[n] - 1;
+                    auto          q      = static_cast<std::int32_t>((zigzag >> 1) ^ (0u - (zigzag & 1)));
+                    values[n]            = static_cast<float>(std::fma(q, step, decoded.predict(at)));
+                }
+                decoded.values[at] = values[n];
+            }
+        }
+    }
+}
+
+}  // namespace
+
+compressed_field::compressed_field(velm_DR::ndarray_view<const float, 3> field,
+                                   field_codec                           codec,
+                                   double                                error_bound,
+                                   velm_DR::thread_pool *                pool) :
+    kind(codec), bound(error_bound) {
+    if (codec == field_codec::bounded && !(error_bound > 0.0)) {
+        throw std::runtime_error("compressed_field: the bounded codec needs a positive error bound");
+    }
+    for (std::size_t a = 0; a < 3; ++a) {
+        shape[a]  = field.dims[a];
+        bricks[a] = (shape[a] + edge - 1) / edge;
+    }
+    const std::size_t                   brick_count = bricks[0] * bricks[1] * bricks[2];
+    std::vector<std::vector<std::byte>> encoded(brick_count);
+    velm_DR::thread_pool &              workers = pool != nullptr ? *pool : velm_DR::thread_pool::global();
+    workers.parallel_for(brick_count, 1, [&](std::size_t begin, std::size_t end) {
+        float values[brick_values];
+        for (std::size_t b = begin; b < end; ++b) {
+            brick_shape brick = brick_at(shape, bricks, b);
+            for_each_row(field, brick, [&](const float * row, std::size_t at) {
+                for (std::size_t k = 0; k < brick.extent[2]; ++k) {
+                    values[at + k] = row[k * field.strides[2]];
+                }
+            });
+            encode_brick(values, brick, kind, bound, encoded[b]);
+        }
+    });
+
+    offsets.resize(brick_count + 1);
+    for (std::size_t b = 0; b < brick_count; ++b) {
+        offsets[b + 1] = offsets[b] + encoded[b].size();
+    }
+    payload.resize(offsets[brick_count]);
+    workers.parallel_for(brick_count, 64, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t b = begin; b < end; ++b) {
+            std::copy(encoded[b].begin(), encoded[b].end(), payload.begin() + static_cast<std::ptrdiff_t>(offsets[b]));
+        }
+    });
+}
+
+void compressed_field::decode(velm_DR::ndarray_view<float, 3> out, velm_DR::thread_pool * pool) const {
+    for (std::size_t a = 0; a < 3; ++a) {
+        if (out.dims[a] != shape[a]) {
+            throw std::runtime_error("compressed_field: decode target does not have the field's shape");
+        }
+    }
+    velm_DR::thread_pool & workers = pool != nullptr ? *pool : velm_DR::thread_pool::global();
+    workers.parallel_for(offsets.empty() ? 0 : offsets.size() - 1, 1, [&](std::size_t begin, std::size_t end) {
+        float values[brick_values];
+        for (std::size_t b = begin; b < end; ++b) {
+            brick_shape brick = brick_at(shape, bricks, b);
+            decode_brick(payload.data() + offsets[b], offsets[b + 1] - offsets[b], brick, kind, bound, values);
+            for_each_row(out, brick, [&](float * row, std::size_t at) {
+                for (std::size_t k = 0; k < brick.extent[2]; ++k) {
+                    row[k * out.strides[2]] = values[at + k];
+                }
+            });
+        }
+    });
+}
+
+velm_DR::ndarray<float, 3> compressed_field::decode(velm_DR::thread_pool * pool) const {
+    velm_DR::ndarray<float, 3> out(velm_DR::uninitialized, shape[0], shape[1], shape[2]);
+    decode(out.view(), pool);
+    return out;
+}
+
+std::size_t compressed_field::compressed_bytes() const {
+    return payload.size() + offsets.size() * sizeof(std::size_t);
+}
+
+};  // namespace vlem
@@ -0,0 +1,138 @@
+#include "io/hdf5/chunk_codec.h"
+
+#include "hdf5.h"
+
+#if defined(VELM_HAVE_SZIP)
+// szlib.h has no C++ linkage guards of its own
+extern "C" {
+#    include <szlib.h>
+}
+#endif
+
+#include <cstring>
+#include <stdexcept>
+#include <zlib.h>
+
+namespace vlem {
+
+namespace {
+
+void inflate_chunk(std::vector<std::byte> & bytes, std::vector<std::byte> & scratch, std::size_t chunk_bytes) {
+    scratch.resize(chunk_bytes);
+    uLongf        size   = static_cast<uLongf>(chunk_bytes);
+    Bytef *       dst    = reinterpret_cast<Bytef *>(scratch.data());
+    const Bytef * src    = reinterpret_cast<const Bytef *>(bytes.data());
+    uLong         length = static_cast<uLong>(bytes.size());
+    if (uncompress(dst, &size, src, length) != Z_OK) {
+        throw std::runtime_error("decode_chunk: corrupt deflate stream");
+    }
+    scratch.resize(size);
+    bytes.swap(scratch);
+}
+
+void unshuffle_chunk(std::vector<std::byte> & bytes, std::vector<std::byte> & scratch, std::size_t element) {
+    if (element <= 1) {
+        return;
+    }
+    std::size_t count = bytes.size() / element;
+    scratch.resize(bytes.size());
+    // byte b of every element was stored contiguously in plane b
+    for (std::size_t b = 0; b < element; ++b) {
+        const std::byte * plane = bytes.data() + b * count;
+        for (std::size_t i = 0; i < count; ++i) {
+            scratch[i * element + b] = plane[i];
+        }
+    }
+    // trailing bytes that do not form a whole element are left untouched by the filter
+    std::memcpy(scratch.data() + count * element, bytes.data() + count * element, bytes.size() - count * element);
+    bytes.swap(scratch);
+}
+
+#if defined(VELM_HAVE_SZIP)
+void szip_decode_chunk(std::vector<std::byte> &      bytes,
+                       std::vector<std::byte> &      scratch,
+                       const std::vector<unsigned> & parameters) {
+    if (bytes.size() < 4 || parameters.size() < 4) {
+        throw std::runtime_error("decode_chunk: malformed szip chunk");
+    }
+    // the filter prefixes the stream with the decoded size as a little-endian 32-bit integer
+    std::size_t size = 0;
+    for (int i = 3; i >= 0; --i) {
+        size = (size << 8) | static_cast<std::size_t>(bytes[static_cast<std::size_t>(i)]);
+    }
+    SZ_com_t param;
+    param.options_mask        = static_cast<int>(parameters[H5Z_SZIP_PARM_MASK]);
+    param.bits_per_pixel      = static_cast<int>(parameters[H5Z_SZIP_PARM_BPP]);
+    param.pixels_per_block    = static_cast<int>(parameters[H5Z_SZIP_PARM_PPB]);
+    param.pixels_per_scanline = static_cast<int>(parameters[H5Z_SZIP_PARM_PPS]);
+    scratch.resize(size);
+    if (SZ_BufftoBuffDecompress(scratch.data(), &size, bytes.data() + 4, bytes.size() - 4, &param) != SZ_OK) {
+        throw std::runtime_error("decode_chunk: corrupt szip stream");
+    }
+    scratch.resize(size);
+    bytes.swap(scratch);
+}
+#endif
+
+bool is_supported(int filter) {
+    switch (filter) {
+        case H5Z_FILTER_DEFLATE:
+        case H5Z_FILTER_SHUFFLE:
+            return true;
+#if defined(VELM_HAVE_SZIP)
+        case H5Z_FILTER_SZIP:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+}  // namespace
+
+bool can_decode_chunks(const dataset_info & info) {
+    if (!info.is_chunked() || !info.native) {
+        return false;
+    }
+    for (const filter_info & filter : info.filters) {
+        if (!is_supported(filter.id)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void decode_chunk(const dataset_info &     info,
+                  std::uint32_t            filter_mask,
+                  std::vector<std::byte> & bytes,
+                  std::size_t              chunk_bytes) {
+    thread_local std::vector<std::byte> scratch;
+
+    // filters were applied in pipeline order on write, so undo them back to front
+    for (std::size_t i = info.filters.size(); i > 0; --i) {
+        if (filter_mask & (1u << (i - 1))) {
+            continue;
+        }
+        const filter_info & filter = info.filters[i - 1];
+        switch (filter.id) {
+            case H5Z_FILTER_DEFLATE:
+                inflate_chunk(bytes, scratch, chunk_bytes);
+                break;
+            case H5Z_FILTER_SHUFFLE:
+                unshuffle_chunk(bytes, scratch, velm_DR::dtype_size(info.type));
+                break;
+#if defined(VELM_HAVE_SZIP)
+            case H5Z_FILTER_SZIP:
+                szip_decode_chunk(bytes, scratch, filter.parameters);
+                break;
+#endif
+            default:
+                throw std::runtime_error("decode_chunk: unsupported filter");
+        }
+    }
+    if (bytes.size() != chunk_bytes) {
+        throw std::runtime_error("decode_chunk: decoded chunk has an unexpected size");
+    }
+}
+
+};  // namespace vlem
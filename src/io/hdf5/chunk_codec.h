@@ -0,0 +1,25 @@
+#pragma once
+
+#include "velm/io/hd5.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vlem {
+
+/*
+ * Undoes HDF5 chunk filters outside the library, so decompression can run on worker threads instead of inside the
+ * serialized HDF5 section. Supports deflate, shuffle and (when built against libaec/szip) szip.
+ */
+
+// true when every filter of the dataset can be undone here and the raw element type is native
+[[nodiscard]] bool can_decode_chunks(const dataset_info & info);
+
+// decodes a raw chunk from hdf5_file::read_chunk in place; on return `bytes` holds exactly `chunk_bytes`
+void decode_chunk(const dataset_info &     info,
+                  std::uint32_t            filter_mask,
+                  std::vector<std::byte> & bytes,
+                  std::size_t              chunk_bytes);
+
+};  // namespace vlem
@@ -1,4 +1,420 @@
+#include "velm/io/hd5.h"
+
 #include "H5Cpp.h"
+#include "velm/core/profiler.h"
+#include "velm/io/mapped_file.h"
 
-#include <iostream>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace vlem {
+
+namespace {
+
+// large enough for several compressed chunks, so partial region reads do not decompress a chunk twice
+constexpr std::size_t chunk_cache_bytes = std::size_t(64) << 20;
+constexpr std::size_t chunk_cache_slots = 12421;  // prime, as recommended by the HDF5 docs
+
+const H5::PredType & native_type(velm_DR::dtype type) {
+    switch (type) {
+        case velm_DR::dtype::int8:
+            return H5::PredType::NATIVE_INT8;
+        case velm_DR::dtype::uint8:
+            return H5::PredType::NATIVE_UINT8;
+        case velm_DR::dtype::int16:
+            return H5::PredType::NATIVE_INT16;
+        case velm_DR::dtype::uint16:
+            return H5::PredType::NATIVE_UINT16;
+        case velm_DR::dtype::int32:
+            return H5::PredType::NATIVE_INT32;
+        case velm_DR::dtype::uint32:
+            return H5::PredType::NATIVE_UINT32;
+        case velm_DR::dtype::int64:
+            return H5::PredType::NATIVE_INT64;
+        case velm_DR::dtype::uint64:
+            return H5::PredType::NATIVE_UINT64;
+        case velm_DR::dtype::float32:
+            return H5::PredType::NATIVE_FLOAT;
+        case velm_DR::dtype::float64:
+            return H5::PredType::NATIVE_DOUBLE;
+    }
+    return H5::PredType::NATIVE_FLOAT;
+}
+
+velm_DR::dtype dtype_of_file_type(const H5::DataType & type, const std::string & field) {
+    std::size_t size = type.getSize();
+    switch (type.getClass()) {
+        case H5T_FLOAT:
+            if (size == 4) {
+                return velm_DR::dtype::float32;
+            }
+            if (size == 8) {
+                return velm_DR::dtype::float64;
+            }
+            break;
+        case H5T_INTEGER:
+            {
+                bool is_signed = H5Tget_sign(type.getId()) == H5T_SGN_2;
+                switch (size) {
+                    case 1:
+                        return is_signed ? velm_DR::dtype::int8 : velm_DR::dtype::uint8;
+                    case 2:
+                        return is_signed ? velm_DR::dtype::int16 : velm_DR::dtype::uint16;
+                    case 4:
+                        return is_signed ? velm_DR::dtype::int32 : velm_DR::dtype::uint32;
+                    case 8:
+                        return is_signed ? velm_DR::dtype::int64 : velm_DR::dtype::uint64;
+                    default:
+                        break;
+                }
+                break;
+            }
+        default:
+            break;
+    }
+    throw std::runtime_error("hdf5_file: unsupported element type in " + field);
+}
+
+// guards every call into the HDF5 library, which is not built thread-safe by default
+std::recursive_mutex & library_mutex() {
+    static std::recursive_mutex mutex;
+    return mutex;
+}
+
+using library_lock = std::unique_lock<std::recursive_mutex>;
+
+library_lock lock_library() {
+    library_lock lock(library_mutex());
+    // errors surface as exceptions, keep HDF5 from printing its own stack on top. Thread-safe builds keep this
+    // setting per thread, so it is applied on the first call from every thread.
+    thread_local bool quiet = false;
+    if (!quiet) {
+        H5::Exception::dontPrint();
+        quiet = true;
+    }
+    return lock;
+}
+
+// runs an HDF5 call, translating library exceptions into the std::runtime_error the rest of Velm uses
+template <typename F> auto guarded(const std::string & what, F && f) -> decltype(f()) {
+    try {
+        return f();
+    } catch (const H5::Exception & e) {
+        throw std::runtime_error("hdf5_file: " + what + ": " + e.getDetailMsg());
+    }
+}
+
+}  // namespace
+
+struct hdf5_file::impl {
+    std::string               path;
+    access                    mode;
+    std::optional<H5::H5File> file;     // opened in place, H5File's copy assignment is deprecated
+    mapped_file               mapping;  // opened on first direct read
+
+    std::unordered_map<std::string, H5::DataSet>  datasets;
+    std::unordered_map<std::string, dataset_info> infos;
+
+    H5::DataSet & dataset(const std::string & field) {
+        auto it = datasets.find(field);
+        if (it != datasets.end()) {
+            return it->second;
+        }
+        H5::DSetAccPropList dapl;
+        dapl.setChunkCache(chunk_cache_slots, chunk_cache_bytes, 1.0);
+        H5::DataSet ds = guarded(field, [&] { return file->openDataSet(field.c_str(), dapl); });
+        return datasets.emplace(field, std::move(ds)).first->second;
+    }
+
+    const dataset_info & info(const std::string & field) {
+        auto it = infos.find(field);
+        if (it != infos.end()) {
+            return it->second;
+        }
+        H5::DataSet & ds = dataset(field);
+        dataset_info  meta;
+        guarded(field, [&] {
+            H5::DataSpace        space = ds.getSpace();
+            int                  rank  = space.getSimpleExtentNdims();
+            std::vector<hsize_t> dims(static_cast<std::size_t>(rank));
+            space.getSimpleExtentDims(dims.data());
+            meta.dims.assign(dims.begin(), dims.end());
+
+            H5::DataType type = ds.getDataType();
+            meta.type         = dtype_of_file_type(type, field);
+            meta.native       = type == native_type(meta.type);
+
+            H5::DSetCreatPropList dcpl = ds.getCreatePlist();
+            for (int i = 0; i < dcpl.getNfilters(); ++i) {
+                filter_info  filter;
+                unsigned int flags  = 0;
+                unsigned int config = 0;
+                std::size_t  count  = 8;
+                char         name[64];
+                filter.parameters.resize(count);
+                filter.id = dcpl.getFilter(i, flags, count, filter.parameters.data(), sizeof(name), name, config);
+                filter.parameters.resize(count < filter.parameters.size() ? count : filter.parameters.size());
+                meta.filters.push_back(std::move(filter));
+            }
+            meta.filtered = !meta.filters.empty();
+            // unwritten storage reads back as the fill value, converted to the in-memory type like H5Dread does.
+            // Without a defined fill value H5Dread leaves the buffer untouched, zero stands in for it here.
+            H5D_fill_value_t fill_state = H5D_FILL_VALUE_UNDEFINED;
+            if (H5Pfill_value_defined(dcpl.getId(), &fill_state) >= 0 && fill_state != H5D_FILL_VALUE_UNDEFINED &&
+                H5Pget_fill_value(dcpl.getId(), native_type(meta.type).getId(), meta.fill_value.data()) < 0) {
+                throw std::runtime_error("hdf5_file: cannot read the fill value of " + field);
+            }
+            if (dcpl.getLayout() == H5D_CHUNKED) {
+                std::vector<hsize_t> chunk(static_cast<std::size_t>(rank));
+                dcpl.getChunk(rank, chunk.data());
+                meta.chunk_dims.assign(chunk.begin(), chunk.end());
+            } else if (dcpl.getLayout() == H5D_CONTIGUOUS) {
+                // HADDR_UNDEF until the data has been written
+                haddr_t offset = H5Dget_offset(ds.getId());
+                if (offset != HADDR_UNDEF) {
+                    meta.file_offset = offset;
+                }
+            }
+        });
+        return infos.emplace(field, std::move(meta)).first->second;
+    }
+
+    // start of a direct dataset in the mapping. The offset comes from the file itself, so a truncated or corrupt
+    // file whose payload would run past the end of the mapping is rejected here instead of faulting on the copy.
+    const std::byte * payload(const std::string & field, const dataset_info & meta) {
+        if (!mapping.is_open()) {
+            // flush so that everything HDF5 buffered is visible through the mapping
+            guarded(path, [&] { file->flush(H5F_SCOPE_LOCAL); });
+            mapping = mapped_file(path);
+        }
+        std::size_t bytes = velm_DR::dtype_size(meta.type);
+        bool        fits  = meta.file_offset <= mapping.size();
+        for (std::size_t d : meta.dims) {
+            fits  = fits && (d == 0 || bytes <= std::numeric_limits<std::size_t>::max() / d);
+            bytes = fits ? bytes * d : 0;
+        }
+        if (!fits || bytes > mapping.size() - meta.file_offset) {
+            throw std::runtime_error("hdf5_file: " + field + " extends past the end of " + path);
+        }
+        return mapping.data() + meta.file_offset;
+    }
+};
+
+hdf5_file::hdf5_file(const std::string & path, access mode) : state(std::make_unique<impl>()) {
+    library_lock lock = lock_library();
+    state->path = path;
+    state->mode = mode;
+    guarded(path, [&] { state->file.emplace(path.c_str(), mode == access::read ? H5F_ACC_RDONLY : H5F_ACC_TRUNC); });
+}
+
+hdf5_file::~hdf5_file() {
+    // closing the file and its cached datasets calls into HDF5 as well
+    library_lock lock = lock_library();
+    state.reset();
+}
+
+hdf5_file::hdf5_file(hdf5_file && other) noexcept = default;
+
+hdf5_file & hdf5_file::operator=(hdf5_file && other) noexcept {
+    library_lock lock = lock_library();
+    state = std::move(other.state);
+    return *this;
+}
+
+const std::string & hdf5_file::path() const {
+    return state->path;
+}
+
+bool hdf5_file::has_dataset(const char * field) const {
+    library_lock lock = lock_library();
+    // H5Lexists needs every intermediate group to exist, so walk the path one component at a time
+    std::string path(field);
+    if (path.empty()) {
+        return false;
+    }
+    std::size_t pos = path.front() == '/' ? 1 : 0;
+    while (true) {
+        std::size_t next   = path.find('/', pos);
+        std::string prefix = path.substr(0, next);
+        if (H5Lexists(state->file->getId(), prefix.c_str(), H5P_DEFAULT) <= 0) {
+            return false;
+        }
+        if (next == std::string::npos) {
+            break;
+        }
+        pos = next + 1;
+    }
+    try {
+        return state->file->childObjType(field) == H5O_TYPE_DATASET;
+    } catch (const H5::Exception &) {
+        return false;
+    }
+}
+
+dataset_info hdf5_file::info(const char * field) const {
+    library_lock lock = lock_library();
+    return state->info(field);
+}
+
+void hdf5_file::check_shape(const char * field, velm_DR::dtype type, std::size_t rank, std::size_t * dims) const {
+    library_lock         lock = lock_library();
+    const dataset_info & meta = state->info(field);
+    if (meta.dims.size() != rank) {
+        throw std::runtime_error(std::string("hdf5_file: rank mismatch for ") + field);
+    }
+    if (meta.type != type) {
+        throw std::runtime_error(std::string("hdf5_file: element type mismatch for ") + field);
+    }
+    for (std::size_t i = 0; i < rank; ++i) {
+        dims[i] = meta.dims[i];
+    }
+}
+
+void hdf5_file::read_raw(const char *        field,
+                         velm_DR::dtype      type,
+                         std::size_t         rank,
+                         const std::size_t * begin,
+                         const std::size_t * count,
+                         void *              dst) {
+    VELM_PROFILE_ZONE("hdf5.read", "io");
+    library_lock             lock = lock_library();
+    std::vector<std::size_t> dims(rank);
+    check_shape(field, type, rank, dims.data());
+    std::size_t total = 1;
+    for (std::size_t i = 0; i < rank; ++i) {
+        if (begin[i] + count[i] > dims[i]) {
+            throw std::runtime_error(std::string("hdf5_file: region out of bounds for ") + field);
+        }
+        total *= count[i];
+    }
+    if (total == 0) {
+        return;
+    }
+
+    const dataset_info & meta = state->info(field);
+    if (meta.is_direct() && state->mode == access::read) {
+        // copy straight out of the page cache: the largest trailing block of whole rows is one memcpy
+        std::size_t element = velm_DR::dtype_size(type);
+        std::size_t axis    = rank - 1;
+        std::size_t run     = count[axis];
+        while (axis > 0 && count[axis] == dims[axis]) {
+            --axis;
+            run *= count[axis];
+        }
+        std::vector<std::size_t> strides(rank);
+        strides[rank - 1] = 1;
+        for (std::size_t i = rank - 1; i > 0; --i) {
+            strides[i - 1] = strides[i] * dims[i];
+        }
+        const std::byte *        src = state->payload(field, meta);
+        std::byte *              out = static_cast<std::byte *>(dst);
+        std::vector<std::size_t> index(rank, 0);
+        // the mapping is stable from here on, copies from several threads may run concurrently
+        lock.unlock();
+        for (std::size_t copied = 0; copied < total; copied += run) {
+            std::size_t offset = 0;
+            for (std::size_t i = 0; i < rank; ++i) {
+                offset += (begin[i] + index[i]) * strides[i];
+            }
+            std::memcpy(out, src + offset * element, run * element);
+            out += run * element;
+            // advance the odometer over the axes slower than the run
+            for (std::size_t i = axis; i > 0; --i) {
+                if (++index[i - 1] < count[i - 1]) {
+                    break;
+                }
+                index[i - 1] = 0;
+            }
+        }
+        return;
+    }
+
+    guarded(field, [&] {
+        H5::DataSet &        ds = state->dataset(field);
+        std::vector<hsize_t> offset(begin, begin + rank);
+        std::vector<hsize_t> extent(count, count + rank);
+        H5::DataSpace        file_space = ds.getSpace();
+        file_space.selectHyperslab(H5S_SELECT_SET, extent.data(), offset.data());
+        H5::DataSpace memory_space(static_cast<int>(rank), extent.data());
+        ds.read(dst, native_type(type), memory_space, file_space);
+    });
+}
+
+const void * hdf5_file::map_raw(const char * field) {
+    library_lock         lock = lock_library();
+    const dataset_info & meta = state->info(field);
+    if (!meta.is_direct() || state->mode != access::read) {
+        throw std::runtime_error(std::string("hdf5_file: dataset cannot be mapped directly: ") + field);
+    }
+    return state->payload(field, meta);
+}
+
+void hdf5_file::write_raw(const char *        field,
+                          velm_DR::dtype      type,
+                          std::size_t         rank,
+                          const std::size_t * dims,
+                          const std::size_t * chunk_dims,
+                          int                 gzip_level,
+                          const void *        src) {
+    VELM_PROFILE_ZONE("hdf5.write", "io");
+    library_lock lock = lock_library();
+    if (gzip_level > 0 && chunk_dims == nullptr) {
+        throw std::runtime_error(std::string("hdf5_file: compression requires a chunked layout for ") + field);
+    }
+    guarded(field, [&] {
+        std::vector<hsize_t>  extent(dims, dims + rank);
+        H5::DataSpace         space(static_cast<int>(rank), extent.data());
+        H5::DSetCreatPropList dcpl;
+        if (chunk_dims != nullptr) {
+            std::vector<hsize_t> chunk(chunk_dims, chunk_dims + rank);
+            dcpl.setChunk(static_cast<int>(rank), chunk.data());
+            if (gzip_level > 0) {
+                dcpl.setDeflate(gzip_level);
+            }
+        }
+        H5::LinkCreatPropList lcpl;
+        lcpl.setCreateIntermediateGroup(true);
+        H5::DataSet ds =
+            state->file->createDataSet(field, native_type(type), space, dcpl, H5::DSetAccPropList::DEFAULT, lcpl);
+        ds.write(src, native_type(type));
+    });
+    state->datasets.erase(field);
+    state->infos.erase(field);
+}
+
+std::uint32_t hdf5_file::read_chunk(const char *             field,
+                                    const std::size_t *      chunk_origin,
+                                    std::vector<std::byte> & bytes) {
+    VELM_PROFILE_ZONE("hdf5.read_chunk", "io");
+    library_lock lock = lock_library();
+    return guarded(field, [&] {
+        H5::DataSet &        ds      = state->dataset(field);
+        std::size_t          rank    = state->info(field).dims.size();
+        hsize_t              stored  = 0;
+        haddr_t              address = HADDR_UNDEF;
+        unsigned             filters = 0;
+        std::vector<hsize_t> offset(chunk_origin, chunk_origin + rank);
+        // asks the chunk index rather than H5Dget_chunk_storage_size, which counts an unwritten chunk as stored
+        // once an earlier H5Dread has put its fill-value copy into the chunk cache
+        if (H5Dget_chunk_info_by_coord(ds.getId(), offset.data(), &filters, &address, &stored) < 0) {
+            throw std::runtime_error(std::string("hdf5_file: cannot locate chunk of ") + field);
+        }
+        if (address == HADDR_UNDEF || stored == 0) {
+            bytes.clear();
+            return std::uint32_t(0);
+        }
+        bytes.resize(static_cast<std::size_t>(stored));
+        std::uint32_t mask = 0;
+        if (H5Dread_chunk(ds.getId(), H5P_DEFAULT, offset.data(), &mask, bytes.data()) < 0) {
+            throw std::runtime_error(std::string("hdf5_file: cannot read chunk of ") + field);
+        }
+        return mask;
+    });
+}
+
+};  // namespace vlem
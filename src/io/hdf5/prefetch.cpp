@@ -0,0 +1,261 @@
+#include "velm/io/prefetch.h"
+
+#include "io/hdf5/chunk_codec.h"
+#include "velm/core/profiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace vlem {
+
+namespace {
+
+// contiguous datasets are copied in slabs of roughly this size, one task each
+constexpr std::size_t copy_slab_bytes = std::size_t(4) << 20;
+
+}  // namespace
+
+struct field_prefetcher::pending {
+    timestep_frame           frame;
+    std::size_t              generation = 0;
+    std::atomic<std::size_t> outstanding{ 1 };  // the reader holds one reference until every task is issued
+    bool                     ready     = false;  // guarded by field_prefetcher::mutex
+    bool                     discarded = false;  // dropped by seek() before it finished; guarded by the mutex
+    std::exception_ptr       error;              // guarded by field_prefetcher::mutex
+};
+
+field_prefetcher::field_prefetcher(hdf5_file &              file,
+                                   std::vector<std::string> fields,
+                                   std::size_t              first_step,
+                                   std::size_t              end_step,
+                                   dataset_path             path) :
+    field_prefetcher(file, std::move(fields), first_step, end_step, std::move(path), options()) {}
+
+field_prefetcher::field_prefetcher(hdf5_file &              file,
+                                   std::vector<std::string> fields,
+                                   std::size_t              first_step,
+                                   std::size_t              end_step,
+                                   dataset_path             path,
+                                   options                  opts) :
+    file(file),
+    fields(std::move(fields)),
+    end_step(end_step),
+    path(std::move(path)),
+    opts(opts),
+    cursor(first_step) {
+    this->opts.depth = std::max<std::size_t>(this->opts.depth, 1);
+    std::size_t threads =
+        opts.decode_threads != 0 ? opts.decode_threads : std::max(1u, std::thread::hardware_concurrency());
+    workers = std::make_unique<velm_DR::thread_pool>(threads);
+    reader  = std::thread([this] { reader_loop(); });
+}
+
+field_prefetcher::~field_prefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        ++generation;
+    }
+    changed.notify_all();
+    reader.join();
+    workers.reset();
+}
+
+std::optional<timestep_frame> field_prefetcher::next() {
+    std::unique_lock<std::mutex> lock(mutex);
+    {
+        // time the consumer spends waiting on the pipeline, the stall seen during playback
+        VELM_PROFILE_ZONE("prefetch.wait", "io");
+        changed.wait(lock, [this] {
+            return (!in_flight.empty() && in_flight.front()->ready) || (in_flight.empty() && cursor >= end_step);
+        });
+    }
+    if (in_flight.empty()) {
+        return std::nullopt;
+    }
+    std::shared_ptr<pending> front = std::move(in_flight.front());
+    in_flight.pop_front();
+    lock.unlock();
+    // a slot became free, let the reader start on the next timestep
+    changed.notify_all();
+
+    if (front->error) {
+        std::rethrow_exception(front->error);
+    }
+    return std::move(front->frame);
+}
+
+void field_prefetcher::seek(std::size_t step) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // frames still decoding keep their own storage alive and are never handed out, but they count against
+        // the depth until their last task finishes, so scrubbing cannot pile up frames
+        for (const std::shared_ptr<pending> & frame : in_flight) {
+            if (!frame->ready) {
+                frame->discarded = true;
+                ++discarded_in_flight;
+            }
+        }
+        in_flight.clear();
+        cursor = step;
+        ++generation;
+    }
+    changed.notify_all();
+}
+
+void field_prefetcher::reader_loop() {
+    velm_DR::profiler::global().name_thread("prefetch reader");
+    while (true) {
+        std::shared_ptr<pending> frame = std::make_shared<pending>();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [this] { return stopping || (cursor < end_step && frames_held() < opts.depth); });
+            if (stopping) {
+                return;
+            }
+            frame->frame.step = cursor++;
+            frame->generation = generation;
+            in_flight.push_back(frame);
+        }
+        try {
+            load(frame);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            frame->error = std::current_exception();
+        }
+        complete(frame);
+    }
+}
+
+void field_prefetcher::load(const std::shared_ptr<pending> & frame) {
+    VELM_PROFILE_ZONE("prefetch.load", "io");
+    // tasks hold references to the arrays, so the vector must never reallocate
+    frame->frame.fields.reserve(fields.size());
+    for (const std::string & field : fields) {
+        if (frame->generation != generation) {
+            // superseded by a seek, stop issuing reads for it
+            return;
+        }
+        std::string  dataset = path(frame->frame.step, field);
+        dataset_info info    = file.info(dataset.c_str());
+        if (info.dims.size() != 3 || info.type != velm_DR::dtype::float32) {
+            throw std::runtime_error("field_prefetcher: " + dataset + " is not a 3D float32 dataset");
+        }
+        std::size_t dims[3] = { info.dims[0], info.dims[1], info.dims[2] };
+        frame->frame.fields.emplace_back(velm_DR::uninitialized, dims);
+        velm_DR::ndarray<float, 3> & target = frame->frame.fields.back();
+
+        if (info.is_direct()) {
+            // metadata is read here, the copies out of the mapping run concurrently on the workers
+            std::size_t plane = dims[1] * dims[2] * sizeof(float);
+            std::size_t rows  = std::max<std::size_t>(1, copy_slab_bytes / std::max<std::size_t>(plane, 1));
+            for (std::size_t x = 0; x < dims[0]; x += rows) {
+                std::size_t count = std::min(rows, dims[0] - x);
+                dispatch(frame, [this, dataset, &target, x, count] {
+                    std::size_t begin[3]  = { x, 0, 0 };
+                    std::size_t extent[3] = { count, target.dims[1], target.dims[2] };
+                    file.read_region<float, 3>(dataset.c_str(), begin, target.subarray(begin, extent));
+                });
+            }
+        } else if (can_decode_chunks(info)) {
+            load_chunked(frame, dataset, info, target);
+        } else {
+            // filters we cannot undo ourselves, let HDF5 decode them inside the serialized section
+            std::size_t begin[3] = { 0, 0, 0 };
+            file.read_region<float, 3>(dataset.c_str(), begin, target.view());
+        }
+    }
+}
+
+void field_prefetcher::load_chunked(const std::shared_ptr<pending> & frame,
+                                    const std::string &               dataset,
+                                    const dataset_info &              info,
+                                    velm_DR::ndarray<float, 3> &      target) {
+    const std::size_t chunk[3]    = { info.chunk_dims[0], info.chunk_dims[1], info.chunk_dims[2] };
+    const std::size_t chunk_bytes = chunk[0] * chunk[1] * chunk[2] * sizeof(float);
+    auto              layout      = std::make_shared<const dataset_info>(info);
+
+    for (std::size_t x = 0; x < target.dims[0]; x += chunk[0]) {
+        for (std::size_t y = 0; y < target.dims[1]; y += chunk[1]) {
+            for (std::size_t z = 0; z < target.dims[2]; z += chunk[2]) {
+                if (frame->generation != generation) {
+                    return;
+                }
+                std::size_t            origin[3] = { x, y, z };
+                std::vector<std::byte> raw;
+                std::uint32_t          mask = file.read_chunk(dataset.c_str(), origin, raw);
+
+                auto decode = [&target, layout, raw = std::move(raw), mask, origin, chunk, chunk_bytes]() mutable {
+                    std::size_t x         = origin[0];
+                    std::size_t y         = origin[1];
+                    std::size_t z         = origin[2];
+                    std::size_t extent[3] = { std::min(chunk[0], target.dims[0] - x),
+                                              std::min(chunk[1], target.dims[1] - y),
+                                              std::min(chunk[2], target.dims[2] - z) };
+                    if (raw.empty()) {
+                        // never written: H5Dread would return the dataset's fill value
+                        float fill;
+                        std::memcpy(&fill, layout->fill_value.data(), sizeof(fill));
+                        for (std::size_t i = 0; i < extent[0]; ++i) {
+                            for (std::size_t j = 0; j < extent[1]; ++j) {
+                                std::fill_n(&target(x + i, y + j, z), extent[2], fill);
+                            }
+                        }
+                        return;
+                    }
+                    decode_chunk(*layout, mask, raw, chunk_bytes);
+                    // chunks are stored at full size even where they overhang the dataset edge
+                    const float * src = reinterpret_cast<const float *>(raw.data());
+                    for (std::size_t i = 0; i < extent[0]; ++i) {
+                        for (std::size_t j = 0; j < extent[1]; ++j) {
+                            std::memcpy(&target(x + i, y + j, z), src + (i * chunk[1] + j) * chunk[2],
+                                        extent[2] * sizeof(float));
+                        }
+                    }
+                };
+                dispatch(frame, std::move(decode));
+            }
+        }
+    }
+}
+
+void field_prefetcher::dispatch(const std::shared_ptr<pending> & frame, std::function<void()> task) {
+    frame->outstanding.fetch_add(1);
+    (void) workers->submit([this, frame, task = std::move(task)] {
+        try {
+            VELM_PROFILE_ZONE("prefetch.decode", "io");
+            task();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!frame->error) {
+                frame->error = std::current_exception();
+            }
+        }
+        complete(frame);
+    });
+}
+
+void field_prefetcher::complete(const std::shared_ptr<pending> & frame) {
+    if (frame->outstanding.fetch_sub(1) == 1) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            frame->ready = true;
+            if (frame->discarded) {
+                --discarded_in_flight;
+            }
+        }
+        changed.notify_all();
+    }
+}
+
+std::size_t field_prefetcher::frames_in_flight() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return frames_held();
+}
+
+std::size_t field_prefetcher::frames_held() const {
+    return in_flight.size() + discarded_in_flight;
+}
+
+};  // namespace vlem
@@ -0,0 +1,125 @@
+#include "velm/io/mapped_file.h"
+
+#if defined(_WIN32)
+#    define WIN32_LEAN_AND_MEAN
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+#include <stdexcept>
+#include <utility>
+
+namespace vlem {
+
+mapped_file::mapped_file(const std::string & path) {
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("mapped_file: cannot open " + path);
+    }
+    LARGE_INTEGER file_size;
+    GetFileSizeEx(file, &file_size);
+    length = static_cast<std::size_t>(file_size.QuadPart);
+    if (length == 0) {
+        CloseHandle(file);
+        throw std::runtime_error("mapped_file: empty file " + path);
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        throw std::runtime_error("mapped_file: cannot map " + path);
+    }
+    base           = static_cast<const std::byte *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    file_handle    = file;
+    mapping_handle = mapping;
+    if (base == nullptr) {
+        unmap();
+        throw std::runtime_error("mapped_file: cannot map " + path);
+    }
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("mapped_file: cannot open " + path);
+    }
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        throw std::runtime_error("mapped_file: cannot stat or empty file " + path);
+    }
+    length   = static_cast<std::size_t>(st.st_size);
+    void * p = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    // the mapping keeps its own reference to the file
+    close(fd);
+    if (p == MAP_FAILED) {
+        length = 0;
+        throw std::runtime_error("mapped_file: cannot map " + path);
+    }
+    base = static_cast<const std::byte *>(p);
+#endif
+}
+
+mapped_file::~mapped_file() {
+    unmap();
+}
+
+mapped_file::mapped_file(mapped_file && other) noexcept {
+    *this = std::move(other);
+}
+
+mapped_file & mapped_file::operator=(mapped_file && other) noexcept {
+    if (this != &other) {
+        unmap();
+        base   = std::exchange(other.base, nullptr);
+        length = std::exchange(other.length, 0);
+#if defined(_WIN32)
+        file_handle    = std::exchange(other.file_handle, nullptr);
+        mapping_handle = std::exchange(other.mapping_handle, nullptr);
+#endif
+    }
+    return *this;
+}
+
+void mapped_file::prefetch(std::size_t offset, std::size_t bytes) const {
+#if defined(_WIN32)
+    (void) offset;
+    (void) bytes;
+#else
+    if (base == nullptr || offset >= length) {
+        return;
+    }
+    // madvise wants a page-aligned start
+    std::size_t page  = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    std::size_t start = offset / page * page;
+    std::size_t end   = offset + bytes < length ? offset + bytes : length;
+    madvise(const_cast<std::byte *>(base) + start, end - start, MADV_WILLNEED);
+#endif
+}
+
+void mapped_file::unmap() noexcept {
+#if defined(_WIN32)
+    if (base != nullptr) {
+        UnmapViewOfFile(base);
+    }
+    if (mapping_handle != nullptr) {
+        CloseHandle(mapping_handle);
+    }
+    if (file_handle != nullptr) {
+        CloseHandle(file_handle);
+    }
+    file_handle    = nullptr;
+    mapping_handle = nullptr;
+#else
+    if (base != nullptr) {
+        munmap(const_cast<std::byte *>(base), length);
+    }
+#endif
+    base   = nullptr;
+    length = 0;
+}
+
+};  // namespace vlem
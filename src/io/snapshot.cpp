@@ -0,0 +1,395 @@
+#include "velm/io/snapshot.h"
+
+#include "velm/core/profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <limits>
+#include <utility>
+
+namespace vlem {
+
+namespace {
+
+constexpr char          magic[8] = { 'V', 'E', 'L', 'M', 'S', 'N', 'A', 'P' };
+constexpr std::uint32_t version  = 1;
+
+constexpr std::size_t max_name = 119;
+
+// the first bytes of the file; the rest of the first 4 KiB is zero
+struct file_header {
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t field_count;
+    std::uint64_t table_offset;
+};
+
+// one entry of the field table, as stored
+struct field_record {
+    char          name[max_name + 1];
+    std::uint8_t  type;
+    std::uint8_t  rank;
+    std::uint8_t  layout;
+    std::uint8_t  order;
+    std::uint32_t brick_edge;
+    std::uint64_t dims[snapshot_max_rank];
+    std::uint64_t strides[snapshot_max_rank];
+    std::uint64_t offset;
+    std::uint64_t bytes;
+};
+
+static_assert(sizeof(file_header) == 24 && sizeof(field_record) == 272, "snapshot records must not be padded");
+
+// a * b and a + b for sizes read from the table, false instead of wrapping around when they do not fit
+bool mul_fits(std::uint64_t a, std::uint64_t b, std::uint64_t & product) {
+    if (b != 0 && a > std::numeric_limits<std::uint64_t>::max() / b) {
+        return false;
+    }
+    product = a * b;
+    return true;
+}
+
+bool add_fits(std::uint64_t a, std::uint64_t b, std::uint64_t & sum) {
+    if (a > std::numeric_limits<std::uint64_t>::max() - b) {
+        return false;
+    }
+    sum = a + b;
+    return true;
+}
+
+std::uint64_t align_up(std::uint64_t offset) {
+    return (offset + snapshot_alignment - 1) / snapshot_alignment * snapshot_alignment;
+}
+
+// largest slab of whole rows along the first axis that stays within `budget` bytes, at least one row
+std::size_t slab_rows(const std::vector<std::size_t> & dims, std::size_t element_size, std::size_t budget) {
+    std::size_t row_bytes = element_size;
+    for (std::size_t i = 1; i < dims.size(); ++i) {
+        row_bytes *= dims[i];
+    }
+    return std::max<std::size_t>(1, budget / std::max<std::size_t>(1, row_bytes));
+}
+
+template <typename T, std::size_t N>
+void convert_dataset(hdf5_file & file, const std::string & dataset, const dataset_info & info, snapshot_writer & out) {
+    constexpr std::size_t slab_budget = std::size_t(64) << 20;
+
+    out.begin_field(dataset, info.type, info.dims);
+    std::size_t rows = std::min(slab_rows(info.dims, sizeof(T), slab_budget), info.dims[0]);
+    std::size_t dims[N], strides[N];
+    std::size_t slab_elements = rows;
+    for (std::size_t i = 1; i < N; ++i) {
+        dims[i] = info.dims[i];
+        slab_elements *= dims[i];
+    }
+    std::vector<T> staging(slab_elements);
+    for (std::size_t row = 0; row < info.dims[0]; row += rows) {
+        dims[0]        = std::min(rows, info.dims[0] - row);
+        strides[N - 1] = 1;
+        for (std::size_t i = N - 1; i > 0; --i) {
+            strides[i - 1] = strides[i] * dims[i];
+        }
+        std::size_t begin[N] = { row };
+        file.read_region<T, N>(dataset.c_str(), begin, velm_DR::ndarray_view<T, N>(staging.data(), dims, strides));
+        out.append(staging.data(), dims[0] * strides[0] * sizeof(T));
+    }
+    out.end_field();
+}
+
+template <typename T>
+void convert_dataset(hdf5_file & file, const std::string & dataset, const dataset_info & info, snapshot_writer & out) {
+    switch (info.dims.size()) {
+        case 1:
+            return convert_dataset<T, 1>(file, dataset, info, out);
+        case 2:
+            return convert_dataset<T, 2>(file, dataset, info, out);
+        case 3:
+            return convert_dataset<T, 3>(file, dataset, info, out);
+        case 4:
+            return convert_dataset<T, 4>(file, dataset, info, out);
+        default:
+            throw std::runtime_error("convert_to_snapshot: " + dataset + " has an unsupported rank");
+    }
+}
+
+}  // namespace
+
+snapshot_writer::snapshot_writer(const std::string & path) :
+    file_path(path), out(path, std::ios::binary | std::ios::trunc) {
+    if (!out) {
+        throw std::runtime_error("snapshot_writer: cannot create " + path);
+    }
+    // placeholder header; finish() fills it in
+    std::array<char, snapshot_alignment> zeros{};
+    out.write(zeros.data(), zeros.size());
+}
+
+snapshot_writer::~snapshot_writer() {
+    if (!finished) {
+        // the header is still zero, so the file would not open anyway; do not leave it behind
+        out.close();
+        std::error_code ignored;
+        std::filesystem::remove(file_path, ignored);
+    }
+}
+
+void snapshot_writer::begin_field(const std::string &              name,
+                                  velm_DR::dtype                   type,
+                                  const std::vector<std::size_t> & dims) {
+    snapshot_field field;
+    field.name = name;
+    field.type = type;
+    field.dims = dims;
+    field.strides.resize(dims.size());
+    std::size_t stride = 1;
+    for (std::size_t i = dims.size(); i > 0; --i) {
+        field.strides[i - 1] = stride;
+        stride *= dims[i - 1];
+    }
+    open_field(std::move(field));
+}
+
+void snapshot_writer::open_field(snapshot_field field) {
+    if (finished || field_open) {
+        throw std::runtime_error("snapshot_writer: cannot add " + field.name +
+                                 " while another field is open or after finish()");
+    }
+    if (field.name.empty() || field.name.size() > max_name) {
+        throw std::runtime_error("snapshot_writer: field names must have 1 to " + std::to_string(max_name) +
+                                 " characters");
+    }
+    if (field.dims.empty() || field.dims.size() > snapshot_max_rank) {
+        throw std::runtime_error("snapshot_writer: " + field.name + " has an unsupported rank");
+    }
+    auto same_name = [&](const snapshot_field & other) { return other.name == field.name; };
+    if (std::any_of(table.begin(), table.end(), same_name)) {
+        throw std::runtime_error("snapshot_writer: " + field.name + " was already added");
+    }
+    // pad to the next boundary; the file ends at `end` after every field
+    std::array<char, snapshot_alignment> zeros{};
+    std::uint64_t                        start = align_up(end);
+    out.write(zeros.data(), static_cast<std::streamsize>(start - end));
+    field.offset = start;
+    field.bytes  = 0;
+    end          = start;
+    table.push_back(std::move(field));
+    field_open = true;
+}
+
+void snapshot_writer::append(const void * bytes, std::size_t size) {
+    if (!field_open) {
+        throw std::runtime_error("snapshot_writer: append without an open field");
+    }
+    out.write(static_cast<const char *>(bytes), static_cast<std::streamsize>(size));
+    if (!out) {
+        throw std::runtime_error("snapshot_writer: cannot write to " + file_path);
+    }
+    table.back().bytes += size;
+    end += size;
+}
+
+void snapshot_writer::end_field() {
+    if (!field_open) {
+        throw std::runtime_error("snapshot_writer: end_field without an open field");
+    }
+    field_open                   = false;
+    const snapshot_field & field = table.back();
+    if (field.layout == snapshot_layout::linear) {
+        std::uint64_t expected = velm_DR::dtype_size(field.type);
+        for (std::size_t d : field.dims) {
+            expected *= d;
+        }
+        if (field.bytes != expected) {
+            throw std::runtime_error("snapshot_writer: " + field.name + " got " + std::to_string(field.bytes) +
+                                     " bytes instead of " + std::to_string(expected));
+        }
+    }
+}
+
+void snapshot_writer::finish() {
+    if (finished) {
+        return;
+    }
+    if (field_open) {
+        throw std::runtime_error("snapshot_writer: finish with a field still open");
+    }
+    finished = true;
+
+    std::vector<field_record> records(table.size());
+    for (std::size_t f = 0; f < table.size(); ++f) {
+        const snapshot_field & field  = table[f];
+        field_record &         record = records[f];
+        record                        = {};
+        std::memcpy(record.name, field.name.data(), field.name.size());
+        record.type       = static_cast<std::uint8_t>(field.type);
+        record.rank       = static_cast<std::uint8_t>(field.dims.size());
+        record.layout     = static_cast<std::uint8_t>(field.layout);
+        record.order      = static_cast<std::uint8_t>(field.order);
+        record.brick_edge = static_cast<std::uint32_t>(field.brick_edge);
+        for (std::size_t i = 0; i < field.dims.size(); ++i) {
+            record.dims[i] = field.dims[i];
+        }
+        for (std::size_t i = 0; i < field.strides.size(); ++i) {
+            record.strides[i] = field.strides[i];
+        }
+        record.offset = field.offset;
+        record.bytes  = field.bytes;
+    }
+    out.write(reinterpret_cast<const char *>(records.data()),
+              static_cast<std::streamsize>(records.size() * sizeof(field_record)));
+
+    file_header header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version      = version;
+    header.field_count  = static_cast<std::uint32_t>(table.size());
+    header.table_offset = end;
+    out.seekp(0);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.close();
+    if (!out) {
+        throw std::runtime_error("snapshot_writer: cannot write to " + file_path);
+    }
+}
+
+snapshot_file::snapshot_file(const std::string & path) : file_path(path), mapping(path) {
+    VELM_PROFILE_ZONE("snapshot.open", "io");
+    file_header header;
+    if (mapping.size() < snapshot_alignment) {
+        throw std::runtime_error("snapshot_file: " + path + " is too short to be a snapshot");
+    }
+    std::memcpy(&header, mapping.data(), sizeof(header));
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0) {
+        throw std::runtime_error("snapshot_file: " + path + " is not a snapshot");
+    }
+    if (header.version != version) {
+        throw std::runtime_error("snapshot_file: " + path + " has unsupported version " +
+                                 std::to_string(header.version));
+    }
+    if (header.table_offset > mapping.size() ||
+        (mapping.size() - header.table_offset) / sizeof(field_record) < header.field_count) {
+        throw std::runtime_error("snapshot_file: " + path + " has a truncated field table");
+    }
+
+    table.resize(header.field_count);
+    for (std::size_t f = 0; f < table.size(); ++f) {
+        field_record record;
+        std::memcpy(&record, mapping.data() + header.table_offset + f * sizeof(field_record), sizeof(record));
+        snapshot_field & field = table[f];
+        record.name[max_name]  = '\0';
+        field.name             = record.name;
+        field.type             = static_cast<velm_DR::dtype>(record.type);
+        field.layout           = static_cast<snapshot_layout>(record.layout);
+        field.order            = static_cast<velm_DR::brick_order>(record.order);
+        field.brick_edge       = record.brick_edge;
+        field.offset           = record.offset;
+        field.bytes            = record.bytes;
+        bool known_type   = record.type <= static_cast<std::uint8_t>(velm_DR::dtype::float64);
+        bool known_layout = record.layout <= static_cast<std::uint8_t>(snapshot_layout::bricked) &&
+                            record.order <= static_cast<std::uint8_t>(velm_DR::brick_order::morton);
+        if (record.rank == 0 || record.rank > snapshot_max_rank || !known_type || !known_layout ||
+            record.offset % snapshot_alignment != 0 || record.offset > header.table_offset ||
+            record.bytes > header.table_offset - record.offset) {
+            throw std::runtime_error("snapshot_file: " + path + " has a malformed entry for " + field.name);
+        }
+        if (field.layout == snapshot_layout::bricked) {
+            // exactly the padded storage of a bricked array of these dims, so brick_view() and load_bricked() can
+            // trust the dims without allocating or indexing past the payload
+            std::uint64_t edge     = record.brick_edge;
+            std::uint64_t expected = velm_DR::dtype_size(field.type);
+            bool          fits     = record.rank == 3 && edge != 0;
+            for (int axis = 0; axis < 3 && fits; ++axis) {
+                std::uint64_t bricks = record.dims[axis] / edge + (record.dims[axis] % edge != 0 ? 1 : 0);
+                fits                 = mul_fits(expected, edge, expected) && mul_fits(expected, bricks, expected);
+            }
+            if (!fits || record.bytes != expected) {
+                throw std::runtime_error("snapshot_file: " + path + " has a malformed bricked entry for " +
+                                         field.name);
+            }
+        }
+        field.dims.assign(record.dims, record.dims + record.rank);
+        std::size_t stride_count = field.layout == snapshot_layout::bricked ? 4 : record.rank;
+        field.strides.assign(record.strides, record.strides + std::min<std::size_t>(stride_count, snapshot_max_rank));
+    }
+}
+
+bool snapshot_file::has_field(const std::string & name) const {
+    return std::any_of(table.begin(), table.end(), [&](const snapshot_field & f) { return f.name == name; });
+}
+
+const snapshot_field & snapshot_file::field(const std::string & name) const {
+    auto found = std::find_if(table.begin(), table.end(), [&](const snapshot_field & f) { return f.name == name; });
+    if (found == table.end()) {
+        throw std::runtime_error("snapshot_file: no field " + name + " in " + file_path);
+    }
+    return *found;
+}
+
+void snapshot_file::prefetch(const std::string & name) const {
+    const snapshot_field & found = field(name);
+    mapping.prefetch(found.offset, found.bytes);
+}
+
+const snapshot_field & snapshot_file::checked(const std::string & name, velm_DR::dtype type, std::size_t rank,
+                                              snapshot_layout layout) const {
+    const snapshot_field & found = field(name);
+    if (found.type != type || found.dims.size() != rank || found.layout != layout) {
+        throw std::runtime_error("snapshot_file: " + name + " has a different type, rank or layout");
+    }
+    // a linear view must stay inside the payload
+    bool empty = std::find(found.dims.begin(), found.dims.end(), std::size_t(0)) != found.dims.end();
+    if (layout == snapshot_layout::linear && !empty) {
+        std::uint64_t extent = 1;
+        bool          fits   = true;
+        for (std::size_t i = 0; i < rank && fits; ++i) {
+            std::uint64_t reach = 0;
+            fits = mul_fits(found.dims[i] - 1, found.strides[i], reach) && add_fits(extent, reach, extent);
+        }
+        if (!fits || !mul_fits(extent, velm_DR::dtype_size(type), extent) || extent > found.bytes) {
+            throw std::runtime_error("snapshot_file: " + name + " reaches beyond its payload");
+        }
+    }
+    return found;
+}
+
+void convert_to_snapshot(hdf5_file & file, const std::vector<std::string> & datasets, const std::string & path) {
+    snapshot_writer out(path);
+    for (const std::string & dataset : datasets) {
+        dataset_info info = file.info(dataset.c_str());
+        switch (info.type) {
+            case velm_DR::dtype::int8:
+                convert_dataset<std::int8_t>(file, dataset, info, out);
+                break;
+            case velm_DR::dtype::uint8:
+                convert_dataset<std::uint8_t>(file, dataset, info, out);
+                break;
+            case velm_DR::dtype::int16:
+                convert_dataset<std::int16_t>(file, dataset, info, out);
+                break;
+            case velm_DR::dtype::uint16:
+                convert_dataset<std::uint16_t>(file, dataset, info, out);
+                break;
+            case velm_DR::dtype::int32:
+                convert_dataset<std::int32_t>(file, dataset, info, out);
+                break;
+            case velm_DR::dtype::uint32:
+                convert_dataset<std::uint32_t>(file, dataset, info, out);
+                break;
+            case velm_DR::dtype::int64:
+                convert_dataset<std::int64_t>(file, dataset, info, out);
+                break;
+            case velm_DR::dtype::uint64:
+                convert_dataset<std::uint64_t>(file, dataset, info, out);
+                break;
+            case velm_DR::dtype::float32:
+                convert_dataset<float>(file, dataset, info, out);
+                break;
+            case velm_DR::dtype::float64:
+                convert_dataset<double>(file, dataset, info, out);
+                break;
+        }
+    }
+    out.finish();
+}
+
+};  // namespace vlem
@@ -0,0 +1,112 @@
+#include "velm/io/tiled_field.h"
+
+#if !defined(_WIN32)
+#    include <fcntl.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+#include <cerrno>
+
+namespace vlem {
+
+#if defined(_WIN32)
+
+raw_file::raw_file(const std::string & path, raw_open mode, std::size_t bytes) : path(path) {
+    file = std::fopen(path.c_str(), mode == raw_open::create ? "w+b" : mode == raw_open::read ? "rb" : "r+b");
+    if (file == nullptr) {
+        throw std::runtime_error("raw_file: cannot open " + path);
+    }
+    if (mode == raw_open::create) {
+        // extend to the full size, so reads of parts never written see zeros
+        if (bytes > 0 && (_fseeki64(file, static_cast<long long>(bytes) - 1, SEEK_SET) != 0 ||
+                          std::fputc(0, file) == EOF || std::fflush(file) != 0)) {
+            std::fclose(file);
+            throw std::runtime_error("raw_file: cannot size " + path);
+        }
+    } else if (_fseeki64(file, 0, SEEK_END) != 0 || static_cast<std::size_t>(_ftelli64(file)) != bytes) {
+        std::fclose(file);
+        throw std::runtime_error("raw_file: " + path + " does not have the expected size");
+    }
+}
+
+raw_file::~raw_file() {
+    std::fclose(file);
+}
+
+void raw_file::read_at(std::size_t offset, void * dst, std::size_t bytes) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (_fseeki64(file, static_cast<long long>(offset), SEEK_SET) != 0 || std::fread(dst, 1, bytes, file) != bytes) {
+        throw std::runtime_error("raw_file: read failed in " + path);
+    }
+}
+
+void raw_file::write_at(std::size_t offset, const void * src, std::size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (_fseeki64(file, static_cast<long long>(offset), SEEK_SET) != 0 || std::fwrite(src, 1, bytes, file) != bytes) {
+        throw std::runtime_error("raw_file: write failed in " + path);
+    }
+}
+
+#else
+
+raw_file::raw_file(const std::string & path, raw_open mode, std::size_t bytes) : path(path) {
+    int flags = mode == raw_open::create ? O_RDWR | O_CREAT | O_TRUNC : mode == raw_open::read ? O_RDONLY : O_RDWR;
+    fd        = open(path.c_str(), flags, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("raw_file: cannot open " + path);
+    }
+    if (mode == raw_open::create) {
+        // sparse where the file system allows it: no disk space is used until a tile is written back
+        if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            close(fd);
+            throw std::runtime_error("raw_file: cannot size " + path);
+        }
+        return;
+    }
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) != bytes) {
+        close(fd);
+        throw std::runtime_error("raw_file: " + path + " does not have the expected size");
+    }
+}
+
+raw_file::~raw_file() {
+    close(fd);
+}
+
+void raw_file::read_at(std::size_t offset, void * dst, std::size_t bytes) const {
+    std::byte * out = static_cast<std::byte *>(dst);
+    while (bytes > 0) {
+        ssize_t n = pread(fd, out, bytes, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            throw std::runtime_error("raw_file: read failed in " + path);
+        }
+        out += n;
+        offset += static_cast<std::size_t>(n);
+        bytes -= static_cast<std::size_t>(n);
+    }
+}
+
+void raw_file::write_at(std::size_t offset, const void * src, std::size_t bytes) {
+    const std::byte * in = static_cast<const std::byte *>(src);
+    while (bytes > 0) {
+        ssize_t n = pwrite(fd, in, bytes, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            throw std::runtime_error("raw_file: write failed in " + path);
+        }
+        in += n;
+        offset += static_cast<std::size_t>(n);
+        bytes -= static_cast<std::size_t>(n);
+    }
+}
+
+#endif
+
+};  // namespace vlem
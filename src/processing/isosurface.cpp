@@ -0,0 +1,447 @@
+#include "velm/processing/isosurface.h"
+
+#include "velm/core/profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+namespace velm_DP {
+
+namespace {
+
+constexpr std::size_t B = block_bounds::block_cells;
+
+/*
+ * Cube corners are numbered by their offsets, bit 0 along axis 0, bit 1 along axis 1 and bit 2 along axis 2. Edge
+ * 4a + m runs along axis a from the corner whose offsets on the other two axes, u = a + 1 and v = a + 2 (mod 3),
+ * are m & 1 and m >> 1.
+ */
+int edge_between(int x, int y) {
+    int a = std::countr_zero(static_cast<unsigned>(x ^ y));
+    int c = x & y;
+    return 4 * a + ((c >> (a + 1) % 3) & 1) + 2 * ((c >> (a + 2) % 3) & 1);
+}
+
+struct cube_case {
+    std::uint8_t count = 0;  // triangles
+    std::uint8_t edges[15];  // three edges per triangle
+};
+
+// bit f of the result is set for the faces the edge lies on, face 2a + side being normal to axis a
+int edge_faces(int edge) {
+    int a = edge / 4;
+    return 1 << (2 * ((a + 1) % 3) + (edge & 1)) | 1 << (2 * ((a + 2) % 3) + (edge >> 1 & 1));
+}
+
+/*
+ * Splits the polygon loop[0..length) into triangles without a diagonal between two vertices on the same cube face:
+ * such a diagonal would lie in the face and could overlap a triangle of the neighbouring cell. Each recursion picks
+ * the apex of the triangle on the edge (first, last).
+ */
+bool split_polygon(const int * loop, int length, std::uint8_t * out, int & count) {
+    if (length == 3) {
+        out[3 * count + 0] = static_cast<std::uint8_t>(loop[0]);
+        out[3 * count + 1] = static_cast<std::uint8_t>(loop[2]);
+        out[3 * count + 2] = static_cast<std::uint8_t>(loop[1]);
+        ++count;
+        return true;
+    }
+    auto in_face = [&](int x, int y) { return (edge_faces(loop[x]) & edge_faces(loop[y])) != 0; };
+    for (int apex = 1; apex + 1 < length; ++apex) {
+        if ((apex > 1 && in_face(0, apex)) || (apex + 2 < length && in_face(apex, length - 1))) {
+            continue;
+        }
+        int saved = count;
+        const int triangle[3] = { loop[0], loop[apex], loop[length - 1] };
+        if ((apex == 1 || split_polygon(loop, apex + 1, out, count)) &&
+            (apex + 2 == length || split_polygon(loop + apex, length - apex, out, count)) &&
+            split_polygon(triangle, 3, out, count)) {
+            return true;
+        }
+        count = saved;
+    }
+    return false;
+}
+
+// the loops wind around the inside corners, so the triangles are emitted reversed to face away from them
+void triangulate(const int * loop, int length, cube_case & out) {
+    int count = out.count;
+    if (!split_polygon(loop, length, out.edges, count)) {
+        abort();
+    }
+    out.count = static_cast<std::uint8_t>(count);
+}
+
+/*
+ * Triangles of every corner case, traced from the faces rather than tabulated by hand. On each face the inside
+ * region is bounded by one segment per run of consecutive inside corners, so diagonal inside corners stay apart.
+ * The segments are directed so that the inside lies on their left seen from outside the cube; they then join into
+ * closed loops around the inside corners, which are split into triangles.
+ */
+std::array<cube_case, 256> build_cases() {
+    std::array<cube_case, 256> cases{};
+    for (int index = 0; index < 256; ++index) {
+        int next[12];
+        std::fill(std::begin(next), std::end(next), -1);
+        for (int a = 0; a < 3; ++a) {
+            int u = (a + 1) % 3, v = (a + 2) % 3;
+            for (int side = 0; side < 2; ++side) {
+                // counter-clockwise seen from the positive end of axis a
+                const int q[4] = { side << a, side << a | 1 << u, side << a | 1 << u | 1 << v, side << a | 1 << v };
+                auto inside = [&](int m) { return (index >> q[m & 3]) & 1; };
+                for (int m = 0; m < 4; ++m) {
+                    if (!inside(m) || inside(m + 3)) {
+                        continue;
+                    }
+                    int last = m;
+                    while (inside(last + 1)) {
+                        ++last;
+                    }
+                    int entering = edge_between(q[(m + 3) & 3], q[m]);
+                    int leaving  = edge_between(q[last & 3], q[(last + 1) & 3]);
+                    if (side == 1) {
+                        next[leaving] = entering;
+                    } else {
+                        next[entering] = leaving;
+                    }
+                }
+            }
+        }
+
+        cube_case & out = cases[index];
+        bool        seen[12] = {};
+        for (int start = 0; start < 12; ++start) {
+            if (next[start] < 0 || seen[start]) {
+                continue;
+            }
+            int loop[12];
+            int length = 0;
+            for (int e = start; !seen[e]; e = next[e]) {
+                seen[e]        = true;
+                loop[length++] = e;
+            }
+            triangulate(loop, length, out);
+        }
+    }
+    return cases;
+}
+
+const std::array<cube_case, 256> & cube_cases() {
+    static const std::array<cube_case, 256> cases = build_cases();
+    return cases;
+}
+
+// unchecked, strided access to the field
+struct sampler {
+    const float * data;
+    std::size_t   n[3];
+    std::size_t   s[3];
+
+    explicit sampler(velm_DR::ndarray_view<const float, 3> field) : data(field.data) {
+        for (std::size_t a = 0; a < 3; ++a) {
+            n[a] = field.dims[a];
+            s[a] = field.strides[a];
+        }
+    }
+
+    const float * at(std::size_t i, std::size_t j, std::size_t k) const {
+        return data + i * s[0] + j * s[1] + k * s[2];
+    }
+
+    // derivative along axis a at p in index units, central inside and one-sided on the faces
+    float derivative(const std::size_t (&p)[3], std::size_t a) const {
+        const float * c  = at(p[0], p[1], p[2]);
+        const float * lo = p[a] > 0 ? c - s[a] : c;
+        const float * hi = p[a] + 1 < n[a] ? c + s[a] : c;
+        float         h  = (p[a] > 0 ? 1.0f : 0.0f) + (p[a] + 1 < n[a] ? 1.0f : 0.0f);
+        return (*hi - *lo) / h;
+    }
+};
+
+bool inside(float value, float iso) {
+    return value >= iso;
+}
+
+// the blocks of a summary that may hold cells crossing one isovalue, and the block columns along axis 2 holding any
+struct active_blocks {
+    std::size_t               blocks[3];
+    std::vector<std::uint8_t> block;
+    std::vector<std::uint8_t> column;
+
+    active_blocks(const block_bounds & bounds, float iso) :
+        blocks{ bounds.counts()[0], bounds.counts()[1], bounds.counts()[2] },
+        block(blocks[0] * blocks[1] * blocks[2]),
+        column(blocks[0] * blocks[1]) {
+        for (std::size_t n = 0; n < block.size(); ++n) {
+            block[n] = bounds.may_cross(n / (blocks[1] * blocks[2]), n / blocks[2] % blocks[1], n % blocks[2], iso);
+            column[n / blocks[2]] |= block[n];
+        }
+    }
+
+    // first block of column (a, b), so that block c is at [c]
+    const std::uint8_t * row(std::size_t a, std::size_t b) const { return &block[(a * blocks[1] + b) * blocks[2]]; }
+
+    // points along axis 2 whose edges lie in block c: the last block also takes the last point
+    std::size_t end_point(std::size_t c, std::size_t points) const {
+        return c + 1 == blocks[2] ? points : (c + 1) * B;
+    }
+};
+
+/*
+ * Calls visit(k, axis, lower, upper) for every edge of the point row (i, j) that crosses `iso`, in the order that
+ * fixes vertex numbering: by point, then by axis. Edges belong to the point at their lower end, and to the block
+ * containing that point (the last block on an axis also takes the last plane of points).
+ */
+template <typename F>
+void visit_row_edges(const sampler &       f,
+                     const active_blocks & active,
+                     float                 iso,
+                     std::size_t           i,
+                     std::size_t           j,
+                     F &&                  visit) {
+    std::size_t bi = std::min(i / B, active.blocks[0] - 1);
+    std::size_t bj = std::min(j / B, active.blocks[1] - 1);
+    if (!active.column[bi * active.blocks[1] + bj]) {
+        return;
+    }
+    const std::uint8_t * blocks = active.row(bi, bj);
+    const float *        row    = f.at(i, j, 0);
+    for (std::size_t c = 0; c < active.blocks[2]; ++c) {
+        if (!blocks[c]) {
+            continue;
+        }
+        for (std::size_t k = c * B; k < active.end_point(c, f.n[2]); ++k) {
+            const float * p  = row + k * f.s[2];
+            bool          in = inside(*p, iso);
+            if (i + 1 < f.n[0] && inside(p[f.s[0]], iso) != in) {
+                visit(k, 0, *p, p[f.s[0]]);
+            }
+            if (j + 1 < f.n[1] && inside(p[f.s[1]], iso) != in) {
+                visit(k, 1, *p, p[f.s[1]]);
+            }
+            if (k + 1 < f.n[2] && inside(p[f.s[2]], iso) != in) {
+                visit(k, 2, *p, p[f.s[2]]);
+            }
+        }
+    }
+}
+
+// calls visit(k, case) for every cell of the cell row (i, j) with corners on both sides of `iso`
+template <typename F>
+void visit_row_cells(const sampler &       f,
+                     const active_blocks & active,
+                     float                 iso,
+                     std::size_t           i,
+                     std::size_t           j,
+                     F &&                  visit) {
+    if (!active.column[i / B * active.blocks[1] + j / B]) {
+        return;
+    }
+    const std::size_t    di = f.s[0], dj = f.s[1], dk = f.s[2];
+    const std::uint8_t * blocks = active.row(i / B, j / B);
+    const float *        row    = f.at(i, j, 0);
+    for (std::size_t c = 0; c < active.blocks[2]; ++c) {
+        if (!blocks[c]) {
+            continue;
+        }
+        for (std::size_t k = c * B; k < std::min((c + 1) * B, f.n[2] - 1); ++k) {
+            const float * p     = row + k * dk;
+            unsigned      index = inside(p[0], iso) | inside(p[di], iso) << 1 | inside(p[dj], iso) << 2 |
+                               inside(p[di + dj], iso) << 3 | inside(p[dk], iso) << 4 | inside(p[di + dk], iso) << 5 |
+                               inside(p[dj + dk], iso) << 6 | inside(p[di + dj + dk], iso) << 7;
+            if (index != 0 && index != 255) {
+                visit(k, index);
+            }
+        }
+    }
+}
+
+// turns counts into offsets in place and returns their total
+std::size_t exclusive_scan(std::vector<std::size_t> & counts) {
+    std::size_t total = 0;
+    for (std::size_t & count : counts) {
+        std::size_t c = count;
+        count         = total;
+        total += c;
+    }
+    return total;
+}
+
+}  // namespace
+
+block_bounds::block_bounds(velm_DR::ndarray_view<const float, 3> field, velm_DR::thread_pool * pool) {
+    if (field.dims[0] < 2 || field.dims[1] < 2 || field.dims[2] < 2) {
+        return;
+    }
+    for (std::size_t a = 0; a < 3; ++a) {
+        blocks[a] = (field.dims[a] - 1 + B - 1) / B;
+    }
+    lo.resize(blocks[0] * blocks[1] * blocks[2]);
+    hi.resize(lo.size());
+
+    sampler                f(field);
+    velm_DR::thread_pool & workers = pool != nullptr ? *pool : velm_DR::thread_pool::global();
+    workers.parallel_for(blocks[0], 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t a = begin; a < end; ++a) {
+            for (std::size_t b = 0; b < blocks[1]; ++b) {
+                for (std::size_t c = 0; c < blocks[2]; ++c) {
+                    // NaNs count as outside, so they widen the range downwards
+                    float low = std::numeric_limits<float>::infinity(), high = -low;
+                    for (std::size_t i = a * B; i <= std::min((a + 1) * B, f.n[0] - 1); ++i) {
+                        for (std::size_t j = b * B; j <= std::min((b + 1) * B, f.n[1] - 1); ++j) {
+                            const float * row = f.at(i, j, 0);
+                            for (std::size_t k = c * B; k <= std::min((c + 1) * B, f.n[2] - 1); ++k) {
+                                float v = row[k * f.s[2]];
+                                low     = std::min(low, v == v ? v : -std::numeric_limits<float>::infinity());
+                                high    = std::max(high, v);
+                            }
+                        }
+                    }
+                    std::size_t n = (a * blocks[1] + b) * blocks[2] + c;
+                    lo[n]         = low;
+                    hi[n]         = high;
+                }
+            }
+        }
+    });
+}
+
+bool block_bounds::may_cross(std::size_t a, std::size_t b, std::size_t c, float iso) const {
+    std::size_t n = (a * blocks[1] + b) * blocks[2] + c;
+    return hi[n] >= iso && lo[n] < iso;
+}
+
+std::size_t block_bounds::active_blocks(float iso) const {
+    std::size_t active = 0;
+    for (std::size_t n = 0; n < lo.size(); ++n) {
+        active += hi[n] >= iso && lo[n] < iso;
+    }
+    return active;
+}
+
+iso_mesh extract_isosurface(velm_DR::ndarray_view<const float, 3> field, float iso, const iso_options & options) {
+    VELM_PROFILE_ZONE("isosurface.extract", "processing");
+    iso_mesh mesh;
+    if (field.dims[0] < 2 || field.dims[1] < 2 || field.dims[2] < 2) {
+        return mesh;
+    }
+    velm_DR::thread_pool & pool = options.pool != nullptr ? *options.pool : velm_DR::thread_pool::global();
+    block_bounds           local;
+    if (options.bounds == nullptr) {
+        local = block_bounds(field, &pool);
+    }
+    const block_bounds & bounds = options.bounds != nullptr ? *options.bounds : local;
+    for (std::size_t a = 0; a < 3; ++a) {
+        if (bounds.counts()[a] != (field.dims[a] - 1 + B - 1) / B) {
+            throw std::invalid_argument("extract_isosurface: options.bounds was built for a field of another shape");
+        }
+    }
+
+    const active_blocks                active(bounds, iso);
+    const sampler                      f(field);
+    const std::array<cube_case, 256> & cases = cube_cases();
+    const std::size_t                  n0    = f.n[0], n1 = f.n[1], n2 = f.n[2];
+    const std::size_t                  grain = std::max<std::size_t>(1, 4096 / n2);
+    std::vector<std::size_t>           vertex_offsets(n0 * n1), triangle_offsets((n0 - 1) * (n1 - 1));
+
+    // pass 1: count per row, so every row knows where its output goes before anything is written
+    pool.parallel_for(n0 * n1, grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t r = begin; r < end; ++r) {
+            std::size_t i = r / n1, j = r % n1, vertices = 0, triangles = 0;
+            visit_row_edges(f, active, iso, i, j, [&](std::size_t, std::size_t, float, float) { ++vertices; });
+            vertex_offsets[r] = vertices;
+            if (i + 1 < n0 && j + 1 < n1) {
+                visit_row_cells(f, active, iso, i, j, [&](std::size_t, unsigned index) {
+                    triangles += cases[index].count;
+                });
+                triangle_offsets[i * (n1 - 1) + j] = triangles;
+            }
+        }
+    });
+    std::size_t vertex_count   = exclusive_scan(vertex_offsets);
+    std::size_t triangle_count = exclusive_scan(triangle_offsets);
+    if (vertex_count > std::numeric_limits<std::uint32_t>::max()) {
+        abort();
+    }
+    mesh.vertices.resize(vertex_count);
+    mesh.indices.resize(3 * triangle_count);
+
+    // pass 2: vertices, interpolated along their edge, with normals from the interpolated gradient
+    pool.parallel_for(n0 * n1, grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t r = begin; r < end; ++r) {
+            std::size_t   i = r / n1, j = r % n1;
+            mesh_vertex * out = mesh.vertices.data() + vertex_offsets[r];
+            visit_row_edges(f, active, iso, i, j, [&](std::size_t k, std::size_t axis, float lower, float upper) {
+                const std::size_t p[3] = { i, j, k };
+                std::size_t       q[3] = { i, j, k };
+                ++q[axis];
+                float t = (iso - lower) / (upper - lower);
+                float length = 0.0f;
+                for (std::size_t a = 0; a < 3; ++a) {
+                    float position   = static_cast<float>(p[a]) + (a == axis ? t : 0.0f);
+                    out->position[a] = options.origin[a] + position * options.spacing[a];
+                    float gradient   = (f.derivative(p, a) * (1.0f - t) + f.derivative(q, a) * t) / options.spacing[a];
+                    out->normal[a]   = -gradient;
+                    length += gradient * gradient;
+                }
+                float scale = length > 0.0f ? 1.0f / std::sqrt(length) : 0.0f;
+                for (float & component : out->normal) {
+                    component *= scale;
+                }
+                ++out;
+            });
+        }
+    });
+
+    // pass 3: triangles, by slabs of x-planes that number the edges of their two current planes of points
+    const std::size_t slabs = (n0 - 2) / B + 1;
+    pool.parallel_for(slabs, 1, [&](std::size_t begin, std::size_t end) {
+        const std::size_t                plane_size = n1 * n2 * 3;
+        std::unique_ptr<std::uint32_t[]> planes     = std::make_unique_for_overwrite<std::uint32_t[]>(2 * plane_size);
+        std::uint32_t *                  lower      = planes.get();
+        std::uint32_t *                  upper      = planes.get() + plane_size;
+
+        // only edges that cross are written, and only those are ever looked up
+        auto number_plane = [&](std::size_t i, std::uint32_t * ids) {
+            for (std::size_t j = 0; j < n1; ++j) {
+                auto next = static_cast<std::uint32_t>(vertex_offsets[i * n1 + j]);
+                visit_row_edges(f, active, iso, i, j, [&](std::size_t k, std::size_t axis, float, float) {
+                    ids[(j * n2 + k) * 3 + axis] = next++;
+                });
+            }
+        };
+
+        for (std::size_t slab = begin; slab < end; ++slab) {
+            std::size_t first = slab * B, last = std::min(first + B, n0 - 1);
+            number_plane(first, lower);
+            for (std::size_t i = first; i < last; ++i) {
+                number_plane(i + 1, upper);
+                for (std::size_t j = 0; j + 1 < n1; ++j) {
+                    std::uint32_t * out = mesh.indices.data() + 3 * triangle_offsets[i * (n1 - 1) + j];
+                    visit_row_cells(f, active, iso, i, j, [&](std::size_t k, unsigned index) {
+                        const cube_case & cell = cases[index];
+                        for (std::size_t e = 0; e < 3u * cell.count; ++e) {
+                            int             edge   = cell.edges[e];
+                            int             axis   = edge / 4;
+                            int             corner = (edge & 1) << (axis + 1) % 3 | (edge >> 1 & 1) << (axis + 2) % 3;
+                            std::uint32_t * ids    = corner & 1 ? upper : lower;
+                            std::size_t     cj     = j + (corner >> 1 & 1);
+                            std::size_t     ck     = k + (corner >> 2 & 1);
+                            *out++                 = ids[(cj * n2 + ck) * 3 + axis];
+                        }
+                    });
+                }
+                std::swap(lower, upper);
+            }
+        }
+    });
+    return mesh;
+}
+
+};  // namespace velm_DP
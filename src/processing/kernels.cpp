@@ -0,0 +1,100 @@
+#include "velm/processing/kernels.h"
+
+#include "processing/simd_kernels.h"
+
+#include <atomic>
+#include <cmath>
+
+namespace velm_DP {
+
+namespace detail {
+
+#if defined(VELM_HAVE_AVX2)
+template <typename T> const kernel_table<T> & avx2_kernels();
+#endif
+#if defined(VELM_HAVE_AVX512)
+template <typename T> const kernel_table<T> & avx512_kernels();
+#endif
+
+};  // namespace detail
+
+namespace {
+
+// one element per "register"; the compiler remains free to auto-vectorise for the baseline instruction set
+template <typename T> struct scalar_batch {
+    using scalar = T;
+    using vector = T;
+
+    static constexpr std::size_t width = 1;
+
+    static T    zero() { return T(0); }
+    static T    set1(T a) { return a; }
+    static T    load(const T * p) { return *p; }
+    static void store(T * p, T a) { *p = a; }
+    static T    add(T a, T b) { return a + b; }
+    static T    sub(T a, T b) { return a - b; }
+    static T    mul(T a, T b) { return a * b; }
+    static T    fmadd(T a, T b, T c) { return a * b + c; }
+    static T    sqrt(T a) { return std::sqrt(a); }
+    static T    min(T a, T b) { return b < a ? b : a; }
+    static T    max(T a, T b) { return b > a ? b : a; }
+};
+
+simd_level detect() {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+#    if defined(VELM_HAVE_AVX512)
+    if (__builtin_cpu_supports("avx512f")) {
+        return simd_level::avx512;
+    }
+#    endif
+#    if defined(VELM_HAVE_AVX2)
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return simd_level::avx2;
+    }
+#    endif
+#endif
+    return simd_level::scalar;
+}
+
+std::atomic<simd_level> & requested_level() {
+    static std::atomic<simd_level> level{ simd_level::avx512 };
+    return level;
+}
+
+}  // namespace
+
+simd_level detected_simd_level() {
+    static const simd_level level = detect();
+    return level;
+}
+
+simd_level active_simd_level() {
+    simd_level requested = requested_level().load(std::memory_order_relaxed);
+    simd_level detected  = detected_simd_level();
+    return requested < detected ? requested : detected;
+}
+
+void set_simd_level(simd_level level) {
+    requested_level().store(level, std::memory_order_relaxed);
+}
+
+template <typename T> const detail::kernel_table<T> & detail::active_kernels() {
+    switch (active_simd_level()) {
+#if defined(VELM_HAVE_AVX512)
+        case simd_level::avx512:
+            return avx512_kernels<T>();
+#endif
+#if defined(VELM_HAVE_AVX2)
+        case simd_level::avx2:
+            return avx2_kernels<T>();
+#endif
+        default:
+            return simd_kernels<scalar_batch<T>>::table;
+    }
+}
+
+template const detail::kernel_table<float> &  detail::active_kernels<float>();
+template const detail::kernel_table<double> & detail::active_kernels<double>();
+
+};  // namespace velm_DP
@@ -0,0 +1,64 @@
+// compiled with -mavx2 -mfma; only reached after detected_simd_level() has confirmed CPU support
+#include "processing/simd_kernels.h"
+
+#include <immintrin.h>
+
+namespace velm_DP {
+
+namespace {
+
+struct avx2_float {
+    using scalar = float;
+    using vector = __m256;
+
+    static constexpr std::size_t width = 8;
+
+    static __m256 zero() { return _mm256_setzero_ps(); }
+    static __m256 set1(float a) { return _mm256_set1_ps(a); }
+    static __m256 load(const float * p) { return _mm256_loadu_ps(p); }
+    static void   store(float * p, __m256 a) { _mm256_storeu_ps(p, a); }
+    static __m256 add(__m256 a, __m256 b) { return _mm256_add_ps(a, b); }
+    static __m256 sub(__m256 a, __m256 b) { return _mm256_sub_ps(a, b); }
+    static __m256 mul(__m256 a, __m256 b) { return _mm256_mul_ps(a, b); }
+    static __m256 fmadd(__m256 a, __m256 b, __m256 c) { return _mm256_fmadd_ps(a, b, c); }
+    static __m256 sqrt(__m256 a) { return _mm256_sqrt_ps(a); }
+    static __m256 min(__m256 a, __m256 b) { return _mm256_min_ps(a, b); }
+    static __m256 max(__m256 a, __m256 b) { return _mm256_max_ps(a, b); }
+};
+
+struct avx2_double {
+    using scalar = double;
+    using vector = __m256d;
+
+    static constexpr std::size_t width = 4;
+
+    static __m256d zero() { return _mm256_setzero_pd(); }
+    static __m256d set1(double a) { return _mm256_set1_pd(a); }
+    static __m256d load(const double * p) { return _mm256_loadu_pd(p); }
+    static void    store(double * p, __m256d a) { _mm256_storeu_pd(p, a); }
+    static __m256d add(__m256d a, __m256d b) { return _mm256_add_pd(a, b); }
+    static __m256d sub(__m256d a, __m256d b) { return _mm256_sub_pd(a, b); }
+    static __m256d mul(__m256d a, __m256d b) { return _mm256_mul_pd(a, b); }
+    static __m256d fmadd(__m256d a, __m256d b, __m256d c) { return _mm256_fmadd_pd(a, b, c); }
+    static __m256d sqrt(__m256d a) { return _mm256_sqrt_pd(a); }
+    static __m256d min(__m256d a, __m256d b) { return _mm256_min_pd(a, b); }
+    static __m256d max(__m256d a, __m256d b) { return _mm256_max_pd(a, b); }
+};
+
+}  // namespace
+
+namespace detail {
+
+template <typename T> const kernel_table<T> & avx2_kernels();
+
+template <> const kernel_table<float> & avx2_kernels<float>() {
+    return simd_kernels<avx2_float>::table;
+}
+
+template <> const kernel_table<double> & avx2_kernels<double>() {
+    return simd_kernels<avx2_double>::table;
+}
+
+};  // namespace detail
+
+};  // namespace velm_DP
@@ -0,0 +1,73 @@
+// compiled with -mavx512f; only reached after detected_simd_level() has confirmed CPU support
+#include "processing/simd_kernels.h"
+
+// GCC 12 reports the deliberately undefined passthrough operand of the masked AVX-512 min/max builtins as
+// maybe-uninitialized (GCC bug 105593); the warning is located in the intrinsics header itself
+#if defined(__GNUC__) && !defined(__clang__)
+#    pragma GCC diagnostic push
+#    pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#    include <immintrin.h>
+#    pragma GCC diagnostic pop
+#else
+#    include <immintrin.h>
+#endif
+
+namespace velm_DP {
+
+namespace {
+
+struct avx512_float {
+    using scalar = float;
+    using vector = __m512;
+
+    static constexpr std::size_t width = 16;
+
+    static __m512 zero() { return _mm512_setzero_ps(); }
+    static __m512 set1(float a) { return _mm512_set1_ps(a); }
+    static __m512 load(const float * p) { return _mm512_loadu_ps(p); }
+    static void   store(float * p, __m512 a) { _mm512_storeu_ps(p, a); }
+    static __m512 add(__m512 a, __m512 b) { return _mm512_add_ps(a, b); }
+    static __m512 sub(__m512 a, __m512 b) { return _mm512_sub_ps(a, b); }
+    static __m512 mul(__m512 a, __m512 b) { return _mm512_mul_ps(a, b); }
+    static __m512 fmadd(__m512 a, __m512 b, __m512 c) { return _mm512_fmadd_ps(a, b, c); }
+    static __m512 sqrt(__m512 a) { return _mm512_sqrt_ps(a); }
+    static __m512 min(__m512 a, __m512 b) { return _mm512_min_ps(a, b); }
+    static __m512 max(__m512 a, __m512 b) { return _mm512_max_ps(a, b); }
+};
+
+struct avx512_double {
+    using scalar = double;
+    using vector = __m512d;
+
+    static constexpr std::size_t width = 8;
+
+    static __m512d zero() { return _mm512_setzero_pd(); }
+    static __m512d set1(double a) { return _mm512_set1_pd(a); }
+    static __m512d load(const double * p) { return _mm512_loadu_pd(p); }
+    static void    store(double * p, __m512d a) { _mm512_storeu_pd(p, a); }
+    static __m512d add(__m512d a, __m512d b) { return _mm512_add_pd(a, b); }
+    static __m512d sub(__m512d a, __m512d b) { return _mm512_sub_pd(a, b); }
+    static __m512d mul(__m512d a, __m512d b) { return _mm512_mul_pd(a, b); }
+    static __m512d fmadd(__m512d a, __m512d b, __m512d c) { return _mm512_fmadd_pd(a, b, c); }
+    static __m512d sqrt(__m512d a) { return _mm512_sqrt_pd(a); }
+    static __m512d min(__m512d a, __m512d b) { return _mm512_min_pd(a, b); }
+    static __m512d max(__m512d a, __m512d b) { return _mm512_max_pd(a, b); }
+};
+
+}  // namespace
+
+namespace detail {
+
+template <typename T> const kernel_table<T> & avx512_kernels();
+
+template <> const kernel_table<float> & avx512_kernels<float>() {
+    return simd_kernels<avx512_float>::table;
+}
+
+template <> const kernel_table<double> & avx512_kernels<double>() {
+    return simd_kernels<avx512_double>::table;
+}
+
+};  // namespace detail
+
+};  // namespace velm_DP
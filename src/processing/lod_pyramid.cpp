@@ -0,0 +1,352 @@
+#include "velm/processing/lod_pyramid.h"
+
+#include "velm/core/profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <limits>
+#include <system_error>
+
+namespace velm_DP {
+
+namespace {
+
+const char * filter_name(lod_filter filter) {
+    switch (filter) {
+        case lod_filter::min:
+            return "min";
+        case lod_filter::max:
+            return "max";
+        case lod_filter::mean:
+            return "mean";
+    }
+    return "";
+}
+
+std::string level_dataset(const char * field, lod_filter filter, std::size_t level) {
+    return std::string(field) + "/lod_" + filter_name(filter) + "/" + std::to_string(level);
+}
+
+std::string shape_dataset(const char * field, lod_filter filter) {
+    return std::string(field) + "/lod_" + filter_name(filter) + "/source_dims";
+}
+
+template <lod_filter F, typename T> T identity() {
+    if constexpr (F == lod_filter::min) {
+        return std::numeric_limits<T>::infinity();
+    } else if constexpr (F == lod_filter::max) {
+        return -std::numeric_limits<T>::infinity();
+    } else {
+        return T(0);
+    }
+}
+
+template <lod_filter F, typename T> void combine(T & acc, T value) {
+    if constexpr (F == lod_filter::min) {
+        acc = value < acc ? value : acc;
+    } else if constexpr (F == lod_filter::max) {
+        acc = value > acc ? value : acc;
+    } else {
+        acc += value;
+    }
+}
+
+template <typename T> velm_DR::ndarray<T, 3> coarser_level(const std::size_t * dims, lod_filter filter) {
+    velm_DR::ndarray<T, 3> next(velm_DR::uninitialized, (dims[0] + 1) / 2, (dims[1] + 1) / 2, (dims[2] + 1) / 2);
+    switch (filter) {
+        case lod_filter::min:
+            next.fill(identity<lod_filter::min, T>());
+            break;
+        case lod_filter::max:
+            next.fill(identity<lod_filter::max, T>());
+            break;
+        case lod_filter::mean:
+            next.fill(T(0));
+            break;
+    }
+    return next;
+}
+
+/*
+ * Folds `chunk`, which starts at `origin` in the finer level, into the coarser level `out`. Chunks need not be
+ * aligned to even indices: a 2×2×2 block split over two chunks is completed by the second fold. Output planes are
+ * spread over the pool, and no two workers touch the same plane.
+ */
+template <lod_filter F, typename T>
+void fold_chunk(velm_DR::ndarray_view<const T, 3> chunk,
+                const std::size_t (&origin)[3],
+                velm_DR::ndarray<T, 3> & out,
+                velm_DR::thread_pool &   pool) {
+    const std::size_t first_plane = origin[0] / 2;
+    const std::size_t last_plane  = (origin[0] + chunk.dims[0] - 1) / 2;
+    pool.parallel_for(last_plane - first_plane + 1, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t p = first_plane + begin; p < first_plane + end; ++p) {
+            std::size_t lo = std::max(2 * p, origin[0]) - origin[0];
+            std::size_t hi = std::min(2 * p + 2, origin[0] + chunk.dims[0]) - origin[0];
+            for (std::size_t i = lo; i < hi; ++i) {
+                for (std::size_t j = 0; j < chunk.dims[1]; ++j) {
+                    const T * in  = &chunk(i, j, 0);
+                    T *       row = &out(p, (origin[1] + j) / 2, 0);
+                    for (std::size_t k = 0; k < chunk.dims[2]; ++k) {
+                        combine<F>(row[(origin[2] + k) / 2], in[k * chunk.strides[2]]);
+                    }
+                }
+            }
+        }
+    });
+}
+
+template <typename T>
+void fold(velm_DR::ndarray_view<const T, 3> chunk,
+          const std::size_t (&origin)[3],
+          velm_DR::ndarray<T, 3> & out,
+          lod_filter               filter,
+          velm_DR::thread_pool &   pool) {
+    if (chunk.total_elements() == 0) {
+        return;
+    }
+    switch (filter) {
+        case lod_filter::min:
+            fold_chunk<lod_filter::min>(chunk, origin, out, pool);
+            break;
+        case lod_filter::max:
+            fold_chunk<lod_filter::max>(chunk, origin, out, pool);
+            break;
+        case lod_filter::mean:
+            fold_chunk<lod_filter::mean>(chunk, origin, out, pool);
+            break;
+    }
+}
+
+// turns the block sums of a mean level into means; blocks at odd upper edges hold fewer than 8 samples
+template <typename T>
+void finish(const std::size_t * finer, velm_DR::ndarray<T, 3> & out, lod_filter filter, velm_DR::thread_pool & pool) {
+    if (filter != lod_filter::mean) {
+        return;
+    }
+    auto samples = [&](std::size_t axis, std::size_t i) { return std::min<std::size_t>(2, finer[axis] - 2 * i); };
+    pool.parallel_for(out.dims[0], 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            for (std::size_t j = 0; j < out.dims[1]; ++j) {
+                T * row = &out(i, j, 0);
+                T   ij  = static_cast<T>(samples(0, i) * samples(1, j));
+                for (std::size_t k = 0; k < out.dims[2]; ++k) {
+                    row[k] /= ij * static_cast<T>(samples(2, k));
+                }
+            }
+        }
+    });
+}
+
+bool needs_level(const std::size_t * dims, std::size_t built, std::size_t max_levels) {
+    if (max_levels != 0 && built >= max_levels) {
+        return false;
+    }
+    return dims[0] * dims[1] * dims[2] > 1;
+}
+
+// appends coarser levels below `finer` until a single voxel or max_levels is reached
+template <typename T>
+void build_levels(std::vector<velm_DR::ndarray<T, 3>> & levels,
+                  velm_DR::ndarray_view<const T, 3>     finer,
+                  lod_filter                            filter,
+                  std::size_t                           max_levels,
+                  velm_DR::thread_pool &                pool) {
+    VELM_PROFILE_ZONE("lod.build_levels", "processing");
+    const std::size_t origin[3] = {};
+    while (needs_level(finer.dims, levels.size(), max_levels)) {
+        velm_DR::ndarray<T, 3> next = coarser_level<T>(finer.dims, filter);
+        fold(finer, origin, next, filter, pool);
+        finish(finer.dims, next, filter, pool);
+        levels.push_back(std::move(next));
+        finer = levels.back().view();
+    }
+}
+
+}  // namespace
+
+template <typename T>
+lod_pyramid<T>::lod_pyramid(velm_DR::ndarray_view<const T, 3> source_view,
+                            lod_filter                        filter,
+                            const lod_options &               options) :
+    kind(filter) {
+    static_assert(std::is_floating_point_v<T>, "lod_pyramid supports float and double fields");
+    for (std::size_t a = 0; a < 3; ++a) {
+        source[a] = source_view.dims[a];
+    }
+    if (source_view.total_elements() == 0) {
+        return;
+    }
+    velm_DR::thread_pool & pool = options.pool != nullptr ? *options.pool : velm_DR::thread_pool::global();
+    build_levels<T>(levels, source_view, kind, options.max_levels, pool);
+}
+
+template <typename T>
+lod_pyramid<T>::lod_pyramid(vlem::hdf5_file &   file,
+                            const char *        field,
+                            lod_filter          filter,
+                            const lod_options & options) :
+    kind(filter) {
+    velm_DR::thread_pool &   pool = options.pool != nullptr ? *options.pool : velm_DR::thread_pool::global();
+    vlem::chunk_stream<T, 3> stream(file, field);
+    vlem::dataset_info       info = file.info(field);
+    for (std::size_t a = 0; a < 3; ++a) {
+        source[a] = info.dims[a];
+    }
+    if (source[0] * source[1] * source[2] == 0 || !needs_level(source, 0, options.max_levels)) {
+        return;
+    }
+
+    // level 1 is folded chunk by chunk as the stream delivers them, the rest is built from it in memory
+    velm_DR::ndarray<T, 3>      first = coarser_level<T>(source, kind);
+    velm_DR::ndarray<T, 3>      buffer(velm_DR::uninitialized, stream.chunk_shape());
+    velm_DR::ndarray_view<T, 3> chunk;
+    std::size_t                 origin[3];
+    while (stream.next(buffer, origin, chunk)) {
+        fold<T>(chunk, origin, first, kind, pool);
+    }
+    finish(source, first, kind, pool);
+    levels.push_back(std::move(first));
+    build_levels<T>(levels, levels.back().view(), kind, options.max_levels, pool);
+}
+
+template <typename T>
+lod_pyramid<T>
+lod_pyramid<T>::open(vlem::hdf5_file & file, const char * field, lod_filter filter, const lod_options & options) {
+    std::string     sidecar = sidecar_path(file.path(), field, filter);
+    std::error_code error;
+    auto            saved   = std::filesystem::last_write_time(sidecar, error);
+    if (!error && saved >= std::filesystem::last_write_time(file.path())) {
+        vlem::dataset_info info = file.info(field);
+        std::size_t        dims[3];
+        for (std::size_t a = 0; a < 3 && a < info.dims.size(); ++a) {
+            dims[a] = info.dims[a];
+        }
+        if (info.dims.size() == 3) {
+            std::optional<lod_pyramid> loaded = load(sidecar, field, filter, dims);
+            if (loaded && (options.max_levels == 0 || loaded->levels.size() == options.max_levels)) {
+                return std::move(*loaded);
+            }
+        }
+    }
+    lod_pyramid pyramid(file, field, filter, options);
+    pyramid.save(sidecar, field);
+    return pyramid;
+}
+
+template <typename T>
+std::optional<lod_pyramid<T>> lod_pyramid<T>::load(const std::string & path,
+                                                   const char *        field,
+                                                   lod_filter          filter,
+                                                   const std::size_t (&source_dims)[3]) {
+    if (!std::filesystem::exists(path)) {
+        return std::nullopt;
+    }
+    vlem::hdf5_file file(path);
+    std::string     shape = shape_dataset(field, filter);
+    if (!file.has_dataset(shape.c_str())) {
+        return std::nullopt;
+    }
+    velm_DR::ndarray<std::uint64_t, 1> saved = file.extract_field<std::uint64_t, 1>(shape.c_str());
+    if (saved.dims[0] != 3) {
+        return std::nullopt;
+    }
+    lod_pyramid pyramid;
+    pyramid.kind = filter;
+    for (std::size_t a = 0; a < 3; ++a) {
+        if (saved(a) != source_dims[a]) {
+            return std::nullopt;
+        }
+        pyramid.source[a] = source_dims[a];
+    }
+    for (std::size_t l = 1;; ++l) {
+        std::string name = level_dataset(field, filter, l);
+        if (!file.has_dataset(name.c_str())) {
+            break;
+        }
+        pyramid.levels.push_back(file.extract_field<T, 3>(name.c_str()));
+        const std::size_t * finer = pyramid.dims(l - 1);
+        for (std::size_t a = 0; a < 3; ++a) {
+            if (pyramid.levels.back().dims[a] != (finer[a] + 1) / 2) {
+                return std::nullopt;
+            }
+        }
+    }
+    return pyramid;
+}
+
+template <typename T> void lod_pyramid<T>::save(const std::string & path, const char * field) const {
+    vlem::hdf5_file                    file(path, vlem::hdf5_file::access::truncate);
+    velm_DR::ndarray<std::uint64_t, 1> shape(3);
+    for (std::size_t a = 0; a < 3; ++a) {
+        shape(a) = source[a];
+    }
+    file.write_field(shape_dataset(field, kind).c_str(), shape);
+    for (std::size_t l = 1; l < level_count(); ++l) {
+        file.write_field(level_dataset(field, kind, l).c_str(), levels[l - 1]);
+    }
+}
+
+template <typename T>
+std::string lod_pyramid<T>::sidecar_path(const std::string & source_path, const char * field, lod_filter filter) {
+    std::string name(field);
+    std::replace(name.begin(), name.end(), '/', '_');
+    return source_path + "." + name + "." + filter_name(filter) + ".lod";
+}
+
+template <typename T> const std::size_t * lod_pyramid<T>::dims(std::size_t l) const {
+    if (l >= level_count()) {
+        abort();
+    }
+    return l == 0 ? source : levels[l - 1].dims;
+}
+
+template <typename T> velm_DR::ndarray_view<const T, 3> lod_pyramid<T>::level(std::size_t l) const {
+    if (l == 0 || l >= level_count()) {
+        abort();
+    }
+    return levels[l - 1].view();
+}
+
+template <typename T>
+lod_selection lod_pyramid<T>::select(const std::size_t (&begin)[3],
+                                     const std::size_t (&end)[3],
+                                     double             screen_pixels,
+                                     double             max_error_pixels) const {
+    std::size_t longest = 0;
+    for (std::size_t a = 0; a < 3; ++a) {
+        if (begin[a] > end[a] || end[a] > source[a]) {
+            abort();
+        }
+        longest = std::max(longest, end[a] - begin[a]);
+    }
+
+    lod_selection selection;
+    if (longest > 0 && screen_pixels > 0.0) {
+        // pixels covered by one source voxel; each level doubles it
+        double voxel_pixels = screen_pixels / static_cast<double>(longest);
+        while (selection.level + 1 < level_count() &&
+               voxel_pixels * std::ldexp(1.0, static_cast<int>(selection.level + 1)) <= max_error_pixels) {
+            ++selection.level;
+        }
+    } else if (longest > 0) {
+        // off screen or degenerate projection: anything will do
+        selection.level = level_count() - 1;
+    }
+    const std::size_t * level_dims = dims(selection.level);
+    for (std::size_t a = 0; a < 3; ++a) {
+        std::size_t first   = begin[a] >> selection.level;
+        std::size_t last    = (end[a] + (std::size_t(1) << selection.level) - 1) >> selection.level;
+        selection.begin[a]  = first;
+        selection.extent[a] = std::min(last, level_dims[a]) - first;
+    }
+    return selection;
+}
+
+template class lod_pyramid<float>;
+template class lod_pyramid<double>;
+
+};  // namespace velm_DP
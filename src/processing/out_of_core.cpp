@@ -0,0 +1,218 @@
+#include "velm/processing/out_of_core.h"
+
+#include "velm/core/profiler.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+namespace velm_DP {
+
+namespace {
+
+// a stretch of block samples along one axis, read from a contiguous range of the grid
+struct segment {
+    std::size_t block;
+    std::size_t grid;
+    std::size_t count;
+};
+
+/*
+ * Tile t of the output grown by one sample on every side: clipped to the grid, except along periodic axes longer
+ * than one sample, where the halo wraps to the opposite side. `inner` is where the tile starts inside the block.
+ */
+struct halo_block {
+    std::size_t          origin[3];
+    std::size_t          extent[3];
+    std::size_t          dims[3];
+    std::size_t          inner[3];
+    std::vector<segment> segments[3];
+};
+
+template <typename T> halo_block plan_block(const vlem::tiled_field<T> & out, std::size_t t, boundary edges) {
+    halo_block block;
+    out.tile_box(t, block.origin, block.extent);
+    for (std::size_t a = 0; a < 3; ++a) {
+        const std::size_t n    = out.dims()[a];
+        const bool        wrap = edges == boundary::periodic && n > 1;
+        std::size_t       lo   = block.origin[a];
+        std::size_t       hi   = block.origin[a] + block.extent[a];
+        bool              below = lo > 0 || wrap;
+        bool              above = hi < n || wrap;
+
+        block.inner[a] = below ? 1 : 0;
+        block.dims[a]  = block.extent[a] + (below ? 1 : 0) + (above ? 1 : 0);
+        std::vector<segment> & runs = block.segments[a];
+        if (below) {
+            runs.push_back({ 0, lo > 0 ? lo - 1 : n - 1, 1 });
+        }
+        runs.push_back({ block.inner[a], lo, block.extent[a] });
+        if (above) {
+            runs.push_back({ block.inner[a] + block.extent[a], hi < n ? hi : 0, 1 });
+        }
+        // neighbouring runs that are also neighbours in the grid are read in one go
+        std::vector<segment> merged;
+        for (const segment & s : runs) {
+            if (!merged.empty() && merged.back().grid + merged.back().count == s.grid) {
+                merged.back().count += s.count;
+            } else {
+                merged.push_back(s);
+            }
+        }
+        runs = std::move(merged);
+    }
+    return block;
+}
+
+template <typename T>
+velm_DR::ndarray<T, 3> gather(vlem::tiled_field<T> & field, const halo_block & block) {
+    velm_DR::ndarray<T, 3> values(velm_DR::uninitialized, block.dims);
+    for (const segment & x : block.segments[0]) {
+        for (const segment & y : block.segments[1]) {
+            for (const segment & z : block.segments[2]) {
+                const std::size_t begin[3]  = { x.grid, y.grid, z.grid };
+                const std::size_t at[3]     = { x.block, y.block, z.block };
+                const std::size_t extent[3] = { x.count, y.count, z.count };
+                field.read_box(begin, values.subarray(at, extent));
+            }
+        }
+    }
+    return values;
+}
+
+template <typename T> using blocks = std::vector<velm_DR::ndarray<T, 3>>;
+
+// runs `kernel` on the halo blocks of every output tile and keeps the block interiors
+template <typename T, std::size_t In, std::size_t Out, typename K>
+void run_tiled(vlem::tiled_field<T> * (&inputs)[In],
+               vlem::tiled_field<T> * (&outputs)[Out],
+               const stencil_options<T> & options,
+               K &&                       kernel) {
+    for (vlem::tiled_field<T> * field : inputs) {
+        detail::check_same_tiling(*outputs[0], *field);
+    }
+    for (vlem::tiled_field<T> * field : outputs) {
+        detail::check_same_tiling(*outputs[0], *field);
+    }
+    vlem::tiled_field<T> & first = *outputs[0];
+    // the halo is explicit, so within a block every boundary only decides the outer layer, which is dropped
+    stencil_options<T> local = options;
+    local.edges              = options.edges == boundary::periodic ? boundary::one_sided : options.edges;
+    local.pool               = &first.pool();
+
+    first.pool().parallel_for(first.tile_count(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t t = begin; t < end; ++t) {
+            VELM_PROFILE_ZONE("out_of_core.stencil_tile", "processing");
+            halo_block block = plan_block(first, t, options.edges);
+            blocks<T>  in;
+            blocks<T>  result;
+            in.reserve(In);
+            result.reserve(Out);
+            for (vlem::tiled_field<T> * field : inputs) {
+                in.push_back(gather(*field, block));
+            }
+            for (std::size_t o = 0; o < Out; ++o) {
+                result.emplace_back(velm_DR::uninitialized, block.dims);
+            }
+            kernel(in, result, local);
+            for (std::size_t o = 0; o < Out; ++o) {
+                auto tile = outputs[o]->acquire(t, vlem::tile_access::overwrite);
+                vlem::detail::copy_box<T>(result[o].subarray(block.inner, block.extent), tile.view());
+            }
+        }
+    });
+}
+
+}  // namespace
+
+template <typename T> void downsample(vlem::tiled_field<T> & in, lod_filter filter, vlem::tiled_field<T> & out) {
+    for (std::size_t a = 0; a < 3; ++a) {
+        if (out.dims()[a] != (in.dims()[a] + 1) / 2) {
+            abort();
+        }
+    }
+    // output tiles start on even source indices, so each one is a whole level 1 of its source box
+    lod_options level;
+    level.max_levels = 1;
+    level.pool       = &out.pool();
+    out.pool().parallel_for(out.tile_count(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t t = begin; t < end; ++t) {
+            VELM_PROFILE_ZONE("out_of_core.downsample_tile", "processing");
+            std::size_t origin[3], extent[3], source_begin[3], source_extent[3];
+            out.tile_box(t, origin, extent);
+            for (std::size_t a = 0; a < 3; ++a) {
+                source_begin[a]  = 2 * origin[a];
+                source_extent[a] = std::min(2 * extent[a], in.dims()[a] - source_begin[a]);
+            }
+            velm_DR::ndarray<T, 3> source(velm_DR::uninitialized, source_extent);
+            in.read_box(source_begin, source.view());
+
+            auto tile = out.acquire(t, vlem::tile_access::overwrite);
+            if (source.total_elements() == 1) {
+                // a single voxel has no coarser level
+                tile.view()(0, 0, 0) = source(0, 0, 0);
+                continue;
+            }
+            lod_pyramid<T> pyramid(velm_DR::ndarray_view<const T, 3>(source.view()), filter, level);
+            vlem::detail::copy_box<T>(pyramid.level(1), tile.view());
+        }
+    });
+}
+
+template <typename T>
+void curl(vlem::tiled_field<T> &     fx,
+          vlem::tiled_field<T> &     fy,
+          vlem::tiled_field<T> &     fz,
+          vlem::tiled_field<T> &     cx,
+          vlem::tiled_field<T> &     cy,
+          vlem::tiled_field<T> &     cz,
+          const stencil_options<T> & options) {
+    vlem::tiled_field<T> * in[3]  = { &fx, &fy, &fz };
+    vlem::tiled_field<T> * out[3] = { &cx, &cy, &cz };
+    run_tiled(in, out, options, [](blocks<T> & f, blocks<T> & c, const stencil_options<T> & local) {
+        curl<T>(f[0].view(), f[1].view(), f[2].view(), c[0].view(), c[1].view(), c[2].view(), local);
+    });
+}
+
+template <typename T>
+void divergence(vlem::tiled_field<T> &     fx,
+                vlem::tiled_field<T> &     fy,
+                vlem::tiled_field<T> &     fz,
+                vlem::tiled_field<T> &     out,
+                const stencil_options<T> & options) {
+    vlem::tiled_field<T> * in[3]     = { &fx, &fy, &fz };
+    vlem::tiled_field<T> * result[1] = { &out };
+    run_tiled(in, result, options, [](blocks<T> & f, blocks<T> & d, const stencil_options<T> & local) {
+        divergence<T>(f[0].view(), f[1].view(), f[2].view(), d[0].view(), local);
+    });
+}
+
+template <typename T>
+void gradient(vlem::tiled_field<T> &     phi,
+              vlem::tiled_field<T> &     gx,
+              vlem::tiled_field<T> &     gy,
+              vlem::tiled_field<T> &     gz,
+              const stencil_options<T> & options) {
+    vlem::tiled_field<T> * in[1]  = { &phi };
+    vlem::tiled_field<T> * out[3] = { &gx, &gy, &gz };
+    run_tiled(in, out, options, [](blocks<T> & p, blocks<T> & g, const stencil_options<T> & local) {
+        gradient<T>(p[0].view(), g[0].view(), g[1].view(), g[2].view(), local);
+    });
+}
+
+#define VELM_INSTANTIATE_OUT_OF_CORE(T)                                                                             \
+    template void downsample<T>(vlem::tiled_field<T> &, lod_filter, vlem::tiled_field<T> &);                       \
+    template void curl<T>(vlem::tiled_field<T> &, vlem::tiled_field<T> &, vlem::tiled_field<T> &,                  \
+                          vlem::tiled_field<T> &, vlem::tiled_field<T> &, vlem::tiled_field<T> &,                  \
+                          const stencil_options<T> &);                                                            \
+    template void divergence<T>(vlem::tiled_field<T> &, vlem::tiled_field<T> &, vlem::tiled_field<T> &,            \
+                                vlem::tiled_field<T> &, const stencil_options<T> &);                              \
+    template void gradient<T>(vlem::tiled_field<T> &, vlem::tiled_field<T> &, vlem::tiled_field<T> &,              \
+                              vlem::tiled_field<T> &, const stencil_options<T> &);
+
+VELM_INSTANTIATE_OUT_OF_CORE(float)
+VELM_INSTANTIATE_OUT_OF_CORE(double)
+
+#undef VELM_INSTANTIATE_OUT_OF_CORE
+
+};  // namespace velm_DP
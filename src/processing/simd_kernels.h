@@ -0,0 +1,206 @@
+#pragma once
+
+#include "velm/processing/kernels.h"
+
+#include <cstddef>
+#include <limits>
+
+namespace velm_DP {
+
+/*
+ * Kernel bodies shared by every instruction set, written against a batch type B describing one SIMD register:
+ *
+ *   scalar, vector, width           element type, register type, lanes per register
+ *   zero, set1, load, store         loads and stores are unaligned
+ *   add, sub, mul, fmadd, sqrt      fmadd(a, b, c) = a * b + c
+ *   min, max
+ *
+ * Each kernels_<isa>.cpp defines its batch types in an anonymous namespace, so the instantiations below are local
+ * to a translation unit compiled with that instruction set. For the same reason this header must not call inline
+ * functions from other headers: the linker could pick a copy compiled for a wider instruction set than the CPU has.
+ * Loop tails are padded into a full register rather than running a scalar loop, for the same reason.
+ */
+template <typename B> struct simd_kernels {
+    using T = typename B::scalar;
+    using V = typename B::vector;
+
+    static constexpr std::size_t width = B::width;
+    // registers summed in T lanes before the partial sums are folded into the double total
+    static constexpr std::size_t flush_interval = 256;
+
+    class accumulator {
+      public:
+        accumulator() : lo(B::set1(infinity)), hi(B::set1(-infinity)), sum(B::zero()) {}
+
+        void add(V v) {
+            lo  = B::min(lo, v);
+            hi  = B::max(hi, v);
+            sum = B::add(sum, v);
+            if (++pending == flush_interval) {
+                flush();
+            }
+        }
+
+        // only the first `lanes` lanes of v are valid
+        void add_partial(V v, std::size_t lanes) {
+            T values[width];
+            B::store(values, v);
+            for (std::size_t i = 0; i < lanes; ++i) {
+                tail_lo = values[i] < tail_lo ? values[i] : tail_lo;
+                tail_hi = values[i] > tail_hi ? values[i] : tail_hi;
+                total += static_cast<double>(values[i]);
+            }
+        }
+
+        [[nodiscard]] field_stats<T> finish(std::size_t count) {
+            flush();
+            T lows[width];
+            T highs[width];
+            B::store(lows, lo);
+            B::store(highs, hi);
+            T min = tail_lo;
+            T max = tail_hi;
+            for (std::size_t i = 0; i < width; ++i) {
+                min = lows[i] < min ? lows[i] : min;
+                max = highs[i] > max ? highs[i] : max;
+            }
+            return field_stats<T>{ min, max, total, count };
+        }
+
+      private:
+        // a constant, so numeric_limits is evaluated at compile time and never emitted from this translation unit
+        static constexpr T infinity = std::numeric_limits<T>::infinity();
+
+        void flush() {
+            T lanes[width];
+            B::store(lanes, sum);
+            for (std::size_t i = 0; i < width; ++i) {
+                total += static_cast<double>(lanes[i]);
+            }
+            sum     = B::zero();
+            pending = 0;
+        }
+
+        V           lo;
+        V           hi;
+        V           sum;
+        T           tail_lo = infinity;
+        T           tail_hi = -infinity;
+        double      total   = 0.0;
+        std::size_t pending = 0;
+    };
+
+    // loads the last `lanes` < width elements, padding the register with zeros
+    static V load_tail(const T * p, std::size_t lanes) {
+        T padded[width] = {};
+        for (std::size_t i = 0; i < lanes; ++i) {
+            padded[i] = p[i];
+        }
+        return B::load(padded);
+    }
+
+    static void store_tail(T * p, V v, std::size_t lanes) {
+        T values[width];
+        B::store(values, v);
+        for (std::size_t i = 0; i < lanes; ++i) {
+            p[i] = values[i];
+        }
+    }
+
+    static field_stats<T> stats(const T * x, std::size_t n) {
+        accumulator acc;
+        std::size_t i = 0;
+        for (; i + width <= n; i += width) {
+            acc.add(B::load(x + i));
+        }
+        if (i < n) {
+            acc.add_partial(load_tail(x + i, n - i), n - i);
+        }
+        return acc.finish(n);
+    }
+
+    static V magnitude_of(V x, V y, V z) { return B::sqrt(B::fmadd(x, x, B::fmadd(y, y, B::mul(z, z)))); }
+
+    static field_stats<T> magnitude(const T * const * xyz, T * out, std::size_t n) {
+        const T *   x = xyz[0];
+        const T *   y = xyz[1];
+        const T *   z = xyz[2];
+        accumulator acc;
+        std::size_t i = 0;
+        for (; i + width <= n; i += width) {
+            V m = magnitude_of(B::load(x + i), B::load(y + i), B::load(z + i));
+            B::store(out + i, m);
+            acc.add(m);
+        }
+        if (i < n) {
+            std::size_t lanes = n - i;
+            V           m     = magnitude_of(load_tail(x + i, lanes), load_tail(y + i, lanes), load_tail(z + i, lanes));
+            store_tail(out + i, m, lanes);
+            acc.add_partial(m, lanes);
+        }
+        return acc.finish(n);
+    }
+
+    static void cross_of(const V (&a)[3], const V (&b)[3], V (&c)[3]) {
+        c[0] = B::sub(B::mul(a[1], b[2]), B::mul(a[2], b[1]));
+        c[1] = B::sub(B::mul(a[2], b[0]), B::mul(a[0], b[2]));
+        c[2] = B::sub(B::mul(a[0], b[1]), B::mul(a[1], b[0]));
+    }
+
+    static void cross(const T * const * a, const T * const * b, T * const * out, std::size_t n) {
+        std::size_t i = 0;
+        for (; i + width <= n; i += width) {
+            V va[3] = { B::load(a[0] + i), B::load(a[1] + i), B::load(a[2] + i) };
+            V vb[3] = { B::load(b[0] + i), B::load(b[1] + i), B::load(b[2] + i) };
+            V vc[3];
+            cross_of(va, vb, vc);
+            for (std::size_t k = 0; k < 3; ++k) {
+                B::store(out[k] + i, vc[k]);
+            }
+        }
+        if (i < n) {
+            std::size_t lanes = n - i;
+            V           va[3] = { load_tail(a[0] + i, lanes), load_tail(a[1] + i, lanes), load_tail(a[2] + i, lanes) };
+            V           vb[3] = { load_tail(b[0] + i, lanes), load_tail(b[1] + i, lanes), load_tail(b[2] + i, lanes) };
+            V           vc[3];
+            cross_of(va, vb, vc);
+            for (std::size_t k = 0; k < 3; ++k) {
+                store_tail(out[k] + i, vc[k], lanes);
+            }
+        }
+    }
+
+    static V energy_of(const V (&e)[3], const V (&h)[3], V half_epsilon, V half_inv_mu) {
+        V e2 = B::fmadd(e[0], e[0], B::fmadd(e[1], e[1], B::mul(e[2], e[2])));
+        V h2 = B::fmadd(h[0], h[0], B::fmadd(h[1], h[1], B::mul(h[2], h[2])));
+        return B::fmadd(half_epsilon, e2, B::mul(half_inv_mu, h2));
+    }
+
+    static field_stats<T>
+    energy_density(const T * const * e, const T * const * h, T * out, std::size_t n, T epsilon, T mu) {
+        V           half_epsilon = B::set1(epsilon * T(0.5));
+        V           half_inv_mu  = B::set1(T(0.5) / mu);
+        accumulator acc;
+        std::size_t i = 0;
+        for (; i + width <= n; i += width) {
+            V ve[3] = { B::load(e[0] + i), B::load(e[1] + i), B::load(e[2] + i) };
+            V vh[3] = { B::load(h[0] + i), B::load(h[1] + i), B::load(h[2] + i) };
+            V u     = energy_of(ve, vh, half_epsilon, half_inv_mu);
+            B::store(out + i, u);
+            acc.add(u);
+        }
+        if (i < n) {
+            std::size_t lanes = n - i;
+            V           ve[3] = { load_tail(e[0] + i, lanes), load_tail(e[1] + i, lanes), load_tail(e[2] + i, lanes) };
+            V           vh[3] = { load_tail(h[0] + i, lanes), load_tail(h[1] + i, lanes), load_tail(h[2] + i, lanes) };
+            V           u     = energy_of(ve, vh, half_epsilon, half_inv_mu);
+            store_tail(out + i, u, lanes);
+            acc.add_partial(u, lanes);
+        }
+        return acc.finish(n);
+    }
+
+    static constexpr detail::kernel_table<T> table = { &stats, &magnitude, &cross, &energy_density };
+};
+
+};  // namespace velm_DP
@@ -0,0 +1,284 @@
+#include "velm/processing/stencil.h"
+
+#include "velm/core/profiler.h"
+
+#include <cstdlib>
+
+namespace velm_DP {
+
+namespace {
+
+// rows per tile along x and y; neighbouring rows of a tile are still in cache when the next row needs them
+constexpr std::size_t tile_planes = 4;
+constexpr std::size_t tile_rows   = 16;
+
+// the two samples a difference reads for output index i, and the factor applied to hi - lo
+template <typename T> struct sample_pair {
+    std::size_t lo        = 0;
+    std::size_t hi        = 0;
+    bool        lo_inside = true;
+    bool        hi_inside = true;
+    T           factor    = T(0);
+};
+
+template <typename T>
+sample_pair<T> neighbours(std::size_t i, std::size_t n, const stencil_options<T> & options, std::size_t axis) {
+    std::ptrdiff_t lo = static_cast<std::ptrdiff_t>(i);
+    std::ptrdiff_t hi = static_cast<std::ptrdiff_t>(i);
+    if (options.scheme != difference::forward) {
+        --lo;
+    }
+    if (options.scheme != difference::backward) {
+        ++hi;
+    }
+    const std::ptrdiff_t size = static_cast<std::ptrdiff_t>(n);
+    const T              h    = options.spacing[axis];
+
+    sample_pair<T> pair;
+    if (n == 1) {
+        // no extent along this axis, so no variation either
+        return pair;
+    }
+    switch (options.edges) {
+        case boundary::periodic:
+            pair.factor = T(1) / (static_cast<T>(hi - lo) * h);
+            lo          = (lo + size) % size;
+            hi          = hi % size;
+            break;
+        case boundary::zero:
+            pair.factor    = T(1) / (static_cast<T>(hi - lo) * h);
+            pair.lo_inside = lo >= 0;
+            pair.hi_inside = hi < size;
+            lo             = lo < 0 ? 0 : lo;
+            hi             = hi >= size ? size - 1 : hi;
+            break;
+        case boundary::one_sided:
+            lo = lo < 0 ? 0 : lo;
+            hi = hi >= size ? size - 1 : hi;
+            if (hi == lo) {
+                // a forward difference at the last sample becomes a backward one and vice versa
+                if (lo > 0) {
+                    --lo;
+                } else {
+                    ++hi;
+                }
+            }
+            pair.factor = T(1) / (static_cast<T>(hi - lo) * h);
+            break;
+    }
+    pair.lo = static_cast<std::size_t>(lo);
+    pair.hi = static_cast<std::size_t>(hi);
+    return pair;
+}
+
+// one derivative contributing to an output component: sign * d(field)/d(axis)
+template <typename T> struct term {
+    field_view<T> field;
+    std::size_t   axis = 0;
+    T             sign = T(1);
+};
+
+template <typename T> struct target {
+    field_out_view<T> out;
+    term<T>           terms[3];
+    std::size_t       count = 0;
+};
+
+template <typename T> const T * row_of(const field_view<T> & field, std::size_t i, std::size_t j) {
+    return field.data + i * field.strides[0] + j * field.strides[1];
+}
+
+// out (+)= factor * (hi - lo) over whole rows, a missing row reads as zero
+template <typename T>
+void difference_rows(T * __restrict out, const T * hi, const T * lo, T factor, std::size_t n, bool accumulate) {
+    if (hi != nullptr && lo != nullptr) {
+        if (accumulate) {
+            for (std::size_t k = 0; k < n; ++k) {
+                out[k] += factor * (hi[k] - lo[k]);
+            }
+        } else {
+            for (std::size_t k = 0; k < n; ++k) {
+                out[k] = factor * (hi[k] - lo[k]);
+            }
+        }
+        return;
+    }
+    const T * one  = hi != nullptr ? hi : lo;
+    T         sign = hi != nullptr ? factor : -factor;
+    for (std::size_t k = 0; k < n; ++k) {
+        T value = one != nullptr ? sign * one[k] : T(0);
+        out[k]  = accumulate ? out[k] + value : value;
+    }
+}
+
+// out (+)= factor * d/dz along a single row
+template <typename T>
+void difference_along_row(T * __restrict out,
+                          const T * __restrict row,
+                          std::size_t                n,
+                          const stencil_options<T> & options,
+                          T                          sign,
+                          bool                       accumulate) {
+    // interior samples all read the same offsets, so they form one vectorisable loop
+    std::size_t begin = 0;
+    std::size_t end   = 0;
+    if (n > 2) {
+        std::ptrdiff_t lo_offset = options.scheme == difference::forward ? 0 : -1;
+        std::ptrdiff_t hi_offset = options.scheme == difference::backward ? 0 : 1;
+        T              factor    = sign / (static_cast<T>(hi_offset - lo_offset) * options.spacing[2]);
+        begin                    = lo_offset < 0 ? 1 : 0;
+        end                      = hi_offset > 0 ? n - 1 : n;
+        if (accumulate) {
+            for (std::size_t k = begin; k < end; ++k) {
+                out[k] += factor * (row[k + hi_offset] - row[k + lo_offset]);
+            }
+        } else {
+            for (std::size_t k = begin; k < end; ++k) {
+                out[k] = factor * (row[k + hi_offset] - row[k + lo_offset]);
+            }
+        }
+    }
+    // the remaining samples sit on the boundary
+    auto edge = [&](std::size_t k) {
+        sample_pair<T> pair  = neighbours(k, n, options, 2);
+        T              hi    = pair.hi_inside ? row[pair.hi] : T(0);
+        T              lo    = pair.lo_inside ? row[pair.lo] : T(0);
+        T              value = sign * pair.factor * (hi - lo);
+        out[k]               = accumulate ? out[k] + value : value;
+    };
+    for (std::size_t k = 0; k < begin; ++k) {
+        edge(k);
+    }
+    for (std::size_t k = end; k < n; ++k) {
+        edge(k);
+    }
+}
+
+template <typename T>
+void apply_term(T * out, const term<T> & t, std::size_t i, std::size_t j, const stencil_options<T> & options,
+                bool accumulate) {
+    const std::size_t * dims = t.field.dims;
+    if (t.axis == 2) {
+        difference_along_row(out, row_of(t.field, i, j), dims[2], options, t.sign, accumulate);
+        return;
+    }
+    sample_pair<T> pair = neighbours(t.axis == 0 ? i : j, dims[t.axis], options, t.axis);
+    const T *      hi   = nullptr;
+    const T *      lo   = nullptr;
+    if (pair.hi_inside) {
+        hi = t.axis == 0 ? row_of(t.field, pair.hi, j) : row_of(t.field, i, pair.hi);
+    }
+    if (pair.lo_inside) {
+        lo = t.axis == 0 ? row_of(t.field, pair.lo, j) : row_of(t.field, i, pair.lo);
+    }
+    if (pair.factor == T(0)) {
+        hi = lo = nullptr;
+    }
+    difference_rows(out, hi, lo, t.sign * pair.factor, dims[2], accumulate);
+}
+
+template <typename T, std::size_t Count>
+void run(const target<T> (&targets)[Count], const stencil_options<T> & options) {
+    VELM_PROFILE_ZONE("stencil", "processing");
+    const std::size_t * dims = targets[0].out.dims;
+    for (const target<T> & tgt : targets) {
+        auto check = [&](const auto & view) {
+            for (std::size_t a = 0; a < 3; ++a) {
+                if (view.dims[a] != dims[a]) {
+                    abort();
+                }
+            }
+            if (view.dims[2] > 1 && view.strides[2] != 1) {
+                abort();
+            }
+        };
+        check(tgt.out);
+        for (std::size_t t = 0; t < tgt.count; ++t) {
+            check(tgt.terms[t].field);
+        }
+    }
+    if (dims[0] == 0 || dims[1] == 0 || dims[2] == 0) {
+        return;
+    }
+
+    const std::size_t      tiles_x = (dims[0] + tile_planes - 1) / tile_planes;
+    const std::size_t      tiles_y = (dims[1] + tile_rows - 1) / tile_rows;
+    velm_DR::thread_pool & pool    = options.pool != nullptr ? *options.pool : velm_DR::thread_pool::global();
+    pool.parallel_for(tiles_x * tiles_y, 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t tile = first; tile < last; ++tile) {
+            std::size_t i0 = (tile / tiles_y) * tile_planes;
+            std::size_t j0 = (tile % tiles_y) * tile_rows;
+            std::size_t i1 = i0 + tile_planes < dims[0] ? i0 + tile_planes : dims[0];
+            std::size_t j1 = j0 + tile_rows < dims[1] ? j0 + tile_rows : dims[1];
+            for (std::size_t i = i0; i < i1; ++i) {
+                for (std::size_t j = j0; j < j1; ++j) {
+                    for (const target<T> & tgt : targets) {
+                        T * out = tgt.out.data + i * tgt.out.strides[0] + j * tgt.out.strides[1];
+                        for (std::size_t t = 0; t < tgt.count; ++t) {
+                            apply_term(out, tgt.terms[t], i, j, options, t > 0);
+                        }
+                    }
+                }
+            }
+        }
+    });
+}
+
+}  // namespace
+
+template <typename T>
+void curl(std::type_identity_t<field_view<T>> fx,
+          std::type_identity_t<field_view<T>> fy,
+          std::type_identity_t<field_view<T>> fz,
+          field_out_view<T>                   cx,
+          field_out_view<T>                   cy,
+          field_out_view<T>                   cz,
+          const stencil_options<T> &          options) {
+    const target<T> targets[3] = {
+        { cx, { { fz, 1, T(1) }, { fy, 2, T(-1) } }, 2 },
+        { cy, { { fx, 2, T(1) }, { fz, 0, T(-1) } }, 2 },
+        { cz, { { fy, 0, T(1) }, { fx, 1, T(-1) } }, 2 },
+    };
+    run(targets, options);
+}
+
+template <typename T>
+void divergence(std::type_identity_t<field_view<T>> fx,
+                std::type_identity_t<field_view<T>> fy,
+                std::type_identity_t<field_view<T>> fz,
+                field_out_view<T>                   out,
+                const stencil_options<T> &          options) {
+    const target<T> targets[1] = {
+        { out, { { fx, 0, T(1) }, { fy, 1, T(1) }, { fz, 2, T(1) } }, 3 },
+    };
+    run(targets, options);
+}
+
+template <typename T>
+void gradient(std::type_identity_t<field_view<T>> phi,
+              field_out_view<T>                   gx,
+              field_out_view<T>                   gy,
+              field_out_view<T>                   gz,
+              const stencil_options<T> &          options) {
+    const target<T> targets[3] = {
+        { gx, { { phi, 0, T(1) } }, 1 },
+        { gy, { { phi, 1, T(1) } }, 1 },
+        { gz, { { phi, 2, T(1) } }, 1 },
+    };
+    run(targets, options);
+}
+
+#define VELM_INSTANTIATE_STENCILS(T)                                                                                \
+    template void curl<T>(field_view<T>, field_view<T>, field_view<T>, field_out_view<T>, field_out_view<T>,      \
+                          field_out_view<T>, const stencil_options<T> &);                                         \
+    template void divergence<T>(field_view<T>, field_view<T>, field_view<T>, field_out_view<T>,                   \
+                                const stencil_options<T> &);                                                      \
+    template void gradient<T>(field_view<T>, field_out_view<T>, field_out_view<T>, field_out_view<T>,             \
+                              const stencil_options<T> &);
+
+VELM_INSTANTIATE_STENCILS(float)
+VELM_INSTANTIATE_STENCILS(double)
+
+#undef VELM_INSTANTIATE_STENCILS
+
+};  // namespace velm_DP
@@ -0,0 +1,275 @@
+#include "velm/processing/streamlines.h"
+
+#include "velm/core/profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+namespace velm_DP {
+
+namespace {
+
+// Dormand-Prince 5(4): row s gives stage s + 2 from the stages before it, the last row being the fifth-order weights
+constexpr double tableau[6][6] = {
+    { 1.0 / 5 },
+    { 3.0 / 40, 9.0 / 40 },
+    { 44.0 / 45, -56.0 / 15, 32.0 / 9 },
+    { 19372.0 / 6561, -25360.0 / 2187, 64448.0 / 6561, -212.0 / 729 },
+    { 9017.0 / 3168, -355.0 / 33, 46732.0 / 5247, 49.0 / 176, -5103.0 / 18656 },
+    { 35.0 / 384, 0.0, 500.0 / 1113, 125.0 / 192, -2187.0 / 6784, 11.0 / 84 },
+};
+// fifth- minus fourth-order weights, giving the local error estimate
+constexpr double error_weights[7] = {
+    71.0 / 57600, 0.0, -71.0 / 16695, 71.0 / 1920, -17253.0 / 339200, 22.0 / 525, -1.0 / 40,
+};
+
+// trilinear interpolation of the three components at world positions
+class field_sampler {
+  public:
+    field_sampler(velm_DR::ndarray_view<const float, 3> (&components)[3], const streamline_options & options) {
+        for (std::size_t c = 0; c < 3; ++c) {
+            data[c] = components[c].data;
+            for (std::size_t a = 0; a < 3; ++a) {
+                if (components[c].dims[a] != components[0].dims[a]) {
+                    abort();
+                }
+                strides[c][a] = components[c].strides[a];
+            }
+        }
+        for (std::size_t a = 0; a < 3; ++a) {
+            n[a]           = components[0].dims[a];
+            origin[a]      = options.origin[a];
+            inv_spacing[a] = 1.0 / options.spacing[a];
+        }
+    }
+
+    // whether the grid has cells to interpolate in
+    [[nodiscard]] bool valid() const { return n[0] >= 2 && n[1] >= 2 && n[2] >= 2; }
+
+    // false outside the grid
+    bool sample(const double (&p)[3], double (&v)[3]) const {
+        std::size_t cell[3];
+        double      t[3];
+        for (std::size_t a = 0; a < 3; ++a) {
+            double u = (p[a] - origin[a]) * inv_spacing[a];
+            if (!(u >= 0.0 && u <= static_cast<double>(n[a] - 1))) {
+                return false;
+            }
+            cell[a] = std::min(static_cast<std::size_t>(u), n[a] - 2);
+            t[a]    = u - static_cast<double>(cell[a]);
+        }
+        for (std::size_t c = 0; c < 3; ++c) {
+            const std::size_t * s  = strides[c];
+            const float *       p0 = data[c] + cell[0] * s[0] + cell[1] * s[1] + cell[2] * s[2];
+            const float *       p1 = p0 + s[0];
+            double              x00 = p0[0] + t[2] * (p0[s[2]] - p0[0]);
+            double              x01 = p0[s[1]] + t[2] * (p0[s[1] + s[2]] - p0[s[1]]);
+            double              x10 = p1[0] + t[2] * (p1[s[2]] - p1[0]);
+            double              x11 = p1[s[1]] + t[2] * (p1[s[1] + s[2]] - p1[s[1]]);
+            double              x0  = x00 + t[1] * (x01 - x00);
+            double              x1  = x10 + t[1] * (x11 - x10);
+            v[c]                    = x0 + t[0] * (x1 - x0);
+        }
+        return true;
+    }
+
+  private:
+    const float * data[3];
+    std::size_t   strides[3][3];
+    std::size_t   n[3];
+    double        origin[3];
+    double        inv_spacing[3];
+};
+
+class line_tracer {
+  public:
+    line_tracer(const field_sampler & field, const streamline_options & options) : field(field), options(options) {
+        double unit = std::min({ options.spacing[0], options.spacing[1], options.spacing[2] });
+        first_step  = options.first_step * unit;
+        min_step    = options.min_step * unit;
+        max_step    = options.max_step * unit;
+        tolerance   = options.tolerance * unit;
+    }
+
+    // appends the line from `seed` along sign * v, seed first; nothing if the seed cannot be evaluated
+    void trace(const double (&seed)[3], double sign, std::vector<line_vertex> & out, std::size_t & rejected) const {
+        double y[3] = { seed[0], seed[1], seed[2] };
+        double k[7][3];
+        double speed;
+        if (!direction(y, sign, k[0], speed)) {
+            return;
+        }
+        append(out, y, speed);
+
+        double h = first_step, length = 0.0;
+        for (std::size_t points = 1; points < options.max_points && length < options.max_length; ++points) {
+            double next[3], error = 0.0;
+            for (;;) {
+                h = std::min(h, static_cast<double>(options.max_length) - length);
+                if (stages(y, h, sign, k, next, speed)) {
+                    error = estimate(k, h);
+                    if (error <= tolerance || h <= min_step) {
+                        break;
+                    }
+                    h *= std::max(0.2, 0.9 * std::pow(tolerance / error, 0.2));
+                } else {
+                    // a stage left the grid or hit a null of the field
+                    h *= 0.5;
+                }
+                ++rejected;
+                if (h < min_step) {
+                    return;
+                }
+            }
+            std::copy(std::begin(next), std::end(next), y);
+            append(out, y, speed);
+            // turning back within one step: a sink or null the line cannot pass, where it would only dither
+            if (k[6][0] * k[0][0] + k[6][1] * k[0][1] + k[6][2] * k[0][2] < 0.0) {
+                return;
+            }
+            std::copy(std::begin(k[6]), std::end(k[6]), k[0]);
+            length += h;
+            double growth = error > 0.0 ? 0.9 * std::pow(tolerance / error, 0.2) : 5.0;
+            h             = std::min(h * std::clamp(growth, 0.2, 5.0), max_step);
+        }
+    }
+
+  private:
+    bool direction(const double (&p)[3], double sign, double (&d)[3], double & speed) const {
+        double v[3];
+        if (!field.sample(p, v)) {
+            return false;
+        }
+        speed = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        if (!(speed >= options.min_speed)) {
+            return false;
+        }
+        for (std::size_t c = 0; c < 3; ++c) {
+            d[c] = sign * v[c] / speed;
+        }
+        return true;
+    }
+
+    // stages 2-7 from k[0]; `next` is the fifth-order solution, where the last stage is evaluated (FSAL)
+    bool stages(const double (&y)[3],
+                double h,
+                double sign,
+                double (&k)[7][3],
+                double (&next)[3],
+                double & speed) const {
+        for (std::size_t s = 0; s < 6; ++s) {
+            for (std::size_t c = 0; c < 3; ++c) {
+                double sum = 0.0;
+                for (std::size_t j = 0; j <= s; ++j) {
+                    sum += tableau[s][j] * k[j][c];
+                }
+                next[c] = y[c] + h * sum;
+            }
+            if (!direction(next, sign, k[s + 1], speed)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static double estimate(const double (&k)[7][3], double h) {
+        double error = 0.0;
+        for (std::size_t c = 0; c < 3; ++c) {
+            double sum = 0.0;
+            for (std::size_t s = 0; s < 7; ++s) {
+                sum += error_weights[s] * k[s][c];
+            }
+            error = std::max(error, std::abs(h * sum));
+        }
+        return error;
+    }
+
+    static void append(std::vector<line_vertex> & out, const double (&p)[3], double speed) {
+        out.push_back({ { static_cast<float>(p[0]), static_cast<float>(p[1]), static_cast<float>(p[2]) },
+                        static_cast<float>(speed) });
+    }
+
+    const field_sampler &      field;
+    const streamline_options & options;
+    double                     first_step, min_step, max_step, tolerance;
+};
+
+// where the vertices of one seed's line were left by the block that traced it
+struct traced_line {
+    std::size_t block  = 0;
+    std::size_t offset = 0;
+    std::size_t count  = 0;
+};
+
+}  // namespace
+
+streamline_set trace_streamlines(velm_DR::ndarray_view<const float, 3> fx,
+                                 velm_DR::ndarray_view<const float, 3> fy,
+                                 velm_DR::ndarray_view<const float, 3> fz,
+                                 velm_DR::ndarray_view<const float, 2> seeds,
+                                 const streamline_options &            options) {
+    VELM_PROFILE_ZONE("streamlines.trace", "processing");
+    if (seeds.dims[1] != 3) {
+        abort();
+    }
+    velm_DR::ndarray_view<const float, 3> components[3] = { fx, fy, fz };
+    const field_sampler                   field(components, options);
+    const line_tracer                     tracer(field, options);
+    velm_DR::thread_pool & pool = options.pool != nullptr ? *options.pool : velm_DR::thread_pool::global();
+
+    // small blocks, taken by whichever thread is free next, keep long lines from piling up on one thread
+    const std::size_t                     seed_count = seeds.dims[0];
+    const std::size_t                     grain      = 4;
+    std::vector<std::vector<line_vertex>> blocks((seed_count + grain - 1) / grain);
+    std::vector<traced_line>              lines(seed_count);
+    std::vector<std::size_t>              rejected(blocks.size());
+    pool.parallel_for(seed_count, grain, [&](std::size_t begin, std::size_t end) {
+        std::vector<line_vertex> & out = blocks[begin / grain];
+        for (std::size_t s = begin; s < end && field.valid(); ++s) {
+            const double  seed[3] = { seeds(s, 0), seeds(s, 1), seeds(s, 2) };
+            traced_line & line    = lines[s];
+            line.block            = begin / grain;
+            line.offset           = out.size();
+            if (options.direction != trace_direction::forward) {
+                tracer.trace(seed, -1.0, out, rejected[begin / grain]);
+                std::reverse(out.begin() + static_cast<std::ptrdiff_t>(line.offset), out.end());
+            }
+            if (options.direction != trace_direction::backward) {
+                // both directions start at the seed, which the backward half already ends with
+                if (options.direction == trace_direction::both && out.size() > line.offset) {
+                    out.pop_back();
+                }
+                tracer.trace(seed, 1.0, out, rejected[begin / grain]);
+            }
+            line.count = out.size() - line.offset;
+        }
+    });
+
+    streamline_set result;
+    result.first.resize(seed_count);
+    result.count.resize(seed_count);
+    std::size_t total = 0;
+    for (std::size_t s = 0; s < seed_count; ++s) {
+        result.first[s] = static_cast<std::int32_t>(total);
+        result.count[s] = static_cast<std::int32_t>(lines[s].count);
+        total += lines[s].count;
+        if (total > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max())) {
+            abort();
+        }
+    }
+    for (std::size_t r : rejected) {
+        result.rejected_steps += r;
+    }
+    result.vertices.resize(total);
+    pool.parallel_for(seed_count, 64, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t s = begin; s < end; ++s) {
+            const line_vertex * in = blocks[lines[s].block].data() + lines[s].offset;
+            std::copy(in, in + lines[s].count, result.vertices.begin() + result.first[s]);
+        }
+    });
+    return result;
+}
+
+};  // namespace velm_DP
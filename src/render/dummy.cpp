@@ -1,7 +0,0 @@
-#include "velm/velm.h"
-
-#include <GLFW/glfw3.h>
-
-int dummy() {
-    return 0;
-}
@@ -0,0 +1,95 @@
+#include "velm/render/frame_timer.h"
+
+#include "velm/core/profiler.h"
+
+#include <glad/gl.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace velm_GL {
+
+namespace {
+
+void summarize(const std::array<double, frame_timer::window> & times,
+               std::size_t                                    count,
+               double &                                       last,
+               double &                                       mean,
+               double &                                       max) {
+    std::size_t n = std::min(count, frame_timer::window);
+    if (n == 0) {
+        return;
+    }
+    double sum = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        sum += times[i];
+        max = std::max(max, times[i]);
+    }
+    mean = sum / static_cast<double>(n);
+    last = times[(count - 1) % frame_timer::window];
+}
+
+}  // namespace
+
+frame_timer::frame_timer() {
+    glGenQueries(static_cast<GLsizei>(queries), query_names.data());
+}
+
+frame_timer::~frame_timer() {
+    glDeleteQueries(static_cast<GLsizei>(queries), query_names.data());
+}
+
+void frame_timer::begin_frame() {
+    collect();
+    // a query still in flight after `queries` frames is dropped rather than waited for
+    query_pending[next_query] = false;
+    glBeginQuery(GL_TIME_ELAPSED, query_names[next_query]);
+    frame_start = clock::now();
+}
+
+void frame_timer::end_frame() {
+    glEndQuery(GL_TIME_ELAPSED);
+    clock::duration cpu_time        = clock::now() - frame_start;
+    cpu_times[cpu_count++ % window] = std::chrono::duration<double, std::milli>(cpu_time).count();
+#ifdef VELM_ENABLE_PROFILING
+    // the frame spans two calls, so it is recorded by hand rather than by a scoped zone
+    velm_DR::profiler & profiler = velm_DR::profiler::global();
+    if (profiler.enabled()) {
+        std::uint64_t end      = profiler.now();
+        std::uint64_t duration = std::chrono::duration_cast<std::chrono::nanoseconds>(cpu_time).count();
+        profiler.record("frame", "render", end - std::min(duration, end), end);
+    }
+#endif
+    query_pending[next_query]       = true;
+    next_query                      = (next_query + 1) % queries;
+    collect();
+}
+
+void frame_timer::collect() {
+    // oldest first, so the GPU times keep frame order
+    for (std::size_t n = 0; n < queries; ++n) {
+        std::size_t q = (next_query + n) % queries;
+        if (!query_pending[q]) {
+            continue;
+        }
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(query_names[q], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == GL_FALSE) {
+            continue;
+        }
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(query_names[q], GL_QUERY_RESULT, &nanoseconds);
+        gpu_times[gpu_count++ % window] = static_cast<double>(nanoseconds) * 1e-6;
+        query_pending[q]                = false;
+    }
+}
+
+frame_stats frame_timer::stats() const {
+    frame_stats result;
+    result.frames = std::min(cpu_count, window);
+    summarize(cpu_times, cpu_count, result.cpu_last, result.cpu_mean, result.cpu_max);
+    summarize(gpu_times, gpu_count, result.gpu_last, result.gpu_mean, result.gpu_max);
+    return result;
+}
+
+};  // namespace velm_GL
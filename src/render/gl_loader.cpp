@@ -0,0 +1,13 @@
+#define GLAD_GL_IMPLEMENTATION
+#include "velm/render/gl.h"
+
+#include <glad/gl.h>
+
+namespace velm_GL {
+
+int load_gl(gl_loader loader) {
+    int version = gladLoadGL(reinterpret_cast<GLADloadfunc>(loader));
+    return GLAD_VERSION_MAJOR(version) * 10 + GLAD_VERSION_MINOR(version);
+}
+
+};  // namespace velm_GL
@@ -0,0 +1,90 @@
+#include "velm/render/headless_context.h"
+
+#include "velm/render/gl.h"
+
+// EGL's headers must not see glad's macros, so GL_RENDERER is queried through a plain function pointer
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+namespace velm_GL {
+
+namespace {
+
+constexpr unsigned gl_renderer = 0x1F01;  // GL_RENDERER
+
+[[noreturn]] void fail(const char * what) {
+    char code[16];
+    std::snprintf(code, sizeof(code), "%#x", static_cast<unsigned>(eglGetError()));
+    throw std::runtime_error(std::string("headless_context: ") + what + " (EGL error " + code + ")");
+}
+
+}  // namespace
+
+struct headless_context::impl {
+    EGLDisplay  display = EGL_NO_DISPLAY;
+    EGLContext  context = EGL_NO_CONTEXT;
+    std::string renderer;
+};
+
+headless_context::headless_context() : state(std::make_unique<impl>()) {
+    auto get_platform_display =
+        reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (get_platform_display == nullptr) {
+        fail("eglGetPlatformDisplayEXT is not available");
+    }
+    state->display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    EGLint major   = 0;
+    EGLint minor   = 0;
+    if (state->display == EGL_NO_DISPLAY || eglInitialize(state->display, &major, &minor) == EGL_FALSE) {
+        fail("no surfaceless EGL display");
+    }
+    if (eglBindAPI(EGL_OPENGL_API) == EGL_FALSE) {
+        eglTerminate(state->display);
+        fail("desktop OpenGL is not supported");
+    }
+
+    // surfaceless contexts need no config (EGL_KHR_no_config_context)
+    const EGLint attributes[] = { EGL_CONTEXT_MAJOR_VERSION,
+                                  4,
+                                  EGL_CONTEXT_MINOR_VERSION,
+                                  5,
+                                  EGL_CONTEXT_OPENGL_PROFILE_MASK,
+                                  EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                  EGL_NONE };
+    state->context = eglCreateContext(state->display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attributes);
+    if (state->context == EGL_NO_CONTEXT) {
+        eglTerminate(state->display);
+        fail("cannot create an OpenGL 4.5 core context");
+    }
+    make_current();
+    if (load_gl(reinterpret_cast<gl_loader>(eglGetProcAddress)) == 0) {
+        eglDestroyContext(state->display, state->context);
+        eglTerminate(state->display);
+        fail("cannot load the OpenGL entry points");
+    }
+
+    using get_string_proc = const unsigned char * (*)(unsigned);
+    auto get_string       = reinterpret_cast<get_string_proc>(eglGetProcAddress("glGetString"));
+    state->renderer       = reinterpret_cast<const char *>(get_string(gl_renderer));
+}
+
+headless_context::~headless_context() {
+    eglMakeCurrent(state->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(state->display, state->context);
+    eglTerminate(state->display);
+}
+
+void headless_context::make_current() {
+    if (eglMakeCurrent(state->display, EGL_NO_SURFACE, EGL_NO_SURFACE, state->context) == EGL_FALSE) {
+        fail("cannot make the context current");
+    }
+}
+
+const std::string & headless_context::renderer() const {
+    return state->renderer;
+}
+
+};  // namespace velm_GL
@@ -0,0 +1,65 @@
+#include "velm/render/profiler_overlay.h"
+
+#include <imgui.h>
+
+#include <vector>
+
+namespace velm_GL {
+
+void draw_profiler_overlay(velm_DR::profiler & profiler, const frame_stats * frame) {
+    std::vector<velm_DR::stage_stats> stages = profiler.stages();
+    velm_DR::memory_usage             memory = velm_DR::process_memory();
+
+    ImGui::SetNextWindowBgAlpha(0.8f);
+    if (!ImGui::Begin("Profiler", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::End();
+        return;
+    }
+
+    if (frame != nullptr && frame->frames > 0) {
+        ImGui::Text("frame  cpu %.2f ms (mean %.2f, max %.2f)", frame->cpu_last, frame->cpu_mean, frame->cpu_max);
+        ImGui::Text("       gpu %.2f ms (mean %.2f, max %.2f)", frame->gpu_last, frame->gpu_mean, frame->gpu_max);
+    }
+    ImGui::Text("resident %.1f MiB, peak %.1f MiB", static_cast<double>(memory.resident) / (1 << 20),
+                static_cast<double>(memory.peak_resident) / (1 << 20));
+
+    bool recording = profiler.enabled();
+    if (ImGui::Checkbox("record", &recording)) {
+        profiler.enable(recording);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("reset")) {
+        profiler.clear();
+        stages.clear();
+    }
+    if (std::size_t lost = profiler.dropped(); lost > 0) {
+        ImGui::SameLine();
+        ImGui::Text("%zu zones dropped", lost);
+    }
+
+    if (!stages.empty() && ImGui::BeginTable("stages", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+        ImGui::TableSetupColumn("stage");
+        ImGui::TableSetupColumn("calls");
+        ImGui::TableSetupColumn("last ms");
+        ImGui::TableSetupColumn("mean ms");
+        ImGui::TableSetupColumn("max ms");
+        ImGui::TableHeadersRow();
+        for (const velm_DR::stage_stats & stage : stages) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(stage.name);
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", stage.calls);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stage.last);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stage.mean);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stage.max);
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
+};  // namespace velm_GL
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+namespace velm_GL {
+
+namespace detail {
+
+// IEEE binary16 with round-to-nearest-even; overflow goes to infinity and NaN stays NaN
+inline std::uint16_t float_to_half(float value) {
+    std::uint32_t bits = std::bit_cast<std::uint32_t>(value);
+    std::uint16_t sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000u);
+    std::uint32_t abs  = bits & 0x7fffffffu;
+    if (abs >= 0x7f800000u) {
+        return sign | (abs > 0x7f800000u ? 0x7e00u : 0x7c00u);
+    }
+    if (abs >= 0x477ff000u) {
+        // rounds past the largest finite half, 65504
+        return sign | 0x7c00u;
+    }
+    if (abs < 0x38800000u) {
+        // below the smallest normal half: multiples of 2^-24, rounded to even by the FPU
+        float magnitude = std::bit_cast<float>(abs);
+        return sign | static_cast<std::uint16_t>(std::nearbyint(magnitude * 16777216.0f));
+    }
+    // rebias the exponent from 127 to 15 and round the 13 dropped mantissa bits to even
+    return sign | static_cast<std::uint16_t>((abs + 0x0fffu + ((abs >> 13) & 1u) - 0x38000000u) >> 13);
+}
+
+// maps [lo, hi] onto [0, 65535], clamping values outside; NaN becomes 0
+inline std::uint16_t float_to_unorm16(float value, float lo, float scale) {
+    float normalized = (value - lo) * scale;
+    normalized       = normalized > 0.0f ? std::min(normalized, 1.0f) : 0.0f;
+    return static_cast<std::uint16_t>(normalized * 65535.0f + 0.5f);
+}
+
+};  // namespace detail
+
+};  // namespace velm_GL
@@ -0,0 +1,310 @@
+#include "velm/render/texture_streamer.h"
+
+#include "texel_convert.h"
+#include "velm/core/profiler.h"
+
+#include <glad/gl.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace velm_GL {
+
+namespace {
+
+constexpr std::size_t default_slot_bytes = std::size_t(64) << 20;
+
+GLenum internal_format(texel_format format) {
+    switch (format) {
+        case texel_format::float32:
+            return GL_R32F;
+        case texel_format::float16:
+            return GL_R16F;
+        case texel_format::unorm16:
+            return GL_R16;
+    }
+    return GL_R32F;
+}
+
+GLenum pixel_type(texel_format format) {
+    switch (format) {
+        case texel_format::float32:
+            return GL_FLOAT;
+        case texel_format::float16:
+            return GL_HALF_FLOAT;
+        case texel_format::unorm16:
+            return GL_UNSIGNED_SHORT;
+    }
+    return GL_FLOAT;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+texture_streamer::texture_streamer(std::size_t nx, std::size_t ny, std::size_t nz, const streamer_options & options) :
+    options(options) {
+    if (!GLAD_GL_VERSION_4_4) {
+        throw std::runtime_error("texture_streamer needs an OpenGL 4.4 context with loaded entry points");
+    }
+    if (nx == 0 || ny == 0 || nz == 0 || options.staging_slots == 0 || !(options.range_max > options.range_min)) {
+        throw std::runtime_error("texture_streamer: empty volume, no staging slots or empty unorm16 range");
+    }
+    extent[0] = nx;
+    extent[1] = ny;
+    extent[2] = nz;
+
+    GLint max_edge = 0;
+    glGetIntegerv(GL_MAX_3D_TEXTURE_SIZE, &max_edge);
+    if (std::max({ nx, ny, nz }) > static_cast<std::size_t>(max_edge)) {
+        throw std::runtime_error("texture_streamer: volume exceeds GL_MAX_3D_TEXTURE_SIZE of " +
+                                 std::to_string(max_edge));
+    }
+
+    std::size_t plane_bytes = ny * nz * texel_bytes();
+    slot_bytes = options.staging_bytes != 0 ? options.staging_bytes : std::min(nx * plane_bytes, default_slot_bytes);
+    slot_bytes = std::max(slot_bytes, plane_bytes);
+
+    glGenTextures(1, &name);
+    glBindTexture(GL_TEXTURE_3D, name);
+    glTexStorage3D(GL_TEXTURE_3D,
+                   1,
+                   internal_format(options.format),
+                   static_cast<GLsizei>(nz),
+                   static_cast<GLsizei>(ny),
+                   static_cast<GLsizei>(nx));
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    for (GLenum wrap : { GL_TEXTURE_WRAP_S, GL_TEXTURE_WRAP_T, GL_TEXTURE_WRAP_R }) {
+        glTexParameteri(GL_TEXTURE_3D, wrap, GL_CLAMP_TO_EDGE);
+    }
+    glBindTexture(GL_TEXTURE_3D, 0);
+
+    // coherent persistent mappings: writes through `mapped` are visible to later GL commands without a flush
+    const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    slots.resize(options.staging_slots);
+    for (slot & s : slots) {
+        glGenBuffers(1, &s.buffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s.buffer);
+        glBufferStorage(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(slot_bytes), nullptr, access);
+        s.mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(slot_bytes), access);
+        if (s.mapped == nullptr) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            throw std::runtime_error("texture_streamer: could not map a staging buffer of " +
+                                     std::to_string(slot_bytes) + " bytes");
+        }
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+texture_streamer::~texture_streamer() {
+    for (slot & s : slots) {
+        if (s.fence != nullptr) {
+            glDeleteSync(static_cast<GLsync>(s.fence));
+        }
+        if (s.mapped != nullptr) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s.buffer);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+        glDeleteBuffers(1, &s.buffer);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glDeleteTextures(1, &name);
+}
+
+std::size_t texture_streamer::texel_bytes() const {
+    return options.format == texel_format::float32 ? sizeof(float) : sizeof(std::uint16_t);
+}
+
+std::size_t texture_streamer::slab_planes(const std::size_t (&region)[3]) const {
+    return std::max<std::size_t>(1, slot_bytes / (region[1] * region[2] * texel_bytes()));
+}
+
+bool texture_streamer::slot_busy(const slot & s) const {
+    if (s.fence == nullptr) {
+        return false;
+    }
+    GLint status = GL_SIGNALED;
+    glGetSynciv(static_cast<GLsync>(s.fence), GL_SYNC_STATUS, 1, nullptr, &status);
+    return status != GL_SIGNALED;
+}
+
+void texture_streamer::wait_for(slot & s) {
+    if (s.fence == nullptr) {
+        return;
+    }
+    GLsync fence = static_cast<GLsync>(s.fence);
+    if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+        VELM_PROFILE_ZONE("texture.stall", "render");
+        auto start = std::chrono::steady_clock::now();
+        ++counters.stalls;
+        // the flush bit makes sure the fence itself has been submitted, otherwise the wait could never end
+        while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {
+        }
+        counters.stall_seconds += seconds_since(start);
+    }
+    glDeleteSync(fence);
+    s.fence = nullptr;
+}
+
+// converts a slab into tightly packed rows of texels at `destination`, spread over the pool by rows
+template <typename T>
+void texture_streamer::stage(velm_DR::ndarray_view<const T, 3> slab, void * destination, velm_DR::thread_pool & pool) {
+    VELM_PROFILE_ZONE("texture.convert", "render");
+    const std::size_t rows  = slab.dims[0] * slab.dims[1];
+    const std::size_t width = slab.dims[2];
+    const float       lo    = options.range_min;
+    const float       scale = 1.0f / (options.range_max - options.range_min);
+    const std::size_t grain = std::max<std::size_t>(1, 16384 / width);
+    pool.parallel_for(rows, grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t r = begin; r < end; ++r) {
+            const T * in = &slab(r / slab.dims[1], r % slab.dims[1], 0);
+            switch (options.format) {
+                case texel_format::float32: {
+                    float * out = static_cast<float *>(destination) + r * width;
+                    for (std::size_t k = 0; k < width; ++k) {
+                        out[k] = static_cast<float>(in[k * slab.strides[2]]);
+                    }
+                    break;
+                }
+                case texel_format::float16: {
+                    std::uint16_t * out = static_cast<std::uint16_t *>(destination) + r * width;
+                    for (std::size_t k = 0; k < width; ++k) {
+                        out[k] = detail::float_to_half(static_cast<float>(in[k * slab.strides[2]]));
+                    }
+                    break;
+                }
+                case texel_format::unorm16: {
+                    std::uint16_t * out = static_cast<std::uint16_t *>(destination) + r * width;
+                    for (std::size_t k = 0; k < width; ++k) {
+                        out[k] = detail::float_to_unorm16(static_cast<float>(in[k * slab.strides[2]]), lo, scale);
+                    }
+                    break;
+                }
+            }
+        }
+    });
+}
+
+template <typename T> void texture_streamer::upload(velm_DR::ndarray_view<const T, 3> field) {
+    const std::size_t origin[3] = {};
+    upload(field, origin);
+}
+
+template <typename T>
+void texture_streamer::upload(velm_DR::ndarray_view<const T, 3> region, const std::size_t (&origin)[3]) {
+    for (std::size_t a = 0; a < 3; ++a) {
+        if (origin[a] + region.dims[a] > extent[a]) {
+            throw std::runtime_error("texture_streamer: region lies outside the volume");
+        }
+    }
+    if (region.total_elements() == 0) {
+        return;
+    }
+    VELM_PROFILE_ZONE("texture.upload", "render");
+    velm_DR::thread_pool & pool   = options.pool != nullptr ? *options.pool : velm_DR::thread_pool::global();
+    const std::size_t      planes = slab_planes(region.dims);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_3D, name);
+    for (std::size_t first = 0; first < region.dims[0]; first += planes) {
+        std::size_t count = std::min(planes, region.dims[0] - first);
+        slot &      s     = slots[next_slot];
+        next_slot         = (next_slot + 1) % slots.size();
+        wait_for(s);
+
+        velm_DR::ndarray_view<const T, 3> slab = region;
+        slab.data += first * region.strides[0];
+        slab.dims[0] = count;
+        auto start   = std::chrono::steady_clock::now();
+        stage(slab, s.mapped, pool);
+        counters.convert_seconds += seconds_since(start);
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s.buffer);
+        glTexSubImage3D(GL_TEXTURE_3D,
+                        0,
+                        static_cast<GLint>(origin[2]),
+                        static_cast<GLint>(origin[1]),
+                        static_cast<GLint>(origin[0] + first),
+                        static_cast<GLsizei>(region.dims[2]),
+                        static_cast<GLsizei>(region.dims[1]),
+                        static_cast<GLsizei>(count),
+                        GL_RED,
+                        pixel_type(options.format),
+                        nullptr);
+        s.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        ++counters.slabs;
+        counters.bytes += slab.total_elements() * texel_bytes();
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_3D, 0);
+    // submit now, so the copies run while the caller goes on with the frame
+    glFlush();
+    ++counters.uploads;
+}
+
+template <typename T>
+bool texture_streamer::try_upload(velm_DR::ndarray_view<const T, 3> region, const std::size_t (&origin)[3]) {
+    std::size_t slabs = (region.dims[0] + slab_planes(region.dims) - 1) / slab_planes(region.dims);
+    for (std::size_t n = 0; n < std::min(slabs, slots.size()); ++n) {
+        if (slot_busy(slots[(next_slot + n) % slots.size()])) {
+            ++counters.skipped;
+            return false;
+        }
+    }
+    upload(region, origin);
+    return true;
+}
+
+bool texture_streamer::idle() const {
+    return std::none_of(slots.begin(), slots.end(), [this](const slot & s) { return slot_busy(s); });
+}
+
+void texture_streamer::finish() {
+    for (slot & s : slots) {
+        wait_for(s);
+    }
+}
+
+void texture_streamer::read_back(velm_DR::ndarray_view<float, 3> out) const {
+    for (std::size_t a = 0; a < 3; ++a) {
+        if (out.dims[a] != extent[a]) {
+            throw std::runtime_error("texture_streamer: read_back target does not have the volume shape");
+        }
+    }
+    std::vector<float> texels(extent[0] * extent[1] * extent[2]);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_3D, name);
+    glGetTexImage(GL_TEXTURE_3D, 0, GL_RED, GL_FLOAT, texels.data());
+    glBindTexture(GL_TEXTURE_3D, 0);
+
+    // unorm16 texels come back normalised to [0, 1]
+    const bool  quantised = options.format == texel_format::unorm16;
+    const float span      = options.range_max - options.range_min;
+    std::size_t n         = 0;
+    for (std::size_t i = 0; i < extent[0]; ++i) {
+        for (std::size_t j = 0; j < extent[1]; ++j) {
+            for (std::size_t k = 0; k < extent[2]; ++k, ++n) {
+                out(i, j, k) = quantised ? options.range_min + texels[n] * span : texels[n];
+            }
+        }
+    }
+}
+
+#define VELM_INSTANTIATE_UPLOADS(T)                                                                                    \
+    template void texture_streamer::upload<T>(velm_DR::ndarray_view<const T, 3>);                                      \
+    template void texture_streamer::upload<T>(velm_DR::ndarray_view<const T, 3>, const std::size_t (&)[3]);            \
+    template bool texture_streamer::try_upload<T>(velm_DR::ndarray_view<const T, 3>, const std::size_t (&)[3]);
+
+VELM_INSTANTIATE_UPLOADS(float)
+VELM_INSTANTIATE_UPLOADS(double)
+
+#undef VELM_INSTANTIATE_UPLOADS
+
+};  // namespace velm_GL
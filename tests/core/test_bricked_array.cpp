@@ -0,0 +1,183 @@
+#include "velm/core/bricked_array.h"
+#include "velm/core/ndarray.h"
+
+#include <cassert>
+#include <cstddef>
+#include <iostream>
+#include <set>
+
+using velm_DR::brick_order;
+using velm_DR::brick_ref;
+using velm_DR::bricked_array;
+using velm_DR::ndarray;
+
+namespace {
+
+ndarray<int, 3> make_numbered(std::size_t nx, std::size_t ny, std::size_t nz) {
+    ndarray<int, 3> linear(nx, ny, nz);
+    for (std::size_t n = 0; n < linear.total_elements(); ++n) {
+        linear.data[n] = static_cast<int>(n) + 1;
+    }
+    return linear;
+}
+
+}  // namespace
+
+// Test shape, zero initialisation, indexing and fill
+void test_initialization_and_indexing() {
+    bricked_array<int> arr(10, 3, 17);
+    assert(arr.total_elements() == 10 * 3 * 17);
+    assert(arr.bricks[0] == 2 && arr.bricks[1] == 1 && arr.bricks[2] == 3);
+    assert(arr.brick_count() == 6);
+    assert(arr.storage_elements() == 6 * 512);
+
+    for (std::size_t n = 0; n < arr.storage_elements(); ++n) {
+        assert(arr.data[n] == 0);
+    }
+
+    // every element has its own offset, all inside the storage
+    std::set<std::size_t> offsets;
+    for (std::size_t i = 0; i < 10; ++i) {
+        for (std::size_t j = 0; j < 3; ++j) {
+            for (std::size_t k = 0; k < 17; ++k) {
+                std::size_t offset = arr.offset_of_index(i, j, k);
+                assert(offset < arr.storage_elements());
+                offsets.insert(offset);
+                arr(i, j, k) = static_cast<int>(i * 100 + j * 10 + k);
+            }
+        }
+    }
+    assert(offsets.size() == arr.total_elements());
+    assert(arr(9, 2, 16) == 936 && arr.at(0, 1, 8) == 18);
+
+    // neighbours along every axis are within a brick of each other
+    assert(arr.offset_of_index(1, 0, 0) - arr.offset_of_index(0, 0, 0) == 64);
+    assert(arr.offset_of_index(0, 1, 0) - arr.offset_of_index(0, 0, 0) == 8);
+    assert(arr.offset_of_index(0, 0, 1) - arr.offset_of_index(0, 0, 0) == 1);
+
+    arr.fill(-4);
+    assert(arr(3, 1, 12) == -4);
+
+    std::cout << "Initialization and indexing test passed.\n";
+}
+
+// Test conversion to and from the linear layout in both brick orders
+void test_linear_conversion() {
+    const std::size_t nx = 19, ny = 8, nz = 33;
+    ndarray<int, 3>   linear = make_numbered(nx, ny, nz);
+
+    for (brick_order order : { brick_order::linear, brick_order::morton }) {
+        bricked_array<int> small(linear.view(), order);
+        for (std::size_t i = 0; i < nx; ++i) {
+            for (std::size_t j = 0; j < ny; ++j) {
+                for (std::size_t k = 0; k < nz; ++k) {
+                    assert(small(i, j, k) == linear(i, j, k));
+                }
+            }
+        }
+        ndarray<int, 3> back = small.to_ndarray();
+        for (std::size_t n = 0; n < linear.total_elements(); ++n) {
+            assert(back.data[n] == linear.data[n]);
+        }
+
+        bricked_array<int, 16> large(linear.view(), order);
+        ndarray<int, 3>        transposed(nz, ny, nx);
+        large.to_linear(transposed.transpose());
+        for (std::size_t i = 0; i < nx; ++i) {
+            assert(transposed(nz - 1, 3, i) == linear(i, 3, nz - 1));
+        }
+    }
+
+    // a strided source view converts like a dense copy of it
+    bricked_array<int> every_other(linear.slice(2, 0, nz, 2));
+    assert(every_other.dims[2] == 17);
+    assert(every_other(18, 7, 16) == linear(18, 7, 32));
+
+    std::cout << "Linear conversion test passed.\n";
+}
+
+// Test Morton order: the first 8 bricks of a 2x2x2 block come first, in Z order
+void test_morton_order() {
+    bricked_array<float> arr(32, 24, 40, brick_order::morton);
+    assert(arr.brick_count() == 4 * 3 * 5);
+
+    std::size_t expected[8][3] = { { 0, 0, 0 }, { 0, 0, 8 }, { 0, 8, 0 }, { 0, 8, 8 },
+                                   { 8, 0, 0 }, { 8, 0, 8 }, { 8, 8, 0 }, { 8, 8, 8 } };
+    for (std::size_t b = 0; b < 8; ++b) {
+        brick_ref<float> brick = arr.brick(b);
+        for (std::size_t a = 0; a < 3; ++a) {
+            assert(brick.origin[a] == expected[b][a]);
+        }
+        assert(arr.offset_of_index(expected[b][0], expected[b][1], expected[b][2]) == b * 512);
+    }
+
+    // the curve skips codes outside the grid but still covers every brick once
+    std::set<std::size_t> origins;
+    arr.for_each_brick([&](const brick_ref<float> & brick) {
+        origins.insert((brick.origin[0] * 100 + brick.origin[1]) * 100 + brick.origin[2]);
+    });
+    assert(origins.size() == arr.brick_count());
+
+    std::cout << "Morton order test passed.\n";
+}
+
+// Test brick views: edge bricks are clipped to the grid and views alias the storage
+void test_brick_iteration() {
+    bricked_array<int> arr(make_numbered(12, 9, 8).view(), brick_order::morton);
+
+    std::size_t visited = 0;
+    arr.for_each_brick([&](const brick_ref<int> & brick) {
+        for (std::size_t a = 0; a < 3; ++a) {
+            assert(brick.view.dims[a] == std::min<std::size_t>(8, arr.dims[a] - brick.origin[a]));
+        }
+        assert(brick.view.strides[2] == 1);
+        for (std::size_t i = 0; i < brick.view.dims[0]; ++i) {
+            for (std::size_t j = 0; j < brick.view.dims[1]; ++j) {
+                for (std::size_t k = 0; k < brick.view.dims[2]; ++k) {
+                    assert(&brick.view(i, j, k) == &arr(brick.origin[0] + i, brick.origin[1] + j, brick.origin[2] + k));
+                }
+            }
+        }
+        brick.view.fill(7);
+        visited += brick.view.total_elements();
+    });
+    assert(visited == arr.total_elements());
+
+    const bricked_array<int> & constant = arr;
+    constant.for_each_brick([](const brick_ref<const int> & brick) {
+        for (const int & value : brick.view) {
+            assert(value == 7);
+        }
+    });
+
+    std::cout << "Brick iteration test passed.\n";
+}
+
+// Test copy and move construction and assignment
+void test_copy_and_move() {
+    bricked_array<int> a(make_numbered(9, 9, 9).view(), brick_order::morton);
+    bricked_array<int> b(a);
+    assert(b.data != a.data && b(8, 8, 8) == a(8, 8, 8) && b.order == brick_order::morton);
+
+    bricked_array<int> c(std::move(b));
+    assert(b.data == nullptr && c(4, 5, 6) == a(4, 5, 6));
+
+    bricked_array<int> d(2, 2, 2);
+    d = c;
+    assert(d.dims[0] == 9 && d(1, 2, 3) == a(1, 2, 3));
+    d = bricked_array<int>(3, 3, 3);
+    assert(d.dims[0] == 3 && d(2, 2, 2) == 0);
+
+    std::cout << "Copy and move test passed.\n";
+}
+
+int main() {
+    test_initialization_and_indexing();
+    test_linear_conversion();
+    test_morton_order();
+    test_brick_iteration();
+    test_copy_and_move();
+
+    std::cout << "All tests passed!\n";
+    return 0;
+}
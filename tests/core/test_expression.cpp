@@ -0,0 +1,118 @@
+#include "velm/core/ndarray.h"
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+using velm_DR::ndarray;
+using velm_DR::ndarray_view;
+
+namespace {
+
+ndarray<float, 3> make_field(std::size_t nx, std::size_t ny, std::size_t nz, float offset) {
+    ndarray<float, 3> field(nx, ny, nz);
+    for (std::size_t i = 0; i < nx; ++i) {
+        for (std::size_t j = 0; j < ny; ++j) {
+            for (std::size_t k = 0; k < nz; ++k) {
+                field(i, j, k) = offset + static_cast<float>(i) - 0.5f * static_cast<float>(j) + 0.25f * k;
+            }
+        }
+    }
+    return field;
+}
+
+bool close(float a, float b) {
+    return std::abs(a - b) <= 1e-5f * std::max(1.0f, std::abs(b));
+}
+
+}  // namespace
+
+// Test that arithmetic builds lazy nodes and evaluates them elementwise on assignment
+void test_expression_arithmetic() {
+    ndarray<float, 3> ex = make_field(4, 5, 6, 1.0f);
+    ndarray<float, 3> ey = make_field(4, 5, 6, -2.0f);
+    ndarray<float, 3> ez = make_field(4, 5, 6, 0.5f);
+
+    auto lazy = ex * ex + ey * ey + ez * ez;
+    static_assert(velm_DR::is_expression_v<decltype(lazy)>);
+    ex(0, 0, 0) = 10.0f;  // nothing has been computed yet, so this is picked up
+
+    ndarray<float, 3> mag = sqrt(lazy);
+    assert(mag.dims[0] == 4 && mag.dims[1] == 5 && mag.dims[2] == 6);
+    for (std::size_t i = 0; i < 4; ++i) {
+        for (std::size_t j = 0; j < 5; ++j) {
+            for (std::size_t k = 0; k < 6; ++k) {
+                float x = ex(i, j, k), y = ey(i, j, k), z = ez(i, j, k);
+                assert(close(mag(i, j, k), std::sqrt(x * x + y * y + z * z)));
+            }
+        }
+    }
+
+    // scalars on either side, unary minus and elementwise functions
+    ndarray<float, 3> mixed = 2.0f * ex - ey / 4 + -ez + max(ex, ey) + abs(ey) + pow(ez, 2);
+    for (std::size_t n = 0; n < mixed.total_elements(); ++n) {
+        float x = ex.data[n], y = ey.data[n], z = ez.data[n];
+        assert(close(mixed.data[n], 2.0f * x - y / 4 - z + std::max(x, y) + std::abs(y) + z * z));
+    }
+
+    // in-place compound assignment, including an operand that aliases the destination
+    ndarray<float, 3> acc = ex;
+    acc += ey;
+    acc *= 0.5f;
+    acc -= acc / 2.0f;
+    for (std::size_t n = 0; n < acc.total_elements(); ++n) {
+        assert(close(acc.data[n], (ex.data[n] + ey.data[n]) * 0.25f));
+    }
+
+    // mixed element types promote like the scalar operations do
+    ndarray<double, 3> precise = ex.view() * 1.0 + ndarray<double, 3>(4, 5, 6);
+    assert(precise(3, 4, 5) == static_cast<double>(ex(3, 4, 5)));
+
+    std::cout << "Expression arithmetic test passed.\n";
+}
+
+// Test expressions over strided views and writing into strided destinations
+void test_expression_views() {
+    ndarray<float, 3> a = make_field(6, 4, 8, 0.0f);
+    ndarray<float, 3> b = make_field(8, 4, 6, 3.0f);
+
+    // a transposed operand forces the index-space walk
+    ndarray<float, 3> sum = a + b.transpose();
+    for (std::size_t i = 0; i < 6; ++i) {
+        for (std::size_t j = 0; j < 4; ++j) {
+            for (std::size_t k = 0; k < 8; ++k) {
+                assert(sum(i, j, k) == a(i, j, k) + b(k, j, i));
+            }
+        }
+    }
+
+    // write every other plane of a through a stepped view
+    ndarray_view<float, 3> even = a.slice(0, 0, 6, 2);
+    velm_DR::assign(even, even * 0.0f + 7.0f);
+    for (std::size_t i = 0; i < 6; ++i) {
+        assert(a(i, 1, 1) == (i % 2 == 0 ? 7.0f : make_field(6, 4, 8, 0.0f)(i, 1, 1)));
+    }
+
+    // rank-reduced views combine like arrays of the lower rank
+    ndarray<float, 2> plane = a.index(0, 1) - b.index(2, 0).transpose();
+    for (std::size_t j = 0; j < 4; ++j) {
+        for (std::size_t k = 0; k < 8; ++k) {
+            assert(plane(j, k) == a(1, j, k) - b(k, j, 0));
+        }
+    }
+
+    // assigning an expression of a different shape reallocates the destination
+    ndarray<float, 3> target(1, 1, 1);
+    target = a * 2.0f;
+    assert(target.dims[0] == 6 && target.dims[2] == 8 && target(5, 3, 7) == 2.0f * a(5, 3, 7));
+
+    std::cout << "Expression views test passed.\n";
+}
+
+int main() {
+    test_expression_arithmetic();
+    test_expression_views();
+
+    std::cout << "All tests passed!\n";
+    return 0;
+}
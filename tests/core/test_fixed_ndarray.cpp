@@ -0,0 +1,100 @@
+#include "velm/core/fixed_ndarray.h"
+#include "velm/core/ndarray.h"
+
+#include <cassert>
+#include <complex>
+#include <concepts>
+#include <cstddef>
+#include <iostream>
+#include <type_traits>
+
+using velm_DR::fixed_ndarray;
+using velm_DR::mat2;
+using velm_DR::mat3;
+using velm_DR::vec3;
+
+// shape, offsets and arithmetic are usable at compile time
+static_assert(mat3<float>::rank == 2 && mat3<float>::size == 9);
+static_assert(mat3<float>::strides[0] == 3 && mat3<float>::strides[1] == 1);
+static_assert(fixed_ndarray<int, 2, 3, 4>::offset_of_index(1, 2, 3) == 23);
+// element access takes exactly one integral index per axis
+static_assert(std::invocable<mat3<float> &, int, int> && !std::invocable<mat3<float> &, int>);
+static_assert(!std::invocable<const mat3<float> &, int, int, int> && !std::invocable<mat3<float> &, int, double>);
+static_assert(sizeof(mat3<float>) == 9 * sizeof(float) && std::is_trivially_copyable_v<mat3<double>>);
+static_assert(velm_DR::mat_vec(mat3<int>{ 1, 2, 3, 4, 5, 6, 7, 8, 9 }, vec3<int>{ 1, 0, -1 }) ==
+              vec3<int>{ -2, -2, -2 });
+static_assert(velm_DR::dot(vec3<int>{ 1, 2, 3 }, vec3<int>{ 4, 5, 6 }) == 32);
+
+// Test indexing, bounds-checked access and fill
+void test_indexing() {
+    fixed_ndarray<int, 2, 3, 4> t{};
+    for (int & value : t) {
+        assert(value == 0);
+    }
+    int n = 0;
+    for (std::size_t i = 0; i < 2; ++i) {
+        for (std::size_t j = 0; j < 3; ++j) {
+            for (std::size_t k = 0; k < 4; ++k) {
+                t(i, j, k) = n++;
+            }
+        }
+    }
+    for (int i = 0; i < 24; ++i) {
+        assert(t.data[i] == i);
+    }
+    assert(t.at(1, 0, 2) == 14);
+
+    // the runtime-shape view sees the same elements
+    velm_DR::ndarray_view<int, 3> view = t.view();
+    assert(view.dims[0] == 2 && view.dims[1] == 3 && view.dims[2] == 4);
+    assert(view(1, 2, 3) == 23 && view.is_contiguous());
+
+    t.fill(7);
+    assert(t(0, 0, 0) == 7 && t(1, 2, 3) == 7);
+
+    std::cout << "Indexing test passed.\n";
+}
+
+// Test the small linear algebra helpers, including complex Jones matrices
+void test_arithmetic() {
+    mat3<double> m{ 2, 0, 0, 0, 3, 0, 1, 0, 1 };
+    vec3<double> x{ 1, 2, 3 };
+    vec3<double> y = velm_DR::mat_vec(m, x);
+    assert(y(0) == 2 && y(1) == 6 && y(2) == 4);
+
+    mat3<double> identity{ 1, 0, 0, 0, 1, 0, 0, 0, 1 };
+    assert(velm_DR::mat_mul(m, identity) == m);
+    assert(m + identity - identity == m);
+    assert((2.0 * x)(2) == 6.0 && (x * 0.5)(0) == 0.5);
+
+    // a half-wave plate applied twice is the identity
+    using jones         = mat2<std::complex<float>>;
+    const jones half    = { 1.0f, 0.0f, 0.0f, -1.0f };
+    const jones twice   = velm_DR::mat_mul(half, half);
+    const jones unit    = { 1.0f, 0.0f, 0.0f, 1.0f };
+    assert(twice == unit);
+
+    std::cout << "Arithmetic test passed.\n";
+}
+
+// Test fixed_ndarray as the element type of a runtime-shape ndarray
+void test_as_ndarray_element() {
+    velm_DR::ndarray<mat3<float>, 3> field(4, 5, 6);
+    assert(field(3, 4, 5)(2, 2) == 0.0f);
+    field(1, 2, 3)(0, 1) = 5.0f;
+    assert(field.data[field.offset_of_index(1, 2, 3)].data[1] == 5.0f);
+
+    velm_DR::ndarray<mat3<float>, 3> copy = field;
+    assert(copy(1, 2, 3) == field(1, 2, 3));
+
+    std::cout << "Ndarray element test passed.\n";
+}
+
+int main() {
+    test_indexing();
+    test_arithmetic();
+    test_as_ndarray_element();
+
+    std::cout << "All tests passed!\n";
+    return 0;
+}
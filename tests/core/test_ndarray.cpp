@@ -2,9 +2,11 @@
 #include "velm/velm.h"
 
 #include <cassert>
+#include <cstdint>
 #include <iostream>
 
 using velm_DR::ndarray;
+using velm_DR::ndarray_view;
 
 // Test default initialization and fill
 void test_initialization_and_fill() {
@@ -197,6 +199,191 @@ void test_move_assignment() {
     std::cout << "Move assignment test passed.\n";
 }
 
+// Test rank-reducing index and slicing along every axis
+void test_view_slicing() {
+    ndarray<int, 3> arr(3, 4, 5);
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            for (int k = 0; k < 5; ++k) {
+                arr(i, j, k) = i * 100 + j * 10 + k;
+            }
+        }
+    }
+
+    // plane along the slowest axis is contiguous and shares storage
+    ndarray_view<int, 2> yz = arr.index(0, 2);
+    assert(yz.dims[0] == 4 && yz.dims[1] == 5);
+    assert(yz.is_contiguous());
+    assert(&yz(1, 3) == &arr(2, 1, 3));
+
+    // planes along the faster axes are strided
+    ndarray_view<int, 2> xz = arr.index(1, 3);
+    ndarray_view<int, 2> xy = arr.index(2, 4);
+    assert(!xz.is_contiguous());
+    assert(!xy.is_contiguous());
+    for (int i = 0; i < 3; ++i) {
+        for (int k = 0; k < 5; ++k) {
+            assert(xz(i, k) == i * 100 + 30 + k);
+        }
+        for (int j = 0; j < 4; ++j) {
+            assert(xy(i, j) == i * 100 + j * 10 + 4);
+        }
+    }
+
+    // stepped slice keeps the rank
+    ndarray_view<int, 3> odd = arr.slice(2, 1, 5, 2);
+    assert(odd.dims[2] == 2);
+    assert(odd(1, 2, 0) == 121 && odd(1, 2, 1) == 123);
+
+    // nested views compose
+    ndarray_view<int, 1> line = arr.slice(0, 1, 3).index(1, 2).index(0, 1);
+    assert(line.dims[0] == 5);
+    assert(line(4) == 224);
+
+    std::cout << "View slicing test passed.\n";
+}
+
+// Test subarray, permute and transpose
+void test_view_subarray_and_permute() {
+    ndarray<int, 4> arr(2, 3, 4, 5);
+    for (std::size_t n = 0; n < arr.total_elements(); ++n) {
+        arr.data[n] = static_cast<int>(n);
+    }
+
+    ndarray_view<int, 4> box = arr.subarray({ 1, 1, 2, 1 }, { 1, 2, 2, 3 });
+    assert(box.total_elements() == 12);
+    assert(!box.is_contiguous());
+    assert(box(0, 0, 0, 0) == arr(1, 1, 2, 1));
+    assert(box(0, 1, 1, 2) == arr(1, 2, 3, 3));
+
+    ndarray_view<int, 4> permuted = arr.permute({ 2, 0, 3, 1 });
+    assert(permuted.dims[0] == 4 && permuted.dims[1] == 2 && permuted.dims[2] == 5 && permuted.dims[3] == 3);
+    assert(permuted(3, 1, 4, 2) == arr(1, 2, 3, 4));
+
+    ndarray<int, 2> mat(3, 4);
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            mat(i, j) = i * 4 + j;
+        }
+    }
+    ndarray_view<const int, 2> t = static_cast<const ndarray<int, 2> &>(mat).transpose();
+    assert(t.dims[0] == 4 && t.dims[1] == 3);
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            assert(t(j, i) == mat(i, j));
+        }
+    }
+
+    std::cout << "View subarray and permute test passed.\n";
+}
+
+// Test fill and iteration through non-contiguous views
+void test_view_fill_and_iteration() {
+    ndarray<int, 3> arr(4, 3, 6);
+
+    // every other x-z column of the middle row
+    ndarray_view<int, 2> strided = arr.index(1, 1).slice(1, 0, 6, 2);
+    strided.fill(7);
+    int filled = 0;
+    for (int v : arr) {
+        filled += v == 7;
+    }
+    assert(filled == 12);
+    for (int i = 0; i < 4; ++i) {
+        for (int k = 0; k < 6; ++k) {
+            assert(arr(i, 1, k) == (k % 2 == 0 ? 7 : 0));
+        }
+    }
+
+    // iteration visits elements in logical row-major order
+    for (std::size_t n = 0; n < arr.total_elements(); ++n) {
+        arr.data[n] = static_cast<int>(n);
+    }
+    ndarray_view<const int, 3> t = static_cast<const ndarray<int, 3> &>(arr).transpose();
+    std::size_t                visited = 0;
+    int                        i = 0, j = 0, k = 0;
+    for (int v : t) {
+        assert(v == arr(k, j, i));
+        ++visited;
+        if (++k == 4) {
+            k = 0;
+            if (++j == 3) {
+                j = 0;
+                ++i;
+            }
+        }
+    }
+    assert(visited == arr.total_elements());
+
+    // a view over the full array is contiguous and iterates like the array itself
+    ndarray_view<int, 3> whole = arr.view();
+    assert(whole.is_contiguous());
+    int expected = 0;
+    for (int v : whole) {
+        assert(v == expected++);
+    }
+
+    std::cout << "View fill and iteration test passed.\n";
+}
+
+// Test storage policies: alignment, uninitialised construction, huge pages and pooling
+void test_allocator_policies() {
+    ndarray<float, 3> aligned(5, 7, 3);
+    assert(reinterpret_cast<std::uintptr_t>(aligned.data) % velm_DR::default_alignment == 0);
+
+    ndarray<double, 2> scratch(velm_DR::uninitialized, 16, 16);
+    scratch.fill(2.5);
+    for (double v : scratch) {
+        assert(v == 2.5);
+    }
+
+    ndarray<int, 3, velm_DR::huge_page_allocator<int>> huge(8, 8, 8);
+    for (int v : huge) {
+        assert(v == 0);
+    }
+    huge.fill(4);
+    ndarray<int, 3, velm_DR::huge_page_allocator<int>> huge_copy(huge);
+    assert(huge_copy(7, 7, 7) == 4);
+
+    velm_DR::block_pool            pool;
+    velm_DR::pool_allocator<float> from_pool(pool);
+    const float *                  first_block = nullptr;
+    for (int frame = 0; frame < 3; ++frame) {
+        ndarray<float, 3, velm_DR::pool_allocator<float>> temporary(from_pool, 4, 4, 4);
+        assert(temporary(3, 3, 3) == 0.0f);
+        if (frame == 0) {
+            first_block = temporary.data;
+        } else {
+            // every frame after the first reuses the cached block
+            assert(temporary.data == first_block);
+        }
+    }
+    assert(pool.misses() == 1 && pool.hits() == 2);
+    assert(pool.cached_bytes() == 64 * sizeof(float));
+    pool.trim();
+    assert(pool.cached_bytes() == 0);
+
+    // lowering the limit frees what no longer fits, and releases beyond it go back to the system
+    void * blocks[3] = { pool.acquire(256), pool.acquire(256), pool.acquire(512) };
+    for (void * block : blocks) {
+        pool.release(block, block == blocks[2] ? 512 : 256);
+    }
+    assert(pool.cached_bytes() == 1024);
+    pool.set_max_cached_bytes(600);
+    assert(pool.cached_bytes() <= 600 && pool.max_cached_bytes() == 600);
+    pool.release(pool.acquire(4096), 4096);
+    assert(pool.cached_bytes() <= 600);
+    assert(velm_DR::block_pool::global().max_cached_bytes() == velm_DR::block_pool::default_global_cache_bytes);
+
+    // empty arrays map nothing
+    ndarray<int, 3, velm_DR::huge_page_allocator<int>> empty(0, 4, 4);
+    assert(empty.data != nullptr && empty.total_elements() == 0);
+    ndarray<int, 3, velm_DR::huge_page_allocator<int>> empty_copy(empty);
+    assert(empty_copy.data != nullptr);
+
+    std::cout << "Allocator policy test passed.\n";
+}
+
 // Test out-of-bounds access triggers abort
 void test_at_bounds_checking() {
     std::cout << "Testing out-of-bounds access (some assertions may fail)...\n";
@@ -228,6 +415,10 @@ int main() {
     test_move_constructor();
     test_copy_assignment();
     test_move_assignment();
+    test_view_slicing();
+    test_view_subarray_and_permute();
+    test_view_fill_and_iteration();
+    test_allocator_policies();
     test_at_bounds_checking();
 
     std::cout << "All tests passed!\n";
@@ -0,0 +1,205 @@
+#include "velm/core/profiler.h"
+#include "velm/core/thread_pool.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using velm_DR::profiler;
+using velm_DR::stage_stats;
+using velm_DR::trace_event;
+
+namespace {
+
+const stage_stats * find_stage(const std::vector<stage_stats> & stages, const char * name) {
+    for (const stage_stats & stage : stages) {
+        if (std::strcmp(stage.name, name) == 0) {
+            return &stage;
+        }
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+// Test that recorded zones add up to the per-stage statistics
+void test_record_and_stages() {
+    profiler p;
+    assert(!p.enabled());
+
+    p.record("read", "io", 0, 2'000'000);
+    p.record("read", "io", 2'000'000, 6'000'000);
+    p.record("draw", "render", 1'000, 501'000);
+    std::vector<stage_stats> stages = p.stages();
+    assert(stages.size() == 2);
+    // ordered by name
+    assert(std::strcmp(stages[0].name, "draw") == 0 && std::strcmp(stages[1].name, "read") == 0);
+
+    const stage_stats * read = find_stage(stages, "read");
+    assert(read->calls == 2);
+    assert(read->total > 5.999 && read->total < 6.001);
+    assert(read->last > 3.999 && read->last < 4.001);
+    assert(read->max > 3.999 && read->max < 4.001);
+    assert(read->mean > 2.999 && read->mean < 3.001);
+    assert(std::strcmp(read->category, "io") == 0);
+    assert(p.events().size() == 3);
+
+    p.clear();
+    assert(p.stages().empty() && p.events().empty());
+
+    std::cout << "Record and stages test passed.\n";
+}
+
+// Test that every thread gets its own ring and nothing is lost between collects
+void test_threads() {
+    profiler           p;
+    velm_DR::thread_pool pool(4);
+    pool.parallel_for(4000, 10, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            std::uint64_t t = p.now();
+            p.record("block", "test", t, t + 1000);
+        }
+    });
+    std::vector<trace_event> events = p.events();
+    assert(events.size() == 4000);
+    std::set<std::uint32_t> threads;
+    for (const trace_event & event : events) {
+        assert(event.end >= event.start);
+        threads.insert(event.thread);
+    }
+    assert(!threads.empty() && threads.size() <= pool.size() + 1);
+    assert(p.dropped() == 0);
+
+    std::cout << "Threads test passed.\n";
+}
+
+// Test that a full ring drops new zones instead of overwriting unread ones
+void test_overflow() {
+    profiler p;
+    for (std::size_t i = 0; i < profiler::ring_capacity + 10; ++i) {
+        p.record("zone", "test", i, i + 1);
+    }
+    assert(p.dropped() == 10);
+    std::vector<trace_event> events = p.events();
+    assert(events.size() == profiler::ring_capacity);
+    assert(events.front().start == 0 && events.back().start == profiler::ring_capacity - 1);
+
+    // collected slots are free again
+    p.record("zone", "test", 0, 1);
+    assert(p.events().size() == profiler::ring_capacity + 1);
+    p.clear();
+    assert(p.dropped() == 0);
+
+    std::cout << "Overflow test passed.\n";
+}
+
+// Test that threads which come and go do not leave their rings behind
+void test_thread_churn() {
+    profiler p;
+    for (std::size_t round = 0; round < 50; ++round) {
+        // naming alone allocates nothing
+        std::thread named([&] { p.name_thread("transient"); });
+        named.join();
+        assert(p.live_rings() == 0);
+
+        std::thread recording([&] {
+            p.name_thread("worker");
+            p.record("work", "test", round, round + 1);
+        });
+        recording.join();
+        assert(p.live_rings() == 1);
+        // draining the exited thread frees its ring but keeps its zones and name
+        assert(p.events().size() == round + 1);
+        assert(p.live_rings() == 0);
+    }
+    assert(p.stages().front().calls == 50);
+
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "velm_test_profiler_churn.json";
+    p.write_chrome_trace(path.string());
+    std::ifstream in(path);
+    std::string   json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    assert(json.find("\"args\":{\"name\":\"worker\"}") != std::string::npos);
+    assert(json.find("transient") == std::string::npos);
+    std::filesystem::remove(path);
+
+    p.clear();
+    assert(p.live_rings() == 0 && p.dropped() == 0);
+
+    std::cout << "Thread churn test passed.\n";
+}
+
+// Test the Chrome trace-event export
+void test_chrome_trace() {
+    profiler p;
+    p.name_thread("main \"loop\"");
+    p.record("hdf5.read", "io", 1'500, 4'000);
+
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "velm_test_profiler.json";
+    p.write_chrome_trace(path.string());
+
+    std::ifstream in(path);
+    std::string   json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    assert(json.find("\"traceEvents\":[") != std::string::npos);
+    assert(json.find("{\"ph\":\"X\",\"pid\":1,\"tid\":1,\"name\":\"hdf5.read\",\"cat\":\"io\",\"ts\":1.500,"
+                     "\"dur\":2.500}") != std::string::npos);
+    assert(json.find("\"name\":\"thread_name\",\"args\":{\"name\":\"main \\\"loop\\\"\"}") != std::string::npos);
+    std::filesystem::remove(path);
+
+    bool threw = false;
+    try {
+        p.write_chrome_trace("/nonexistent/dir/trace.json");
+    } catch (const std::runtime_error &) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "Chrome trace test passed.\n";
+}
+
+// Test the scoped zones of the global profiler
+void test_zone_macro() {
+    profiler & p = profiler::global();
+    p.clear();
+    {
+        VELM_PROFILE_ZONE("disabled", "test");
+    }
+    p.enable(true);
+    {
+        VELM_PROFILE_ZONE("enabled", "test");
+    }
+    p.enable(false);
+    std::vector<stage_stats> stages = p.stages();
+#ifdef VELM_ENABLE_PROFILING
+    assert(stages.size() == 1 && std::strcmp(stages[0].name, "enabled") == 0 && stages[0].calls == 1);
+#else
+    assert(stages.empty());
+#endif
+    p.clear();
+
+    [[maybe_unused]] velm_DR::memory_usage memory = velm_DR::process_memory();
+#ifdef __linux__
+    assert(memory.resident > 0 && memory.peak_resident >= memory.resident);
+#endif
+
+    std::cout << "Zone macro test passed.\n";
+}
+
+int main() {
+    test_record_and_stages();
+    test_threads();
+    test_overflow();
+    test_thread_churn();
+    test_chrome_trace();
+    test_zone_macro();
+
+    std::cout << "All tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include "velm/core/fixed_ndarray.h"
+#include "velm/core/tensor_array.h"
+
+#include <cassert>
+#include <cstddef>
+#include <iostream>
+#include <type_traits>
+
+using velm_DR::mat3;
+using velm_DR::tensor_array;
+using velm_DR::tensor_layout;
+using velm_DR::vec3;
+
+template <tensor_layout Layout> using mat3_field = tensor_array<mat3<float>, 3, Layout>;
+
+namespace {
+
+// distinct value for component (a, b) of voxel (i, j, k)
+float numbered(std::size_t i, std::size_t j, std::size_t k, std::size_t a, std::size_t b) {
+    return static_cast<float>(((i * 10 + j) * 10 + k) * 10 + a * 3 + b);
+}
+
+template <tensor_layout Layout> mat3_field<Layout> make_numbered() {
+    mat3_field<Layout> field(velm_DR::uninitialized, 3, 4, 5);
+    for (std::size_t i = 0; i < 3; ++i) {
+        for (std::size_t j = 0; j < 4; ++j) {
+            for (std::size_t k = 0; k < 5; ++k) {
+                for (std::size_t a = 0; a < 3; ++a) {
+                    for (std::size_t b = 0; b < 3; ++b) {
+                        field(i, j, k)(a, b) = numbered(i, j, k, a, b);
+                    }
+                }
+            }
+        }
+    }
+    return field;
+}
+
+}  // namespace
+
+// Test that both layouts are addressed alike and store components where the layout says
+template <tensor_layout Layout> void test_layout() {
+    mat3_field<Layout> zero(3, 4, 5);
+    assert(zero.voxel_count() == 60 && zero.total_elements() == 540);
+    for (std::size_t n = 0; n < zero.total_elements(); ++n) {
+        assert(zero.scalars.data[n] == 0.0f);
+    }
+
+    mat3_field<Layout> field = make_numbered<Layout>();
+    const std::size_t  v     = field.offset_of_index(2, 1, 3);
+    if constexpr (Layout == tensor_layout::aos) {
+        static_assert(std::is_same_v<decltype(field(0, 0, 0)), mat3<float> &>);
+        assert(field.scalars.data[v * 9 + 5] == numbered(2, 1, 3, 1, 2));
+    } else {
+        assert(field.scalars.data[5 * field.voxel_count() + v] == numbered(2, 1, 3, 1, 2));
+    }
+
+    // whole tensors in and out
+    mat3<float> m = field(2, 1, 3);
+    assert(m(1, 2) == numbered(2, 1, 3, 1, 2));
+    mat3<float> diagonal{ 1, 0, 0, 0, 2, 0, 0, 0, 3 };
+    field(0, 0, 0) = diagonal;
+    assert(field.at(0, 0, 0)(1, 1) == 2.0f && field(0, 0, 0)(0, 1) == 0.0f);
+    field(0, 0, 1) = field(2, 1, 3);
+    assert(static_cast<mat3<float>>(field(0, 0, 1)) == m);
+    // copying the neighbour did not rebind anything
+    assert(static_cast<mat3<float>>(field(2, 1, 3)) == m);
+
+    vec3<float> y = velm_DR::mat_vec(static_cast<mat3<float>>(field(0, 0, 0)), vec3<float>{ 1, 1, 1 });
+    assert(y(0) == 1.0f && y(1) == 2.0f && y(2) == 3.0f);
+
+    const mat3_field<Layout> & read_only = field;
+    assert(read_only(2, 1, 3)(2, 0) == numbered(2, 1, 3, 2, 0));
+
+    // one component over the grid
+    velm_DR::ndarray_view<float, 3> xz = field.component(0, 2);
+    assert(xz.dims[0] == 3 && xz.dims[1] == 4 && xz.dims[2] == 5);
+    assert(xz(1, 3, 4) == numbered(1, 3, 4, 0, 2));
+    assert(xz.is_contiguous() == (Layout == tensor_layout::soa));
+    xz(1, 3, 4) = -1.0f;
+    assert(field(1, 3, 4)(0, 2) == -1.0f);
+
+    field.fill(diagonal);
+    assert(static_cast<mat3<float>>(field(2, 3, 4)) == diagonal);
+
+    mat3_field<Layout> copy = field;
+    copy(0, 0, 0)(0, 0)     = 9.0f;
+    assert(field(0, 0, 0)(0, 0) == 1.0f);
+    mat3_field<Layout> moved = std::move(copy);
+    assert(moved(0, 0, 0)(0, 0) == 9.0f && copy.scalars.data == nullptr);
+
+    std::cout << (Layout == tensor_layout::aos ? "AoS" : "SoA") << " layout test passed.\n";
+}
+
+// Test converting between the layouts
+void test_conversion() {
+    mat3_field<tensor_layout::aos> aos = make_numbered<tensor_layout::aos>();
+    mat3_field<tensor_layout::soa> soa(aos);
+    mat3_field<tensor_layout::aos> back(soa);
+    for (std::size_t v = 0; v < aos.voxel_count(); ++v) {
+        assert(static_cast<mat3<float>>(soa.voxel(v)) == aos.voxel(v));
+    }
+    for (std::size_t n = 0; n < aos.total_elements(); ++n) {
+        assert(back.scalars.data[n] == aos.scalars.data[n]);
+    }
+    mat3_field<tensor_layout::soa> numbered_soa = make_numbered<tensor_layout::soa>();
+    for (std::size_t n = 0; n < soa.total_elements(); ++n) {
+        assert(soa.scalars.data[n] == numbered_soa.scalars.data[n]);
+    }
+
+    std::cout << "Conversion test passed.\n";
+}
+
+int main() {
+    test_layout<tensor_layout::aos>();
+    test_layout<tensor_layout::soa>();
+    test_conversion();
+
+    std::cout << "All tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include "velm/core/thread_pool.h"
+
+#include <atomic>
+#include <cassert>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+using velm_DR::thread_pool;
+
+// Test that submitted tasks run and hand back their results
+void test_submit() {
+    thread_pool pool(3);
+    assert(pool.size() == 3);
+
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 32; ++i) {
+        results.push_back(pool.submit([i] { return i * i; }));
+    }
+    for (int i = 0; i < 32; ++i) {
+        assert(results[static_cast<std::size_t>(i)].get() == i * i);
+    }
+
+    std::future<void> failing = pool.submit([] { throw std::runtime_error("task failed"); });
+    bool              threw   = false;
+    try {
+        failing.get();
+    } catch (const std::runtime_error &) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "Submit test passed.\n";
+}
+
+// Test that parallel_for covers every index exactly once, also when nested
+void test_parallel_for() {
+    thread_pool pool(4);
+
+    std::vector<std::atomic<int>> visits(1000);
+    pool.parallel_for(visits.size(), 7, [&](std::size_t begin, std::size_t end) {
+        assert(end - begin <= 7);
+        for (std::size_t i = begin; i < end; ++i) {
+            ++visits[i];
+        }
+    });
+    for (const std::atomic<int> & v : visits) {
+        assert(v.load() == 1);
+    }
+
+    // every outer block runs an inner parallel_for on the same pool
+    std::atomic<std::size_t> total{ 0 };
+    pool.parallel_for(16, 1, [&](std::size_t, std::size_t) {
+        pool.parallel_for(100, 10, [&](std::size_t begin, std::size_t end) { total += end - begin; });
+    });
+    assert(total.load() == 1600);
+
+    pool.parallel_for(0, 4, [](std::size_t, std::size_t) { assert(false); });
+
+    bool threw = false;
+    try {
+        pool.parallel_for(64, 1, [](std::size_t begin, std::size_t) {
+            if (begin == 40) {
+                throw std::runtime_error("block failed");
+            }
+        });
+    } catch (const std::runtime_error &) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "Parallel for test passed.\n";
+}
+
+int main() {
+    test_submit();
+    test_parallel_for();
+
+    std::cout << "All tests passed!\n";
+    return 0;
+}
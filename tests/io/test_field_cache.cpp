@@ -0,0 +1,213 @@
+#include "velm/core/ndarray.h"
+#include "velm/core/thread_pool.h"
+#include "velm/io/field_cache.h"
+#include "velm/io/field_codec.h"
+#include "velm/io/hd5.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+using velm_DR::ndarray;
+using vlem::cache_counters;
+using vlem::cache_options;
+using vlem::compressed_field;
+using vlem::field_cache;
+using vlem::field_codec;
+using vlem::hdf5_file;
+
+namespace {
+
+const std::string test_file = (std::filesystem::temp_directory_path() / "velm_test_field_cache.h5").string();
+
+// a smooth wave with a little noise, over dims that leave partial bricks on every axis
+ndarray<float, 3> make_field(std::size_t nx, std::size_t ny, std::size_t nz, float phase) {
+    ndarray<float, 3> field(nx, ny, nz);
+    std::uint32_t     state = 12345;
+    for (std::size_t i = 0; i < nx; ++i) {
+        for (std::size_t j = 0; j < ny; ++j) {
+            for (std::size_t k = 0; k < nz; ++k) {
+                state          = state * 1664525u + 1013904223u;
+                float noise    = static_cast<float>(state >> 8) / static_cast<float>(1 << 24) - 0.5f;
+                field(i, j, k) = std::sin(0.2f * i + phase) * std::cos(0.15f * j) + 0.1f * k + 1e-3f * noise;
+            }
+        }
+    }
+    return field;
+}
+
+bool same_bits(float a, float b) {
+    return std::memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+}  // namespace
+
+// Test that the lossless codec reproduces every bit, special values included, with any thread count
+void test_lossless() {
+    ndarray<float, 3> field = make_field(37, 20, 18, 0.0f);
+    field(0, 0, 0)          = std::numeric_limits<float>::quiet_NaN();
+    field(5, 17, 3)         = -std::numeric_limits<float>::infinity();
+    field(36, 19, 17)       = -0.0f;
+    field(20, 1, 1)         = std::numeric_limits<float>::denorm_min();
+
+    velm_DR::thread_pool serial(0);
+    velm_DR::thread_pool parallel(3);
+    compressed_field     packed(field.view(), field_codec::lossless, 0.0, &parallel);
+    assert(packed.dims()[0] == 37 && packed.dims()[1] == 20 && packed.dims()[2] == 18);
+    assert(packed.raw_bytes() == field.total_elements() * sizeof(float));
+    assert(packed.compressed_bytes() < packed.raw_bytes());
+
+    ndarray<float, 3> decoded = packed.decode(&serial);
+    for (std::size_t n = 0; n < field.total_elements(); ++n) {
+        assert(same_bits(decoded.data[n], field.data[n]));
+    }
+
+    // the same bits from a strided source, into a strided destination
+    ndarray<float, 3> wide(37, 20, 36);
+    ndarray<float, 3> out(37, 40, 18);
+    for (std::size_t i = 0; i < 37; ++i) {
+        for (std::size_t j = 0; j < 20; ++j) {
+            for (std::size_t k = 0; k < 18; ++k) {
+                wide(i, j, 2 * k) = field(i, j, k);
+            }
+        }
+    }
+    compressed_field strided(velm_DR::ndarray_view<const float, 3>(wide.slice(2, 0, 36, 2)), field_codec::lossless);
+    strided.decode(out.slice(1, 0, 40, 2), &parallel);
+    for (std::size_t i = 0; i < 37; ++i) {
+        for (std::size_t j = 0; j < 20; ++j) {
+            for (std::size_t k = 0; k < 18; ++k) {
+                assert(same_bits(out(i, 2 * j, k), field(i, j, k)) && out(i, 2 * j + 1, k) == 0.0f);
+            }
+        }
+    }
+
+    bool threw = false;
+    try {
+        packed.decode(out.view());
+    } catch (const std::runtime_error &) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "Lossless test passed.\n";
+}
+
+// Test that the bounded codec stays within its bound, keeps what it cannot quantise, and compresses harder
+void test_bounded() {
+    ndarray<float, 3> field = make_field(40, 33, 17, 1.0f);
+    field(3, 3, 3)          = std::numeric_limits<float>::quiet_NaN();
+    field(30, 20, 10)       = std::numeric_limits<float>::infinity();
+    field(10, 10, 10)       = 1e30f;
+
+    compressed_field lossless(field.view(), field_codec::lossless);
+    for (double bound : { 1e-2, 1e-4, 1e-6 }) {
+        compressed_field  packed(field.view(), field_codec::bounded, bound);
+        ndarray<float, 3> decoded = packed.decode();
+        for (std::size_t n = 0; n < field.total_elements(); ++n) {
+            if (std::isfinite(field.data[n])) {
+                assert(std::abs(static_cast<double>(decoded.data[n]) - field.data[n]) <= bound);
+            } else {
+                assert(same_bits(decoded.data[n], field.data[n]));
+            }
+        }
+        assert(decoded(10, 10, 10) == 1e30f);
+        if (bound >= 1e-4) {
+            assert(packed.compressed_bytes() < lossless.compressed_bytes());
+        }
+    }
+
+    bool threw = false;
+    try {
+        compressed_field unbounded(field.view(), field_codec::bounded, 0.0);
+    } catch (const std::runtime_error &) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "Bounded test passed.\n";
+}
+
+// Test hits, misses and least-recently-used eviction under the budget
+void test_cache() {
+    {
+        hdf5_file file(test_file, hdf5_file::access::truncate);
+        for (std::size_t step = 0; step < 4; ++step) {
+            std::string dataset = "/step_" + std::to_string(step);
+            file.write_field(dataset.c_str(), make_field(24, 24, 24, static_cast<float>(step)));
+        }
+    }
+    hdf5_file   file(test_file);
+    field_cache cache(file);
+
+    ndarray<float, 3> first = cache.get("/step_0");
+    assert(cache.contains("/step_0"));
+    ndarray<float, 3> again = cache.get("/step_0");
+    assert(std::memcmp(first.data, again.data, first.total_elements() * sizeof(float)) == 0);
+    cache_counters counters = cache.counters();
+    assert(counters.hits == 1 && counters.misses == 1 && counters.entries == 1 && counters.evictions == 0);
+    assert(counters.raw_bytes_held == first.total_elements() * sizeof(float));
+    assert(counters.bytes_held < counters.raw_bytes_held);
+    std::size_t entry_bytes = counters.bytes_held;
+
+    // room for two entries: touching step_0 leaves step_1 the least recently used
+    cache.set_budget(entry_bytes * 5 / 2);
+    ndarray<float, 3> out(24, 24, 24);
+    cache.get("/step_1", out.view());
+    cache.get("/step_0", out.view());
+    cache.get("/step_2", out.view());
+    assert(cache.contains("/step_0") && !cache.contains("/step_1") && cache.contains("/step_2"));
+    counters = cache.counters();
+    assert(counters.entries == 2 && counters.evictions == 1 && counters.hits == 2 && counters.misses == 3);
+    assert(counters.read_seconds > 0.0 && counters.encode_seconds > 0.0 && counters.decode_seconds > 0.0);
+
+    cache.set_budget(entry_bytes * 3 / 2);
+    assert(cache.counters().entries == 1 && cache.contains("/step_2"));
+    cache.set_budget(entry_bytes / 2);
+    assert(cache.counters().entries == 0 && cache.counters().bytes_held == 0);
+    cache.get("/step_3", out.view());
+    assert(!cache.contains("/step_3") && cache.counters().uncacheable == 1);
+
+    cache.set_budget(entry_bytes * 10);
+    cache.get("/step_3", out.view());
+    cache.clear();
+    assert(!cache.contains("/step_3") && cache.counters().entries == 0 && cache.counters().raw_bytes_held == 0);
+
+    // a bounded cache hands out the exact values on a miss and values within the bound afterwards
+    cache_options options;
+    options.codec       = field_codec::bounded;
+    options.error_bound = 1e-3;
+    field_cache       lossy(file, options);
+    ndarray<float, 3> exact = lossy.get("/step_1");
+    ndarray<float, 3> close = lossy.get("/step_1");
+    ndarray<float, 3> truth = make_field(24, 24, 24, 1.0f);
+    for (std::size_t n = 0; n < truth.total_elements(); ++n) {
+        assert(exact.data[n] == truth.data[n] && std::abs(static_cast<double>(close.data[n]) - truth.data[n]) <= 1e-3);
+    }
+
+    bool threw = false;
+    try {
+        ndarray<float, 3> wrong(24, 24, 23);
+        lossy.get("/step_0", wrong.view());
+    } catch (const std::runtime_error &) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "Cache test passed.\n";
+}
+
+int main() {
+    test_lossless();
+    test_bounded();
+    test_cache();
+    std::filesystem::remove(test_file);
+
+    std::cout << "All tests passed!\n";
+    return 0;
+}
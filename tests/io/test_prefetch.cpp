@@ -0,0 +1,154 @@
+#include "velm/core/ndarray.h"
+#include "velm/io/hd5.h"
+#include "velm/io/prefetch.h"
+
+#include <cassert>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using velm_DR::ndarray;
+using vlem::field_prefetcher;
+using vlem::hdf5_file;
+using vlem::timestep_frame;
+
+namespace {
+
+const std::string test_file = (std::filesystem::temp_directory_path() / "velm_test_prefetch.h5").string();
+
+constexpr std::size_t steps = 6;
+
+float value_at(std::size_t step, std::size_t field, std::size_t i, std::size_t j, std::size_t k) {
+    return static_cast<float>(step * 1000000 + field * 100000 + i * 1000 + j * 30 + k);
+}
+
+std::string dataset_path(std::size_t step, const std::string & field) {
+    return "/step_" + std::to_string(step) + "/" + field;
+}
+
+// Ex is contiguous, Ey chunked with edge chunks overhanging the dataset, Ez chunked and deflated
+void write_test_file() {
+    hdf5_file   file(test_file, hdf5_file::access::truncate);
+    std::size_t chunk[3] = { 8, 8, 8 };
+    for (std::size_t step = 0; step < steps; ++step) {
+        for (std::size_t f = 0; f < 3; ++f) {
+            ndarray<float, 3> field(21, 17, 12);
+            for (std::size_t i = 0; i < 21; ++i) {
+                for (std::size_t j = 0; j < 17; ++j) {
+                    for (std::size_t k = 0; k < 12; ++k) {
+                        field(i, j, k) = value_at(step, f, i, j, k);
+                    }
+                }
+            }
+            const char * names[3] = { "Ex", "Ey", "Ez" };
+            std::string  dataset  = dataset_path(step, names[f]);
+            if (f == 0) {
+                file.write_field(dataset.c_str(), field);
+            } else {
+                file.write_field(dataset.c_str(), field, chunk, f == 2 ? 3 : 0);
+            }
+        }
+    }
+}
+
+void check_frame(const timestep_frame & frame, std::size_t step) {
+    assert(frame.step == step);
+    assert(frame.fields.size() == 3);
+    for (std::size_t f = 0; f < 3; ++f) {
+        const ndarray<float, 3> & field = frame.fields[f];
+        assert(field.dims[0] == 21 && field.dims[1] == 17 && field.dims[2] == 12);
+        for (std::size_t i = 0; i < 21; ++i) {
+            for (std::size_t j = 0; j < 17; ++j) {
+                for (std::size_t k = 0; k < 12; ++k) {
+                    assert(field(i, j, k) == value_at(step, f, i, j, k));
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+// Test that every timestep arrives in order with all fields decoded, for several pipeline depths
+void test_prefetch_order() {
+    hdf5_file file(test_file);
+
+    for (std::size_t depth : { 1, 2, 4 }) {
+        field_prefetcher::options opts;
+        opts.depth          = depth;
+        opts.decode_threads = 2;
+        field_prefetcher prefetcher(file, { "Ex", "Ey", "Ez" }, 1, steps, dataset_path, opts);
+
+        for (std::size_t step = 1; step < steps; ++step) {
+            std::optional<timestep_frame> frame = prefetcher.next();
+            assert(frame.has_value());
+            check_frame(*frame, step);
+        }
+        // the end of the range stays ended
+        std::optional<timestep_frame> end   = prefetcher.next();
+        std::optional<timestep_frame> again = prefetcher.next();
+        assert(!end.has_value() && !again.has_value());
+    }
+
+    std::cout << "Prefetch order test passed.\n";
+}
+
+// Test that seeking drops frames in flight and continues from the new step
+void test_prefetch_seek() {
+    hdf5_file        file(test_file);
+    field_prefetcher prefetcher(file, { "Ex", "Ey", "Ez" }, 0, steps, dataset_path);
+
+    check_frame(*prefetcher.next(), 0);
+    prefetcher.seek(4);
+    check_frame(*prefetcher.next(), 4);
+    prefetcher.seek(2);
+    check_frame(*prefetcher.next(), 2);
+    check_frame(*prefetcher.next(), 3);
+
+    // frames dropped while decoding still count against the depth, however fast the scrubbing
+    field_prefetcher::options opts;
+    opts.depth = 2;
+    field_prefetcher scrubbed(file, { "Ex", "Ey", "Ez" }, 0, steps, dataset_path, opts);
+    for (std::size_t round = 0; round < 20; ++round) {
+        scrubbed.seek(round % steps);
+        assert(scrubbed.frames_in_flight() <= opts.depth);
+        std::this_thread::yield();
+        assert(scrubbed.frames_in_flight() <= opts.depth);
+    }
+    check_frame(*scrubbed.next(), 19 % steps);
+
+    // destroying the prefetcher with frames still in flight must not hang or crash
+    prefetcher.seek(0);
+
+    std::cout << "Prefetch seek test passed.\n";
+}
+
+// Test that a missing dataset surfaces as an exception from next()
+void test_prefetch_error() {
+    hdf5_file        file(test_file);
+    field_prefetcher prefetcher(file, { "Ex", "Hx" }, 0, 2, dataset_path);
+
+    bool threw = false;
+    try {
+        (void) prefetcher.next();
+    } catch (const std::runtime_error &) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "Prefetch error test passed.\n";
+}
+
+int main() {
+    write_test_file();
+    test_prefetch_order();
+    test_prefetch_seek();
+    test_prefetch_error();
+    std::filesystem::remove(test_file);
+
+    std::cout << "All tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,258 @@
+#include "velm/core/bricked_array.h"
+#include "velm/core/ndarray.h"
+#include "velm/io/hd5.h"
+#include "velm/io/snapshot.h"
+
+#include <cassert>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using velm_DR::bricked_array;
+using velm_DR::ndarray;
+using vlem::hdf5_file;
+using vlem::snapshot_field;
+using vlem::snapshot_file;
+using vlem::snapshot_layout;
+using vlem::snapshot_writer;
+
+namespace {
+
+const std::filesystem::path temp_dir      = std::filesystem::temp_directory_path();
+const std::string           snapshot_path = (temp_dir / "velm_test_snapshot.vsnap").string();
+const std::string           hdf5_path     = (temp_dir / "velm_test_snapshot.h5").string();
+
+template <typename F> bool throws(F && f) {
+    try {
+        f();
+    } catch (const std::runtime_error &) {
+        return true;
+    }
+    return false;
+}
+
+bool aligned(const void * p) {
+    return reinterpret_cast<std::uintptr_t>(p) % vlem::snapshot_alignment == 0;
+}
+
+}  // namespace
+
+// Test that linear fields come back as views over the mapping with their dtype, dims and values
+void test_linear() {
+    ndarray<float, 3> field(13, 7, 5);
+    for (std::size_t n = 0; n < field.total_elements(); ++n) {
+        field.data[n] = static_cast<float>(n) * 0.5f;
+    }
+    ndarray<std::int16_t, 2> mask(3, 1000);
+    for (std::size_t n = 0; n < mask.total_elements(); ++n) {
+        mask.data[n] = static_cast<std::int16_t>(n % 300) - 150;
+    }
+    ndarray<double, 1> times(4);
+    {
+        snapshot_writer out(snapshot_path);
+        out.add("/step_0/E", field);
+        out.add("mask", mask);
+        // a strided view is packed
+        out.add<float, 3>("/every_other", field.slice(0, 0, 13, 2));
+        out.add("times", times);
+        out.finish();
+    }
+
+    snapshot_file file(snapshot_path);
+    assert(file.fields().size() == 4 && file.has_field("mask") && !file.has_field("/step_0"));
+    const snapshot_field & info = file.field("/step_0/E");
+    assert(info.type == velm_DR::dtype::float32 && info.layout == snapshot_layout::linear);
+    assert(info.dims == std::vector<std::size_t>({ 13, 7, 5 }));
+    assert(info.strides == std::vector<std::size_t>({ 35, 5, 1 }));
+    assert(info.offset % vlem::snapshot_alignment == 0 && info.bytes == field.total_elements() * sizeof(float));
+
+    velm_DR::ndarray_view<const float, 3> e = file.view<float, 3>("/step_0/E");
+    assert(aligned(e.data) && e.dims[0] == 13 && e.dims[1] == 7 && e.dims[2] == 5);
+    for (std::size_t i = 0; i < 13; ++i) {
+        for (std::size_t j = 0; j < 7; ++j) {
+            for (std::size_t k = 0; k < 5; ++k) {
+                assert(e(i, j, k) == field(i, j, k));
+            }
+        }
+    }
+    velm_DR::ndarray_view<const float, 3> every_other = file.view<float, 3>("/every_other");
+    assert(every_other.dims[0] == 7 && every_other(3, 6, 4) == field(6, 6, 4));
+    velm_DR::ndarray_view<const std::int16_t, 2> m = file.view<std::int16_t, 2>("mask");
+    assert(aligned(m.data) && m(2, 999) == mask(2, 999) && m(0, 7) == -143);
+    file.prefetch("times");
+
+    // the field's type, rank and layout are checked
+    const bool wrong_type  = throws([&] { (void) file.view<double, 3>("/step_0/E"); });
+    const bool wrong_rank  = throws([&] { (void) file.view<float, 2>("/step_0/E"); });
+    const bool not_bricked = throws([&] { (void) file.brick_view<float>("/step_0/E"); });
+    const bool missing     = throws([&] { (void) file.field("missing"); });
+    assert(wrong_type && wrong_rank && not_bricked && missing);
+
+    std::cout << "Linear test passed.\n";
+}
+
+// Test that bricked fields keep their storage order and load back into an identical bricked_array
+void test_bricked() {
+    bricked_array<float, 8> bricked(20, 9, 17, velm_DR::brick_order::morton);
+    for (std::size_t i = 0; i < 20; ++i) {
+        for (std::size_t j = 0; j < 9; ++j) {
+            for (std::size_t k = 0; k < 17; ++k) {
+                bricked(i, j, k) = static_cast<float>(i * 10000 + j * 100 + k);
+            }
+        }
+    }
+    {
+        snapshot_writer out(snapshot_path);
+        out.add("bricked", bricked);
+        out.finish();
+    }
+
+    snapshot_file          file(snapshot_path);
+    const snapshot_field & info = file.field("bricked");
+    assert(info.layout == snapshot_layout::bricked && info.brick_edge == 8);
+    assert(info.order == velm_DR::brick_order::morton && info.dims == std::vector<std::size_t>({ 20, 9, 17 }));
+
+    velm_DR::ndarray_view<const float, 4> bricks = file.brick_view<float>("bricked");
+    assert(aligned(bricks.data) && bricks.dims[0] == bricked.brick_count() && bricks.dims[3] == 8);
+    for (std::size_t b = 0; b < bricked.brick_count(); ++b) {
+        velm_DR::brick_ref<const float> ref = std::as_const(bricked).brick(b);
+        for (std::size_t i = 0; i < ref.view.dims[0]; ++i) {
+            for (std::size_t j = 0; j < ref.view.dims[1]; ++j) {
+                for (std::size_t k = 0; k < ref.view.dims[2]; ++k) {
+                    assert(bricks(b, i, j, k) == ref.view(i, j, k));
+                }
+            }
+        }
+    }
+
+    bricked_array<float, 8> loaded = file.load_bricked<float, 8>("bricked");
+    assert(loaded.order == velm_DR::brick_order::morton && loaded(19, 8, 16) == bricked(19, 8, 16));
+    assert(loaded(7, 3, 11) == 70311.0f);
+    const bool wrong_edge = throws([&] { (void) file.load_bricked<float, 16>("bricked"); });
+    const bool not_linear = throws([&] { (void) file.view<float, 3>("bricked"); });
+    assert(wrong_edge && not_linear);
+
+    std::cout << "Bricked test passed.\n";
+}
+
+// Test conversion from HDF5, with contiguous and chunked datasets of several types
+void test_convert() {
+    ndarray<float, 3>        field(30, 11, 6);
+    ndarray<std::uint8_t, 2> labels(5, 9);
+    ndarray<std::int64_t, 4> ids(2, 3, 4, 5);
+    for (std::size_t n = 0; n < field.total_elements(); ++n) {
+        field.data[n] = static_cast<float>(n) - 100.0f;
+    }
+    for (std::size_t n = 0; n < labels.total_elements(); ++n) {
+        labels.data[n] = static_cast<std::uint8_t>(n * 7);
+    }
+    for (std::size_t n = 0; n < ids.total_elements(); ++n) {
+        ids.data[n] = static_cast<std::int64_t>(n) << 40;
+    }
+    hdf5_file   h5(hdf5_path, hdf5_file::access::truncate);
+    std::size_t chunk[3] = { 8, 4, 6 };
+    h5.write_field("/chunked", field, chunk, 1);
+    h5.write_field("/labels", labels);
+    h5.write_field("/ids", ids);
+
+    vlem::convert_to_snapshot(h5, { "/chunked", "/labels", "/ids" }, snapshot_path);
+    snapshot_file file(snapshot_path);
+    assert(file.fields().size() == 3);
+    velm_DR::ndarray_view<const float, 3> converted = file.view<float, 3>("/chunked");
+    for (std::size_t n = 0; n < field.total_elements(); ++n) {
+        assert(converted.data[n] == field.data[n]);
+    }
+    velm_DR::ndarray_view<const std::uint8_t, 2> converted_labels = file.view<std::uint8_t, 2>("/labels");
+    velm_DR::ndarray_view<const std::int64_t, 4> converted_ids    = file.view<std::int64_t, 4>("/ids");
+    assert(converted_labels(4, 8) == labels(4, 8) && converted_ids(1, 2, 3, 4) == ids(1, 2, 3, 4));
+    const bool missing = throws([&] { vlem::convert_to_snapshot(h5, { "/missing" }, snapshot_path); });
+    assert(missing);
+    assert(!std::filesystem::exists(snapshot_path));
+
+    std::cout << "Convert test passed.\n";
+}
+
+// Test writer misuse and files that are not snapshots
+void test_errors() {
+    {
+        snapshot_writer out(snapshot_path);
+        ndarray<float, 1> values(4);
+        out.add("a", values);
+        const bool duplicate = throws([&] { out.add("a", values); });
+        const bool too_long  = throws([&] { out.add(std::string(200, 'x'), values); });
+        assert(duplicate && too_long);
+        out.begin_field("b", velm_DR::dtype::float32, { 4 });
+        out.append(values.data, 8);
+        const bool short_field = throws([&] { out.end_field(); });
+        const bool no_field    = throws([&] { out.append(values.data, 8); });
+        assert(short_field && no_field);
+    }
+    // an unfinished writer leaves nothing behind
+    assert(!std::filesystem::exists(snapshot_path));
+    {
+        std::ofstream junk(snapshot_path, std::ios::binary | std::ios::trunc);
+        std::string   text(8192, 'x');
+        junk.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+    const bool not_snapshot = throws([&] { snapshot_file file(snapshot_path); });
+    const bool no_file      = throws([&] { snapshot_file file((temp_dir / "velm_no_such_snapshot.vsnap").string()); });
+    assert(not_snapshot && no_file);
+
+    // table entries with a zero brick edge, a partial brick, dims that do not match the payload or an unknown layout
+    // or order are rejected on open; a linear view whose extent wraps around 64 bits is rejected too
+    const std::size_t edge_at = 124, layout_at = 122, order_at = 123, dims_at = 128, strides_at = 192, bytes_at = 264;
+    auto corrupted = [&](std::size_t at, const void * value, std::size_t size) {
+        {
+            snapshot_writer out(snapshot_path);
+            out.add("bricked", bricked_array<float, 4>(5, 5, 5));
+            out.add("linear", ndarray<float, 1>(3));
+            out.finish();
+        }
+        std::uint64_t table_offset = 0;
+        std::fstream  file(snapshot_path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekg(16);
+        file.read(reinterpret_cast<char *>(&table_offset), sizeof(table_offset));
+        file.seekp(static_cast<std::streamoff>(table_offset + at));
+        file.write(static_cast<const char *>(value), static_cast<std::streamsize>(size));
+        file.close();
+        return throws([&] {
+            snapshot_file snapshot(snapshot_path);
+            (void) snapshot.view<float, 1>("linear");
+        });
+    };
+    const std::uint32_t zero_edge = 0;
+    const std::uint64_t partial   = 4 * 4 * 4 * sizeof(float) + 4;
+    const std::uint64_t larger    = 9;
+    const std::uint64_t huge      = std::uint64_t(1) << 62;
+    const std::uint64_t wrap      = std::uint64_t(1) << 63;
+    const std::uint8_t  unknown   = 7;
+    const bool          intact    = corrupted(edge_at, "\4\0\0\0", 4);
+    const bool          no_edge   = corrupted(edge_at, &zero_edge, sizeof(zero_edge));
+    const bool          torn      = corrupted(bytes_at, &partial, sizeof(partial));
+    const bool          reshaped  = corrupted(dims_at, &larger, sizeof(larger));
+    const bool          overflow  = corrupted(dims_at, &huge, sizeof(huge));
+    const bool          wraps     = corrupted(272 + strides_at, &wrap, sizeof(wrap));  // the 272-byte second entry
+    const bool          layout    = corrupted(layout_at, &unknown, 1);
+    const bool          order     = corrupted(order_at, &unknown, 1);
+    assert(!intact && no_edge && torn && reshaped && overflow && wraps && layout && order);
+    std::filesystem::remove(snapshot_path);
+
+    std::cout << "Errors test passed.\n";
+}
+
+int main() {
+    test_linear();
+    test_bricked();
+    test_convert();
+    test_errors();
+    std::filesystem::remove(snapshot_path);
+    std::filesystem::remove(hdf5_path);
+
+    std::cout << "All tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,237 @@
+#include "velm/core/ndarray.h"
+#include "velm/core/thread_pool.h"
+#include "velm/io/hd5.h"
+#include "velm/io/snapshot.h"
+#include "velm/io/tiled_field.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+using velm_DR::ndarray;
+using vlem::hdf5_file;
+using vlem::raw_open;
+using vlem::raw_tile_store;
+using vlem::tile_access;
+using vlem::tiled_field;
+using vlem::tiled_options;
+
+namespace {
+
+const std::filesystem::path temp_dir = std::filesystem::temp_directory_path();
+
+// value of element (i, j, k), unique over the grids used here
+float expected(std::size_t i, std::size_t j, std::size_t k) {
+    return static_cast<float>(i * 10000 + j * 100 + k);
+}
+
+ndarray<float, 3> make_field(std::size_t nx, std::size_t ny, std::size_t nz) {
+    ndarray<float, 3> field(nx, ny, nz);
+    for (std::size_t i = 0; i < nx; ++i) {
+        for (std::size_t j = 0; j < ny; ++j) {
+            for (std::size_t k = 0; k < nz; ++k) {
+                field(i, j, k) = expected(i, j, k);
+            }
+        }
+    }
+    return field;
+}
+
+}  // namespace
+
+// Test tile geometry with partial tiles on every axis
+void test_tile_grid() {
+    const std::string path    = (temp_dir / "velm_test_tiled.raw").string();
+    const std::size_t dims[3] = { 10, 7, 5 };
+    auto              store   = std::make_shared<raw_tile_store<float>>(path, dims);
+    tiled_options     options;
+    options.tile[0] = 4;
+    options.tile[1] = 4;
+    options.tile[2] = 4;
+    tiled_field<float> field(store, options);
+
+    assert(field.tile_grid()[0] == 3 && field.tile_grid()[1] == 2 && field.tile_grid()[2] == 2);
+    assert(field.tile_count() == 12);
+    std::size_t origin[3], extent[3];
+    field.tile_box(11, origin, extent);
+    assert(origin[0] == 8 && origin[1] == 4 && origin[2] == 4);
+    assert(extent[0] == 2 && extent[1] == 3 && extent[2] == 1);
+
+    // a fresh raw store reads as zero
+    auto tile = field.acquire(0, tile_access::read);
+    assert(tile.view().dims[0] == 4 && tile.view()(3, 3, 3) == 0.0f);
+
+    std::cout << "Tile grid test passed.\n";
+}
+
+// Test that the budget evicts least recently used tiles and writes modified ones back
+void test_eviction_and_writeback() {
+    const std::string path    = (temp_dir / "velm_test_tiled.raw").string();
+    const std::size_t dims[3] = { 16, 16, 16 };
+    tiled_options     options;
+    options.tile[0]        = 8;
+    options.tile[1]        = 8;
+    options.tile[2]        = 8;
+    options.resident_bytes = 3 * 8 * 8 * 8 * sizeof(float);  // three of the eight tiles
+    {
+        tiled_field<float> field(std::make_shared<raw_tile_store<float>>(path, dims), options);
+        for (std::size_t t = 0; t < field.tile_count(); ++t) {
+            auto        tile = field.acquire(t, tile_access::overwrite);
+            std::size_t origin[3], extent[3];
+            field.tile_box(t, origin, extent);
+            for (std::size_t i = 0; i < extent[0]; ++i) {
+                for (std::size_t j = 0; j < extent[1]; ++j) {
+                    for (std::size_t k = 0; k < extent[2]; ++k) {
+                        tile.view()(i, j, k) = expected(origin[0] + i, origin[1] + j, origin[2] + k);
+                    }
+                }
+            }
+        }
+        vlem::tile_counters counters = field.counters();
+        assert(counters.loads == 8);
+        assert(counters.evictions == 5 && counters.writebacks == 5);
+        assert(counters.resident_bytes <= options.resident_bytes);
+        assert(counters.peak_bytes <= options.resident_bytes);
+
+        // a pinned tile is never evicted, even when the budget is exceeded meanwhile
+        auto pinned = field.acquire(0, tile_access::read);
+        for (std::size_t t = 1; t < field.tile_count(); ++t) {
+            auto tile = field.acquire(t, tile_access::read);
+            assert(tile.view()(1, 2, 3) != 0.0f);
+        }
+        assert(pinned.view()(7, 7, 7) == expected(7, 7, 7));
+        // the destructor writes the last modified tiles back
+    }
+
+    raw_tile_store<float> reopened(path, dims, raw_open::read);
+    ndarray<float, 3>     all(16, 16, 16);
+    reopened.read({ 0, 0, 0 }, all.view());
+    ndarray<float, 3> reference = make_field(16, 16, 16);
+    for (std::size_t i = 0; i < all.total_elements(); ++i) {
+        assert(all.data[i] == reference.data[i]);
+    }
+
+    bool threw = false;
+    try {
+        reopened.write({ 0, 0, 0 }, all.view());
+    } catch (const std::runtime_error &) {
+        threw = true;
+    }
+    assert(threw);
+
+    threw = false;
+    try {
+        const std::size_t wrong[3] = { 16, 16, 17 };
+        raw_tile_store<float> mismatched(path, wrong, raw_open::read);
+    } catch (const std::runtime_error &) {
+        threw = true;
+    }
+    assert(threw);
+    std::filesystem::remove(path);
+
+    std::cout << "Eviction and writeback test passed.\n";
+}
+
+// Test boxes read across tile seams from an HDF5 dataset and from a snapshot
+void test_read_box() {
+    ndarray<float, 3> reference = make_field(13, 9, 11);
+    const std::string h5_path   = (temp_dir / "velm_test_tiled.h5").string();
+    const std::string snap_path = (temp_dir / "velm_test_tiled.vsnap").string();
+    {
+        hdf5_file         file(h5_path, hdf5_file::access::truncate);
+        const std::size_t chunk[3] = { 5, 5, 5 };
+        file.write_field<float, 3>("E", reference, chunk);
+    }
+    {
+        vlem::snapshot_writer writer(snap_path);
+        writer.add("E", reference);
+        writer.finish();
+    }
+
+    hdf5_file           h5(h5_path);
+    vlem::snapshot_file snapshot(snap_path);
+    tiled_options       options;
+    options.tile[0] = 5;
+    options.tile[1] = 5;
+    options.tile[2] = 5;
+    tiled_field<float> from_h5(std::make_shared<vlem::hdf5_tile_store<float>>(h5, "E"), options);
+    tiled_field<float> from_snapshot(std::make_shared<vlem::snapshot_tile_store<float>>(snapshot, "E"), options);
+    assert(from_h5.dims()[0] == 13 && from_h5.dims()[1] == 9 && from_h5.dims()[2] == 11);
+    assert(!from_h5.store().writable());
+
+    for (tiled_field<float> * field : { &from_h5, &from_snapshot }) {
+        ndarray<float, 3> box(7, 6, 8);
+        field->read_box({ 3, 2, 1 }, box.view());
+        for (std::size_t i = 0; i < 7; ++i) {
+            for (std::size_t j = 0; j < 6; ++j) {
+                for (std::size_t k = 0; k < 8; ++k) {
+                    assert(box(i, j, k) == expected(3 + i, 2 + j, 1 + k));
+                }
+            }
+        }
+    }
+
+    bool threw = false;
+    try {
+        auto tile = from_h5.acquire(0, tile_access::write);
+    } catch (const std::runtime_error &) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::filesystem::remove(h5_path);
+    std::filesystem::remove(snap_path);
+    std::cout << "Read box test passed.\n";
+}
+
+// Test that tiles requested from many threads are each loaded once
+void test_concurrent_acquire() {
+    const std::string path    = (temp_dir / "velm_test_tiled_concurrent.raw").string();
+    const std::size_t dims[3] = { 32, 32, 32 };
+    {
+        raw_tile_store<float> store(path, dims);
+        store.write({ 0, 0, 0 }, make_field(32, 32, 32).view());
+    }
+    tiled_options options;
+    options.tile[0] = 8;
+    options.tile[1] = 8;
+    options.tile[2] = 8;
+    tiled_field<float> field(std::make_shared<raw_tile_store<float>>(path, dims, raw_open::read), options);
+
+    velm_DR::thread_pool     pool(4);
+    std::atomic<std::size_t> wrong{ 0 };
+    pool.parallel_for(4 * field.tile_count(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t n = begin; n < end; ++n) {
+            std::size_t t    = n % field.tile_count();
+            auto        tile = field.acquire(t, tile_access::read);
+            std::size_t origin[3], extent[3];
+            field.tile_box(t, origin, extent);
+            if (tile.view()(1, 1, 1) != expected(origin[0] + 1, origin[1] + 1, origin[2] + 1)) {
+                wrong.fetch_add(1);
+            }
+        }
+    });
+    assert(wrong.load() == 0);
+    assert(field.counters().loads == field.tile_count());
+
+    field.release_all();
+    assert(field.counters().resident_bytes == 0);
+    std::filesystem::remove(path);
+
+    std::cout << "Concurrent acquire test passed.\n";
+}
+
+int main() {
+    test_tile_grid();
+    test_eviction_and_writeback();
+    test_read_box();
+    test_concurrent_acquire();
+
+    std::cout << "All tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,233 @@
+#include "velm/core/ndarray.h"
+#include "velm/core/thread_pool.h"
+#include "velm/processing/isosurface.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+using velm_DP::block_bounds;
+using velm_DP::extract_isosurface;
+using velm_DP::iso_mesh;
+using velm_DP::iso_options;
+using velm_DR::ndarray;
+
+namespace {
+
+// deterministic values in [-1, 1)
+ndarray<float, 3> make_noise(std::size_t nx, std::size_t ny, std::size_t nz, unsigned seed) {
+    ndarray<float, 3> field(nx, ny, nz);
+    unsigned          state = seed * 2654435761u + 1;
+    for (float & value : field) {
+        state = state * 1664525u + 1013904223u;
+        value = static_cast<float>(state >> 8) / static_cast<float>(1u << 24) * 2.0f - 1.0f;
+    }
+    return field;
+}
+
+// radius - distance from `center`: positive inside the ball
+ndarray<float, 3> make_ball(std::size_t n, float center, float radius) {
+    ndarray<float, 3> field(n, n, n);
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < n; ++j) {
+            for (std::size_t k = 0; k < n; ++k) {
+                float x = i - center, y = j - center, z = k - center;
+                field(i, j, k) = radius - std::sqrt(x * x + y * y + z * z);
+            }
+        }
+    }
+    return field;
+}
+
+// how often each directed edge occurs among the triangles
+std::map<std::pair<std::uint32_t, std::uint32_t>, int> directed_edges(const iso_mesh & mesh) {
+    std::map<std::pair<std::uint32_t, std::uint32_t>, int> edges;
+    for (std::size_t t = 0; t < mesh.triangle_count(); ++t) {
+        for (std::size_t e = 0; e < 3; ++e) {
+            ++edges[{ mesh.indices[3 * t + e], mesh.indices[3 * t + (e + 1) % 3] }];
+        }
+    }
+    return edges;
+}
+
+bool same_mesh(const iso_mesh & a, const iso_mesh & b) {
+    return a.vertices.size() == b.vertices.size() && a.indices == b.indices &&
+           std::memcmp(a.vertices.data(), b.vertices.data(), a.vertices.size() * sizeof(a.vertices[0])) == 0;
+}
+
+}  // namespace
+
+// Test a closed sphere: on the surface, outward facing, welded and watertight
+void test_sphere() {
+    ndarray<float, 3> field = make_ball(24, 11.3f, 7.0f);
+    iso_options       options;
+    options.spacing[2] = 0.5f;
+    options.origin[0]  = 100.0f;
+    iso_mesh mesh      = extract_isosurface(field.view(), 0.0f, options);
+    assert(mesh.triangle_count() > 500);
+
+    for (const velm_DP::mesh_vertex & v : mesh.vertices) {
+        float x = v.position[0] - 100.0f - 11.3f, y = v.position[1] - 11.3f, z = v.position[2] / 0.5f - 11.3f;
+        float r = std::sqrt(x * x + y * y + z * z);
+        // linear interpolation of a distance field cuts chords slightly inside the sphere
+        assert(std::abs(r - 7.0f) < 0.1f);
+        assert(std::abs(v.normal[0] * v.normal[0] + v.normal[1] * v.normal[1] + v.normal[2] * v.normal[2] - 1) < 1e-4f);
+        // the normal is taken in world space, where the ball is squashed along axis 2
+        assert(v.normal[0] * x + v.normal[1] * y > -0.1f * r);
+    }
+    for (std::size_t t = 0; t < mesh.triangle_count(); ++t) {
+        const float * a = mesh.vertices[mesh.indices[3 * t]].position;
+        const float * b = mesh.vertices[mesh.indices[3 * t + 1]].position;
+        const float * c = mesh.vertices[mesh.indices[3 * t + 2]].position;
+        float         u[3], w[3], n[3], centroid[3];
+        for (std::size_t i = 0; i < 3; ++i) {
+            u[i]        = b[i] - a[i];
+            w[i]        = c[i] - a[i];
+            centroid[i] = (a[i] + b[i] + c[i]) / 3.0f;
+        }
+        n[0] = u[1] * w[2] - u[2] * w[1];
+        n[1] = u[2] * w[0] - u[0] * w[2];
+        n[2] = u[0] * w[1] - u[1] * w[0];
+        // counter-clockwise seen from outside
+        float outward = n[0] * (centroid[0] - 111.3f) + n[1] * (centroid[1] - 11.3f) + n[2] * (centroid[2] - 5.65f);
+        assert(outward > 0.0f);
+    }
+
+    // every edge is shared by two triangles with opposite winding, and no vertex is duplicated
+    auto edges = directed_edges(mesh);
+    for (const auto & [edge, count] : edges) {
+        assert(count == 1 && edges.count({ edge.second, edge.first }) == 1);
+    }
+    std::set<std::tuple<float, float, float>> positions;
+    for (const velm_DP::mesh_vertex & v : mesh.vertices) {
+        positions.insert({ v.position[0], v.position[1], v.position[2] });
+    }
+    assert(positions.size() == mesh.vertices.size());
+    // a sphere: V - E + F = 2
+    std::size_t euler = mesh.vertices.size() + mesh.triangle_count() - edges.size() / 2;
+    assert(euler == 2);
+
+    std::cout << "Sphere test passed.\n";
+}
+
+// Test the case table on noise, which hits every ambiguous face: neighbouring cells always agree
+void test_noise_is_manifold() {
+    for (unsigned seed = 0; seed < 4; ++seed) {
+        ndarray<float, 3> field = make_noise(13, 10, 17, seed);
+        iso_mesh          mesh  = extract_isosurface(field.view(), 0.1f * seed);
+        auto              edges = directed_edges(mesh);
+        std::size_t       open  = 0;
+        for (const auto & [edge, count] : edges) {
+            assert(count == 1);
+            open += edges.count({ edge.second, edge.first }) == 0;
+        }
+        // edges without a twin can only lie on the faces of the grid
+        for (const auto & [edge, count] : edges) {
+            if (edges.count({ edge.second, edge.first }) == 0) {
+                const float * a        = mesh.vertices[edge.first].position;
+                const float * b        = mesh.vertices[edge.second].position;
+                bool          on_faces = false;
+                const float   last[3]  = { 12.0f, 9.0f, 16.0f };
+                for (std::size_t axis = 0; axis < 3; ++axis) {
+                    on_faces |= a[axis] == b[axis] && (a[axis] == 0.0f || a[axis] == last[axis]);
+                }
+                assert(on_faces);
+            }
+        }
+        assert(open > 0 && mesh.triangle_count() > 1000);
+        for (std::uint32_t index : mesh.indices) {
+            assert(index < mesh.vertices.size());
+        }
+    }
+
+    std::cout << "Noise is manifold test passed.\n";
+}
+
+// Test that block skipping, thread count and strided input leave the mesh unchanged
+void test_determinism() {
+    ndarray<float, 3>    field = make_ball(41, 20.0f, 6.5f);
+    velm_DR::thread_pool serial(0);
+    velm_DR::thread_pool parallel(3);
+    iso_options          options;
+    options.pool  = &serial;
+    iso_mesh base = extract_isosurface(field.view(), 0.0f, options);
+
+    options.pool      = &parallel;
+    iso_mesh threaded = extract_isosurface(field.view(), 0.0f, options);
+    assert(same_mesh(base, threaded));
+
+    block_bounds bounds(field.view(), &parallel);
+    assert(bounds.counts()[0] == 5 && bounds.counts()[2] == 5);
+    // the ball only reaches into the middle blocks
+    assert(bounds.active_blocks(0.0f) < 125 && bounds.active_blocks(0.0f) >= 8);
+    assert(bounds.active_blocks(100.0f) == 0);
+    options.bounds   = &bounds;
+    iso_mesh skipped = extract_isosurface(field.view(), 0.0f, options);
+    assert(same_mesh(base, skipped));
+
+    // every other sample of a twice finer grid, so rows are strided
+    ndarray<float, 3> fine(81, 41, 82);
+    for (std::size_t i = 0; i < 81; ++i) {
+        for (std::size_t j = 0; j < 41; ++j) {
+            for (std::size_t k = 0; k < 82; ++k) {
+                fine(i, j, k) = i % 2 == 0 && k % 2 == 0 ? field(i / 2, j, k / 2) : 99.0f;
+            }
+        }
+    }
+    auto strided = fine.view().slice(0, 0, 81, 2).slice(2, 0, 82, 2);
+    assert(!strided.is_contiguous());
+    options.bounds     = nullptr;
+    iso_mesh resampled = extract_isosurface(strided, 0.0f, options);
+    assert(same_mesh(base, resampled));
+
+    // a summary built for a field of another shape is rejected
+    ndarray<float, 3> smaller = make_ball(21, 10.0f, 6.5f);
+    block_bounds      wrong(smaller.view(), &serial);
+    options.bounds = &wrong;
+    bool threw     = false;
+    try {
+        (void) extract_isosurface(field.view(), 0.0f, options);
+    } catch (const std::invalid_argument &) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "Determinism test passed.\n";
+}
+
+// Test empty results
+void test_empty() {
+    ndarray<float, 3> field = make_ball(9, 4.0f, 2.0f);
+    iso_mesh          above = extract_isosurface(field.view(), 10.0f);
+    iso_mesh          below = extract_isosurface(field.view(), -10.0f);
+    assert(above.vertices.empty() && above.indices.empty());
+    assert(below.vertices.empty() && below.indices.empty());
+    ndarray<float, 3> flat(1, 9, 9);
+    iso_mesh          slab = extract_isosurface(flat.view(), 0.0f);
+    assert(slab.vertices.empty() && slab.indices.empty());
+    // a cube of cells touched exactly at one corner: inside corners at >= iso
+    ndarray<float, 3> corner(2, 2, 2);
+    corner(1, 1, 1) = 1.0f;
+    iso_mesh single = extract_isosurface(corner.view(), 0.5f);
+    assert(single.vertices.size() == 3 && single.triangle_count() == 1);
+
+    std::cout << "Empty test passed.\n";
+}
+
+int main() {
+    test_sphere();
+    test_noise_is_manifold();
+    test_determinism();
+    test_empty();
+
+    std::cout << "All tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,166 @@
+#include "velm/core/ndarray.h"
+#include "velm/processing/kernels.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+using velm_DP::field_stats;
+using velm_DP::simd_level;
+using velm_DR::ndarray;
+using velm_DR::ndarray_view;
+
+namespace {
+
+template <typename T> bool close(T a, T b) {
+    T tolerance = sizeof(T) == 4 ? T(1e-5) : T(1e-12);
+    return std::abs(a - b) <= tolerance * std::max(T(1), std::abs(b));
+}
+
+// lanes sum in T before folding into double, so allow rounding proportional to the element count
+template <typename T> bool close_sum(double a, double b, std::size_t count) {
+    double tolerance = sizeof(T) == 4 ? 1e-5 : 1e-12;
+    return std::abs(a - b) <= tolerance * static_cast<double>(std::max<std::size_t>(count, 1));
+}
+
+// deterministic values in [-2, 2) that differ between components
+template <typename T> ndarray<T, 3> make_component(std::size_t nx, std::size_t ny, std::size_t nz, unsigned seed) {
+    ndarray<T, 3> field(nx, ny, nz);
+    unsigned      state = seed * 2654435761u + 1;
+    for (T & value : field) {
+        state = state * 1664525u + 1013904223u;
+        value = static_cast<T>(state >> 8) / static_cast<T>(1u << 24) * T(4) - T(2);
+    }
+    return field;
+}
+
+template <typename T, std::size_t N> field_stats<T> reference_stats(ndarray_view<const T, N> field) {
+    field_stats<T> stats;
+    for (const T & value : field) {
+        stats.min = std::min(stats.min, value);
+        stats.max = std::max(stats.max, value);
+        stats.sum += static_cast<double>(value);
+        ++stats.count;
+    }
+    return stats;
+}
+
+template <typename T> void check_stats(const field_stats<T> & got, const field_stats<T> & expected) {
+    assert(got.count == expected.count);
+    assert(got.min == expected.min && got.max == expected.max);
+    assert(close_sum<T>(got.sum, expected.sum, expected.count));
+}
+
+std::vector<simd_level> available_levels() {
+    std::vector<simd_level> levels = { simd_level::scalar };
+    if (velm_DP::detected_simd_level() >= simd_level::avx2) {
+        levels.push_back(simd_level::avx2);
+    }
+    if (velm_DP::detected_simd_level() >= simd_level::avx512) {
+        levels.push_back(simd_level::avx512);
+    }
+    return levels;
+}
+
+// shapes whose flat length hits every remainder modulo the widest register
+const std::size_t shapes[][3] = { { 1, 1, 1 }, { 1, 1, 7 }, { 2, 3, 5 }, { 4, 4, 17 }, { 9, 11, 13 }, { 16, 16, 16 } };
+
+template <typename T> void check_reductions() {
+    for (const auto & shape : shapes) {
+        ndarray<T, 3> field = make_component<T>(shape[0], shape[1], shape[2], 1);
+        check_stats(velm_DP::reduce_stats(field), reference_stats<T, 3>(field.view()));
+        // strided: transposed and every other row
+        ndarray_view<const T, 3> transposed = field.transpose();
+        check_stats(velm_DP::reduce_stats(transposed), reference_stats<T, 3>(transposed));
+        ndarray_view<const T, 3> stepped = field.slice(1, 0, shape[1], 2);
+        check_stats(velm_DP::reduce_stats(stepped), reference_stats<T, 3>(stepped));
+    }
+}
+
+template <typename T> void check_elementwise() {
+    for (const auto & shape : shapes) {
+        std::size_t   nx = shape[0];
+        std::size_t   ny = shape[1];
+        std::size_t   nz = shape[2];
+        ndarray<T, 3> e[3] = { make_component<T>(nx, ny, nz, 2), make_component<T>(nx, ny, nz, 3),
+                               make_component<T>(nx, ny, nz, 4) };
+        ndarray<T, 3> h[3] = { make_component<T>(nx, ny, nz, 5), make_component<T>(nx, ny, nz, 6),
+                               make_component<T>(nx, ny, nz, 7) };
+        ndarray<T, 3> mag(nx, ny, nz);
+        ndarray<T, 3> energy(nx, ny, nz);
+        ndarray<T, 3> s[3] = { ndarray<T, 3>(nx, ny, nz), ndarray<T, 3>(nx, ny, nz), ndarray<T, 3>(nx, ny, nz) };
+
+        field_stats<T> mag_stats = velm_DP::magnitude<T, 3>(e[0].view(), e[1].view(), e[2].view(), mag.view());
+        velm_DP::poynting<T, 3>(e[0].view(), e[1].view(), e[2].view(), h[0].view(), h[1].view(), h[2].view(),
+                                s[0].view(), s[1].view(), s[2].view());
+        field_stats<T> energy_stats = velm_DP::energy_density<T, 3>(
+            e[0].view(), e[1].view(), e[2].view(), h[0].view(), h[1].view(), h[2].view(), energy.view(), T(2), T(4));
+
+        for (std::size_t n = 0; n < mag.total_elements(); ++n) {
+            T ex = e[0].data[n], ey = e[1].data[n], ez = e[2].data[n];
+            T hx = h[0].data[n], hy = h[1].data[n], hz = h[2].data[n];
+            assert(close(mag.data[n], std::sqrt(ex * ex + ey * ey + ez * ez)));
+            assert(close(s[0].data[n], ey * hz - ez * hy));
+            assert(close(s[1].data[n], ez * hx - ex * hz));
+            assert(close(s[2].data[n], ex * hy - ey * hx));
+            T e2 = ex * ex + ey * ey + ez * ez;
+            T h2 = hx * hx + hy * hy + hz * hz;
+            assert(close(energy.data[n], (T(2) * e2 + h2 / T(4)) / T(2)));
+        }
+        // the fused stats describe exactly what was written
+        check_stats(mag_stats, reference_stats<T, 3>(mag.view()));
+        check_stats(energy_stats, reference_stats<T, 3>(energy.view()));
+
+        // a transposed destination goes through the row walker and must match the dense result
+        ndarray<T, 3> transposed_out(nz, ny, nx);
+        velm_DP::magnitude<T, 3>(e[0].view(), e[1].view(), e[2].view(), transposed_out.transpose());
+        for (std::size_t i = 0; i < nx; ++i) {
+            for (std::size_t j = 0; j < ny; ++j) {
+                for (std::size_t k = 0; k < nz; ++k) {
+                    assert(transposed_out(k, j, i) == mag(i, j, k));
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+// Test min/max/sum reductions against a scalar reference for every instruction set available
+void test_reduce_stats() {
+    for (simd_level level : available_levels()) {
+        velm_DP::set_simd_level(level);
+        assert(velm_DP::active_simd_level() == level);
+        check_reductions<float>();
+        check_reductions<double>();
+    }
+    velm_DP::set_simd_level(simd_level::avx512);
+
+    ndarray<float, 3>  empty(0, 4, 4);
+    field_stats<float> stats = velm_DP::reduce_stats(empty);
+    assert(stats.count == 0 && stats.mean() == 0.0);
+
+    std::cout << "Reduce stats test passed.\n";
+}
+
+// Test the fused elementwise kernels against scalar references for every instruction set available
+void test_elementwise_kernels() {
+    for (simd_level level : available_levels()) {
+        velm_DP::set_simd_level(level);
+        check_elementwise<float>();
+        check_elementwise<double>();
+    }
+    velm_DP::set_simd_level(simd_level::avx512);
+
+    std::cout << "Elementwise kernels test passed.\n";
+}
+
+int main() {
+    test_reduce_stats();
+    test_elementwise_kernels();
+
+    std::cout << "All tests passed!\n";
+    return 0;
+}
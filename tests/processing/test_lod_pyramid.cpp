@@ -0,0 +1,219 @@
+#include "velm/core/ndarray.h"
+#include "velm/core/thread_pool.h"
+#include "velm/io/hd5.h"
+#include "velm/processing/lod_pyramid.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <utility>
+
+using velm_DP::lod_filter;
+using velm_DP::lod_options;
+using velm_DP::lod_pyramid;
+using velm_DP::lod_selection;
+using velm_DR::ndarray;
+using velm_DR::ndarray_view;
+using vlem::hdf5_file;
+
+namespace {
+
+const std::string test_file = (std::filesystem::temp_directory_path() / "velm_test_lod_pyramid.h5").string();
+
+// deterministic values in [-1, 1) with a single spike, so max and mean differ visibly
+ndarray<float, 3> make_field(std::size_t nx, std::size_t ny, std::size_t nz) {
+    ndarray<float, 3> field(nx, ny, nz);
+    unsigned          state = 12345;
+    for (float & value : field) {
+        state = state * 1664525u + 1013904223u;
+        value = static_cast<float>(state >> 8) / static_cast<float>(1u << 24) * 2.0f - 1.0f;
+    }
+    field(nx / 2, ny / 3, nz - 1) = 50.0f;
+    return field;
+}
+
+// reference reduction of one level into the next, straight from the definition
+ndarray<float, 3> reduce(ndarray_view<const float, 3> finer, lod_filter filter) {
+    ndarray<float, 3> coarse((finer.dims[0] + 1) / 2, (finer.dims[1] + 1) / 2, (finer.dims[2] + 1) / 2);
+    for (std::size_t i = 0; i < coarse.dims[0]; ++i) {
+        for (std::size_t j = 0; j < coarse.dims[1]; ++j) {
+            for (std::size_t k = 0; k < coarse.dims[2]; ++k) {
+                float       lo = INFINITY, hi = -INFINITY, sum = 0.0f;
+                std::size_t n = 0;
+                for (std::size_t a = 2 * i; a < std::min(2 * i + 2, finer.dims[0]); ++a) {
+                    for (std::size_t b = 2 * j; b < std::min(2 * j + 2, finer.dims[1]); ++b) {
+                        for (std::size_t c = 2 * k; c < std::min(2 * k + 2, finer.dims[2]); ++c) {
+                            float v = finer(a, b, c);
+                            lo      = std::min(lo, v);
+                            hi      = std::max(hi, v);
+                            sum += v;
+                            ++n;
+                        }
+                    }
+                }
+                coarse(i, j, k) = filter == lod_filter::min ? lo : filter == lod_filter::max ? hi : sum / n;
+            }
+        }
+    }
+    return coarse;
+}
+
+void check_levels(const lod_pyramid<float> & pyramid, ndarray_view<const float, 3> source) {
+    ndarray<float, 3> expected = reduce(source, pyramid.filter());
+    for (std::size_t l = 1; l < pyramid.level_count(); ++l) {
+        ndarray_view<const float, 3> level = pyramid.level(l);
+        for (std::size_t a = 0; a < 3; ++a) {
+            assert(level.dims[a] == expected.dims[a] && pyramid.dims(l)[a] == expected.dims[a]);
+        }
+        for (std::size_t n = 0; n < expected.total_elements(); ++n) {
+            assert(std::abs(level.data[n] - expected.data[n]) <= 1e-5f * std::max(1.0f, std::abs(expected.data[n])));
+        }
+        ndarray<float, 3> next = reduce(level, pyramid.filter());
+        std::swap(expected, next);
+    }
+}
+
+}  // namespace
+
+// Test every filter against a direct reduction, including odd extents
+void test_build_in_memory() {
+    ndarray<float, 3>    field = make_field(11, 6, 9);
+    velm_DR::thread_pool pool(3);
+    lod_options          options;
+    options.pool = &pool;
+
+    for (lod_filter filter : { lod_filter::min, lod_filter::max, lod_filter::mean }) {
+        lod_pyramid<float> pyramid(field.view(), filter, options);
+        // 11x6x9 -> 6x3x5 -> 3x2x3 -> 2x1x2 -> 1x1x1
+        assert(pyramid.level_count() == 5);
+        assert(pyramid.dims(0)[0] == 11 && pyramid.dims(4)[0] == 1 && pyramid.dims(4)[2] == 1);
+        check_levels(pyramid, field.view());
+    }
+
+    // the spike survives to the coarsest max level, but not the mean
+    lod_pyramid<float> peaks(field.view(), lod_filter::max);
+    assert(peaks.level(peaks.level_count() - 1)(0, 0, 0) == 50.0f);
+    lod_pyramid<float> mean(field.view(), lod_filter::mean);
+    assert(mean.level(mean.level_count() - 1)(0, 0, 0) < 2.0f);
+
+    options.max_levels = 2;
+    lod_pyramid<float> shallow(field.view(), lod_filter::mean, options);
+    assert(shallow.level_count() == 3);
+
+    std::cout << "Build in memory test passed.\n";
+}
+
+// Test that streaming out of HDF5 gives the same levels, for chunks that do not align with 2x2x2 blocks
+void test_build_streamed() {
+    ndarray<float, 3> field = make_field(23, 17, 30);
+    {
+        hdf5_file   file(test_file, hdf5_file::access::truncate);
+        std::size_t chunk[3] = { 5, 7, 9 };
+        file.write_field("chunked", field, chunk);
+        file.write_field("contiguous", field);
+    }
+    hdf5_file file(test_file);
+    for (const char * name : { "chunked", "contiguous" }) {
+        for (lod_filter filter : { lod_filter::min, lod_filter::max, lod_filter::mean }) {
+            lod_pyramid<float> streamed(file, name, filter);
+            assert(streamed.level_count() == 6);
+            assert(streamed.source_dims()[1] == 17);
+            check_levels(streamed, field.view());
+        }
+    }
+
+    std::cout << "Build streamed test passed.\n";
+}
+
+// Test the sidecar round trip and that a newer source invalidates it
+void test_persistence() {
+    ndarray<float, 3> field = make_field(16, 16, 16);
+    {
+        hdf5_file file(test_file, hdf5_file::access::truncate);
+        file.write_field("/step_0/Ex", field);
+    }
+    hdf5_file   file(test_file);
+    std::string sidecar = lod_pyramid<float>::sidecar_path(test_file, "/step_0/Ex", lod_filter::max);
+    std::filesystem::remove(sidecar);
+
+    lod_pyramid<float> built = lod_pyramid<float>::open(file, "/step_0/Ex", lod_filter::max);
+    assert(std::filesystem::exists(sidecar));
+    assert(built.level_count() == 5);
+
+    const std::size_t                 dims[3] = { 16, 16, 16 };
+    std::optional<lod_pyramid<float>> loaded  = lod_pyramid<float>::load(sidecar, "/step_0/Ex", lod_filter::max, dims);
+    assert(loaded && loaded->level_count() == 5);
+    check_levels(*loaded, field.view());
+    // a different shape or filter does not match what was saved
+    const std::size_t                 other[3] = { 16, 16, 8 };
+    std::optional<lod_pyramid<float>> wrong_shape =
+        lod_pyramid<float>::load(sidecar, "/step_0/Ex", lod_filter::max, other);
+    std::optional<lod_pyramid<float>> wrong_filter =
+        lod_pyramid<float>::load(sidecar, "/step_0/Ex", lod_filter::min, dims);
+    assert(!wrong_shape && !wrong_filter);
+
+    // reopening reuses the sidecar as long as it is newer than the source
+    auto               saved_time  = std::filesystem::last_write_time(sidecar);
+    lod_pyramid<float> reopened    = lod_pyramid<float>::open(file, "/step_0/Ex", lod_filter::max);
+    auto               reused_time = std::filesystem::last_write_time(sidecar);
+    assert(reopened.level_count() == 5);
+    assert(reused_time == saved_time);
+
+    auto stale = std::filesystem::last_write_time(test_file) - std::chrono::hours(1);
+    std::filesystem::last_write_time(sidecar, stale);
+    lod_pyramid<float> rebuilt      = lod_pyramid<float>::open(file, "/step_0/Ex", lod_filter::max);
+    auto               rebuilt_time = std::filesystem::last_write_time(sidecar);
+    assert(rebuilt_time > stale);
+    check_levels(rebuilt, field.view());
+
+    std::filesystem::remove(sidecar);
+    std::cout << "Persistence test passed.\n";
+}
+
+// Test level selection by screen-space error
+void test_select() {
+    ndarray<float, 3>  field(64, 64, 32);
+    lod_pyramid<float> pyramid(field.view(), lod_filter::mean);
+    assert(pyramid.level_count() == 7);
+
+    const std::size_t begin[3] = { 0, 0, 0 };
+    const std::size_t end[3]   = { 64, 64, 32 };
+    // one source voxel per pixel: only the source is accurate enough
+    assert(pyramid.select(begin, end, 64.0).level == 0);
+    // four source voxels per pixel
+    lod_selection quarter = pyramid.select(begin, end, 16.0);
+    assert(quarter.level == 2);
+    assert(quarter.extent[0] == 16 && quarter.extent[2] == 8);
+    // a looser tolerance allows one more level
+    assert(pyramid.select(begin, end, 16.0, 2.0).level == 3);
+    // tiny on screen: the coarsest level
+    assert(pyramid.select(begin, end, 0.01).level == 6);
+
+    // a sub-box rounds outward to whole voxels of the chosen level
+    const std::size_t box_begin[3] = { 5, 10, 3 };
+    const std::size_t box_end[3]   = { 13, 30, 4 };
+    lod_selection     box          = pyramid.select(box_begin, box_end, 5.0);
+    assert(box.level == 2);
+    assert(box.begin[0] == 1 && box.extent[0] == 3);
+    assert(box.begin[1] == 2 && box.extent[1] == 6);
+    assert(box.begin[2] == 0 && box.extent[2] == 1);
+
+    std::cout << "Select test passed.\n";
+}
+
+int main() {
+    test_build_in_memory();
+    test_build_streamed();
+    test_persistence();
+    test_select();
+
+    std::filesystem::remove(test_file);
+    std::cout << "All tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,326 @@
+#include "velm/core/ndarray.h"
+#include "velm/core/thread_pool.h"
+#include "velm/io/tiled_field.h"
+#include "velm/processing/lod_pyramid.h"
+#include "velm/processing/out_of_core.h"
+#include "velm/processing/stencil.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#    include <malloc.h>
+#    include <sys/resource.h>
+#endif
+
+using velm_DP::boundary;
+using velm_DP::difference;
+using velm_DP::lod_filter;
+using velm_DP::stencil_options;
+using velm_DR::ndarray;
+using vlem::tile_access;
+using vlem::tiled_field;
+using vlem::tiled_options;
+
+namespace {
+
+const std::filesystem::path temp_dir = std::filesystem::temp_directory_path();
+
+// a tiled field over a fresh raw scratch file, which is removed with it
+class scratch {
+  public:
+    scratch(const std::string & name, const std::size_t (&dims)[3], const tiled_options & options) :
+        path((temp_dir / ("velm_test_out_of_core_" + name + ".raw")).string()),
+        field(std::make_shared<vlem::raw_tile_store<float>>(path, dims), options) {}
+
+    ~scratch() {
+        field.release_all();
+        std::filesystem::remove(path);
+    }
+
+    std::string        path;
+    tiled_field<float> field;
+};
+
+// deterministic values in [-1, 1)
+ndarray<float, 3> make_field(std::size_t nx, std::size_t ny, std::size_t nz, unsigned seed) {
+    ndarray<float, 3> field(nx, ny, nz);
+    unsigned          state = seed * 2654435761u + 1;
+    for (float & value : field) {
+        state = state * 1664525u + 1013904223u;
+        value = static_cast<float>(state >> 8) / static_cast<float>(1u << 24) * 2.0f - 1.0f;
+    }
+    return field;
+}
+
+void store(tiled_field<float> & field, const ndarray<float, 3> & values) {
+    velm_DP::for_each_tile(field, tile_access::overwrite, [&](const std::size_t (&origin)[3], auto tile) {
+        vlem::detail::copy_box<float>(values.subarray(origin, tile.dims), tile);
+    });
+}
+
+ndarray<float, 3> load(tiled_field<float> & field) {
+    ndarray<float, 3> values(field.dims()[0], field.dims()[1], field.dims()[2]);
+    field.read_box({ 0, 0, 0 }, values.view());
+    return values;
+}
+
+bool same(const ndarray<float, 3> & a, velm_DR::ndarray_view<const float, 3> b) {
+    for (std::size_t i = 0; i < a.dims[0]; ++i) {
+        for (std::size_t j = 0; j < a.dims[1]; ++j) {
+            for (std::size_t k = 0; k < a.dims[2]; ++k) {
+                if (std::abs(a(i, j, k) - b(i, j, k)) > 1e-5f * std::max(1.0f, std::abs(b(i, j, k)))) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+tiled_options small_tiles() {
+    tiled_options options;
+    options.tile[0]        = 4;
+    options.tile[1]        = 3;
+    options.tile[2]        = 5;
+    options.resident_bytes = 6 * 4 * 3 * 5 * sizeof(float);  // far less than any of the fields
+    return options;
+}
+
+}  // namespace
+
+// Test that the stencils give the in-core result across tile seams, for every scheme and boundary
+void test_stencil_seams() {
+    const std::size_t shapes[2][3] = { { 13, 10, 7 }, { 9, 7, 1 } };
+    for (const auto & dims : shapes) {
+        ndarray<float, 3> fx = make_field(dims[0], dims[1], dims[2], 1);
+        ndarray<float, 3> fy = make_field(dims[0], dims[1], dims[2], 2);
+        ndarray<float, 3> fz = make_field(dims[0], dims[1], dims[2], 3);
+
+        tiled_options options = small_tiles();
+        scratch       tx("fx", dims, options), ty("fy", dims, options), tz("fz", dims, options);
+        scratch       ox("ox", dims, options), oy("oy", dims, options), oz("oz", dims, options);
+        store(tx.field, fx);
+        store(ty.field, fy);
+        store(tz.field, fz);
+
+        for (difference scheme : { difference::central, difference::forward, difference::backward }) {
+            for (boundary edges : { boundary::one_sided, boundary::periodic, boundary::zero }) {
+                stencil_options<float> stencil;
+                stencil.spacing[0] = 0.5f;
+                stencil.spacing[2] = 2.0f;
+                stencil.scheme     = scheme;
+                stencil.edges      = edges;
+
+                ndarray<float, 3> cx(dims[0], dims[1], dims[2]), cy(dims[0], dims[1], dims[2]),
+                    cz(dims[0], dims[1], dims[2]);
+                velm_DP::curl<float>(fx.view(), fy.view(), fz.view(), cx.view(), cy.view(), cz.view(), stencil);
+                velm_DP::curl(tx.field, ty.field, tz.field, ox.field, oy.field, oz.field, stencil);
+                ndarray<float, 3> rx = load(ox.field), ry = load(oy.field), rz = load(oz.field);
+                assert(same(rx, cx.view()) && same(ry, cy.view()) && same(rz, cz.view()));
+
+                velm_DP::gradient<float>(fx.view(), cx.view(), cy.view(), cz.view(), stencil);
+                velm_DP::gradient(tx.field, ox.field, oy.field, oz.field, stencil);
+                ndarray<float, 3> gx = load(ox.field), gy = load(oy.field), gz = load(oz.field);
+                assert(same(gx, cx.view()) && same(gy, cy.view()) && same(gz, cz.view()));
+
+                velm_DP::divergence<float>(fx.view(), fy.view(), fz.view(), cx.view(), stencil);
+                velm_DP::divergence(tx.field, ty.field, tz.field, ox.field, stencil);
+                ndarray<float, 3> div = load(ox.field);
+                assert(same(div, cx.view()));
+            }
+        }
+    }
+
+    std::cout << "Stencil seams test passed.\n";
+}
+
+// Test that downsampling tile by tile matches level 1 of an in-core pyramid
+void test_downsample() {
+    const std::size_t dims[3]   = { 13, 10, 7 };
+    const std::size_t coarse[3] = { 7, 5, 4 };
+    ndarray<float, 3> values    = make_field(13, 10, 7, 4);
+    tiled_options     options   = small_tiles();
+    scratch           in("fine", dims, options), out("coarse", coarse, options);
+    store(in.field, values);
+
+    for (lod_filter filter : { lod_filter::min, lod_filter::max, lod_filter::mean }) {
+        velm_DP::downsample(in.field, filter, out.field);
+        velm_DP::lod_pyramid<float> pyramid(values.view(), filter, { 1, nullptr });
+        ndarray<float, 3>           tiled = load(out.field);
+        assert(same(tiled, pyramid.level(1)));
+    }
+
+    std::cout << "Downsample test passed.\n";
+}
+
+// Test the per-tile callables and the merged reduction
+void test_transform_and_reduce() {
+    const std::size_t dims[3] = { 13, 10, 7 };
+    ndarray<float, 3> a       = make_field(13, 10, 7, 5);
+    ndarray<float, 3> b       = make_field(13, 10, 7, 6);
+    tiled_options     options = small_tiles();
+    scratch           ta("a", dims, options), tb("b", dims, options), sum("sum", dims, options);
+    store(ta.field, a);
+    store(tb.field, b);
+
+    velm_DP::transform_tiles(
+        sum.field,
+        [](auto out, velm_DR::ndarray_view<const float, 3> x, velm_DR::ndarray_view<const float, 3> y) {
+            for (std::size_t i = 0; i < out.dims[0]; ++i) {
+                for (std::size_t j = 0; j < out.dims[1]; ++j) {
+                    for (std::size_t k = 0; k < out.dims[2]; ++k) {
+                        out(i, j, k) = x(i, j, k) + 2.0f * y(i, j, k);
+                    }
+                }
+            }
+        },
+        ta.field, tb.field);
+    ndarray<float, 3> expected = a + 2.0f * b;
+    ndarray<float, 3> summed   = load(sum.field);
+    assert(same(summed, expected.view()));
+
+    // in place: the output is also the input
+    velm_DP::transform_tiles(
+        ta.field,
+        [](auto out, velm_DR::ndarray_view<const float, 3> x) {
+            for (std::size_t i = 0; i < out.dims[0]; ++i) {
+                for (std::size_t j = 0; j < out.dims[1]; ++j) {
+                    for (std::size_t k = 0; k < out.dims[2]; ++k) {
+                        out(i, j, k) = -x(i, j, k);
+                    }
+                }
+            }
+        },
+        ta.field);
+    ndarray<float, 3> negated  = -a;
+    ndarray<float, 3> in_place = load(ta.field);
+    assert(same(in_place, negated.view()));
+
+    velm_DP::field_stats<float> tiled   = velm_DP::reduce_stats(sum.field);
+    velm_DP::field_stats<float> in_core = velm_DP::reduce_stats(expected);
+    assert(tiled.count == expected.total_elements());
+    assert(tiled.min == in_core.min && tiled.max == in_core.max);
+    assert(std::abs(tiled.sum - in_core.sum) < 1e-3);
+
+    std::cout << "Transform and reduce test passed.\n";
+}
+
+#ifdef __linux__
+
+namespace {
+
+std::size_t data_segment_bytes() {
+    std::ifstream status("/proc/self/status");
+    std::string   line;
+    while (std::getline(status, line)) {
+        std::size_t kilobytes = 0;
+        if (std::sscanf(line.c_str(), "VmData: %zu kB", &kilobytes) == 1) {
+            return kilobytes * 1024;
+        }
+    }
+    return 0;
+}
+
+}  // namespace
+
+// Test a grid many times larger than the memory the process may allocate
+void test_memory_cap() {
+    const std::size_t n           = 256;
+    const std::size_t dims[3]     = { n, n, n };
+    const std::size_t coarse[3]   = { n / 2, n / 2, n / 2 };
+    const std::size_t field_bytes = n * n * n * sizeof(float);
+
+#    ifdef __GLIBC__
+    // otherwise freed tile-sized buffers stay in glibc's per-thread heaps, see tiled_field.h
+    mallopt(M_MMAP_THRESHOLD, 64 << 10);
+#    endif
+    // threads and their stacks exist before the cap
+    velm_DR::thread_pool pool(2);
+    pool.parallel_for(8, 1, [](std::size_t, std::size_t) {});
+    tiled_options options;
+    options.tile[0]        = 32;
+    options.tile[1]        = 32;
+    options.tile[2]        = 32;
+    options.resident_bytes = std::size_t(2) << 20;  // 16 tiles of each 64 MiB field
+    options.pool           = &pool;
+
+    scratch phi("phi", dims, options), gx("gx", dims, options), gy("gy", dims, options), gz("gz", dims, options);
+    scratch mean("mean", coarse, options);
+
+    rlimit previous;
+    getrlimit(RLIMIT_DATA, &previous);
+    const std::size_t cap   = data_segment_bytes() + (std::size_t(24) << 20);
+    rlimit            limit = previous;
+    limit.rlim_cur          = cap;
+    assert(field_bytes > 2 * (cap - data_segment_bytes()));
+    if (setrlimit(RLIMIT_DATA, &limit) != 0) {
+        std::cout << "Memory cap test skipped, RLIMIT_DATA cannot be set.\n";
+        return;
+    }
+
+    bool threw = false;
+    try {
+        ndarray<float, 3> whole(velm_DR::uninitialized, dims);
+    } catch (const std::bad_alloc &) {
+        threw = true;
+    }
+    assert(threw);
+
+    // phi = i + 2j + 3k, exact in float over this grid
+    velm_DP::for_each_tile(phi.field, tile_access::overwrite, [](const std::size_t (&origin)[3], auto tile) {
+        for (std::size_t i = 0; i < tile.dims[0]; ++i) {
+            for (std::size_t j = 0; j < tile.dims[1]; ++j) {
+                for (std::size_t k = 0; k < tile.dims[2]; ++k) {
+                    tile(i, j, k) = static_cast<float>(origin[0] + i + 2 * (origin[1] + j) + 3 * (origin[2] + k));
+                }
+            }
+        }
+    });
+
+    velm_DP::field_stats<float> stats = velm_DP::reduce_stats(phi.field);
+    const double                axis  = static_cast<double>(n * (n - 1) / 2) * static_cast<double>(n * n);
+    assert(stats.count == n * n * n && stats.min == 0.0f && stats.max == 6.0f * (n - 1));
+    assert(stats.sum == 6.0 * axis);
+
+    velm_DP::gradient(phi.field, gx.field, gy.field, gz.field);
+    for (auto [field, slope] : { std::pair{ &gx, 1.0f }, std::pair{ &gy, 2.0f }, std::pair{ &gz, 3.0f } }) {
+        velm_DP::field_stats<float> g = velm_DP::reduce_stats(field->field);
+        assert(g.min == slope && g.max == slope);
+    }
+
+    velm_DP::downsample(phi.field, lod_filter::mean, mean.field);
+    velm_DP::field_stats<float> m = velm_DP::reduce_stats(mean.field);
+    assert(m.min == 3.0f && m.max == 6.0f * (n - 1) - 3.0f);
+
+    assert(phi.field.counters().peak_bytes <= options.resident_bytes);
+    assert(gx.field.counters().evictions > 0);
+    setrlimit(RLIMIT_DATA, &previous);
+
+    std::cout << "Memory cap test passed.\n";
+}
+
+#endif
+
+int main() {
+    test_stencil_seams();
+    test_downsample();
+    test_transform_and_reduce();
+#ifdef __linux__
+    test_memory_cap();
+#endif
+
+    std::cout << "All tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,239 @@
+#include "velm/core/ndarray.h"
+#include "velm/core/thread_pool.h"
+#include "velm/processing/stencil.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+
+using velm_DP::boundary;
+using velm_DP::difference;
+using velm_DP::stencil_options;
+using velm_DR::ndarray;
+
+namespace {
+
+template <typename T> bool close(T a, T b) {
+    T tolerance = sizeof(T) == 4 ? T(1e-4) : T(1e-10);
+    return std::abs(a - b) <= tolerance * std::max(T(1), std::abs(b));
+}
+
+template <typename T> T max_abs(const ndarray<T, 3> & field) {
+    T result = T(0);
+    for (const T & value : field) {
+        result = std::max(result, std::abs(value));
+    }
+    return result;
+}
+
+// deterministic values in [-1, 1)
+template <typename T> ndarray<T, 3> make_field(std::size_t nx, std::size_t ny, std::size_t nz, unsigned seed) {
+    ndarray<T, 3> field(nx, ny, nz);
+    unsigned      state = seed * 2654435761u + 1;
+    for (T & value : field) {
+        state = state * 1664525u + 1013904223u;
+        value = static_cast<T>(state >> 8) / static_cast<T>(1u << 24) * T(2) - T(1);
+    }
+    return field;
+}
+
+template <typename T> void check_linear_gradient() {
+    const std::size_t nx = 7, ny = 5, nz = 19;
+    ndarray<T, 3>     phi(nx, ny, nz);
+    for (std::size_t i = 0; i < nx; ++i) {
+        for (std::size_t j = 0; j < ny; ++j) {
+            for (std::size_t k = 0; k < nz; ++k) {
+                phi(i, j, k) = T(3) * T(i) * T(0.5) - T(2) * T(j) * T(0.25) + T(k) * T(0.125);
+            }
+        }
+    }
+    for (difference scheme : { difference::central, difference::forward, difference::backward }) {
+        stencil_options<T> options;
+        options.spacing[0] = T(0.5);
+        options.spacing[1] = T(0.25);
+        options.spacing[2] = T(0.125);
+        options.scheme     = scheme;
+        ndarray<T, 3> gx(nx, ny, nz), gy(nx, ny, nz), gz(nx, ny, nz);
+        velm_DP::gradient<T>(phi.view(), gx.view(), gy.view(), gz.view(), options);
+        for (std::size_t n = 0; n < phi.total_elements(); ++n) {
+            assert(close(gx.data[n], T(3)));
+            assert(close(gy.data[n], T(-2)));
+            assert(close(gz.data[n], T(1)));
+        }
+    }
+}
+
+// on a periodic Yee grid curl grad and div curl vanish up to rounding, as in the continuum
+template <typename T> void check_identities() {
+    const std::size_t nx = 9, ny = 12, nz = 21;
+    ndarray<T, 3>     phi = make_field<T>(nx, ny, nz, 1);
+
+    stencil_options<T> options;
+    options.spacing[0] = T(0.5);
+    options.spacing[1] = T(2);
+    options.scheme     = difference::forward;
+    options.edges      = boundary::periodic;
+
+    ndarray<T, 3> gx(nx, ny, nz), gy(nx, ny, nz), gz(nx, ny, nz);
+    velm_DP::gradient<T>(phi.view(), gx.view(), gy.view(), gz.view(), options);
+    ndarray<T, 3> cx(nx, ny, nz), cy(nx, ny, nz), cz(nx, ny, nz);
+    velm_DP::curl<T>(gx.view(), gy.view(), gz.view(), cx.view(), cy.view(), cz.view(), options);
+    T tolerance = sizeof(T) == 4 ? T(1e-4) : T(1e-11);
+    assert(max_abs(cx) < tolerance && max_abs(cy) < tolerance && max_abs(cz) < tolerance);
+
+    ndarray<T, 3> ex = make_field<T>(nx, ny, nz, 2), ey = make_field<T>(nx, ny, nz, 3);
+    ndarray<T, 3> ez = make_field<T>(nx, ny, nz, 4);
+    velm_DP::curl<T>(ex.view(), ey.view(), ez.view(), cx.view(), cy.view(), cz.view(), options);
+    assert(max_abs(cx) > T(0.1));
+    ndarray<T, 3> div(nx, ny, nz);
+    velm_DP::divergence<T>(cx.view(), cy.view(), cz.view(), div.view(), options);
+    assert(max_abs(div) < tolerance);
+
+    // E on edges to H on faces and back: backward differences undo the staggering of forward ones
+    options.scheme = difference::backward;
+    velm_DP::curl<T>(gx.view(), gy.view(), gz.view(), cx.view(), cy.view(), cz.view(), options);
+    assert(max_abs(cx) > T(0.1));
+    velm_DP::divergence<T>(ex.view(), ey.view(), ez.view(), div.view(), options);
+    assert(max_abs(div) > T(0.1));
+}
+
+template <typename T> void check_rotation() {
+    const std::size_t nx = 6, ny = 8, nz = 3;
+    ndarray<T, 3>     fx(nx, ny, nz), fy(nx, ny, nz), fz(nx, ny, nz);
+    for (std::size_t i = 0; i < nx; ++i) {
+        for (std::size_t j = 0; j < ny; ++j) {
+            for (std::size_t k = 0; k < nz; ++k) {
+                fx(i, j, k) = -T(j);
+                fy(i, j, k) = T(i);
+            }
+        }
+    }
+    ndarray<T, 3> cx(nx, ny, nz), cy(nx, ny, nz), cz(nx, ny, nz), div(nx, ny, nz);
+    velm_DP::curl<T>(fx.view(), fy.view(), fz.view(), cx.view(), cy.view(), cz.view());
+    velm_DP::divergence<T>(fx.view(), fy.view(), fz.view(), div.view());
+    for (std::size_t n = 0; n < cz.total_elements(); ++n) {
+        assert(cx.data[n] == T(0) && cy.data[n] == T(0));
+        assert(close(cz.data[n], T(2)));
+        assert(div.data[n] == T(0));
+    }
+}
+
+}  // namespace
+
+// Test that every scheme differentiates a linear field exactly, boundaries included
+void test_linear_gradient() {
+    check_linear_gradient<float>();
+    check_linear_gradient<double>();
+
+    std::cout << "Linear gradient test passed.\n";
+}
+
+// Test curl grad = 0 and div curl = 0 on a staggered periodic grid
+void test_vector_identities() {
+    check_identities<float>();
+    check_identities<double>();
+
+    std::cout << "Vector identities test passed.\n";
+}
+
+// Test curl and divergence of a rigid rotation
+void test_rotation() {
+    check_rotation<float>();
+    check_rotation<double>();
+
+    std::cout << "Rotation test passed.\n";
+}
+
+// Test that results do not depend on the number of threads
+void test_thread_independence() {
+    const std::size_t nx = 13, ny = 37, nz = 29;
+    ndarray<double, 3> ex = make_field<double>(nx, ny, nz, 5), ey = make_field<double>(nx, ny, nz, 6);
+    ndarray<double, 3> ez = make_field<double>(nx, ny, nz, 7);
+
+    velm_DR::thread_pool    serial(0);
+    velm_DR::thread_pool    parallel(4);
+    ndarray<double, 3>      a[3] = { { nx, ny, nz }, { nx, ny, nz }, { nx, ny, nz } };
+    ndarray<double, 3>      b[3] = { { nx, ny, nz }, { nx, ny, nz }, { nx, ny, nz } };
+    stencil_options<double> options;
+    options.pool = &serial;
+    velm_DP::curl<double>(ex.view(), ey.view(), ez.view(), a[0].view(), a[1].view(), a[2].view(), options);
+    options.pool = &parallel;
+    velm_DP::curl<double>(ex.view(), ey.view(), ez.view(), b[0].view(), b[1].view(), b[2].view(), options);
+    for (std::size_t c = 0; c < 3; ++c) {
+        for (std::size_t n = 0; n < a[c].total_elements(); ++n) {
+            assert(a[c].data[n] == b[c].data[n]);
+        }
+    }
+
+    std::cout << "Thread independence test passed.\n";
+}
+
+// Test strided inputs and outputs and zero boundaries
+void test_views_and_boundaries() {
+    const std::size_t nx = 10, ny = 4, nz = 6;
+    ndarray<float, 3> phi = make_field<float>(nx, ny, nz, 8);
+    ndarray<float, 3> full[3] = { { nx, ny, nz }, { nx, ny, nz }, { nx, ny, nz } };
+    velm_DP::gradient<float>(phi.view(), full[0].view(), full[1].view(), full[2].view());
+
+    // every other plane along x behaves like a grid with twice the spacing
+    stencil_options<float> options;
+    options.spacing[0]       = 2.0f;
+    ndarray<float, 3> out[3] = { { nx, ny, nz }, { nx, ny, nz }, { nx, ny, nz } };
+    ndarray<float, 3> coarse(nx / 2, ny, nz);
+    for (std::size_t i = 0; i < nx / 2; ++i) {
+        for (std::size_t j = 0; j < ny; ++j) {
+            for (std::size_t k = 0; k < nz; ++k) {
+                coarse(i, j, k) = phi(2 * i, j, k);
+            }
+        }
+    }
+    velm_DP::gradient<float>(phi.slice(0, 0, nx, 2), out[0].slice(0, 0, nx, 2), out[1].slice(0, 0, nx, 2),
+                             out[2].slice(0, 0, nx, 2), options);
+    ndarray<float, 3> reference[3] = { { nx / 2, ny, nz }, { nx / 2, ny, nz }, { nx / 2, ny, nz } };
+    velm_DP::gradient<float>(coarse.view(), reference[0].view(), reference[1].view(), reference[2].view(),
+                             options);
+    for (std::size_t i = 0; i < nx / 2; ++i) {
+        for (std::size_t j = 0; j < ny; ++j) {
+            for (std::size_t k = 0; k < nz; ++k) {
+                for (std::size_t c = 0; c < 3; ++c) {
+                    assert(out[c](2 * i, j, k) == reference[c](i, j, k));
+                }
+                assert(out[1](2 * i, j, k) == full[1](2 * i, j, k));
+                assert(out[2](2 * i, j, k) == full[2](2 * i, j, k));
+            }
+        }
+    }
+
+    // a constant field drops to zero just outside the grid
+    ndarray<float, 3> ones(nx, ny, nz);
+    ones.fill(1.0f);
+    options.spacing[0]     = 0.5f;
+    options.scheme         = difference::forward;
+    options.edges          = boundary::zero;
+    ndarray<float, 3> & gx = out[0];
+    velm_DP::gradient<float>(ones.view(), gx.view(), out[1].view(), out[2].view(), options);
+    for (std::size_t j = 0; j < ny; ++j) {
+        for (std::size_t k = 0; k < nz; ++k) {
+            for (std::size_t i = 0; i + 1 < nx; ++i) {
+                assert(gx(i, j, k) == 0.0f);
+            }
+            assert(gx(nx - 1, j, k) == -2.0f);
+            assert(out[1](0, j, k) == (j + 1 < ny ? 0.0f : -1.0f));
+            assert(out[2](0, j, nz - 1) == -1.0f);
+        }
+    }
+
+    std::cout << "Views and boundaries test passed.\n";
+}
+
+int main() {
+    test_linear_gradient();
+    test_vector_identities();
+    test_rotation();
+    test_thread_independence();
+    test_views_and_boundaries();
+
+    std::cout << "All tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,195 @@
+#include "velm/core/ndarray.h"
+#include "velm/core/thread_pool.h"
+#include "velm/processing/streamlines.h"
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <numbers>
+
+using velm_DP::streamline_options;
+using velm_DP::streamline_set;
+using velm_DP::trace_direction;
+using velm_DP::trace_streamlines;
+using velm_DR::ndarray;
+
+namespace {
+
+struct vector_field {
+    ndarray<float, 3> x, y, z;
+
+    vector_field(std::size_t nx, std::size_t ny, std::size_t nz) : x(nx, ny, nz), y(nx, ny, nz), z(nx, ny, nz) {}
+};
+
+ndarray<float, 2> make_seeds(std::initializer_list<std::array<float, 3>> points) {
+    ndarray<float, 2> seeds(points.size(), 3);
+    std::size_t       s = 0;
+    for (const auto & p : points) {
+        for (std::size_t a = 0; a < 3; ++a) {
+            seeds(s, a) = p[a];
+        }
+        ++s;
+    }
+    return seeds;
+}
+
+streamline_set trace(const vector_field & v, const ndarray<float, 2> & seeds, const streamline_options & options) {
+    return trace_streamlines(v.x.view(), v.y.view(), v.z.view(), seeds.view(), options);
+}
+
+}  // namespace
+
+// Test straight lines in a uniform field, in world coordinates and in every direction mode
+void test_uniform() {
+    vector_field v(10, 6, 6);
+    v.x.fill(0.5f);
+    streamline_options options;
+    options.spacing[0] = 2.0f;
+    options.origin[1]  = -3.0f;
+    ndarray<float, 2> seeds = make_seeds({ { 7.0f, -1.0f, 2.5f } });
+
+    for (trace_direction direction : { trace_direction::forward, trace_direction::backward, trace_direction::both }) {
+        options.direction  = direction;
+        streamline_set set = trace(v, seeds, options);
+        assert(set.line_count() == 1 && set.first[0] == 0);
+        assert(static_cast<std::size_t>(set.count[0]) == set.vertices.size() && set.count[0] > 2);
+
+        const velm_DP::line_vertex & front = set.vertices.front();
+        const velm_DP::line_vertex & back  = set.vertices.back();
+        for (const velm_DP::line_vertex & p : set.vertices) {
+            assert(p.position[1] == -1.0f && p.position[2] == 2.5f && p.speed == 0.5f);
+        }
+        for (std::size_t n = 1; n < set.vertices.size(); ++n) {
+            assert(set.vertices[n].position[0] > set.vertices[n - 1].position[0]);
+        }
+        // the grid spans x in [0, 18]; lines stop within the last step of its faces
+        assert(direction == trace_direction::forward ? front.position[0] == 7.0f : front.position[0] < 4.0f);
+        assert(direction == trace_direction::backward ? back.position[0] == 7.0f : back.position[0] > 14.0f);
+        assert(front.position[0] >= 0.0f && back.position[0] <= 18.0f);
+    }
+
+    std::cout << "Uniform test passed.\n";
+}
+
+// Test that a rigid rotation, which trilinear interpolation reproduces exactly, closes into a circle
+void test_circle() {
+    vector_field v(33, 33, 3);
+    for (std::size_t i = 0; i < 33; ++i) {
+        for (std::size_t j = 0; j < 33; ++j) {
+            for (std::size_t k = 0; k < 3; ++k) {
+                v.x(i, j, k) = -(static_cast<float>(j) - 16.0f);
+                v.y(i, j, k) = static_cast<float>(i) - 16.0f;
+            }
+        }
+    }
+    streamline_options options;
+    options.direction  = trace_direction::forward;
+    options.max_length = 2.0f * std::numbers::pi_v<float> * 10.0f;
+    options.tolerance  = 1e-5f;
+    streamline_set set = trace(v, make_seeds({ { 26.0f, 16.0f, 1.0f } }), options);
+
+    for (const velm_DP::line_vertex & p : set.vertices) {
+        float r = std::hypot(p.position[0] - 16.0f, p.position[1] - 16.0f);
+        assert(std::abs(r - 10.0f) < 1e-3f);
+        assert(std::abs(p.speed - r) < 1e-3f);
+    }
+    // one full turn ends where it began
+    const velm_DP::line_vertex & end = set.vertices.back();
+    assert(std::hypot(end.position[0] - 26.0f, end.position[1] - 16.0f) < 1e-2f);
+    // an accurate circle takes more than a handful of steps, but the step size grows well beyond the first
+    assert(set.vertices.size() > 20 && set.vertices.size() < 400);
+
+    options.max_points = 10;
+    assert(trace(v, make_seeds({ { 26.0f, 16.0f, 1.0f } }), options).vertices.size() == 10);
+
+    std::cout << "Circle test passed.\n";
+}
+
+// Test seeds that cannot start a line, and lines ending at a null of the field
+void test_degenerate() {
+    vector_field v(8, 8, 8);
+    streamline_options options;
+    // a null field and a seed outside the grid
+    streamline_set set = trace(v, make_seeds({ { 3.0f, 3.0f, 3.0f }, { -1.0f, 0.0f, 0.0f } }), options);
+    assert(set.line_count() == 2 && set.vertices.empty() && set.count[0] == 0 && set.count[1] == 0);
+
+    // flow into the plane x = 4 from both sides: the line ends there instead of crossing back and forth
+    for (std::size_t i = 0; i < 8; ++i) {
+        for (std::size_t j = 0; j < 8; ++j) {
+            for (std::size_t k = 0; k < 8; ++k) {
+                v.x(i, j, k) = 4.0f - static_cast<float>(i);
+            }
+        }
+    }
+    options.direction = trace_direction::forward;
+    set               = trace(v, make_seeds({ { 1.0f, 2.0f, 2.0f } }), options);
+    assert(set.count[0] > 1 && set.count[0] < 100);
+    assert(std::abs(set.vertices.back().position[0] - 4.0f) < 0.01f);
+
+    std::cout << "Degenerate test passed.\n";
+}
+
+// Test many lines of very different lengths: same buffer for any thread count, packed in seed order
+void test_parallel() {
+    vector_field v(24, 24, 24);
+    for (std::size_t i = 0; i < 24; ++i) {
+        for (std::size_t j = 0; j < 24; ++j) {
+            for (std::size_t k = 0; k < 24; ++k) {
+                float x = static_cast<float>(i) - 11.5f, y = static_cast<float>(j) - 11.5f;
+                v.x(i, j, k) = -y + 0.05f * x;
+                v.y(i, j, k) = x + 0.05f * y;
+                v.z(i, j, k) = 0.3f;
+            }
+        }
+    }
+    ndarray<float, 2> seeds(101, 3);
+    for (std::size_t s = 0; s < 101; ++s) {
+        seeds(s, 0) = 12.0f + 0.1f * static_cast<float>(s);
+        seeds(s, 1) = 11.5f;
+        seeds(s, 2) = static_cast<float>(s % 23);
+    }
+
+    velm_DR::thread_pool serial(0);
+    velm_DR::thread_pool parallel(3);
+    streamline_options   options;
+    options.pool        = &serial;
+    streamline_set base = trace(v, seeds, options);
+    options.pool        = &parallel;
+    streamline_set same = trace(v, seeds, options);
+
+    assert(base.vertices.size() == same.vertices.size() && base.first == same.first && base.count == same.count);
+    assert(std::memcmp(base.vertices.data(), same.vertices.data(), base.vertices.size() * sizeof(base.vertices[0])) ==
+           0);
+    std::size_t expected = 0;
+    int         shortest = base.count[0], longest = base.count[0];
+    for (std::size_t s = 0; s < base.line_count(); ++s) {
+        assert(static_cast<std::size_t>(base.first[s]) == expected);
+        expected += static_cast<std::size_t>(base.count[s]);
+        shortest = std::min(shortest, base.count[s]);
+        longest  = std::max(longest, base.count[s]);
+        // both directions meet at the seed
+        bool seen = false;
+        for (int n = 0; n < base.count[s]; ++n) {
+            const float * p = base.vertices[static_cast<std::size_t>(base.first[s] + n)].position;
+            seen |= p[0] == seeds(s, 0) && p[1] == seeds(s, 1) && p[2] == seeds(s, 2);
+        }
+        assert(seen);
+    }
+    assert(expected == base.vertices.size());
+    assert(longest > 4 * shortest);
+
+    std::cout << "Parallel test passed.\n";
+}
+
+int main() {
+    test_uniform();
+    test_circle();
+    test_degenerate();
+    test_parallel();
+
+    std::cout << "All tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,191 @@
+#include "velm/core/ndarray.h"
+#include "velm/core/thread_pool.h"
+#include "velm/render/frame_timer.h"
+#include "velm/render/texture_streamer.h"
+
+#ifdef VELM_HAVE_EGL
+#include "velm/render/headless_context.h"
+#endif
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <utility>
+
+using velm_DR::ndarray;
+using velm_GL::streamer_options;
+using velm_GL::texel_format;
+using velm_GL::texture_streamer;
+
+namespace {
+
+ndarray<float, 3> make_field(std::size_t nx, std::size_t ny, std::size_t nz, float offset) {
+    ndarray<float, 3> field(nx, ny, nz);
+    for (std::size_t i = 0; i < nx; ++i) {
+        for (std::size_t j = 0; j < ny; ++j) {
+            for (std::size_t k = 0; k < nz; ++k) {
+                field(i, j, k) = offset + std::sin(0.3f * i) * std::cos(0.2f * j) + 0.01f * k;
+            }
+        }
+    }
+    return field;
+}
+
+float max_error(const ndarray<float, 3> & a, const ndarray<float, 3> & b) {
+    float error = 0.0f;
+    for (std::size_t n = 0; n < a.total_elements(); ++n) {
+        error = std::max(error, std::abs(a.data[n] - b.data[n]));
+    }
+    return error;
+}
+
+}  // namespace
+
+// Test a full float32 upload, then a sub-region overwrite, through the texture contents
+void test_full_and_region() {
+    ndarray<float, 3> field = make_field(9, 7, 5, 0.0f);
+    texture_streamer  streamer(9, 7, 5);
+    streamer.upload<float>(field.view());
+
+    ndarray<float, 3> out(9, 7, 5);
+    streamer.read_back(out.view());
+    assert(max_error(out, field) == 0.0f);
+
+    // a 3x2x4 patch at (4, 5, 1), given as a strided view into a larger array
+    ndarray<double, 3> patch(6, 2, 8);
+    patch.fill(-2.5);
+    const std::size_t begin[3]  = { 0, 0, 0 };
+    const std::size_t extent[3] = { 3, 2, 4 };
+    const std::size_t origin[3] = { 4, 5, 1 };
+    streamer.upload<double>(patch.subarray(begin, extent), origin);
+    streamer.read_back(out.view());
+    for (std::size_t i = 0; i < 9; ++i) {
+        for (std::size_t j = 0; j < 7; ++j) {
+            for (std::size_t k = 0; k < 5; ++k) {
+                bool inside = i >= 4 && i < 7 && j >= 5 && k >= 1;
+                assert(out(i, j, k) == (inside ? -2.5f : field(i, j, k)));
+            }
+        }
+    }
+
+    const std::size_t outside[3] = { 7, 0, 0 };
+    bool              threw      = false;
+    try {
+        streamer.upload<double>(patch.subarray(begin, extent), outside);
+    } catch (const std::exception &) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "Full and region upload test passed.\n";
+}
+
+// Test the 16-bit formats against their quantisation error
+void test_formats() {
+    ndarray<float, 3> field = make_field(8, 8, 8, 3.0f);
+    ndarray<float, 3> out(8, 8, 8);
+
+    texture_streamer half(8, 8, 8, { .format = texel_format::float16 });
+    half.upload<float>(field.view());
+    half.read_back(out.view());
+    // values in [1.5, 4.5]: half spacing is at most 2^-8
+    assert(max_error(out, field) <= 1.0f / 512.0f);
+
+    streamer_options options;
+    options.format    = texel_format::unorm16;
+    options.range_min = 1.0f;
+    options.range_max = 5.0f;
+    texture_streamer quantised(8, 8, 8, options);
+    quantised.upload<float>(field.view());
+    quantised.read_back(out.view());
+    assert(max_error(out, field) <= 4.0f / 65535.0f);
+
+    // values outside the range clamp to its ends
+    field(0, 0, 0) = -10.0f;
+    field(1, 0, 0) = 10.0f;
+    quantised.upload<float>(field.view());
+    quantised.read_back(out.view());
+    assert(out(0, 0, 0) == 1.0f && out(1, 0, 0) == 5.0f);
+
+    std::cout << "Formats test passed.\n";
+}
+
+// Test that a volume larger than a staging slot goes up in slabs, with every slot fenced and reused
+void test_slabs() {
+    ndarray<float, 3>    field = make_field(20, 6, 10, 0.0f);
+    velm_DR::thread_pool pool(2);
+    streamer_options     options;
+    options.staging_bytes = 3 * 6 * 10 * sizeof(float);
+    options.pool          = &pool;
+    texture_streamer streamer(20, 6, 10, options);
+
+    for (int step = 0; step < 4; ++step) {
+        ndarray<float, 3> next = make_field(20, 6, 10, static_cast<float>(step));
+        streamer.upload<float>(next.view());
+        std::swap(field, next);
+    }
+    ndarray<float, 3> out(20, 6, 10);
+    streamer.read_back(out.view());
+    assert(max_error(out, field) == 0.0f);
+
+    const velm_GL::upload_stats & stats = streamer.stats();
+    assert(stats.uploads == 4);
+    assert(stats.slabs == 4 * 7);
+    assert(stats.bytes == 4 * field.total_elements() * sizeof(float));
+    streamer.finish();
+    assert(streamer.idle());
+
+    // with every slot free try_upload goes through
+    const std::size_t origin[3] = { 0, 0, 0 };
+    const bool        queued    = streamer.try_upload<float>(field.view(), origin);
+    assert(queued);
+    assert(streamer.stats().uploads == 5 && streamer.stats().skipped == 0);
+
+    std::cout << "Slabs test passed.\n";
+}
+
+// Test that frame times arrive for both clocks
+void test_frame_timer() {
+    velm_GL::frame_timer timer;
+    texture_streamer     streamer(16, 16, 16);
+    ndarray<float, 3>    field = make_field(16, 16, 16, 0.0f);
+    for (int frame = 0; frame < 8; ++frame) {
+        timer.begin_frame();
+        streamer.upload<float>(field.view());
+        timer.end_frame();
+    }
+    streamer.finish();
+    velm_GL::frame_stats stats = timer.stats();
+    assert(stats.frames == 8);
+    assert(stats.cpu_mean > 0.0 && stats.cpu_max >= stats.cpu_mean);
+    assert(stats.gpu_mean >= 0.0 && stats.gpu_max >= stats.gpu_mean);
+
+    std::cout << "Frame timer test passed.\n";
+}
+
+int main() {
+#ifdef VELM_HAVE_EGL
+    std::optional<velm_GL::headless_context> context;
+    try {
+        context.emplace();
+    } catch (const std::exception & error) {
+        std::cout << "Skipped, no OpenGL context: " << error.what() << "\n";
+        return 77;
+    }
+    std::cout << "Rendering on " << context->renderer() << "\n";
+
+    test_full_and_region();
+    test_formats();
+    test_slabs();
+    test_frame_timer();
+
+    std::cout << "All tests passed!\n";
+    return 0;
+#else
+    std::cout << "Skipped, built without EGL.\n";
+    return 77;
+#endif
+}